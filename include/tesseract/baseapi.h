@@ -548,6 +548,23 @@ class TESS_API TessBaseAPI {
                    const char* retry_config, int timeout_millisec,
                    TessResultRenderer* renderer);
 
+  /**
+   * Recognize a very large image in overlapping square tiles of
+   * tessedit_tile_size pixels, at most tessedit_tile_jobs at a time, so
+   * that the memory used is bounded by the tile size rather than the page
+   * size. ProcessPage calls this for images bigger than the tile size,
+   * unless a renderer needs more than the text or TSV output.
+   * Each tile is thresholded, laid out and recognized on its own. A word
+   * seen by more than one tile is kept only by the tile nearest to its
+   * centre, so tessedit_tile_overlap must exceed the biggest word.
+   * The merged words are available from GetUTF8Text and GetTSVText until
+   * the next image is set. Other outputs are not available in this mode.
+   * timeout_millisec, if positive, limits the time spent on each tile.
+   *
+   * Returns true if successful, false on error.
+   */
+  bool RecognizeTiled(Pix* pix, int timeout_millisec);
+
   /**
    * Get a reading-order iterator to the results of LayoutAnalysis and/or
    * Recognize. The returned iterator must be deleted after use.
@@ -685,6 +702,21 @@ class TESS_API TessBaseAPI {
    * Returns false if adaption was not possible for some reason.
    */
   bool AdaptToWordStr(PageSegMode mode, const char* wordstr);
+
+  /**
+   * Makes this engine share its adaptive classifier with other, which must
+   * be initialized with the same language, so that engines recognizing the
+   * pages of one document in parallel learn from each other's pages.
+   * Each engine keeps learning privately as it goes, and merges what it
+   * learns into templates shared by all the engines sharing with other,
+   * which it picks up at the start of each page.
+   * Both engines may be used from different threads at once. What the
+   * engines learned before the call is not shared. ClearAdaptiveClassifier
+   * stops the sharing, so to start a new document, clear all the engines
+   * and share them again.
+   * Returns false if the engines can't share.
+   */
+  bool ShareAdaptiveClassifier(TessBaseAPI* other);
 #endif  //  ndef DISABLED_LEGACY_ENGINE
 
   /**
@@ -846,6 +878,10 @@ class TESS_API TessBaseAPI {
   bool ProcessPagesFileList(FILE* fp, std::string* buf, const char* retry_config,
                             int timeout_millisec, TessResultRenderer* renderer,
                             int tessedit_page_number);
+  // Text and TSV output for the results of RecognizeTiled.
+  char* GetTiledUTF8Text() const;
+  char* GetTiledTSVText(int page_number) const;
+
   // TIFF supports multipage so gets special consideration.
   bool ProcessPagesMultipageTiff(const unsigned char* data, size_t size,
                                  const char* filename, const char* retry_config,
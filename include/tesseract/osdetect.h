@@ -121,9 +121,10 @@ int orientation_and_script_detection(const char* filename, OSResults*,
 int os_detect(TO_BLOCK_LIST* port_blocks, OSResults* osr,
               tesseract::Tesseract* tess);
 
+// num_threads > 1 classifies the blobs on that many threads.
 int os_detect_blobs(const std::vector<int>* allowed_scripts,
                     BLOBNBOX_CLIST* blob_list, OSResults* osr,
-                    tesseract::Tesseract* tess);
+                    tesseract::Tesseract* tess, int num_threads = 1);
 
 bool os_detect_blob(BLOBNBOX* bbox, OrientationDetector* o, ScriptDetector* s,
                     OSResults*, tesseract::Tesseract* tess);
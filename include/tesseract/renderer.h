@@ -107,6 +107,14 @@ class TESS_API TessResultRenderer {
     return imagenum_;
   }
 
+  /**
+   * Returns true if the renderer only needs the text or the TSV of a page,
+   * which is all that TessBaseAPI::RecognizeTiled provides.
+   */
+  virtual bool SupportsTiledResults() const {
+    return false;
+  }
+
  protected:
   /**
    * Called by concrete classes.
@@ -157,6 +165,10 @@ class TESS_API TessTextRenderer : public TessResultRenderer {
  public:
   explicit TessTextRenderer(const char* outputbase);
 
+  bool SupportsTiledResults() const override {
+    return true;
+  }
+
  protected:
   bool AddImageHandler(TessBaseAPI* api) override;
 };
@@ -199,6 +211,10 @@ class TESS_API TessTsvRenderer : public TessResultRenderer {
   explicit TessTsvRenderer(const char* outputbase, bool font_info);
   explicit TessTsvRenderer(const char* outputbase);
 
+  bool SupportsTiledResults() const override {
+    return true;
+  }
+
  protected:
   bool BeginDocumentHandler() override;
   bool AddImageHandler(TessBaseAPI* api) override;
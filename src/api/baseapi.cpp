@@ -46,6 +46,7 @@
 #if defined(USE_OPENCL)
 #include "openclwrapper.h"     // for OpenclDevice
 #endif
+#include "pagearena.h"         // for PageArena
 #include "pageres.h"           // for PAGE_RES_IT, WERD_RES, PAGE_RES, CR_DE...
 #include "paragraphs.h"        // for DetectParagraphs
 #include "params.h"            // for BoolParam, IntParam, DoubleParam, Stri...
@@ -554,6 +555,31 @@ void TessBaseAPI::ClearAdaptiveClassifier() {
     return;
   tesseract_->ResetAdaptiveClassifier();
   tesseract_->ResetDocumentDictionary();
+  tesseract_->ShareAdaptedTemplates(nullptr);
+}
+
+/**
+ * Makes this engine share its adaptive classifier with other, so that
+ * they learn from each other's pages. Only the main language is shared.
+ */
+bool TessBaseAPI::ShareAdaptiveClassifier(TessBaseAPI* other) {
+  if (tesseract_ == nullptr || other == nullptr ||
+      other->tesseract_ == nullptr || other == this)
+    return false;
+  if (tesseract_->lang != other->tesseract_->lang ||
+      tesseract_->unicharset.size() != other->tesseract_->unicharset.size()) {
+    tprintf("Can't share the adaptive classifier between %s and %s\n",
+            tesseract_->lang.c_str(), other->tesseract_->lang.c_str());
+    return false;
+  }
+  std::shared_ptr<SharedAdaptedTemplates> shared =
+      other->tesseract_->shared_adapted_templates();
+  if (shared == nullptr) {
+    shared = std::make_shared<SharedAdaptedTemplates>();
+    other->tesseract_->ShareAdaptedTemplates(shared);
+  }
+  tesseract_->ShareAdaptedTemplates(shared);
+  return true;
 }
 #endif  // ndef DISABLED_LEGACY_ENGINE
 
@@ -834,6 +860,10 @@ int TessBaseAPI::Recognize(ETEXT_DESC* monitor) {
 
   tesseract_->SetBlackAndWhitelist();
   recognition_done_ = true;
+  // The results of the page, and the objects made on the way to them, come
+  // from one arena that goes when the last of them is deleted.
+  PageArena* arena = tesseract_->tessedit_page_arena ? new PageArena : nullptr;
+  PageArena::Scope arena_scope(arena);
 #ifndef DISABLED_LEGACY_ENGINE
   if (tesseract_->tessedit_resegment_from_line_boxes) {
     page_res_ = tesseract_->ApplyBoxes(input_file_.c_str(), true, block_list_);
@@ -847,8 +877,10 @@ int TessBaseAPI::Recognize(ETEXT_DESC* monitor) {
   }
 
   if (page_res_ == nullptr) {
+    if (arena != nullptr) arena->Release();
     return -1;
   }
+  page_res_->arena = arena;
 
   if (tesseract_->tessedit_train_line_recognizer) {
     if (!tesseract_->TrainLineRecognizer(input_file_.c_str(), output_file_, block_list_)) {
@@ -1255,10 +1287,36 @@ bool TessBaseAPI::ProcessPagesInternal(const char* filename,
   return true;
 }
 
+// Returns true if every renderer in the chain can output the results of
+// RecognizeTiled, which only provides the text and the TSV.
+static bool RenderersSupportTiles(TessResultRenderer* renderer) {
+  for (; renderer != nullptr; renderer = renderer->next()) {
+    if (!renderer->SupportsTiledResults()) return false;
+  }
+  return true;
+}
+
 bool TessBaseAPI::ProcessPage(Pix* pix, int page_index, const char* filename,
                               const char* retry_config, int timeout_millisec,
                               TessResultRenderer* renderer) {
   SetInputName(filename);
+  int tile_size = tesseract_->tessedit_tile_size;
+  if (tile_size > 0 &&
+      (pixGetWidth(pix) > tile_size || pixGetHeight(pix) > tile_size) &&
+      tesseract_->tessedit_pageseg_mode != PSM_AUTO_ONLY &&
+      tesseract_->tessedit_pageseg_mode != PSM_OSD_ONLY) {
+    if (RenderersSupportTiles(renderer)) {
+      // Too big to process in one piece, so never set the whole image.
+      bool failed = !RecognizeTiled(pix, timeout_millisec);
+      if (renderer && !failed) {
+        failed = !renderer->AddImage(this);
+      }
+      return !failed;
+    }
+    tprintf("Warning: Recognizing the %dx%d image in one piece, as tiled "
+            "recognition only supports txt and tsv output.\n",
+            pixGetWidth(pix), pixGetHeight(pix));
+  }
   SetImage(pix);
   bool failed = false;
 
@@ -1367,6 +1425,8 @@ MutableIterator* TessBaseAPI::GetMutableIterator() {
 
 /** Make a text string from the internal data structures. */
 char* TessBaseAPI::GetUTF8Text() {
+  if (tesseract_ != nullptr && tesseract_->tiled_done())
+    return GetTiledUTF8Text();
   if (tesseract_ == nullptr ||
       (!recognition_done_ && Recognize(nullptr) < 0))
     return nullptr;
@@ -1399,6 +1459,8 @@ static void AddBoxToTSV(const PageIterator* it, PageIteratorLevel level,
  * Returned string must be freed with the delete [] operator.
  */
 char* TessBaseAPI::GetTSVText(int page_number) {
+  if (tesseract_ != nullptr && tesseract_->tiled_done())
+    return GetTiledTSVText(page_number);
   if (tesseract_ == nullptr || (page_res_ == nullptr && Recognize(nullptr) < 0))
     return nullptr;
 
@@ -0,0 +1,497 @@
+/**********************************************************************
+ * File:        tiledrecognize.cpp
+ * Description: Recognition of very large images in overlapping tiles.
+ *
+ ** Licensed under the Apache License, Version 2.0 (the "License");
+ ** you may not use this file except in compliance with the License.
+ ** You may obtain a copy of the License at
+ ** http://www.apache.org/licenses/LICENSE-2.0
+ ** Unless required by applicable law or agreed to in writing, software
+ ** distributed under the License is distributed on an "AS IS" BASIS,
+ ** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ ** See the License for the specific language governing permissions and
+ ** limitations under the License.
+ *
+ **********************************************************************/
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include <algorithm>  // for std::max, std::min, std::stable_sort
+#include <cstdlib>    // for std::abs
+#include <cstring>    // for strcpy
+#include <memory>     // for std::unique_ptr
+#include <string>     // for std::string
+#include <vector>     // for std::vector
+#include "allheaders.h"
+#include <tesseract/baseapi.h>  // for TessBaseAPI
+#include <tesseract/ocrclass.h>  // for ETEXT_DESC
+#include "params.h"          // for ParamUtils
+#include "tesseractclass.h"  // for Tesseract
+#include "tprintf.h"         // for tprintf
+
+namespace tesseract {
+
+// The extent of a tile along one axis, and the part of it, the core, that
+// owns the words whose centre falls in it. The cores of consecutive tiles
+// meet in the middle of their overlap.
+struct TileSpan {
+  int start;
+  int end;
+  int core_start;
+  int core_end;
+};
+
+// Divides [0, size) into spans of at most tile_size, overlapping by overlap.
+static std::vector<TileSpan> SplitIntoTiles(int size, int tile_size,
+                                            int overlap) {
+  std::vector<TileSpan> spans;
+  int step = tile_size - overlap;
+  for (int start = 0;; start += step) {
+    TileSpan span;
+    span.start = start;
+    span.end = std::min(size, start + tile_size);
+    span.core_start = start == 0 ? 0 : start + overlap / 2;
+    span.core_end = span.end == size ? size : start + step + overlap / 2;
+    spans.push_back(span);
+    if (span.end == size) break;
+  }
+  return spans;
+}
+
+// The engines for the tiles after the first, with the setup that they were
+// started with, so that they can be used again for the next image.
+class TileWorkers : public TileEngines {
+ public:
+  std::string datapath;
+  std::string language;
+  OcrEngineMode oem;
+  std::vector<std::string> names;
+  std::vector<std::string> values;
+  std::vector<std::unique_ptr<TessBaseAPI>> engines;
+};
+
+// The words of a textline that a tile owns, in page coordinates.
+struct TileLine {
+  int tile;
+  int block;         // Index of the block in the tile.
+  int starts_level;  // Of the first word, as TiledWord.
+  bool ltr;
+  int left, top, right, bottom;
+  // The x extent of the whole line as the tile saw it, with the words that
+  // other tiles own.
+  int seen_left, seen_right;
+  std::vector<TiledWord> words;
+};
+
+// Returns the root of i in a union-find forest.
+static int FindRoot(std::vector<int>* parents, int i) {
+  while ((*parents)[i] != i) {
+    (*parents)[i] = (*parents)[(*parents)[i]];
+    i = (*parents)[i];
+  }
+  return i;
+}
+
+// Returns true if parts a and b, from different tiles, are the same textline
+// that a seam cut in two: they share most of their height, and one of the
+// tiles saw the line carry on into the words of the other.
+static bool SameTextline(const TileLine& a, const TileLine& b) {
+  int overlap = std::min(a.bottom, b.bottom) - std::max(a.top, b.top);
+  int height = std::min(a.bottom - a.top, b.bottom - b.top);
+  if (2 * overlap < height) return false;
+  return (a.seen_left < b.right && a.seen_right > b.left) ||
+         (b.seen_left < a.right && b.seen_right > a.left);
+}
+
+// Puts the words of the tiles in reading order for the page. The textlines
+// that cross a seam are joined up, the blocks that they join, or that carry
+// on across a horizontal seam, are made one, and the blocks then come in the
+// order that the tiles first find them, each with its lines top to bottom.
+static void MergeTileLines(const std::vector<TileLine>& lines, int x_tiles,
+                           std::vector<TiledWord>* words) {
+  // The blocks are numbered over all the tiles, in tile order.
+  std::vector<int> block_ids(lines.size());
+  int num_blocks = 0;
+  for (size_t i = 0; i < lines.size(); ++i) {
+    if (i == 0 || lines[i].tile != lines[i - 1].tile ||
+        lines[i].block != lines[i - 1].block) {
+      ++num_blocks;
+    }
+    block_ids[i] = num_blocks - 1;
+  }
+  std::vector<int> line_parents(lines.size());
+  for (size_t i = 0; i < lines.size(); ++i) line_parents[i] = i;
+  std::vector<int> block_parents(num_blocks);
+  for (int b = 0; b < num_blocks; ++b) block_parents[b] = b;
+  // Boxes and line heights of the blocks of the tiles.
+  std::vector<TileLine> block_boxes(num_blocks);
+  std::vector<int> block_heights(num_blocks, 0);
+  for (size_t i = 0; i < lines.size(); ++i) {
+    const TileLine& line = lines[i];
+    TileLine& box = block_boxes[block_ids[i]];
+    if (block_heights[block_ids[i]] == 0) {
+      box.tile = line.tile;
+      box.left = line.left;
+      box.top = line.top;
+      box.right = line.right;
+      box.bottom = line.bottom;
+    }
+    box.left = std::min(box.left, line.left);
+    box.top = std::min(box.top, line.top);
+    box.right = std::max(box.right, line.right);
+    box.bottom = std::max(box.bottom, line.bottom);
+    block_heights[block_ids[i]] = std::max(block_heights[block_ids[i]],
+                                           std::max(1, line.bottom - line.top));
+  }
+  // Only the parts in neighbouring tiles can meet.
+  for (size_t i = 0; i < lines.size(); ++i) {
+    int x = lines[i].tile % x_tiles, y = lines[i].tile / x_tiles;
+    for (size_t j = i + 1; j < lines.size(); ++j) {
+      if (lines[j].tile == lines[i].tile) continue;
+      int x2 = lines[j].tile % x_tiles, y2 = lines[j].tile / x_tiles;
+      if (y2 > y + 1) break;
+      if (std::abs(x2 - x) > 1 || !SameTextline(lines[i], lines[j])) continue;
+      line_parents[FindRoot(&line_parents, j)] = FindRoot(&line_parents, i);
+      int b1 = FindRoot(&block_parents, block_ids[i]);
+      int b2 = FindRoot(&block_parents, block_ids[j]);
+      if (b1 != b2) block_parents[std::max(b1, b2)] = std::min(b1, b2);
+    }
+  }
+  // A block that goes on in the tile below shares most of its width with the
+  // one there, and the gap between them is no more than a line or two.
+  for (int b = 0; b < num_blocks; ++b) {
+    const TileLine& upper = block_boxes[b];
+    int x = upper.tile % x_tiles, y = upper.tile / x_tiles;
+    for (int b2 = b + 1; b2 < num_blocks; ++b2) {
+      const TileLine& lower = block_boxes[b2];
+      int x2 = lower.tile % x_tiles, y2 = lower.tile / x_tiles;
+      if (y2 > y + 1) break;
+      if (y2 != y + 1 || std::abs(x2 - x) > 1) continue;
+      int x_overlap = std::min(upper.right, lower.right) -
+                      std::max(upper.left, lower.left);
+      int width = std::min(upper.right - upper.left, lower.right - lower.left);
+      int gap = lower.top - upper.bottom;
+      int height = std::max(block_heights[b], block_heights[b2]);
+      if (2 * x_overlap < width || gap > 2 * height) continue;
+      int r1 = FindRoot(&block_parents, b);
+      int r2 = FindRoot(&block_parents, b2);
+      if (r1 != r2) block_parents[std::max(r1, r2)] = std::min(r1, r2);
+    }
+  }
+  // The parts of each textline, in the order that the tiles found them.
+  std::vector<std::vector<int>> line_parts(lines.size());
+  for (size_t i = 0; i < lines.size(); ++i)
+    line_parts[FindRoot(&line_parents, i)].push_back(i);
+  // The lines of each block. A block is rooted at the first tile block of
+  // it, so the roots come in the order that the tiles first find them.
+  std::vector<std::vector<int>> block_lines(num_blocks);
+  for (size_t i = 0; i < lines.size(); ++i) {
+    if (line_parts[i].empty()) continue;
+    block_lines[FindRoot(&block_parents, block_ids[i])].push_back(i);
+  }
+  for (int b = 0; b < num_blocks; ++b) {
+    std::vector<int>& block = block_lines[b];
+    for (int l : block) {
+      std::vector<int>& parts = line_parts[l];
+      bool ltr = lines[parts[0]].ltr;
+      std::stable_sort(parts.begin(), parts.end(), [&](int p1, int p2) {
+        return ltr ? lines[p1].left < lines[p2].left
+                   : lines[p1].right > lines[p2].right;
+      });
+    }
+    auto line_top = [&](int l) {
+      int top = lines[l].top;
+      for (int p : line_parts[l]) top = std::min(top, lines[p].top);
+      return top;
+    };
+    std::stable_sort(block.begin(), block.end(), [&](int l1, int l2) {
+      return line_top(l1) < line_top(l2);
+    });
+    for (size_t n = 0; n < block.size(); ++n) {
+      const std::vector<int>& parts = line_parts[block[n]];
+      // The start of a block in a tile other than the first of the page
+      // block is at best the start of a line.
+      int starts_level = lines[parts[0]].starts_level == 3 ? 3 : 4;
+      if (n == 0) starts_level = 2;
+      for (int p : parts) {
+        for (const TiledWord& tiled_word : lines[p].words) {
+          words->push_back(tiled_word);
+          words->back().starts_level = starts_level;
+          starts_level = 5;
+        }
+      }
+    }
+  }
+}
+
+bool TessBaseAPI::RecognizeTiled(Pix* pix, int timeout_millisec) {
+  if (tesseract_ == nullptr || pix == nullptr) return false;
+  int width = pixGetWidth(pix);
+  int height = pixGetHeight(pix);
+  int tile_size = tesseract_->tessedit_tile_size;
+  if (tile_size <= 0) tile_size = std::max(width, height);
+  // Keep the step between tiles at least half the tile size.
+  int overlap = std::max(0, std::min<int>(tesseract_->tessedit_tile_overlap,
+                                          tile_size / 2));
+  std::vector<TileSpan> x_spans = SplitIntoTiles(width, tile_size, overlap);
+  std::vector<TileSpan> y_spans = SplitIntoTiles(height, tile_size, overlap);
+  int num_tiles = x_spans.size() * y_spans.size();
+
+  // Extra engines, initialized and configured like this one, so that more
+  // than one tile can be in flight at once.
+  std::vector<TessBaseAPI*> engines(1, this);
+#ifdef _OPENMP
+  int jobs = std::min<int>(tesseract_->tessedit_tile_jobs, num_tiles);
+#else
+  int jobs = 1;
+#endif
+  if (jobs > 1) {
+    std::vector<std::string> names;
+    std::vector<std::string> values;
+    const ParamsVectors* params = tesseract_->params();
+    auto add_param = [&](const char* name) {
+      std::string value;
+      if (ParamUtils::GetParamAsString(name, params, &value)) {
+        names.push_back(name);
+        values.push_back(value);
+      }
+    };
+    for (int i = 0; i < params->int_params.size(); ++i)
+      add_param(params->int_params[i]->name_str());
+    for (int i = 0; i < params->bool_params.size(); ++i)
+      add_param(params->bool_params[i]->name_str());
+    for (int i = 0; i < params->string_params.size(); ++i)
+      add_param(params->string_params[i]->name_str());
+    for (int i = 0; i < params->double_params.size(); ++i)
+      add_param(params->double_params[i]->name_str());
+    // Start again if anything that the engines were started with changed.
+    auto* workers =
+        static_cast<TileWorkers*>(tesseract_->tile_engines().get());
+    if (workers == nullptr || workers->datapath != datapath_ ||
+        workers->language != language_ ||
+        workers->oem != last_oem_requested_ || workers->names != names ||
+        workers->values != values) {
+      workers = new TileWorkers;
+      tesseract_->tile_engines().reset(workers);
+      workers->datapath = datapath_;
+      workers->language = language_;
+      workers->oem = last_oem_requested_;
+      workers->names = names;
+      workers->values = values;
+    }
+    for (int j = workers->engines.size() + 1; j < jobs; ++j) {
+      std::unique_ptr<TessBaseAPI> worker(new TessBaseAPI);
+      if (worker->Init(datapath_.c_str(), language_.c_str(),
+                       last_oem_requested_, nullptr, 0, &names, &values,
+                       false) != 0) {
+        tprintf("Failed to start tile worker %d, using %d\n", j, j);
+        break;
+      }
+      workers->engines.push_back(std::move(worker));
+    }
+    for (const auto& worker : workers->engines) {
+      if (engines.size() == static_cast<size_t>(jobs)) break;
+      engines.push_back(worker.get());
+    }
+    jobs = engines.size();
+  }
+
+  std::vector<std::vector<TileLine>> tile_lines(num_tiles);
+  std::vector<char> tile_ok(num_tiles, false);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(jobs) schedule(dynamic)
+#endif  // _OPENMP
+  for (int t = 0; t < num_tiles; ++t) {
+#ifdef _OPENMP
+    TessBaseAPI* engine = engines[omp_get_thread_num()];
+#else
+    TessBaseAPI* engine = this;
+#endif
+    const TileSpan& x_span = x_spans[t % x_spans.size()];
+    const TileSpan& y_span = y_spans[t / x_spans.size()];
+    Box* box = boxCreate(x_span.start, y_span.start,
+                         x_span.end - x_span.start, y_span.end - y_span.start);
+    Pix* tile = pixClipRectangle(pix, box, nullptr);
+    boxDestroy(&box);
+    // SetImage takes its own copy.
+    engine->SetImage(tile);
+    pixDestroy(&tile);
+    ETEXT_DESC monitor;
+    monitor.cancel = nullptr;
+    monitor.cancel_this = nullptr;
+    if (timeout_millisec > 0) monitor.set_deadline_msecs(timeout_millisec);
+    tile_ok[t] =
+        engine->Recognize(timeout_millisec > 0 ? &monitor : nullptr) >= 0;
+    std::unique_ptr<ResultIterator> it(tile_ok[t] ? engine->GetIterator()
+                                                  : nullptr);
+    // The first word kept after a dropped one inherits the dropped starts.
+    int starts_level = 2;
+    int block = -1;
+    // The line that the kept words of the current textline go in, if any.
+    TileLine* line = nullptr;
+    int seen_left = 0, seen_right = 0;
+    if (it != nullptr) {
+      do {
+        if (it->Empty(RIL_WORD)) continue;
+        if (it->IsAtBeginningOf(RIL_BLOCK)) {
+          starts_level = std::min(starts_level, 2);
+          ++block;
+        } else if (it->IsAtBeginningOf(RIL_PARA)) {
+          starts_level = std::min(starts_level, 3);
+        } else if (it->IsAtBeginningOf(RIL_TEXTLINE)) {
+          starts_level = std::min(starts_level, 4);
+        }
+        int left, top, right, bottom;
+        it->BoundingBox(RIL_WORD, &left, &top, &right, &bottom);
+        if (it->IsAtBeginningOf(RIL_TEXTLINE)) {
+          line = nullptr;
+          seen_left = x_span.start + left;
+          seen_right = x_span.start + right;
+        }
+        seen_left = std::min(seen_left, x_span.start + left);
+        seen_right = std::max(seen_right, x_span.start + right);
+        if (line != nullptr) {
+          line->seen_left = seen_left;
+          line->seen_right = seen_right;
+        }
+        int x_centre = x_span.start + (left + right) / 2;
+        int y_centre = y_span.start + (top + bottom) / 2;
+        if (x_centre < x_span.core_start || x_centre >= x_span.core_end ||
+            y_centre < y_span.core_start || y_centre >= y_span.core_end)
+          continue;
+        TiledWord word;
+        word.left = x_span.start + left;
+        word.top = y_span.start + top;
+        word.right = x_span.start + right;
+        word.bottom = y_span.start + bottom;
+        word.confidence = it->Confidence(RIL_WORD);
+        word.starts_level = starts_level;
+        const std::unique_ptr<const char[]> text(it->GetUTF8Text(RIL_WORD));
+        word.text = text.get();
+        if (line == nullptr) {
+          tile_lines[t].emplace_back();
+          line = &tile_lines[t].back();
+          line->tile = t;
+          line->block = block;
+          line->starts_level = starts_level;
+          line->ltr = it->ParagraphIsLtr();
+          line->left = word.left;
+          line->top = word.top;
+          line->right = word.right;
+          line->bottom = word.bottom;
+          line->seen_left = seen_left;
+          line->seen_right = seen_right;
+        }
+        line->left = std::min(line->left, word.left);
+        line->top = std::min(line->top, word.top);
+        line->right = std::max(line->right, word.right);
+        line->bottom = std::max(line->bottom, word.bottom);
+        line->words.push_back(word);
+        starts_level = 5;
+      } while (it->Next(RIL_WORD));
+    }
+    it.reset();
+    // Release the tile image and results before taking the next tile.
+    engine->Clear();
+  }
+
+  Clear();
+  bool ok = true;
+  std::vector<TileLine> lines;
+  for (int t = 0; t < num_tiles; ++t) {
+    if (!tile_ok[t]) {
+      tprintf("Recognition of tile %d of %d failed\n", t, num_tiles);
+      ok = false;
+    }
+    lines.insert(lines.end(), tile_lines[t].begin(), tile_lines[t].end());
+  }
+  MergeTileLines(lines, x_spans.size(), &tesseract_->tiled_words());
+  tesseract_->set_tiled_done(true);
+  rect_left_ = 0;
+  rect_top_ = 0;
+  rect_width_ = width;
+  rect_height_ = height;
+  image_width_ = width;
+  image_height_ = height;
+  return ok;
+}
+
+// Makes the text of the tiled words, with a newline at the end of each
+// textline and a blank line at the end of each paragraph, as GetUTF8Text.
+char* TessBaseAPI::GetTiledUTF8Text() const {
+  const std::vector<TiledWord>& words = tesseract_->tiled_words();
+  std::string text;
+  for (size_t i = 0; i < words.size(); ++i) {
+    const TiledWord& word = words[i];
+    if (i > 0) {
+      if (word.starts_level <= 3)
+        text += "\n\n";
+      else if (word.starts_level == 4)
+        text += "\n";
+      else
+        text += " ";
+    }
+    text += word.text;
+  }
+  if (!text.empty()) text += "\n\n";
+  char* result = new char[text.length() + 1];
+  strcpy(result, text.c_str());
+  return result;
+}
+
+// Makes the TSV of the tiled words, in the format of GetTSVText. The boxes
+// of the blocks, paragraphs and textlines are those of their words.
+char* TessBaseAPI::GetTiledTSVText(int page_number) const {
+  const std::vector<TiledWord>& words = tesseract_->tiled_words();
+  int page_num = page_number + 1;  // we use 1-based page numbers.
+  STRING tsv_str("");
+  tsv_str.add_str_int("1\t", page_num);  // level 1 - page
+  tsv_str += "\t0\t0\t0\t0";
+  tsv_str.add_str_int("\t", rect_left_);
+  tsv_str.add_str_int("\t", rect_top_);
+  tsv_str.add_str_int("\t", rect_width_);
+  tsv_str.add_str_int("\t", rect_height_);
+  tsv_str += "\t-1\t\n";
+
+  int nums[6] = {0, 0, 0, 0, 0, 0};  // Indexed by TSV level.
+  auto add_row = [&](int level, int left, int top, int right, int bottom) {
+    tsv_str.add_str_int("", level);
+    for (int l = 1; l <= 5; ++l)
+      tsv_str.add_str_int("\t", l == 1 ? page_num : (l <= level ? nums[l] : 0));
+    tsv_str.add_str_int("\t", left);
+    tsv_str.add_str_int("\t", top);
+    tsv_str.add_str_int("\t", right - left);
+    tsv_str.add_str_int("\t", bottom - top);
+  };
+  for (size_t i = 0; i < words.size(); ++i) {
+    const TiledWord& word = words[i];
+    for (int level = std::max(2, word.starts_level); level <= 4; ++level) {
+      ++nums[level];
+      for (int l = level + 1; l <= 5; ++l) nums[l] = 0;
+      // The box is the union of the words up to the next start at level.
+      int left = word.left, top = word.top;
+      int right = word.right, bottom = word.bottom;
+      for (size_t j = i + 1; j < words.size() && words[j].starts_level > level;
+           ++j) {
+        left = std::min(left, words[j].left);
+        top = std::min(top, words[j].top);
+        right = std::max(right, words[j].right);
+        bottom = std::max(bottom, words[j].bottom);
+      }
+      add_row(level, left, top, right, bottom);
+      tsv_str += "\t-1\t\n";
+    }
+    ++nums[5];
+    add_row(5, word.left, word.top, word.right, word.bottom);
+    tsv_str.add_str_int("\t", word.confidence);
+    tsv_str += "\t";
+    tsv_str += word.text.c_str();
+    tsv_str += "\n";
+  }
+  char* ret = new char[tsv_str.length() + 1];
+  strcpy(ret, tsv_str.c_str());
+  return ret;
+}
+
+}  // namespace tesseract.
@@ -0,0 +1,38 @@
+///////////////////////////////////////////////////////////////////////
+// File:        classpruner.cpp
+// Description: Class pruner score accumulation for the legacy classifier.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+///////////////////////////////////////////////////////////////////////
+
+#include "classpruner.h"
+
+namespace tesseract {
+
+// Number of classes in each pruner word.
+constexpr int kClassesPerWord = 16;
+
+void ClassPrunerScoresGeneric(const uint32_t* pruner, const int* offsets,
+                              int num_features, int* class_counts) {
+  for (int f = 0; f < num_features; ++f) {
+    const uint32_t* words = pruner + offsets[f];
+    for (int w = 0; w < kClassPrunerClasses / kClassesPerWord; ++w) {
+      uint32_t word = words[w];
+      int* counts = class_counts + w * kClassesPerWord;
+      for (int c = 0; c < kClassesPerWord; ++c) {
+        counts[c] += word & 3;
+        word >>= 2;
+      }
+    }
+  }
+}
+
+}  // namespace tesseract.
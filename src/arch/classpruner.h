@@ -0,0 +1,40 @@
+///////////////////////////////////////////////////////////////////////
+// File:        classpruner.h
+// Description: Class pruner score accumulation for the legacy classifier.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_ARCH_CLASSPRUNER_H_
+#define TESSERACT_ARCH_CLASSPRUNER_H_
+
+#include <cstdint>
+
+namespace tesseract {
+
+// Number of classes covered by each pair of class pruner words, which hold
+// a 2-bit weight per class, the first word holding the first 16 classes
+// from its least significant bits up.
+constexpr int kClassPrunerClasses = 32;
+
+// Adds the weights of the kClassPrunerClasses classes in the pair of words
+// at pruner + offsets[f] to class_counts, for each of the num_features
+// features. All the kernels produce identical counts.
+void ClassPrunerScoresGeneric(const uint32_t* pruner, const int* offsets,
+                              int num_features, int* class_counts);
+
+// Uses Intel AVX2 intrinsics to access the SIMD instruction set.
+void ClassPrunerScoresAVX2(const uint32_t* pruner, const int* offsets,
+                           int num_features, int* class_counts);
+
+}  // namespace tesseract.
+
+#endif  // TESSERACT_ARCH_CLASSPRUNER_H_
@@ -0,0 +1,62 @@
+///////////////////////////////////////////////////////////////////////
+// File:        classpruneravx2.cpp
+// Description: Class pruner score accumulation on avx2.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+///////////////////////////////////////////////////////////////////////
+
+#if !defined(__AVX2__)
+ #if defined(__i686__) || defined(__x86_64__)
+  #error Implementation only for AVX2 capable architectures
+ #endif
+#else
+
+#include "classpruner.h"
+
+#include <immintrin.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace tesseract {
+
+// Max features that can be summed in a byte lane without overflow, as each
+// weight is at most 3.
+constexpr int kMaxByteSums = 255 / 3;
+
+// The pair of pruner words is broadcast to all four 64-bit lanes and lane k
+// shifted right by 2k, so that after masking, byte j of lane k holds the
+// weight of class 4j + k. The weights are summed in these byte lanes and
+// only moved to class_counts every kMaxByteSums features.
+void ClassPrunerScoresAVX2(const uint32_t* pruner, const int* offsets,
+                           int num_features, int* class_counts) {
+  const __m256i shifts = _mm256_setr_epi64x(0, 2, 4, 6);
+  const __m256i mask = _mm256_set1_epi8(3);
+  for (int start = 0; start < num_features; start += kMaxByteSums) {
+    int end = std::min(num_features, start + kMaxByteSums);
+    __m256i sums = _mm256_setzero_si256();
+    for (int f = start; f < end; ++f) {
+      int64_t words;
+      memcpy(&words, pruner + offsets[f], sizeof(words));
+      __m256i weights = _mm256_srlv_epi64(_mm256_set1_epi64x(words), shifts);
+      sums = _mm256_add_epi8(sums, _mm256_and_si256(weights, mask));
+    }
+    alignas(32) uint8_t bytes[kClassPrunerClasses];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(bytes), sums);
+    for (int k = 0; k < 4; ++k) {
+      for (int j = 0; j < 8; ++j) class_counts[4 * j + k] += bytes[8 * k + j];
+    }
+  }
+}
+
+}  // namespace tesseract.
+
+#endif
@@ -0,0 +1,28 @@
+///////////////////////////////////////////////////////////////////////
+// File:        protodistance.cpp
+// Description: Feature to proto distances for the legacy integer matcher.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+///////////////////////////////////////////////////////////////////////
+
+#include "protodistance.h"
+
+namespace tesseract {
+
+void ProtoDistancesGeneric(const uint32_t* protos, int num_protos,
+                           const ProtoDistanceParams& params,
+                           uint32_t* distances) {
+  for (int p = 0; p < num_protos; ++p) {
+    distances[p] = ProtoDistance(protos[p], params);
+  }
+}
+
+}  // namespace tesseract.
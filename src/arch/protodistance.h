@@ -0,0 +1,75 @@
+///////////////////////////////////////////////////////////////////////
+// File:        protodistance.h
+// Description: Feature to proto distances for the legacy integer matcher.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_ARCH_PROTODISTANCE_H_
+#define TESSERACT_ARCH_PROTODISTANCE_H_
+
+#include <cstdint>
+#include <cstring>
+
+namespace tesseract {
+
+// The feature and matcher constants that the distance of a proto depends on.
+struct ProtoDistanceParams {
+  int x;
+  int y;
+  int theta;
+  int theta_fudge;
+  int mult_trunc_shift_bits;
+  uint32_t evidence_mult_mask;
+  int table_trunc_shift_bits;
+};
+
+// Returns the distance, as an index into the similarity to evidence table,
+// between the feature in params and the proto whose A, B, C and Angle bytes
+// are packed, in that order in memory, into the word proto.
+inline uint32_t ProtoDistance(uint32_t proto, const ProtoDistanceParams& params) {
+  struct {
+    int8_t a;
+    uint8_t b;
+    int8_t c;
+    uint8_t angle;
+  } p;
+  memcpy(&p, &proto, sizeof(p));
+  int32_t a3 = ((p.a * (params.x - 128)) * 2) - (p.b * (params.y - 128)) +
+               (p.c * 512);
+  int32_t m3 = static_cast<int8_t>(params.theta - p.angle) *
+               params.theta_fudge * 2;
+  if (a3 < 0) a3 = ~a3;
+  if (m3 < 0) m3 = ~m3;
+  a3 >>= params.mult_trunc_shift_bits;
+  m3 >>= params.mult_trunc_shift_bits;
+  if (static_cast<uint32_t>(a3) > params.evidence_mult_mask)
+    a3 = params.evidence_mult_mask;
+  if (static_cast<uint32_t>(m3) > params.evidence_mult_mask)
+    m3 = params.evidence_mult_mask;
+  uint32_t a4 = (a3 * a3) + (m3 * m3);
+  return a4 >> params.table_trunc_shift_bits;
+}
+
+// Computes ProtoDistance of each of the num_protos packed protos into
+// distances. All the kernels produce identical distances.
+void ProtoDistancesGeneric(const uint32_t* protos, int num_protos,
+                           const ProtoDistanceParams& params,
+                           uint32_t* distances);
+
+// Uses Intel AVX2 intrinsics to access the SIMD instruction set.
+void ProtoDistancesAVX2(const uint32_t* protos, int num_protos,
+                        const ProtoDistanceParams& params,
+                        uint32_t* distances);
+
+}  // namespace tesseract.
+
+#endif  // TESSERACT_ARCH_PROTODISTANCE_H_
@@ -0,0 +1,76 @@
+///////////////////////////////////////////////////////////////////////
+// File:        protodistanceavx2.cpp
+// Description: Feature to proto distances on avx2.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+///////////////////////////////////////////////////////////////////////
+
+#if !defined(__AVX2__)
+ #if defined(__i686__) || defined(__x86_64__)
+  #error Implementation only for AVX2 capable architectures
+ #endif
+#else
+
+#include "protodistance.h"
+
+#include <immintrin.h>
+#include <cstdint>
+
+namespace tesseract {
+
+// Number of protos in a register.
+constexpr int kProtosPerRegister = 8;
+
+// Each 32-bit lane holds one packed proto, whose bytes are sign or zero
+// extended in place with a pair of shifts. The folding of negative values
+// with ~ is an xor with the sign, and the clipping to the mask is a min,
+// as the values are never negative by then.
+void ProtoDistancesAVX2(const uint32_t* protos, int num_protos,
+                        const ProtoDistanceParams& params,
+                        uint32_t* distances) {
+  const __m256i x = _mm256_set1_epi32((params.x - 128) * 2);
+  const __m256i y = _mm256_set1_epi32(params.y - 128);
+  const __m256i theta = _mm256_set1_epi32(params.theta);
+  const __m256i fudge = _mm256_set1_epi32(params.theta_fudge * 2);
+  const __m256i mask = _mm256_set1_epi32(params.evidence_mult_mask);
+  const __m128i mult_shift = _mm_cvtsi32_si128(params.mult_trunc_shift_bits);
+  const __m128i table_shift = _mm_cvtsi32_si128(params.table_trunc_shift_bits);
+  int p = 0;
+  for (; p + kProtosPerRegister <= num_protos; p += kProtosPerRegister) {
+    __m256i packed =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(protos + p));
+    __m256i a = _mm256_srai_epi32(_mm256_slli_epi32(packed, 24), 24);
+    __m256i b = _mm256_srli_epi32(_mm256_slli_epi32(packed, 16), 24);
+    __m256i c = _mm256_srai_epi32(_mm256_slli_epi32(packed, 8), 24);
+    __m256i angle = _mm256_srli_epi32(packed, 24);
+    __m256i a3 = _mm256_sub_epi32(_mm256_mullo_epi32(a, x),
+                                  _mm256_mullo_epi32(b, y));
+    a3 = _mm256_add_epi32(a3, _mm256_slli_epi32(c, 9));
+    __m256i dtheta = _mm256_sub_epi32(theta, angle);
+    dtheta = _mm256_srai_epi32(_mm256_slli_epi32(dtheta, 24), 24);
+    __m256i m3 = _mm256_mullo_epi32(dtheta, fudge);
+    a3 = _mm256_xor_si256(a3, _mm256_srai_epi32(a3, 31));
+    m3 = _mm256_xor_si256(m3, _mm256_srai_epi32(m3, 31));
+    a3 = _mm256_min_epu32(_mm256_sra_epi32(a3, mult_shift), mask);
+    m3 = _mm256_min_epu32(_mm256_sra_epi32(m3, mult_shift), mask);
+    __m256i a4 = _mm256_add_epi32(_mm256_mullo_epi32(a3, a3),
+                                  _mm256_mullo_epi32(m3, m3));
+    a4 = _mm256_srl_epi32(a4, table_shift);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(distances + p), a4);
+  }
+  for (; p < num_protos; ++p) {
+    distances[p] = ProtoDistance(protos[p], params);
+  }
+}
+
+}  // namespace tesseract.
+
+#endif
@@ -20,6 +20,9 @@
 #endif
 #include <numeric>           // for std::inner_product
 #include "simddetect.h"
+#include "classpruner.h"   // for ClassPrunerScoresGeneric, ...
+#include "protodistance.h"  // for ProtoDistancesGeneric, ...
+#include "weightupdate.h"  // for AdamUpdateWeightsGeneric, ...
 #include "dotproduct.h"
 #include "intsimdmatrix.h"   // for IntSimdMatrix
 #include "params.h"   // for STRING_VAR
@@ -61,6 +64,15 @@ namespace tesseract {
 // in AVX registers.
 DotProductFunction DotProduct;
 
+// Accumulates the class pruner scores of the legacy classifier. All the
+// implementations give identical results.
+ClassPrunerFunction ClassPrunerScores;
+ProtoDistanceFunction ProtoDistances;
+// Updates the weights in training. All the implementations give identical
+// results.
+AdamUpdateFunction AdamUpdateWeights;
+MomentumUpdateFunction MomentumUpdateWeights;
+
 static STRING_VAR(dotproduct, "auto",
                   "Function used for calculation of dot product");
 
@@ -109,6 +121,10 @@ static void SetDotProduct(DotProductFunction f, const IntSimdMatrix* m = nullptr
 SIMDDetect::SIMDDetect() {
   // The fallback is a generic dot product calculation.
   SetDotProduct(DotProductGeneric);
+  ClassPrunerScores = ClassPrunerScoresGeneric;
+  ProtoDistances = ProtoDistancesGeneric;
+  AdamUpdateWeights = AdamUpdateWeightsGeneric;
+  MomentumUpdateWeights = MomentumUpdateWeightsGeneric;
 
 #if defined(HAS_CPUID)
 #if defined(__GNUC__)
@@ -201,11 +217,19 @@ SIMDDetect::SIMDDetect() {
   } else if (avx2_available_) {
     // AVX2 detected.
     SetDotProduct(DotProductAVX, &IntSimdMatrix::intSimdMatrixAVX2);
+    ClassPrunerScores = ClassPrunerScoresAVX2;
+    ProtoDistances = ProtoDistancesAVX2;
+#if defined(HAVE_AVX)
+    AdamUpdateWeights = AdamUpdateWeightsAVX;
+    MomentumUpdateWeights = MomentumUpdateWeightsAVX;
+#endif
 #endif
 #if defined(HAVE_AVX)
   } else if (avx_available_) {
     // AVX detected.
     SetDotProduct(DotProductAVX, &IntSimdMatrix::intSimdMatrixSSE);
+    AdamUpdateWeights = AdamUpdateWeightsAVX;
+    MomentumUpdateWeights = MomentumUpdateWeightsAVX;
 #endif
 #if defined(HAVE_SSE4_1)
   } else if (sse_available_) {
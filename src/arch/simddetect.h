@@ -18,6 +18,7 @@
 #define TESSERACT_ARCH_SIMDDETECT_H_
 
 #include <tesseract/platform.h>
+#include <cstdint>
 
 namespace tesseract {
 
@@ -25,6 +26,25 @@ namespace tesseract {
 using DotProductFunction = double (*)(const double*, const double*, int);
 extern DotProductFunction DotProduct;
 
+// Function pointer for best accumulation of class pruner scores.
+using ClassPrunerFunction = void (*)(const uint32_t*, const int*, int, int*);
+extern ClassPrunerFunction ClassPrunerScores;
+
+struct ProtoDistanceParams;
+// Function pointer for best calculation of integer matcher proto distances.
+using ProtoDistanceFunction = void (*)(const uint32_t*, int,
+                                       const ProtoDistanceParams&, uint32_t*);
+extern ProtoDistanceFunction ProtoDistances;
+
+struct WeightUpdateParams;
+// Function pointers for best Adam and momentum updates of a row of weights.
+using AdamUpdateFunction = void (*)(const WeightUpdateParams&, int, double*,
+                                    double*, double*, double*);
+extern TESS_API AdamUpdateFunction AdamUpdateWeights;
+using MomentumUpdateFunction = void (*)(const WeightUpdateParams&, int,
+                                        double*, double*, double*);
+extern TESS_API MomentumUpdateFunction MomentumUpdateWeights;
+
 // Architecture detector. Add code here to detect any other architectures for
 // SIMD-based faster dot product functions. Intended to be a single static
 // object, but it does no real harm to have more than one.
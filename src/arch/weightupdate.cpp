@@ -0,0 +1,45 @@
+///////////////////////////////////////////////////////////////////////
+// File:        weightupdate.cpp
+// Description: Momentum and Adam updates of rows of network weights.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+///////////////////////////////////////////////////////////////////////
+
+#include "weightupdate.h"
+
+#include <cmath>
+
+namespace tesseract {
+
+void AdamUpdateWeightsGeneric(const WeightUpdateParams& params, int n,
+                              double* dw, double* updates, double* sq_sum,
+                              double* weights) {
+  double update_factor = 1.0 - params.beta;
+  for (int i = 0; i < n; ++i) {
+    sq_sum[i] = sq_sum[i] * params.beta + update_factor * dw[i] * dw[i];
+    dw[i] *= params.dw_scale;
+    updates[i] = updates[i] * params.momentum + dw[i];
+    weights[i] += updates[i] / (std::sqrt(sq_sum[i]) + params.epsilon);
+  }
+}
+
+void MomentumUpdateWeightsGeneric(const WeightUpdateParams& params, int n,
+                                  double* dw, double* updates,
+                                  double* weights) {
+  for (int i = 0; i < n; ++i) {
+    dw[i] *= params.dw_scale;
+    updates[i] += dw[i];
+    if (params.momentum > 0.0) weights[i] += updates[i];
+    if (params.momentum >= 0.0) updates[i] *= params.momentum;
+  }
+}
+
+}  // namespace tesseract.
@@ -0,0 +1,65 @@
+///////////////////////////////////////////////////////////////////////
+// File:        weightupdate.h
+// Description: Momentum and Adam updates of rows of network weights.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_ARCH_WEIGHTUPDATE_H_
+#define TESSERACT_ARCH_WEIGHTUPDATE_H_
+
+namespace tesseract {
+
+// The constants of a single update of the weights.
+struct WeightUpdateParams {
+  // Multiplies the new deltas.
+  double dw_scale;
+  // Decay factor of the accumulated updates.
+  double momentum;
+  // Adam only: decay factor of the sum of squares of the deltas.
+  double beta;
+  // Adam only: added to the root of the sum of squares.
+  double epsilon;
+};
+
+// Updates n weights with the Adam algorithm, from their deltas dw, which are
+// scaled in place, the momentum-decaying updates and the sum of squares of
+// the deltas. The arithmetic is done in the same order as the whole matrix
+// operations of GENERIC_2D_ARRAY, so the results are identical to those of:
+//   sq_sum.SumSquares(dw, beta);
+//   dw *= dw_scale;
+//   updates *= momentum;
+//   updates += dw;
+//   weights.AdamUpdate(updates, sq_sum, epsilon);
+void AdamUpdateWeightsGeneric(const WeightUpdateParams& params, int n,
+                              double* dw, double* updates, double* sq_sum,
+                              double* weights);
+
+// Updates n weights with plain momentum, from their deltas dw, which are
+// scaled in place, and the momentum-decaying updates. The results are
+// identical to those of:
+//   dw *= dw_scale;
+//   updates += dw;
+//   if (momentum > 0.0) weights += updates;
+//   if (momentum >= 0.0) updates *= momentum;
+void MomentumUpdateWeightsGeneric(const WeightUpdateParams& params, int n,
+                                  double* dw, double* updates,
+                                  double* weights);
+
+// Uses Intel AVX intrinsics to access the SIMD instruction set.
+void AdamUpdateWeightsAVX(const WeightUpdateParams& params, int n, double* dw,
+                          double* updates, double* sq_sum, double* weights);
+void MomentumUpdateWeightsAVX(const WeightUpdateParams& params, int n,
+                              double* dw, double* updates, double* weights);
+
+}  // namespace tesseract.
+
+#endif  // TESSERACT_ARCH_WEIGHTUPDATE_H_
@@ -0,0 +1,88 @@
+///////////////////////////////////////////////////////////////////////
+// File:        weightupdateavx.cpp
+// Description: Momentum and Adam weight updates on avx.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+///////////////////////////////////////////////////////////////////////
+
+#if !defined(__AVX__)
+ #if defined(__i686__) || defined(__x86_64__)
+  #error Implementation only for AVX capable architectures
+ #endif
+#else
+
+#include <immintrin.h>
+#include "weightupdate.h"
+
+namespace tesseract {
+
+// Number of weights in a register.
+constexpr int kWeightsPerRegister = 4;
+
+// Each lane does the same operations in the same order as the generic
+// version, without fused multiply-adds, and the square root and division
+// are correctly rounded, so the results are identical.
+void AdamUpdateWeightsAVX(const WeightUpdateParams& params, int n, double* dw,
+                          double* updates, double* sq_sum, double* weights) {
+  const __m256d beta = _mm256_set1_pd(params.beta);
+  const __m256d update_factor = _mm256_set1_pd(1.0 - params.beta);
+  const __m256d dw_scale = _mm256_set1_pd(params.dw_scale);
+  const __m256d momentum = _mm256_set1_pd(params.momentum);
+  const __m256d epsilon = _mm256_set1_pd(params.epsilon);
+  int i = 0;
+  for (; i + kWeightsPerRegister <= n; i += kWeightsPerRegister) {
+    __m256d d = _mm256_loadu_pd(dw + i);
+    __m256d sq = _mm256_mul_pd(_mm256_loadu_pd(sq_sum + i), beta);
+    sq = _mm256_add_pd(sq, _mm256_mul_pd(_mm256_mul_pd(update_factor, d), d));
+    _mm256_storeu_pd(sq_sum + i, sq);
+    d = _mm256_mul_pd(d, dw_scale);
+    _mm256_storeu_pd(dw + i, d);
+    __m256d u = _mm256_mul_pd(_mm256_loadu_pd(updates + i), momentum);
+    u = _mm256_add_pd(u, d);
+    _mm256_storeu_pd(updates + i, u);
+    __m256d w = _mm256_loadu_pd(weights + i);
+    w = _mm256_add_pd(
+        w, _mm256_div_pd(u, _mm256_add_pd(_mm256_sqrt_pd(sq), epsilon)));
+    _mm256_storeu_pd(weights + i, w);
+  }
+  if (i < n) {
+    AdamUpdateWeightsGeneric(params, n - i, dw + i, updates + i, sq_sum + i,
+                             weights + i);
+  }
+}
+
+void MomentumUpdateWeightsAVX(const WeightUpdateParams& params, int n,
+                              double* dw, double* updates, double* weights) {
+  const __m256d dw_scale = _mm256_set1_pd(params.dw_scale);
+  const __m256d momentum = _mm256_set1_pd(params.momentum);
+  bool update_weights = params.momentum > 0.0;
+  bool decay_updates = params.momentum >= 0.0;
+  int i = 0;
+  for (; i + kWeightsPerRegister <= n; i += kWeightsPerRegister) {
+    __m256d d = _mm256_mul_pd(_mm256_loadu_pd(dw + i), dw_scale);
+    _mm256_storeu_pd(dw + i, d);
+    __m256d u = _mm256_add_pd(_mm256_loadu_pd(updates + i), d);
+    if (update_weights) {
+      _mm256_storeu_pd(weights + i,
+                       _mm256_add_pd(_mm256_loadu_pd(weights + i), u));
+    }
+    if (decay_updates) u = _mm256_mul_pd(u, momentum);
+    _mm256_storeu_pd(updates + i, u);
+  }
+  if (i < n) {
+    MomentumUpdateWeightsGeneric(params, n - i, dw + i, updates + i,
+                                 weights + i);
+  }
+}
+
+}  // namespace tesseract.
+
+#endif
@@ -279,6 +279,7 @@ void Tesseract::MaximallyChopWord(const GenericVector<TBOX>& boxes,
   int right_chop_index = 0;
   if (!assume_fixed_pitch_char_segment) {
     // We only chop if the language is not fixed pitch like CJK.
+    ResetSeamSearches();
     SEAM* seam = nullptr;
     while ((seam = chop_one_blob(boxes, blob_choices, word_res,
                                  &blob_number)) != nullptr) {
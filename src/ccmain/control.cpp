@@ -21,11 +21,14 @@
 #include "config_auto.h"
 #endif
 
+#include <algorithm>             // for std::max, std::min
+#include <cfloat>                // for FLT_MAX
 #include <cmath>
 #include <cstdint>               // for int16_t, int32_t
 #include <cstdio>                // for fclose, fopen, FILE
 #include <ctime>                 // for clock
 #include <cctype>
+#include <vector>                // for std::vector
 #include "control.h"
 #ifndef DISABLED_LEGACY_ENGINE
 #include "docqual.h"
@@ -317,7 +320,9 @@ bool Tesseract::recog_all_words(PAGE_RES* page_res,
     // If the adaptive classifier is full switch to one we prepared earlier,
     // ie on the previous page. If the current adaptive classifier is non-empty,
     // prepare a backup starting at this page, in case it fills up. Do all this
-    // independently for each language.
+    // independently for each language. Before that, pick up anything that
+    // other workers on the same document have learned.
+    UpdateFromSharedAdaptedTemplates();
     if (AdaptiveClassifierIsFull()) {
       SwitchAdaptiveClassifier();
     } else if (!AdaptiveClassifierIsEmpty()) {
@@ -325,6 +330,7 @@ bool Tesseract::recog_all_words(PAGE_RES* page_res,
     }
     // Now check the sub-langs as well.
     for (int i = 0; i < sub_langs_.size(); ++i) {
+      sub_langs_[i]->UpdateFromSharedAdaptedTemplates();
       if (sub_langs_[i]->AdaptiveClassifierIsFull()) {
         sub_langs_[i]->SwitchAdaptiveClassifier();
       } else if (!sub_langs_[i]->AdaptiveClassifierIsEmpty()) {
@@ -352,10 +358,20 @@ bool Tesseract::recog_all_words(PAGE_RES* page_res,
     stats_.doc_char_quality = 0;
     stats_.good_char_count = 0;
     stats_.doc_good_char_quality = 0;
+    stats_.multilang_retried_words = 0;
+    stats_.multilang_extra_passes = 0;
 
     most_recently_used_ = this;
+    line_lang_row_ = nullptr;
+    line_lang_ = nullptr;
     // Run pass 1 word recognition.
     if (!RecogAllWordsPassN(1, monitor, &page_res_it, &words)) return false;
+    if (multilang_debug_level > 0 && !sub_langs_.empty()) {
+      tprintf("Multilang: %d of %d words tried in other languages,"
+              " %d extra recognitions\n",
+              stats_.multilang_retried_words, stats_.word_count,
+              stats_.multilang_extra_passes);
+    }
     // Pass 1 post-processing.
     for (page_res_it.restart_page(); page_res_it.word() != nullptr;
          page_res_it.forward()) {
@@ -392,6 +408,8 @@ bool Tesseract::recog_all_words(PAGE_RES* page_res,
       PrerecAllWordsPar(words);
     }
     most_recently_used_ = this;
+    line_lang_row_ = nullptr;
+    line_lang_ = nullptr;
     // Run pass 2 word recognition.
     if (!RecogAllWordsPassN(2, monitor, &page_res_it, &words)) return false;
   }
@@ -898,28 +916,38 @@ int Tesseract::RetryWithLanguage(const WordData& word_data,
                                  WordRecognizer recognizer, bool debug,
                                  WERD_RES** in_word,
                                  PointerVector<WERD_RES>* best_words) {
+  PointerVector<WERD_RES> new_words;
+  RecognizeInLanguage(word_data, recognizer, debug, in_word, &new_words);
+  // Initial version is a bit of a hack based on better certainty and rating
+  // or a dictionary vs non-dictionary word.
+  return SelectBestWords(classify_max_rating_ratio,
+                         classify_max_certainty_margin,
+                         debug, &new_words, best_words);
+}
+
+// Helper to run the recognizer of this (language-specific) tesseract on the
+// word, putting the results in new_words. Touches nothing but this, the
+// in_word and new_words, so different languages may run concurrently.
+void Tesseract::RecognizeInLanguage(const WordData& word_data,
+                                    WordRecognizer recognizer, bool debug,
+                                    WERD_RES** in_word,
+                                    PointerVector<WERD_RES>* new_words) {
   if (debug) {
     tprintf("Trying word using lang %s, oem %d\n",
             lang.c_str(), static_cast<int>(tessedit_ocr_engine_mode));
   }
   // Run the recognizer on the word.
-  PointerVector<WERD_RES> new_words;
-  (this->*recognizer)(word_data, in_word, &new_words);
-  if (new_words.empty()) {
+  (this->*recognizer)(word_data, in_word, new_words);
+  if (new_words->empty()) {
     // Transfer input word to new_words, as the classifier must have put
     // the result back in the input.
-    new_words.push_back(*in_word);
+    new_words->push_back(*in_word);
     *in_word = nullptr;
   }
   if (debug) {
-    for (int i = 0; i < new_words.size(); ++i)
-      new_words[i]->DebugTopChoice("Lang result");
+    for (int i = 0; i < new_words->size(); ++i)
+      (*new_words)[i]->DebugTopChoice("Lang result");
   }
-  // Initial version is a bit of a hack based on better certainty and rating
-  // or a dictionary vs non-dictionary word.
-  return SelectBestWords(classify_max_rating_ratio,
-                         classify_max_certainty_margin,
-                         debug, &new_words, best_words);
 }
 
 // Helper returns true if all the words are acceptable.
@@ -930,6 +958,25 @@ static bool WordsAcceptable(const PointerVector<WERD_RES>& words) {
   return true;
 }
 
+// Helper returns the lowest certainty of the best choices of the words.
+static float WordsCertainty(const PointerVector<WERD_RES>& words) {
+  float certainty = 0.0f;
+  for (int w = 0; w < words.size(); ++w) {
+    if (words[w]->best_choice == nullptr) return -FLT_MAX;
+    certainty = std::min(certainty, words[w]->best_choice->certainty());
+  }
+  return certainty;
+}
+
+bool Tesseract::NeedsOtherLanguages(const PointerVector<WERD_RES>& words,
+                                    bool line_chosen) const {
+  if (multilang_retry_certainty >= 0.0) return !WordsAcceptable(words);
+  if (WordsCertainty(words) >= multilang_retry_certainty) return false;
+  // Once the language of the line is chosen, it is kept on the words that
+  // are above the limit, even if they are not acceptable.
+  return line_chosen || !WordsAcceptable(words);
+}
+
 #ifndef DISABLED_LEGACY_ENGINE
 
 // Moves good-looking "noise"/diacritics from the reject list to the main
@@ -1336,33 +1383,91 @@ void Tesseract::classify_word_and_language(int pass_n, PAGE_RES_IT* pr_it,
       most_recently_used_ = word->tesseract;
     return;
   }
+  // The languages in the order they are tried: the language of the line, if
+  // already chosen, or else the most recently used, then this, then the
+  // sub-languages, with the index of the word set up for each.
+  Tesseract* first_lang = most_recently_used_;
+  bool line_chosen = false;
+  if (multilang_line_language) {
+    if (word_data->row != line_lang_row_) {
+      line_lang_row_ = word_data->row;
+      line_lang_ = nullptr;
+    }
+    if (line_lang_ != nullptr) {
+      first_lang = line_lang_;
+      line_chosen = true;
+    }
+  }
+  GenericVector<Tesseract*> langs;
+  GenericVector<int> lang_indices;
   int sub = sub_langs_.size();
-  if (most_recently_used_ != this) {
-    // Get the index of the most_recently_used_.
-    for (sub = 0; sub < sub_langs_.size() &&
-         most_recently_used_ != sub_langs_[sub]; ++sub) {}
-  }
-  most_recently_used_->RetryWithLanguage(
-      *word_data, recognizer, debug, &word_data->lang_words[sub], &best_words);
-  Tesseract* best_lang_tess = most_recently_used_;
-  if (!WordsAcceptable(best_words)) {
-    // Try all the other languages to see if they are any better.
-    if (most_recently_used_ != this &&
-        this->RetryWithLanguage(*word_data, recognizer, debug,
-                                &word_data->lang_words[sub_langs_.size()],
-                                &best_words) > 0) {
-      best_lang_tess = this;
-    }
-    for (int i = 0; !WordsAcceptable(best_words) && i < sub_langs_.size();
-         ++i) {
-      if (most_recently_used_ != sub_langs_[i] &&
-          sub_langs_[i]->RetryWithLanguage(*word_data, recognizer, debug,
-                                           &word_data->lang_words[i],
-                                           &best_words) > 0) {
-        best_lang_tess = sub_langs_[i];
+  if (first_lang != this) {
+    for (sub = 0; sub < sub_langs_.size() && first_lang != sub_langs_[sub];
+         ++sub) {}
+  }
+  langs.push_back(first_lang);
+  lang_indices.push_back(sub);
+  if (first_lang != this) {
+    langs.push_back(this);
+    lang_indices.push_back(sub_langs_.size());
+  }
+  for (int i = 0; i < sub_langs_.size(); ++i) {
+    if (sub_langs_[i] != first_lang) {
+      langs.push_back(sub_langs_[i]);
+      lang_indices.push_back(i);
+    }
+  }
+  first_lang->RetryWithLanguage(*word_data, recognizer, debug,
+                                &word_data->lang_words[lang_indices[0]],
+                                &best_words);
+  Tesseract* best_lang_tess = first_lang;
+  if (langs.size() > 1 && NeedsOtherLanguages(best_words, line_chosen)) {
+    ++stats_.multilang_retried_words;
+#ifdef _OPENMP
+    // The LSTM recognizers of the languages are independent, so all the
+    // other languages can be run at once, and then their results taken in
+    // order, as if run one by one, until the words are good enough. The
+    // Tesseract recognizer adapts as it goes, so it is always run in order.
+    bool all_lstm = true;
+    for (int l = 0; l < langs.size(); ++l) {
+      if (langs[l]->tessedit_ocr_engine_mode != OEM_LSTM_ONLY) all_lstm = false;
+    }
+    if (tessedit_parallelize && all_lstm) {
+      std::vector<PointerVector<WERD_RES>> lang_results(langs.size());
+#pragma omp parallel for num_threads(langs.size() - 1) schedule(dynamic)
+      for (int l = 1; l < langs.size(); ++l) {
+        langs[l]->RecognizeInLanguage(*word_data, recognizer, debug,
+                                      &word_data->lang_words[lang_indices[l]],
+                                      &lang_results[l]);
+      }
+      stats_.multilang_extra_passes += langs.size() - 1;
+      for (int l = 1;
+           l < langs.size() && NeedsOtherLanguages(best_words, line_chosen);
+           ++l) {
+        if (SelectBestWords(langs[l]->classify_max_rating_ratio,
+                            langs[l]->classify_max_certainty_margin, debug,
+                            &lang_results[l], &best_words) > 0) {
+          best_lang_tess = langs[l];
+        }
+      }
+    } else
+#endif  // _OPENMP
+    {
+      for (int l = 1;
+           l < langs.size() && NeedsOtherLanguages(best_words, line_chosen);
+           ++l) {
+        ++stats_.multilang_extra_passes;
+        if (langs[l]->RetryWithLanguage(*word_data, recognizer, debug,
+                                        &word_data->lang_words[lang_indices[l]],
+                                        &best_words) > 0) {
+          best_lang_tess = langs[l];
+        }
       }
     }
   }
+  if (multilang_line_language && line_lang_ == nullptr) {
+    line_lang_ = best_lang_tess;
+  }
   most_recently_used_ = best_lang_tess;
   if (!best_words.empty()) {
     if (best_words.size() == 1 && !best_words[0]->combination) {
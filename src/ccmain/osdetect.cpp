@@ -37,6 +37,7 @@
 #include <algorithm>
 #include <cmath>        // for std::fabs
 #include <memory>
+#include <vector>
 
 namespace tesseract {
 
@@ -155,6 +156,17 @@ void OSResults::accumulate(const OSResults& osr) {
   update_best_script(best_result.orientation_id);
 }
 
+static int os_detect_filtered(TO_BLOCK_LIST* port_blocks, OSResults* osr,
+                              tesseract::Tesseract* tess,
+                              int min_blob_height);
+
+// Returns the size in pixels, at least 1, of something size pixels big
+// at full resolution, in an image reduced 2^reduction times.
+static int ScaleDownBlobSize(int size, int reduction) {
+  if (reduction == 0) return size;
+  return std::max(1, (size + (1 << (reduction - 1))) >> reduction);
+}
+
 // Detect and erase horizontal/vertical lines and picture regions from the
 // image, so that non-text blobs are removed from consideration.
 static void remove_nontext_regions(tesseract::Tesseract *tess,
@@ -206,8 +218,44 @@ int orientation_and_script_detection(const char* filename,
   int height = pixGetHeight(tess->pix_binary());
 
   BLOCK_LIST blocks;
-  if (!read_unlv_file(name, width, height, &blocks))
+  // The full resolution image, if the detection runs on a copy reduced
+  // 2^reduction times.
+  Pix* full_pix = nullptr;
+  int reduction = 0;
+  if (!read_unlv_file(name, width, height, &blocks)) {
+    int resolution = pixGetXRes(tess->pix_binary());
+    if (tess->osd_max_resolution > 0) {
+      while (reduction < 4 &&
+             (resolution >> reduction) > tess->osd_max_resolution) {
+        ++reduction;
+      }
+    }
+    if (reduction > 0) {
+      // Rank 1 keeps every speck of ink, so thin strokes survive.
+      int levels[4] = {0, 0, 0, 0};
+      for (int i = 0; i < reduction; ++i) levels[i] = 1;
+      Pix* reduced = pixReduceRankBinaryCascade(
+          tess->pix_binary(), levels[0], levels[1], levels[2], levels[3]);
+      if (reduced != nullptr) {
+        pixSetResolution(reduced, resolution >> reduction,
+                         pixGetYRes(tess->pix_binary()) >> reduction);
+        full_pix = tess->pix_binary();
+        *tess->mutable_pix_binary() = reduced;
+        width = pixGetWidth(reduced);
+        height = pixGetHeight(reduced);
+      } else {
+        reduction = 0;
+      }
+    }
     FullPageBlock(width, height, &blocks);
+  }
+
+  // The blob size filters are in pixels at full resolution, so scale them
+  // down with the image.
+  int noise_size = tess->mutable_textord()->textord_max_noise_size;
+  int min_blob_height = ScaleDownBlobSize(kMinAcceptableBlobHeight, reduction);
+  tess->mutable_textord()->textord_max_noise_size.set_value(
+      ScaleDownBlobSize(noise_size, reduction));
 
   // Try to remove non-text regions from consideration.
   TO_BLOCK_LIST land_blocks, port_blocks;
@@ -227,7 +275,15 @@ int orientation_and_script_detection(const char* filename,
                                           &port_blocks, true);
   }
 
-  return os_detect(&port_blocks, osr, tess);
+  int num_blobs = os_detect_filtered(&port_blocks, osr, tess, min_blob_height);
+  tess->mutable_textord()->textord_max_noise_size.set_value(noise_size);
+  if (full_pix != nullptr) {
+    // The blobs and the reduced image are finished with, so put the full
+    // image back for recognition.
+    pixDestroy(tess->mutable_pix_binary());
+    *tess->mutable_pix_binary() = full_pix;
+  }
+  return num_blobs;
 }
 
 // Filter and sample the blobs.
@@ -235,6 +291,13 @@ int orientation_and_script_detection(const char* filename,
 // zero if the page had too few characters to be reliable
 int os_detect(TO_BLOCK_LIST* port_blocks, OSResults* osr,
               tesseract::Tesseract* tess) {
+  return os_detect_filtered(port_blocks, osr, tess, kMinAcceptableBlobHeight);
+}
+
+// As os_detect, with blobs lower than min_blob_height left out.
+static int os_detect_filtered(TO_BLOCK_LIST* port_blocks, OSResults* osr,
+                              tesseract::Tesseract* tess,
+                              int min_blob_height) {
   int blobs_total = 0;
   TO_BLOCK_IT block_it;
   block_it.set_to_list(port_blocks);
@@ -265,11 +328,62 @@ int os_detect(TO_BLOCK_LIST* port_blocks, OSResults* osr,
       float ratio = x_y > y_x ? x_y : y_x;
       // Blob is ambiguous
       if (ratio > kSizeRatioToReject) continue;
-      if (box.height() < kMinAcceptableBlobHeight) continue;
+      if (box.height() < min_blob_height) continue;
       filtered_it.add_to_end(bbox);
     }
   }
-  return os_detect_blobs(nullptr, &filtered_list, osr, tess);
+  return os_detect_blobs(nullptr, &filtered_list, osr, tess, tess->osd_jobs);
+}
+
+// Sets the classifier of tess to the matching used for OSD.
+static void SetOSDMatching(tesseract::Tesseract* tess) {
+  tess->tess_cn_matching.set_value(true); // turn it on
+  tess->tess_bn_matching.set_value(false);
+}
+
+// Classifies the blob rotated by the given number of 90 degree turns
+// anticlockwise into ratings. Changes nothing shared, so the blobs and
+// orientations may be classified concurrently.
+static void ClassifyRotatedBlob(C_BLOB* blob, int orientation,
+                                tesseract::Tesseract* tess,
+                                BLOB_CHOICE_LIST* ratings) {
+  std::unique_ptr<TBLOB> rotated_blob(
+      TBLOB::PolygonalCopy(tess->poly_allow_detailed_fx, blob));
+  TBOX box = rotated_blob->bounding_box();
+  FCOORD rotation(1.0f, 0.0f);
+  FCOORD rotation90(0.0f, 1.0f);
+  for (int i = 0; i < orientation; ++i) rotation.rotate(rotation90);
+  // Normalize the blob. Set the origin to the place we want to be the
+  // bottom-middle after rotation.
+  // Scaling is to make the rotated height the x-height.
+  float scaling = static_cast<float>(kBlnXHeight) / box.height();
+  float x_origin = (box.left() + box.right()) / 2.0f;
+  float y_origin = (box.bottom() + box.top()) / 2.0f;
+  if (orientation == 0 || orientation == 2) {
+    // Rotation is 0 or 180.
+    y_origin = orientation == 0 ? box.bottom() : box.top();
+  } else {
+    // Rotation is 90 or 270.
+    scaling = static_cast<float>(kBlnXHeight) / box.width();
+    x_origin = orientation == 1 ? box.left() : box.right();
+  }
+  rotated_blob->Normalize(nullptr, &rotation, nullptr,
+                          x_origin, y_origin, scaling, scaling,
+                          0.0f, static_cast<float>(kBlnBaselineOffset),
+                          false, nullptr);
+  tess->AdaptiveClassifier(rotated_blob.get(), ratings);
+}
+
+// Adds the ratings of a blob in the 4 orientations to the estimates.
+// Returns true if the estimate of orientation and script satisfies the
+// stopping criteria.
+static bool AddBlobScores(BLOB_CHOICE_LIST* ratings, OrientationDetector* o,
+                          ScriptDetector* s) {
+  bool stop = o->detect_blob(ratings);
+  s->detect_blob(ratings);
+  int orientation = o->get_orientation();
+  stop = s->must_stop(orientation) && stop;
+  return stop;
 }
 
 // Detect orientation and script from a list of blobs.
@@ -280,7 +394,7 @@ int os_detect(TO_BLOCK_LIST* port_blocks, OSResults* osr,
 // from the list.
 int os_detect_blobs(const std::vector<int>* allowed_scripts,
                     BLOBNBOX_CLIST* blob_list, OSResults* osr,
-                    tesseract::Tesseract* tess) {
+                    tesseract::Tesseract* tess, int num_threads) {
   OSResults osr_;
   int minCharactersToTry = tess->min_characters_to_try;
   int maxCharactersToTry = 5 * minCharactersToTry;
@@ -311,12 +425,47 @@ int os_detect_blobs(const std::vector<int>* allowed_scripts,
   }
   QRSequenceGenerator sequence(number_of_blobs);
   int num_blobs_evaluated = 0;
-  for (int i = 0; i < real_max; ++i) {
-    if (os_detect_blob(blobs[sequence.GetVal()], &o, &s, osr, tess)
-        && i > minCharactersToTry) {
-      break;
+#ifdef _OPENMP
+  if (num_threads > 1) {
+    // Classify a batch of blobs in all orientations at once, then add the
+    // scores of the blobs in sequence, stopping exactly where the serial
+    // loop would stop, so that only the rest of the batch is wasted.
+    SetOSDMatching(tess);
+    int batch_size = num_threads;
+    std::vector<BLOBNBOX*> batch(batch_size);
+    std::unique_ptr<BLOB_CHOICE_LIST[]> ratings(
+        new BLOB_CHOICE_LIST[batch_size * 4]);
+    bool stop = false;
+    for (int i = 0; i < real_max && !stop; i += batch_size) {
+      int num_in_batch = std::min(batch_size, real_max - i);
+      for (int b = 0; b < num_in_batch; ++b)
+        batch[b] = blobs[sequence.GetVal()];
+#pragma omp parallel for num_threads(num_threads) schedule(dynamic)
+      for (int t = 0; t < num_in_batch * 4; ++t) {
+        ClassifyRotatedBlob(batch[t / 4]->cblob(), t % 4, tess, &ratings[t]);
+      }
+      for (int b = 0; b < num_in_batch; ++b) {
+        if (!stop) {
+          if (AddBlobScores(&ratings[b * 4], &o, &s) &&
+              i + b > minCharactersToTry) {
+            stop = true;
+          } else {
+            ++num_blobs_evaluated;
+          }
+        }
+        for (int r = 0; r < 4; ++r) ratings[b * 4 + r].clear();
+      }
+    }
+  } else
+#endif  // _OPENMP
+  {
+    for (int i = 0; i < real_max; ++i) {
+      if (os_detect_blob(blobs[sequence.GetVal()], &o, &s, osr, tess)
+          && i > minCharactersToTry) {
+        break;
+      }
+      ++num_blobs_evaluated;
     }
-    ++num_blobs_evaluated;
   }
   delete [] blobs;
 
@@ -332,45 +481,13 @@ int os_detect_blobs(const std::vector<int>* allowed_scripts,
 bool os_detect_blob(BLOBNBOX* bbox, OrientationDetector* o,
                     ScriptDetector* s, OSResults* osr,
                     tesseract::Tesseract* tess) {
-  tess->tess_cn_matching.set_value(true); // turn it on
-  tess->tess_bn_matching.set_value(false);
-  C_BLOB* blob = bbox->cblob();
-  TBLOB* tblob = TBLOB::PolygonalCopy(tess->poly_allow_detailed_fx, blob);
-  TBOX box = tblob->bounding_box();
-  FCOORD current_rotation(1.0f, 0.0f);
-  FCOORD rotation90(0.0f, 1.0f);
+  SetOSDMatching(tess);
   BLOB_CHOICE_LIST ratings[4];
   // Test the 4 orientations
   for (int i = 0; i < 4; ++i) {
-    // Normalize the blob. Set the origin to the place we want to be the
-    // bottom-middle after rotation.
-    // Scaling is to make the rotated height the x-height.
-    float scaling = static_cast<float>(kBlnXHeight) / box.height();
-    float x_origin = (box.left() + box.right()) / 2.0f;
-    float y_origin = (box.bottom() + box.top()) / 2.0f;
-    if (i == 0 || i == 2) {
-      // Rotation is 0 or 180.
-      y_origin = i == 0 ? box.bottom() : box.top();
-    } else {
-      // Rotation is 90 or 270.
-      scaling = static_cast<float>(kBlnXHeight) / box.width();
-      x_origin = i == 1 ? box.left() : box.right();
-    }
-    std::unique_ptr<TBLOB> rotated_blob(new TBLOB(*tblob));
-    rotated_blob->Normalize(nullptr, &current_rotation, nullptr,
-                            x_origin, y_origin, scaling, scaling,
-                            0.0f, static_cast<float>(kBlnBaselineOffset),
-                            false, nullptr);
-    tess->AdaptiveClassifier(rotated_blob.get(), ratings + i);
-    current_rotation.rotate(rotation90);
+    ClassifyRotatedBlob(bbox->cblob(), i, tess, ratings + i);
   }
-  delete tblob;
-
-  bool stop = o->detect_blob(ratings);
-  s->detect_blob(ratings);
-  int orientation = o->get_orientation();
-  stop = s->must_stop(orientation) && stop;
-  return stop;
+  return AddBlobScores(ratings, o, s);
 }
 
 
@@ -47,11 +47,14 @@
 #include "textord.h"
 #include "tordmain.h"
 #include "wordseg.h"
+#include "xycut.h"
 
 namespace tesseract {
 
 // Max erosions to perform in removing an enclosing circle.
 const int kMaxCircleErosions = 8;
+// Max number of 2x reductions of the image for layout analysis.
+const int kMaxLayoutReductions = 4;
 
 // Helper to remove an enclosing circle from an image.
 // If there isn't one, then the image will most likely get badly mangled.
@@ -135,8 +138,25 @@ int Tesseract::SegmentPage(const char* input_file, BLOCK_LIST* blocks,
   BLOBNBOX_LIST diacritic_blobs;
   int auto_page_seg_ret_val = 0;
   TO_BLOCK_LIST to_blocks;
-  if (PSM_OSD_ENABLED(pageseg_mode) || PSM_BLOCK_FIND_ENABLED(pageseg_mode) ||
-      PSM_SPARSE(pageseg_mode)) {
+  int layout_reduction = LayoutReduction(pageseg_mode);
+  if (pageseg_fast_xycut && PSM_COL_FIND_ENABLED(pageseg_mode) &&
+      !PSM_OSD_ENABLED(pageseg_mode)) {
+    // Replace the page block with the blocks found by XY-cuts, and leave
+    // to_blocks empty, so TextordPage finds the components, rows and words
+    // in each of them.
+    deskew_ = FCOORD(1.0f, 0.0f);
+    reskew_ = FCOORD(1.0f, 0.0f);
+    blocks->clear();
+    XYCut xycut(source_resolution_);
+    xycut.FindBlocks(pix_binary_, right_to_left(), blocks);
+  } else if (layout_reduction > 0 &&
+             ReducedAutoPageSeg(pageseg_mode, layout_reduction, blocks)) {
+    // The blocks are now at full resolution, but to_blocks is left empty,
+    // so TextordPage finds the blobs, rows and words in them at full
+    // resolution for recognition.
+  } else if (PSM_OSD_ENABLED(pageseg_mode) ||
+             PSM_BLOCK_FIND_ENABLED(pageseg_mode) ||
+             PSM_SPARSE(pageseg_mode)) {
     auto_page_seg_ret_val = AutoPageSeg(
         pageseg_mode, blocks, &to_blocks,
         enable_noise_removal ? &diacritic_blobs : nullptr, osd_tess, osr);
@@ -198,11 +218,15 @@ int Tesseract::SegmentPage(const char* input_file, BLOCK_LIST* blocks,
  * performed. If osd is desired, (osd or only_osd) then osr_tess must be
  * another Tesseract that was initialized especially for osd, and the results
  * will be output into osr (orientation and script result).
+ *
+ * If photo_mask is not null, the mask of the photo (and music) regions, or
+ * nullptr if there are none, is returned in it, to be pixDestroyed by the
+ * caller.
  */
 int Tesseract::AutoPageSeg(PageSegMode pageseg_mode, BLOCK_LIST* blocks,
                            TO_BLOCK_LIST* to_blocks,
                            BLOBNBOX_LIST* diacritic_blobs, Tesseract* osd_tess,
-                           OSResults* osr) {
+                           OSResults* osr, Pix** photo_mask) {
   Pix* photomask_pix = nullptr;
   Pix* musicmask_pix = nullptr;
   // The blocks made by the ColumnFinder. Moved to blocks before return.
@@ -234,7 +258,11 @@ int Tesseract::AutoPageSeg(PageSegMode pageseg_mode, BLOCK_LIST* blocks,
       finder->GetDeskewVectors(&deskew_, &reskew_);
     delete finder;
   }
-  pixDestroy(&photomask_pix);
+  if (photo_mask != nullptr) {
+    *photo_mask = photomask_pix;
+  } else {
+    pixDestroy(&photomask_pix);
+  }
   pixDestroy(&musicmask_pix);
   if (result < 0) return result;
 
@@ -245,6 +273,129 @@ int Tesseract::AutoPageSeg(PageSegMode pageseg_mode, BLOCK_LIST* blocks,
   return result;
 }
 
+/**
+ * Returns the number of times the image should be reduced by 2 for layout
+ * analysis to get down to pageseg_layout_resolution, or 0 if the layout
+ * analysis should run on the full resolution image.
+ * Only plain automatic page segmentation is supported, as OSD, sparse text
+ * and equation detection all work on the full resolution image.
+ */
+int Tesseract::LayoutReduction(PageSegMode pageseg_mode) const {
+  if (pageseg_layout_resolution <= 0 || !PSM_COL_FIND_ENABLED(pageseg_mode) ||
+      PSM_OSD_ENABLED(pageseg_mode) || equ_detect_ != nullptr) {
+    return 0;
+  }
+  int reduction = 0;
+  while (reduction < kMaxLayoutReductions &&
+         (source_resolution_ >> (reduction + 1)) >= pageseg_layout_resolution) {
+    ++reduction;
+  }
+  return reduction;
+}
+
+/**
+ * Runs AutoPageSeg on a copy of pix_binary_ reduced by 2^reduction, and
+ * scales the resulting blocks back up to full resolution in blocks.
+ * The reduced TO_BLOCKs are discarded, as recognition needs the blobs at
+ * full resolution. The rule lines that the layout analysis removed from the
+ * reduced image, and its photo regions, are scaled up and removed from
+ * pix_binary_ too, so that TextordPage does not make blobs of them.
+ * Returns false, with blocks and pix_binary_ unchanged, if the reduced
+ * layout could not be made or used, as for vertical text blocks, which
+ * would need their blobs rotated by the ColumnFinder.
+ */
+bool Tesseract::ReducedAutoPageSeg(PageSegMode pageseg_mode, int reduction,
+                                   BLOCK_LIST* blocks) {
+  int levels[kMaxLayoutReductions] = {0, 0, 0, 0};
+  for (int i = 0; i < reduction; ++i) levels[i] = 1;
+  Pix* reduced_pix = pixReduceRankBinaryCascade(pix_binary_, levels[0],
+                                                levels[1], levels[2],
+                                                levels[3]);
+  if (reduced_pix == nullptr) return false;
+  int reduced_height = pixGetHeight(reduced_pix);
+  // Swap in the reduced image, hiding the images that are not reduced.
+  Pix* full_binary = pix_binary_;
+  Pix* full_thresholds = pix_thresholds_;
+  Pix* full_grey = pix_grey_;
+  Pix* full_scaled_color = scaled_color_;
+  int full_scaled_factor = scaled_factor_;
+  int full_resolution = source_resolution_;
+  pix_binary_ = reduced_pix;
+  pix_thresholds_ = nullptr;
+  pix_grey_ = nullptr;
+  scaled_color_ = nullptr;
+  scaled_factor_ = -1;
+  source_resolution_ = full_resolution >> reduction;
+
+  BLOCK_LIST reduced_blocks;
+  BLOCK_IT block_it(&reduced_blocks);
+  auto* page_block = new BLOCK("", true, 0, 0, 0, 0, pixGetWidth(reduced_pix),
+                               reduced_height);
+  page_block->set_right_to_left(right_to_left());
+  block_it.add_to_end(page_block);
+  TO_BLOCK_LIST to_blocks;
+  FCOORD deskew = deskew_;
+  FCOORD reskew = reskew_;
+  // AutoPageSeg removes the lines from pix_binary_, so a copy is kept to
+  // find the pixels that went.
+  Pix* removed_pix = pixCopy(nullptr, reduced_pix);
+  Pix* photo_mask = nullptr;
+  int result = AutoPageSeg(pageseg_mode, &reduced_blocks, &to_blocks, nullptr,
+                           nullptr, nullptr, &photo_mask);
+  pixSubtract(removed_pix, removed_pix, pix_binary_);
+  if (photo_mask != nullptr) pixOr(removed_pix, removed_pix, photo_mask);
+  pixDestroy(&photo_mask);
+
+  pixDestroy(&pix_binary_);
+  pix_binary_ = full_binary;
+  pix_thresholds_ = full_thresholds;
+  pix_grey_ = full_grey;
+  scaled_color_ = full_scaled_color;
+  scaled_factor_ = full_scaled_factor;
+  source_resolution_ = full_resolution;
+  bool usable = result >= 0;
+  for (block_it.mark_cycle_pt(); usable && !block_it.cycled_list();
+       block_it.forward()) {
+    const BLOCK* block = block_it.data();
+    if (block->pdblk.poly_block() == nullptr ||
+        block->re_rotation().x() != 1.0f || block->re_rotation().y() != 0.0f)
+      usable = false;
+  }
+  if (!usable) {
+    pixDestroy(&removed_pix);
+    deskew_ = deskew;
+    reskew_ = reskew;
+    return false;
+  }
+  int factor = 1 << reduction;
+  // A reduced pixel is on if any of the full resolution pixels that it
+  // covers is, so the scaled up mask covers every removed pixel. Both
+  // images start at the top left corner, and the rows and columns that the
+  // reduction dropped at the bottom and right are left as they are.
+  Pix* full_removed_pix = pixExpandBinaryPower2(removed_pix, factor);
+  pixDestroy(&removed_pix);
+  if (full_removed_pix != nullptr) {
+    pixSubtract(pix_binary_, pix_binary_, full_removed_pix);
+    pixDestroy(&full_removed_pix);
+  }
+  // The skew vectors are unchanged by scaling, but the polygons scale up.
+  // The reduction drops the last rows when the height is not a multiple of
+  // the factor, so the scaled y-up coords are too low by the number of rows
+  // dropped, and y_shift, which scale_polygon subtracts, is minus that.
+  // A reduced pixel of padding, as in XYCut, makes sure that no ink is
+  // clipped by the rounding in the reduction.
+  int full_height = pixGetHeight(pix_binary_);
+  int y_shift = reduced_height * factor - full_height;
+  TBOX page_box(0, 0, pixGetWidth(pix_binary_), full_height);
+  for (block_it.mark_cycle_pt(); !block_it.cycled_list(); block_it.forward()) {
+    block_it.data()->scale_polygon(factor, y_shift, factor, page_box);
+  }
+  blocks->clear();
+  block_it.set_to_list(blocks);
+  block_it.add_list_after(&reduced_blocks);
+  return true;
+}
+
 // Helper adds all the scripts from sid_set converted to ids from osd_set to
 // allowed_ids.
 static void AddAllScriptsConverted(const UNICHARSET& sid_set,
@@ -367,7 +518,7 @@ ColumnFinder* Tesseract::SetupPageSegAndDetectOrientation(
                                  osd_tess->unicharset, &osd_scripts);
         }
       }
-      os_detect_blobs(&osd_scripts, &osd_blobs, osr, osd_tess);
+      os_detect_blobs(&osd_scripts, &osd_blobs, osr, osd_tess, osd_jobs);
       if (pageseg_mode == PSM_OSD_ONLY) {
         delete finder;
         return nullptr;
@@ -211,6 +211,16 @@ Tesseract::Tesseract()
       double_MEMBER(test_pt_y, 99999.99, "ycoord", this->params()),
       INT_MEMBER(multilang_debug_level, 0, "Print multilang debug info.",
                  this->params()),
+      BOOL_MEMBER(multilang_line_language, false,
+                  "Choose the language on the first word of each textline and"
+                  " only try other languages on the rest of the line when"
+                  " below multilang_retry_certainty, or when not acceptable"
+                  " if that is 0",
+                  this->params()),
+      double_MEMBER(multilang_retry_certainty, 0.0,
+                    "Only try other languages on words with a certainty below"
+                    " this (0 = on all words that are not acceptable)",
+                    this->params()),
       INT_MEMBER(paragraph_debug_level, 0, "Print paragraph debug info.",
                  this->params()),
       BOOL_MEMBER(paragraph_text_based, true,
@@ -399,6 +409,13 @@ Tesseract::Tesseract()
       INT_MEMBER(min_characters_to_try, 50,
                  "Specify minimum characters to try during OSD",
                  this->params()),
+      INT_MEMBER(osd_jobs, 1,
+                 "Max number of blobs classified at once during OSD",
+                 this->params()),
+      INT_MEMBER(osd_max_resolution, 0,
+                 "Run OSD of a whole page on a copy reduced by powers of 2 to"
+                 " at most this resolution (0 = full resolution)",
+                 this->params()),
       STRING_MEMBER(unrecognised_char, "|",
                     "Output char for unidentified blobs", this->params()),
       INT_MEMBER(suspect_level, 99, "Suspect marker level", this->params()),
@@ -461,6 +478,19 @@ Tesseract::Tesseract()
                  this->params()),
       BOOL_MEMBER(tessedit_write_images, false,
                   "Capture the image from the IPE", this->params()),
+      INT_MEMBER(tessedit_tile_size, 0,
+                 "Recognize images bigger than this in overlapping square tiles"
+                 " of this size (0 = off)",
+                 this->params()),
+      INT_MEMBER(tessedit_tile_overlap, 400,
+                 "Overlap in pixels between tiles, larger than the biggest "
+                 "word",
+                 this->params()),
+      INT_MEMBER(tessedit_tile_jobs, 1,
+                 "Max number of tiles recognized at once", this->params()),
+      BOOL_MEMBER(tessedit_page_arena, false,
+                  "Allocate the results of each page from one arena",
+                  this->params()),
       BOOL_MEMBER(interactive_display_mode, false, "Run interactively?",
                   this->params()),
       STRING_MEMBER(file_type, ".tif", "Filename extension", this->params()),
@@ -530,6 +560,16 @@ Tesseract::Tesseract()
           "5", this->params()),
       BOOL_MEMBER(pageseg_apply_music_mask, true,
                 "Detect music staff and remove intersecting components", this->params()),
+      BOOL_MEMBER(pageseg_fast_xycut, false,
+                  "Use fast projection profile XY-cuts instead of column "
+                  "finding for automatic page segmentation without OSD. Only "
+                  "suitable for clean pages without pictures.",
+                  this->params()),
+      INT_MEMBER(pageseg_layout_resolution, 0,
+                 "If > 0, run automatic page layout analysis on the image "
+                 "reduced by powers of 2 to no less than this resolution (in "
+                 "ppi), and scale the blocks back up for recognition.",
+                 this->params()),
 
       backup_config_file_(nullptr),
       pix_binary_(nullptr),
@@ -544,6 +584,8 @@ Tesseract::Tesseract()
       deskew_(1.0f, 0.0f),
       reskew_(1.0f, 0.0f),
       most_recently_used_(this),
+      line_lang_row_(nullptr),
+      line_lang_(nullptr),
       font_table_size_(0),
       equ_detect_(nullptr),
 #ifndef ANDROID_BUILD
@@ -586,6 +628,12 @@ void Tesseract::Clear() {
   reskew_ = FCOORD(1.0f, 0.0f);
   splitter_.Clear();
   scaled_factor_ = -1;
+  tiled_words_.clear();
+  tiled_done_ = false;
+#ifndef DISABLED_LEGACY_ENGINE
+  ClearBlobCache();
+  ClearSeamCache();
+#endif
   for (int i = 0; i < sub_langs_.size(); ++i)
     sub_langs_[i]->Clear();
 }
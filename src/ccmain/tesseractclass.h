@@ -52,6 +52,9 @@
 
 #include <cstdint>                  // for int16_t, int32_t, uint16_t
 #include <cstdio>                   // for FILE
+#include <memory>                   // for std::unique_ptr
+#include <string>                   // for std::string
+#include <vector>                   // for std::vector
 
 namespace tesseract {
 
@@ -125,6 +128,8 @@ struct TesseractStats {
         doc_good_char_quality(0),
         word_count(0),
         dict_words(0),
+        multilang_retried_words(0),
+        multilang_extra_passes(0),
         tilde_crunch_written(false),
         last_char_was_newline(true),
         last_char_was_tilde(false),
@@ -138,6 +143,10 @@ struct TesseractStats {
   int16_t doc_good_char_quality;
   int32_t word_count;     // count of word in the document
   int32_t dict_words;     // number of dicitionary words in the document
+  // Number of words on the page recognized in more than one language, and
+  // the total number of recognitions beyond the first for those words.
+  int32_t multilang_retried_words;
+  int32_t multilang_extra_passes;
   STRING dump_words_str;  // accumulator used by dump_words()
   // Flags used by write_results()
   bool tilde_crunch_written;
@@ -175,6 +184,24 @@ struct WordData {
 using WordRecognizer = void (Tesseract::*)(const WordData&, WERD_RES**,
                                            PointerVector<WERD_RES>*);
 
+// A word found by TessBaseAPI::RecognizeTiled, in page coordinates.
+struct TiledWord {
+  int left, top, right, bottom;
+  float confidence;
+  // Highest level that this word starts: 2 block, 3 paragraph, 4 textline,
+  // or 5 for none, as in the TSV output.
+  int starts_level;
+  std::string text;
+};
+
+// The extra engines that TessBaseAPI::RecognizeTiled keeps from one image to
+// the next. The api defines them, and the Tesseract owns them, so that they
+// go away with it.
+class TileEngines {
+ public:
+  virtual ~TileEngines() = default;
+};
+
 class Tesseract : public Wordrec {
  public:
   Tesseract();
@@ -250,6 +277,20 @@ class Tesseract : public Wordrec {
   int source_resolution() const {
     return source_resolution_;
   }
+  // The words merged from the tiles by TessBaseAPI::RecognizeTiled, which
+  // stand in for the PAGE_RES while tiled_done().
+  std::vector<TiledWord>& tiled_words() {
+    return tiled_words_;
+  }
+  bool tiled_done() const {
+    return tiled_done_;
+  }
+  std::unique_ptr<TileEngines>& tile_engines() {
+    return tile_engines_;
+  }
+  void set_tiled_done(bool done) {
+    tiled_done_ = done;
+  }
   void set_source_resolution(int ppi) {
     source_resolution_ = ppi;
   }
@@ -328,7 +369,11 @@ class Tesseract : public Wordrec {
   void SetupWordScripts(BLOCK_LIST* blocks);
   int AutoPageSeg(PageSegMode pageseg_mode, BLOCK_LIST* blocks,
                   TO_BLOCK_LIST* to_blocks, BLOBNBOX_LIST* diacritic_blobs,
-                  Tesseract* osd_tess, OSResults* osr);
+                  Tesseract* osd_tess, OSResults* osr,
+                  Pix** photo_mask = nullptr);
+  int LayoutReduction(PageSegMode pageseg_mode) const;
+  bool ReducedAutoPageSeg(PageSegMode pageseg_mode, int reduction,
+                          BLOCK_LIST* blocks);
   ColumnFinder* SetupPageSegAndDetectOrientation(
       PageSegMode pageseg_mode, BLOCK_LIST* blocks, Tesseract* osd_tess,
       OSResults* osr, TO_BLOCK_LIST* to_blocks, Pix** photo_mask_pix,
@@ -401,6 +446,20 @@ class Tesseract : public Wordrec {
   int RetryWithLanguage(const WordData& word_data, WordRecognizer recognizer,
                         bool debug, WERD_RES** in_word,
                         PointerVector<WERD_RES>* best_words);
+  // Helper to run the recognizer of this (language-specific) tesseract on the
+  // word, putting the results in new_words. Touches nothing but this, the
+  // in_word and new_words, so different languages may run concurrently.
+  void RecognizeInLanguage(const WordData& word_data,
+                           WordRecognizer recognizer, bool debug,
+                           WERD_RES** in_word,
+                           PointerVector<WERD_RES>* new_words);
+  // Returns true if the other languages should be tried on words, the
+  // results of the first language. With a negative multilang_retry_certainty
+  // only words below it are tried again, and, until line_chosen, only if
+  // they are not acceptable either. Otherwise the words that are not
+  // acceptable are tried again.
+  bool NeedsOtherLanguages(const PointerVector<WERD_RES>& words,
+                           bool line_chosen) const;
   // Moves good-looking "noise"/diacritics from the reject list to the main
   // blob list on the current word. Returns true if anything was done, and
   // sets make_next_word_fuzzy if blob(s) were added to the end of the word.
@@ -894,6 +953,14 @@ class Tesseract : public Wordrec {
   double_VAR_H(test_pt_x, 99999.99, "xcoord");
   double_VAR_H(test_pt_y, 99999.99, "ycoord");
   INT_VAR_H(multilang_debug_level, 0, "Print multilang debug info.");
+  BOOL_VAR_H(multilang_line_language, false,
+             "Choose the language on the first word of each textline and"
+             " only try other languages on the rest of the line when below"
+             " multilang_retry_certainty, or when not acceptable if that"
+             " is 0");
+  double_VAR_H(multilang_retry_certainty, 0.0,
+               "Only try other languages on words with a certainty below"
+               " this (0 = on all words that are not acceptable)");
   INT_VAR_H(paragraph_debug_level, 0, "Print paragraph debug info.");
   BOOL_VAR_H(paragraph_text_based, true,
              "Run paragraph detection on the post-text-recognition "
@@ -1016,6 +1083,10 @@ class Tesseract : public Wordrec {
   INT_VAR_H(user_defined_dpi, 0, "Specify DPI for input image");
   INT_VAR_H(min_characters_to_try, 50,
             "Specify minimum characters to try during OSD");
+  INT_VAR_H(osd_jobs, 1, "Max number of blobs classified at once during OSD");
+  INT_VAR_H(osd_max_resolution, 0,
+            "Run OSD of a whole page on a copy reduced by powers of 2 to at"
+            " most this resolution (0 = full resolution)");
   STRING_VAR_H(unrecognised_char, "|", "Output char for unidentified blobs");
   INT_VAR_H(suspect_level, 99, "Suspect marker level");
   INT_VAR_H(suspect_short_words, 2, "Don't Suspect dict wds longer than this");
@@ -1050,6 +1121,14 @@ class Tesseract : public Wordrec {
   INT_VAR_H(tessedit_page_number, -1,
             "-1 -> All pages, else specific page to process");
   BOOL_VAR_H(tessedit_write_images, false, "Capture the image from the IPE");
+  INT_VAR_H(tessedit_tile_size, 0,
+            "Recognize images bigger than this in overlapping square tiles"
+            " of this size (0 = off)");
+  INT_VAR_H(tessedit_tile_overlap, 400,
+            "Overlap in pixels between tiles, larger than the biggest word");
+  INT_VAR_H(tessedit_tile_jobs, 1, "Max number of tiles recognized at once");
+  BOOL_VAR_H(tessedit_page_arena, false,
+             "Allocate the results of each page from one arena");
   BOOL_VAR_H(interactive_display_mode, false, "Run interactively?");
   STRING_VAR_H(file_type, ".tif", "Filename extension");
   BOOL_VAR_H(tessedit_override_permuter, true, "According to dict_word");
@@ -1101,6 +1180,14 @@ class Tesseract : public Wordrec {
                "standard value is 5.");
   BOOL_VAR_H(pageseg_apply_music_mask, true,
              "Detect music staff and remove intersecting components");
+  BOOL_VAR_H(pageseg_fast_xycut, false,
+             "Use fast projection profile XY-cuts instead of column finding "
+             "for automatic page segmentation without OSD. Only suitable "
+             "for clean pages without pictures.");
+  INT_VAR_H(pageseg_layout_resolution, 0,
+            "If > 0, run automatic page layout analysis on the image reduced "
+            "by powers of 2 to no less than this resolution (in ppi), and "
+            "scale the blocks back up for recognition.");
 
   //// ambigsrecog.cpp /////////////////////////////////////////////////////////
   FILE* init_recog_training(const char* filename);
@@ -1148,6 +1235,10 @@ class Tesseract : public Wordrec {
   // Most recently used Tesseract out of this and sub_langs_. The default
   // language for the next word.
   Tesseract* most_recently_used_;
+  // With multilang_line_language, the row of the last word recognized, and
+  // the language chosen for it, or nullptr if not chosen yet.
+  const ROW* line_lang_row_;
+  Tesseract* line_lang_;
   // The size of the font table, ie max possible font id + 1.
   int font_table_size_;
   // Equation detector. Note: this pointer is NOT owned by the class.
@@ -1156,6 +1247,11 @@ class Tesseract : public Wordrec {
   LSTMRecognizer* lstm_recognizer_;
   // Output "page" number (actually line number) using TrainLineRecognizer.
   int train_line_page_num_;
+  // Results of TessBaseAPI::RecognizeTiled, valid if tiled_done_.
+  std::vector<TiledWord> tiled_words_;
+  bool tiled_done_ = false;
+  // Engines for the other tiles, kept by TessBaseAPI::RecognizeTiled.
+  std::unique_ptr<TileEngines> tile_engines_;
 };
 
 }  // namespace tesseract
@@ -22,6 +22,7 @@
 
 #include "clst.h"              // for CLIST_ITERATOR, CLISTIZEH
 #include "normalis.h"          // for DENORM
+#include "pagearena.h"         // for PageArenaObject
 #include "points.h"            // for FCOORD, ICOORD
 #include "rect.h"              // for TBOX
 #include "scrollview.h"        // for ScrollView, ScrollView::Color
@@ -96,7 +97,7 @@ struct TPOINT {
 
 using VECTOR = TPOINT;           // structure for coordinates.
 
-struct EDGEPT {
+struct EDGEPT : public PageArenaObject {
   EDGEPT()
   : next(nullptr), prev(nullptr), src_outline(nullptr), start_step(0), step_count(0) {
     memset(flags, 0, EDGEPTFLAGS * sizeof(flags[0]));
@@ -200,7 +201,7 @@ struct EDGEPT {
 // For use in chop and findseam to keep a list of which EDGEPTs were inserted.
 CLISTIZEH(EDGEPT)
 
-struct TESSLINE {
+struct TESSLINE : public PageArenaObject {
   TESSLINE() : is_hole(false), loop(nullptr), next(nullptr) {}
   TESSLINE(const TESSLINE& src) : loop(nullptr), next(nullptr) {
     CopyFrom(src);
@@ -281,7 +282,7 @@ struct TESSLINE {
   TESSLINE *next;                // Next outline in blob.
 };                               // Outline structure.
 
-struct TBLOB {
+struct TBLOB : public PageArenaObject {
   TBLOB() : outlines(nullptr) {}
   TBLOB(const TBLOB& src) : outlines(nullptr) {
     CopyFrom(src);
@@ -415,7 +416,7 @@ struct TBLOB {
   DENORM denorm_;
 };                               // Blob structure.
 
-struct TWERD {
+struct TWERD : public PageArenaObject {
   TWERD() : latin_script(false) {}
   TWERD(const TWERD& src) {
     CopyFrom(src);
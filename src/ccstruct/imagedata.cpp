@@ -24,6 +24,7 @@
 #include "imagedata.h"
 
 #include "boxread.h"     // for ReadMemBoxes
+#include "imageshard.h"  // for ImageShard
 #include "rect.h"        // for TBOX
 #include "scrollview.h"  // for ScrollView, ScrollView::CYAN, ScrollView::NONE
 #include "tprintf.h"     // for tprintf
@@ -33,6 +34,9 @@
 
 #include "allheaders.h"  // for pixDestroy, pixGetHeight, pixGetWidth, lept_...
 
+#include <algorithm>     // for std::max, std::upper_bound
+#include <climits>       // for INT_MAX
+#include <chrono>        // for std::chrono
 #include <cinttypes>     // for PRId64
 
 namespace tesseract {
@@ -166,7 +170,14 @@ ImageData* ImageData::Build(const char* name, int page_number, const char* lang,
 bool ImageData::Serialize(TFile* fp) const {
   if (!imagefilename_.Serialize(fp)) return false;
   if (!fp->Serialize(&page_number_)) return false;
-  if (!image_data_.Serialize(fp)) return false;
+  if (image_data_.empty() && decoded_pix_ != nullptr) {
+    // The image was set by SetDecodedPix, so it has to be encoded now.
+    GenericVector<char> image_data;
+    SetPixInternal(pixCopy(nullptr, decoded_pix_.get()), &image_data);
+    if (!image_data.Serialize(fp)) return false;
+  } else if (!image_data_.Serialize(fp)) {
+    return false;
+  }
   if (!language_.Serialize(fp)) return false;
   if (!transcription_.Serialize(fp)) return false;
   // WARNING: Will not work across different endian machines.
@@ -178,6 +189,7 @@ bool ImageData::Serialize(TFile* fp) const {
 
 // Reads from the given file. Returns false in case of error.
 bool ImageData::DeSerialize(TFile* fp) {
+  decoded_pix_.reset();
   if (!imagefilename_.DeSerialize(fp)) return false;
   if (!fp->DeSerialize(&page_number_)) return false;
   if (!image_data_.DeSerialize(fp)) return false;
@@ -213,6 +225,7 @@ void ImageData::SetPix(Pix* pix) {
 #ifdef TESSERACT_IMAGEDATA_AS_PIX
   internal_pix_ = pix;
 #else
+  decoded_pix_.reset();
   SetPixInternal(pix, &image_data_);
 #endif
 }
@@ -230,10 +243,46 @@ Pix* ImageData::GetPix() const {
   return pixCopy(NULL, internal_pix_);
 #endif
 #else
+  if (decoded_pix_ != nullptr) return pixCopy(nullptr, decoded_pix_.get());
   return GetPixInternal(image_data_);
 #endif
 }
 
+// Decodes the image and keeps it, so that GetPix returns a copy of it
+// instead of decoding the image data again on every call.
+void ImageData::Decode() {
+#ifndef TESSERACT_IMAGEDATA_AS_PIX
+  if (decoded_pix_ != nullptr || image_data_.empty()) return;
+  Pix* pix = GetPixInternal(image_data_);
+  if (pix != nullptr) {
+    decoded_pix_.reset(pix, [](Pix* p) { pixDestroy(&p); });
+  }
+#endif
+}
+
+// Keeps the given Pix as the image without encoding it, so that GetPix
+// returns copies of it. Takes ownership of the pix, which may be nullptr to
+// remove the image.
+void ImageData::SetDecodedPix(Pix* pix) {
+#ifdef TESSERACT_IMAGEDATA_AS_PIX
+  pixDestroy(&internal_pix_);
+  internal_pix_ = pix;
+#else
+  image_data_.clear();
+  if (pix == nullptr) {
+    decoded_pix_.reset();
+  } else {
+    decoded_pix_.reset(pix, [](Pix* p) { pixDestroy(&p); });
+  }
+#endif
+}
+
+// Scales the boxes by the given factor, to match an image that has been
+// scaled by it.
+void ImageData::ScaleBoxes(float factor) {
+  for (int b = 0; b < boxes_.size(); ++b) boxes_[b].scale(factor);
+}
+
 // Gets anything and everything with a non-nullptr pointer, prescaled to a
 // given target_height (if 0, then the original image height), and aligned.
 // Also returns (if not nullptr) the width and height of the scaled image.
@@ -582,8 +631,35 @@ bool DocumentData::ReCachePages() {
 
 // A collection of DocumentData that knows roughly how much memory it is using.
 DocumentCache::DocumentCache(int64_t max_memory)
-    : num_pages_per_doc_(0), max_memory_(max_memory) {}
-DocumentCache::~DocumentCache() {}
+    : num_pages_per_doc_(0),
+      max_memory_(max_memory),
+      num_shard_samples_(0),
+      num_prefetch_threads_(0),
+      num_prefetch_ahead_(0),
+      prefetch_start_(0),
+      next_prefetch_(0),
+      prefetch_generation_(0),
+      stop_prefetch_(false),
+      prefetch_hits_(0),
+      prefetch_misses_(0),
+      num_decoded_(0),
+      decode_seconds_(0.0) {}
+
+DocumentCache::~DocumentCache() {
+  StopPrefetchThreads();
+}
+
+// Deletes all existing documents from the cache.
+void DocumentCache::Clear() {
+  StopPrefetchThreads();
+  std::lock_guard<std::mutex> lock(documents_mutex_);
+  documents_.clear();
+  num_pages_per_doc_ = 0;
+  shards_.clear();
+  shard_starts_.clear();
+  num_shard_samples_ = 0;
+  shard_page_.reset();
+}
 
 // Adds all the documents in the list of filenames, counting memory.
 // The reader is used to read the files.
@@ -591,6 +667,17 @@ bool DocumentCache::LoadDocuments(const GenericVector<STRING>& filenames,
                                   CachingStrategy cache_strategy,
                                   FileReader reader) {
   cache_strategy_ = cache_strategy;
+  int num_shards = 0;
+  for (int arg = 0; arg < filenames.size(); ++arg) {
+    if (ImageShard::IsShard(filenames[arg].c_str())) ++num_shards;
+  }
+  if (num_shards > 0) {
+    if (num_shards < filenames.size()) {
+      tprintf("Can't mix shards with other training files!\n");
+      return false;
+    }
+    return LoadShards(filenames);
+  }
   int64_t fair_share_memory = 0;
   // In the round-robin case, each DocumentData handles restricting its content
   // to its fair share of memory. In the sequential case, DocumentCache
@@ -605,7 +692,10 @@ bool DocumentCache::LoadDocuments(const GenericVector<STRING>& filenames,
   }
   if (!documents_.empty()) {
     // Try to get the first page now to verify the list of filenames.
-    if (GetPageBySerial(0) != nullptr) return true;
+    if (GetPageBySerial(0) != nullptr) {
+      if (num_prefetch_threads_ > 0 && !prefetching()) StartPrefetchThreads();
+      return true;
+    }
     tprintf("Load of page 0 failed!\n");
   }
   return false;
@@ -629,6 +719,8 @@ DocumentData* DocumentCache::FindDocument(const STRING& document_name) const {
 // Returns the total number of pages in an epoch. For CS_ROUND_ROBIN cache
 // strategy, could take a long time.
 int DocumentCache::TotalPages() {
+  std::lock_guard<std::mutex> lock(documents_mutex_);
+  if (!shards_.empty()) return num_shard_samples_;
   if (cache_strategy_ == CS_SEQUENTIAL) {
     // In sequential mode, we assume each doc has the same number of pages
     // whether it is true or not.
@@ -645,6 +737,109 @@ int DocumentCache::TotalPages() {
   return total_pages;
 }
 
+// Returns a page by serial number using the current cache_strategy_ to
+// determine the mapping from serial number to page.
+const ImageData* DocumentCache::GetPageBySerial(int serial) {
+  std::lock_guard<std::mutex> lock(documents_mutex_);
+  return GetPageBySerialLocked(serial);
+}
+
+// As GetPageBySerial, for callers that hold documents_mutex_.
+const ImageData* DocumentCache::GetPageBySerialLocked(int serial) {
+  if (!shards_.empty()) {
+    shard_page_.reset(GetShardSample(serial));
+    return shard_page_.get();
+  }
+  if (cache_strategy_ == CS_SEQUENTIAL)
+    return GetPageSequential(serial);
+  else
+    return GetPageRoundRobin(serial);
+}
+
+// Returns a copy of the page with the given serial number, with its image
+// decoded, or nullptr if there is none. The copy belongs to the caller and
+// stays valid whatever happens to the cache. If prefetching, the page is
+// taken from those already prepared by the prefetch threads when possible.
+ImageData* DocumentCache::CopyPageBySerial(int serial) {
+  std::unique_lock<std::mutex> lock(prefetch_mutex_);
+  std::unique_ptr<ImageData> page;
+  bool found = false;
+  if (prefetching() && IsPrefetchScheduled(serial)) {
+    // Wait for it, unless another caller moves on and discards it first.
+    prefetched_cv_.wait(lock, [this, serial] {
+      return prefetched_.count(serial) > 0 || !IsPrefetchScheduled(serial);
+    });
+    auto it = prefetched_.find(serial);
+    if (it != prefetched_.end()) {
+      page = std::move(it->second);
+      found = true;
+    }
+  }
+  if (found) {
+    ++prefetch_hits_;
+    prefetch_start_ = std::max(prefetch_start_, serial + 1);
+    next_prefetch_ = std::max(next_prefetch_, prefetch_start_);
+  } else {
+    ++prefetch_misses_;
+    // Start again from here.
+    ++prefetch_generation_;
+    prefetched_.clear();
+    prefetch_start_ = serial + 1;
+    next_prefetch_ = serial + 1;
+  }
+  // Discard any pages that were skipped.
+  prefetched_.erase(prefetched_.begin(),
+                    prefetched_.lower_bound(prefetch_start_));
+  prefetch_cv_.notify_all();
+  prefetched_cv_.notify_all();
+  lock.unlock();
+  if (!found) page.reset(FetchPage(serial));
+  return page.release();
+}
+
+// Makes num_threads threads keep copies of the pages of the num_ahead serial
+// numbers that follow the last one passed to CopyPageBySerial, with their
+// images decoded.
+void DocumentCache::SetPrefetch(int num_threads, int num_ahead) {
+  StopPrefetchThreads();
+  num_prefetch_threads_ = num_ahead > 0 ? num_threads : 0;
+  num_prefetch_ahead_ = num_ahead;
+  if (num_prefetch_threads_ > 0 && (!documents_.empty() || !shards_.empty()))
+    StartPrefetchThreads();
+}
+
+int DocumentCache::prefetch_hits() const {
+  std::lock_guard<std::mutex> lock(prefetch_mutex_);
+  return prefetch_hits_;
+}
+
+int DocumentCache::prefetch_misses() const {
+  std::lock_guard<std::mutex> lock(prefetch_mutex_);
+  return prefetch_misses_;
+}
+
+int DocumentCache::num_decoded() const {
+  std::lock_guard<std::mutex> lock(prefetch_mutex_);
+  return num_decoded_;
+}
+
+double DocumentCache::decode_seconds() const {
+  std::lock_guard<std::mutex> lock(prefetch_mutex_);
+  return decode_seconds_;
+}
+
+// Prints the statistics.
+void DocumentCache::PrintStats() const {
+  std::lock_guard<std::mutex> lock(prefetch_mutex_);
+  int num_pages = prefetch_hits_ + prefetch_misses_;
+  tprintf("Training data: %d of %d pages prefetched (%.1f%%),"
+          " %d images decoded in %.3fs (%.3fms each)\n",
+          prefetch_hits_, num_pages,
+          num_pages > 0 ? 100.0 * prefetch_hits_ / num_pages : 0.0,
+          num_decoded_, decode_seconds_,
+          num_decoded_ > 0 ? 1000.0 * decode_seconds_ / num_decoded_ : 0.0);
+}
+
 // Returns a page by serial number, selecting them in a round-robin fashion
 // from all the documents. Highly disk-intensive, but doesn't need samples
 // to be shuffled between files to begin with.
@@ -715,6 +910,80 @@ const ImageData* DocumentCache::GetPageSequential(int serial) {
   return doc;
 }
 
+// Opens the shards in the list of filenames, instead of documents.
+bool DocumentCache::LoadShards(const GenericVector<STRING>& filenames) {
+  for (int arg = 0; arg < filenames.size(); ++arg) {
+    auto* shard = new ImageShard;
+    shards_.emplace_back(shard);
+    if (!shard->Open(filenames[arg].c_str())) {
+      Clear();
+      return false;
+    }
+    if (shard->NumSamples() > INT_MAX - num_shard_samples_) {
+      tprintf("Too many samples in shards!\n");
+      Clear();
+      return false;
+    }
+    shard_starts_.push_back(num_shard_samples_);
+    num_shard_samples_ += shard->NumSamples();
+  }
+  if (num_shard_samples_ == 0) {
+    tprintf("No samples in shards!\n");
+    Clear();
+    return false;
+  }
+  tprintf("Mapped %d samples from %d shards\n", num_shard_samples_,
+          filenames.size());
+  if (num_prefetch_threads_ > 0 && !prefetching()) StartPrefetchThreads();
+  return true;
+}
+
+// Mixes the bits of value, as the finalizer of SplitMix64.
+static uint64_t MixBits(uint64_t value) {
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+  return value ^ (value >> 31);
+}
+
+// Returns the element at the given index of a pseudo-random permutation of
+// [0, size) that is different for each seed, without storing the permutation.
+// A Feistel network permutes the smallest even number of bits that covers
+// size, and is repeated until the result is in range, which it is on average
+// in less than 4 tries.
+static int ShuffledIndex(int index, int size, uint64_t seed) {
+  int half_bits = 1;
+  while ((uint64_t{1} << (2 * half_bits)) < static_cast<uint64_t>(size))
+    ++half_bits;
+  const uint64_t half_mask = (uint64_t{1} << half_bits) - 1;
+  const int kNumRounds = 4;
+  uint64_t value = index;
+  do {
+    uint64_t left = value >> half_bits;
+    uint64_t right = value & half_mask;
+    for (int round = 0; round < kNumRounds; ++round) {
+      uint64_t next_right =
+          left ^ (MixBits(right ^ MixBits(seed * kNumRounds + round)) &
+                  half_mask);
+      left = right;
+      right = next_right;
+    }
+    value = (left << half_bits) | right;
+  } while (value >= static_cast<uint64_t>(size));
+  return static_cast<int>(value);
+}
+
+// Returns a new copy of the sample of the shards with the given serial
+// number. Each epoch takes all the samples in its own random order.
+ImageData* DocumentCache::GetShardSample(int serial) const {
+  int epoch = serial / num_shard_samples_;
+  int sample = ShuffledIndex(serial % num_shard_samples_, num_shard_samples_,
+                             epoch);
+  int shard = std::upper_bound(shard_starts_.begin(), shard_starts_.end(),
+                               sample) -
+              shard_starts_.begin() - 1;
+  return shards_[shard]->GetSample(sample - shard_starts_[shard]);
+}
+
 // Helper counts the number of adjacent cached neighbours of index looking in
 // direction dir, ie index+dir, index+2*dir etc.
 int DocumentCache::CountNeighbourDocs(int index, int dir) {
@@ -726,4 +995,90 @@ int DocumentCache::CountNeighbourDocs(int index, int dir) {
   return num_docs;
 }
 
+// Returns a decoded copy of the page with the given serial number, or
+// nullptr if there is none.
+ImageData* DocumentCache::FetchPage(int serial) {
+  // Samples from shards need no decoding.
+  if (!shards_.empty()) return GetShardSample(serial);
+  std::unique_ptr<ImageData> page(new ImageData);
+  {
+    // The page may be de-cached as soon as the lock is released, so copy it
+    // now.
+    std::lock_guard<std::mutex> lock(documents_mutex_);
+    if (documents_.empty()) return nullptr;
+    const ImageData* cached = GetPageBySerialLocked(serial);
+    if (cached == nullptr) return nullptr;
+    GenericVector<char> data;
+    TFile out;
+    out.OpenWrite(&data);
+    if (!cached->Serialize(&out)) return nullptr;
+    TFile in;
+    in.Open(&data[0], data.size());
+    if (!page->DeSerialize(&in)) return nullptr;
+  }
+  auto start = std::chrono::steady_clock::now();
+  page->Decode();
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  std::lock_guard<std::mutex> lock(prefetch_mutex_);
+  ++num_decoded_;
+  decode_seconds_ += elapsed.count();
+  return page.release();
+}
+
+// Starts the prefetch threads.
+void DocumentCache::StartPrefetchThreads() {
+  {
+    std::lock_guard<std::mutex> lock(prefetch_mutex_);
+    stop_prefetch_ = false;
+    ++prefetch_generation_;
+    prefetched_.clear();
+    prefetch_start_ = 0;
+    next_prefetch_ = 0;
+  }
+  for (int i = 0; i < num_prefetch_threads_; ++i) {
+    prefetch_threads_.emplace_back(&DocumentCache::PrefetchPages, this);
+  }
+}
+
+// Stops the prefetch threads and discards the pages they prepared.
+void DocumentCache::StopPrefetchThreads() {
+  {
+    std::lock_guard<std::mutex> lock(prefetch_mutex_);
+    stop_prefetch_ = true;
+  }
+  prefetch_cv_.notify_all();
+  for (auto& thread : prefetch_threads_) thread.join();
+  prefetch_threads_.clear();
+  std::lock_guard<std::mutex> lock(prefetch_mutex_);
+  ++prefetch_generation_;
+  prefetched_.clear();
+  // Wake any callers waiting for a page, which now won't come.
+  prefetch_start_ = 0;
+  next_prefetch_ = 0;
+  prefetched_cv_.notify_all();
+}
+
+// Body of the prefetch threads: prepares the next page that is not yet
+// prefetched, until num_prefetch_ahead_ pages are ready.
+void DocumentCache::PrefetchPages() {
+  std::unique_lock<std::mutex> lock(prefetch_mutex_);
+  for (;;) {
+    prefetch_cv_.wait(lock, [this] {
+      return stop_prefetch_ ||
+             next_prefetch_ < prefetch_start_ + num_prefetch_ahead_;
+    });
+    if (stop_prefetch_) return;
+    int serial = next_prefetch_++;
+    int generation = prefetch_generation_;
+    lock.unlock();
+    std::unique_ptr<ImageData> page(FetchPage(serial));
+    lock.lock();
+    if (generation == prefetch_generation_ && IsPrefetchScheduled(serial)) {
+      prefetched_[serial] = std::move(page);
+      prefetched_cv_.notify_all();
+    }
+  }
+}
+
 }  // namespace tesseract.
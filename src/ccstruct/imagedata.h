@@ -24,13 +24,18 @@
 #include "genericvector.h"      // for GenericVector, PointerVector, FileReader
 #include "strngs.h"   // for STRING
 
+#include <condition_variable>  // for std::condition_variable
+#include <map>                  // for std::map
+#include <memory>               // for std::shared_ptr, std::unique_ptr
 #include <mutex>                // for std::mutex
 #include <thread>               // for std::thread
+#include <vector>               // for std::vector
 
 struct Pix;
 
 namespace tesseract {
 
+class ImageShard;
 class TFile;
 class ScrollView;
 class TBOX;
@@ -164,6 +169,16 @@ class ImageData {
   void SetPix(Pix* pix);
   // Returns the Pix image for *this. Must be pixDestroyed after use.
   Pix* GetPix() const;
+  // Decodes the image and keeps it, so that GetPix returns a copy of it
+  // instead of decoding the image data again on every call.
+  void Decode();
+  // Keeps the given Pix as the image without encoding it, so that GetPix
+  // returns copies of it. It is encoded only if *this is serialized.
+  // Takes ownership of the pix, which may be nullptr to remove the image.
+  void SetDecodedPix(Pix* pix);
+  // Scales the boxes by the given factor, to match an image that has been
+  // scaled by it.
+  void ScaleBoxes(float factor);
   // Gets anything and everything with a non-nullptr pointer, prescaled to a
   // given target_height (if 0, then the original image height), and aligned.
   // Also returns (if not nullptr) the width and height of the scaled image.
@@ -203,6 +218,7 @@ class ImageData {
   Pix *internal_pix_;
 #endif
   GenericVector<char> image_data_;   // PNG/PNM file data.
+  std::shared_ptr<Pix> decoded_pix_;  // If not null, image_data_ decoded.
   STRING language_;                  // Language code for image.
   STRING transcription_;             // UTF-8 ground truth of image.
   GenericVector<TBOX> boxes_;        // If non-empty boxes of the image.
@@ -319,22 +335,23 @@ class DocumentData {
 };
 
 // A collection of DocumentData that knows roughly how much memory it is using.
-// Note that while it supports background read-ahead, it assumes that a single
-// thread is accessing documents, ie it is not safe for multiple threads to
-// access different documents in parallel, as one may de-cache the other's
-// content.
+// Note that while it supports background read-ahead, the pages returned by
+// GetPageBySerial belong to the cache, and may be de-cached by a later call,
+// so only a single thread should use them. CopyPageBySerial is safe to call
+// from multiple threads, as it returns copies, and can have a pool of threads
+// copy and decode the next pages ahead of the caller.
 class DocumentCache {
  public:
   explicit DocumentCache(int64_t max_memory);
   ~DocumentCache();
 
   // Deletes all existing documents from the cache.
-  void Clear() {
-    documents_.clear();
-    num_pages_per_doc_ = 0;
-  }
+  void Clear();
   // Adds all the documents in the list of filenames, counting memory.
   // The reader is used to read the files.
+  // The files may instead all be shards (see imageshard.h), which are mapped
+  // into memory, and whose samples are taken in a different random order in
+  // each epoch, whatever the cache_strategy.
   bool LoadDocuments(const GenericVector<STRING>& filenames,
                      CachingStrategy cache_strategy, FileReader reader);
 
@@ -345,13 +362,33 @@ class DocumentCache {
   DocumentData* FindDocument(const STRING& document_name) const;
 
   // Returns a page by serial number using the current cache_strategy_ to
-  // determine the mapping from serial number to page.
-  const ImageData* GetPageBySerial(int serial) {
-    if (cache_strategy_ == CS_SEQUENTIAL)
-      return GetPageSequential(serial);
-    else
-      return GetPageRoundRobin(serial);
+  // determine the mapping from serial number to page. A page from a shard is
+  // only valid until the next call.
+  const ImageData* GetPageBySerial(int serial);
+  // Returns a copy of the page with the given serial number, with its image
+  // decoded, or nullptr if there is none. The copy belongs to the caller and
+  // stays valid whatever happens to the cache. If prefetching, the page is
+  // taken from those already prepared by the prefetch threads when possible.
+  ImageData* CopyPageBySerial(int serial);
+
+  // Makes num_threads threads keep copies of the pages of the num_ahead serial
+  // numbers that follow the last one passed to CopyPageBySerial, with their
+  // images decoded. The threads run while there are documents, and stop
+  // while the cache is cleared and reloaded. 0 threads turns it off.
+  // Must not be called while other threads are using the cache.
+  void SetPrefetch(int num_threads, int num_ahead);
+  bool prefetching() const {
+    return !prefetch_threads_.empty();
   }
+  // Statistics of CopyPageBySerial: the number of pages that had been
+  // prefetched and the number that had to be copied on demand, and the
+  // number of images decoded and the total time taken to decode them.
+  int prefetch_hits() const;
+  int prefetch_misses() const;
+  int num_decoded() const;
+  double decode_seconds() const;
+  // Prints the statistics.
+  void PrintStats() const;
 
   const PointerVector<DocumentData>& documents() const {
     return documents_;
@@ -370,9 +407,29 @@ class DocumentCache {
   // uniform distribution of data. Less disk-intensive than GetPageRoundRobin.
   const ImageData* GetPageSequential(int serial);
 
+  // As GetPageBySerial, for callers that hold documents_mutex_.
+  const ImageData* GetPageBySerialLocked(int serial);
+  // Opens the shards in the list of filenames, instead of documents.
+  bool LoadShards(const GenericVector<STRING>& filenames);
+  // Returns a new copy of the sample of the shards with the given serial
+  // number.
+  ImageData* GetShardSample(int serial) const;
   // Helper counts the number of adjacent cached neighbour documents_ of index
   // looking in direction dir, ie index+dir, index+2*dir etc.
   int CountNeighbourDocs(int index, int dir);
+  // Returns a decoded copy of the page with the given serial number, or
+  // nullptr if there is none.
+  ImageData* FetchPage(int serial);
+  // Starts and stops the prefetch threads.
+  void StartPrefetchThreads();
+  void StopPrefetchThreads();
+  // Body of the prefetch threads.
+  void PrefetchPages();
+  // Returns true if the page with the given serial number is prefetched or
+  // is being prefetched. Must hold prefetch_mutex_.
+  bool IsPrefetchScheduled(int serial) const {
+    return serial >= prefetch_start_ && serial < next_prefetch_;
+  }
 
   // A group of pages that corresponds in some loose way to a document.
   PointerVector<DocumentData> documents_;
@@ -383,6 +440,43 @@ class DocumentCache {
   int num_pages_per_doc_;
   // Max memory allowed in this cache.
   int64_t max_memory_;
+  // Guards the documents, as getting a page may load and unload them.
+  std::mutex documents_mutex_;
+  // The shards, if used instead of documents_. They are read-only, so
+  // samples may be taken from them without a lock.
+  std::vector<std::unique_ptr<ImageShard>> shards_;
+  // Index in the whole of the first sample of each shard.
+  std::vector<int> shard_starts_;
+  int num_shard_samples_;
+  // The last page returned by GetPageBySerial from the shards.
+  std::unique_ptr<ImageData> shard_page_;
+
+  // Requested number of prefetch threads and of pages to keep ahead.
+  int num_prefetch_threads_;
+  int num_prefetch_ahead_;
+  // The running prefetch threads.
+  std::vector<std::thread> prefetch_threads_;
+  // Guards the members below.
+  mutable std::mutex prefetch_mutex_;
+  // Signals the prefetch threads that there is more to do or they must stop.
+  std::condition_variable prefetch_cv_;
+  // Signals callers of CopyPageBySerial that a page is ready.
+  std::condition_variable prefetched_cv_;
+  // Prefetched pages by serial number. A page may be nullptr.
+  std::map<int, std::unique_ptr<ImageData>> prefetched_;
+  // Serial numbers from prefetch_start_ up to next_prefetch_ are prefetched
+  // or being prefetched.
+  int prefetch_start_;
+  int next_prefetch_;
+  // Increments when the prefetched pages are discarded, so that those still
+  // being prepared are dropped when they are done.
+  int prefetch_generation_;
+  bool stop_prefetch_;
+  // Statistics.
+  int prefetch_hits_;
+  int prefetch_misses_;
+  int num_decoded_;
+  double decode_seconds_;
 };
 
 }  // namespace tesseract
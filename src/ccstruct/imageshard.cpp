@@ -0,0 +1,290 @@
+///////////////////////////////////////////////////////////////////////
+// File:        imageshard.cpp
+// Description: Memory-mapped file of line images ready for training.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+// Include automatically generated configuration file if running autoconf.
+#ifdef HAVE_CONFIG_H
+#include "config_auto.h"
+#endif
+
+#include "imageshard.h"
+
+#include "imagedata.h"   // for ImageData
+#include "serialis.h"    // for TFile
+#include "tprintf.h"     // for tprintf
+
+#include "allheaders.h"  // for pixCreate, pixConvertTo8, GET_DATA_BYTE, ...
+
+#include <climits>       // for INT_MAX
+#include <cstring>       // for memcmp, memcpy
+#include <memory>        // for std::unique_ptr
+
+#ifndef _WIN32
+#include <fcntl.h>       // for open
+#include <sys/mman.h>    // for mmap, munmap, posix_madvise
+#include <sys/stat.h>    // for fstat
+#include <unistd.h>      // for close
+#endif
+
+namespace tesseract {
+
+// Identifies a shard file. It is only written when the file is complete.
+static const char kShardMagic[sizeof(ShardHeader::magic)] = {
+    'T', 'E', 'S', 'S', 'H', 'A', 'R', 'D'};
+const uint32_t kShardVersion = 1;
+// The index is aligned to this, so that it can be used in place.
+const uint64_t kShardIndexAlignment = 8;
+
+ImageShard::ImageShard()
+    : data_(nullptr), size_(0), index_(nullptr), num_samples_(0),
+      mapped_(false) {}
+
+ImageShard::~ImageShard() {
+  Close();
+}
+
+// Returns true if the given file starts like a shard.
+bool ImageShard::IsShard(const char* filename) {
+  FILE* fp = fopen(filename, "rb");
+  if (fp == nullptr) return false;
+  ShardHeader header;
+  bool result = fread(&header, sizeof(header), 1, fp) == 1 &&
+                memcmp(header.magic, kShardMagic, sizeof(kShardMagic)) == 0;
+  fclose(fp);
+  return result;
+}
+
+// Maps the given shard file into memory and checks its index. Returns false
+// on error.
+bool ImageShard::Open(const char* filename) {
+  Close();
+#ifdef _WIN32
+  // Without mmap, the whole file is read instead.
+  FILE* fp = fopen(filename, "rb");
+  if (fp == nullptr) {
+    tprintf("Can't open shard %s\n", filename);
+    return false;
+  }
+  fseek(fp, 0, SEEK_END);
+  long size = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+  if (size > 0) {
+    buffer_.resize(size);
+    if (fread(&buffer_[0], 1, size, fp) != static_cast<size_t>(size))
+      buffer_.clear();
+  }
+  fclose(fp);
+  data_ = buffer_.data();
+  size_ = buffer_.size();
+#else
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    tprintf("Can't open shard %s\n", filename);
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (map != MAP_FAILED) {
+      // Samples are read in a random order, so read-ahead is wasted.
+      posix_madvise(map, st.st_size, POSIX_MADV_RANDOM);
+      data_ = static_cast<const char*>(map);
+      size_ = st.st_size;
+      mapped_ = true;
+    }
+  }
+  close(fd);
+#endif
+  ShardHeader header;
+  if (size_ < sizeof(header)) {
+    tprintf("Can't read shard %s\n", filename);
+    Close();
+    return false;
+  }
+  memcpy(&header, data_, sizeof(header));
+  if (memcmp(header.magic, kShardMagic, sizeof(kShardMagic)) != 0 ||
+      header.version != kShardVersion) {
+    tprintf("%s is not a shard of version %u\n", filename, kShardVersion);
+    Close();
+    return false;
+  }
+  uint64_t index_size = header.num_samples * sizeof(ShardIndexEntry);
+  if (header.num_samples > INT_MAX ||
+      header.index_offset % kShardIndexAlignment != 0 ||
+      header.index_offset > size_ || index_size > size_ - header.index_offset) {
+    tprintf("Bad index in shard %s\n", filename);
+    Close();
+    return false;
+  }
+  index_ = reinterpret_cast<const ShardIndexEntry*>(data_ + header.index_offset);
+  num_samples_ = header.num_samples;
+  for (int s = 0; s < num_samples_; ++s) {
+    const ShardIndexEntry& entry = index_[s];
+    uint64_t image_size = static_cast<uint64_t>(entry.width) * entry.height;
+    if (entry.width == 0 || entry.height == 0 ||
+        entry.image_offset > size_ || image_size > size_ - entry.image_offset ||
+        entry.metadata_offset > size_ ||
+        entry.metadata_size > size_ - entry.metadata_offset ||
+        entry.metadata_size > INT_MAX) {
+      tprintf("Bad index entry %d in shard %s\n", s, filename);
+      Close();
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns a new ImageData for the sample with the given index, with its
+// image ready to use, or nullptr on error.
+ImageData* ImageShard::GetSample(int index) const {
+  if (index < 0 || index >= num_samples_) return nullptr;
+  const ShardIndexEntry& entry = index_[index];
+  std::unique_ptr<ImageData> sample(new ImageData);
+  TFile fp;
+  fp.Open(data_ + entry.metadata_offset, entry.metadata_size);
+  if (!sample->DeSerialize(&fp)) return nullptr;
+  Pix* pix = pixCreate(entry.width, entry.height, 8);
+  if (pix == nullptr) return nullptr;
+  l_uint32* data = pixGetData(pix);
+  int wpl = pixGetWpl(pix);
+  const auto* src =
+      reinterpret_cast<const uint8_t*>(data_ + entry.image_offset);
+  for (uint32_t y = 0; y < entry.height; ++y) {
+    l_uint32* line = data + y * wpl;
+    for (uint32_t x = 0; x < entry.width; ++x) {
+      SET_DATA_BYTE(line, x, src[x]);
+    }
+    src += entry.width;
+  }
+  sample->SetDecodedPix(pix);
+  return sample.release();
+}
+
+// Unmaps the file.
+void ImageShard::Close() {
+#ifndef _WIN32
+  if (mapped_) munmap(const_cast<char*>(data_), size_);
+#endif
+  buffer_.clear();
+  data_ = nullptr;
+  size_ = 0;
+  index_ = nullptr;
+  num_samples_ = 0;
+  mapped_ = false;
+}
+
+ImageShardWriter::ImageShardWriter() : fp_(nullptr), offset_(0) {}
+
+ImageShardWriter::~ImageShardWriter() {
+  // An unfinished file is left without its magic, so it won't be read.
+  if (fp_ != nullptr) fclose(fp_);
+}
+
+// Creates the given file. Returns false on error.
+bool ImageShardWriter::Open(const char* filename) {
+  if (fp_ != nullptr) fclose(fp_);
+  index_.clear();
+  offset_ = 0;
+  fp_ = fopen(filename, "wb");
+  if (fp_ == nullptr) {
+    tprintf("Can't create shard %s\n", filename);
+    return false;
+  }
+  // The header is written for real by Close.
+  ShardHeader header = {};
+  return Write(&header, sizeof(header));
+}
+
+// Adds the given sample, with its image scaled to target_height, or if 0 to
+// its own height limited to max_height, and its boxes scaled to match.
+bool ImageShardWriter::AddSample(const ImageData& sample, int target_height,
+                                 int max_height) {
+  if (fp_ == nullptr) return false;
+  float scale_factor;
+  Pix* scaled_pix = sample.PreScale(target_height, max_height, &scale_factor,
+                                    nullptr, nullptr, nullptr);
+  if (scaled_pix == nullptr) return false;
+  Pix* pix = pixConvertTo8(scaled_pix, false);
+  pixDestroy(&scaled_pix);
+  if (pix == nullptr) return false;
+  ShardIndexEntry entry = {};
+  entry.width = pixGetWidth(pix);
+  entry.height = pixGetHeight(pix);
+  entry.image_offset = offset_;
+  l_uint32* data = pixGetData(pix);
+  int wpl = pixGetWpl(pix);
+  std::vector<uint8_t> row(entry.width);
+  bool ok = true;
+  for (uint32_t y = 0; y < entry.height && ok; ++y) {
+    l_uint32* line = data + y * wpl;
+    for (uint32_t x = 0; x < entry.width; ++x) {
+      row[x] = GET_DATA_BYTE(line, x);
+    }
+    ok = Write(row.data(), row.size());
+  }
+  pixDestroy(&pix);
+  if (!ok) return false;
+  // The rest of the sample is stored as a copy without the image, with its
+  // boxes scaled to fit the stored image.
+  std::vector<char> data_copy;
+  TFile out;
+  out.OpenWrite(&data_copy);
+  if (!sample.Serialize(&out)) return false;
+  ImageData metadata;
+  TFile in;
+  in.Open(&data_copy[0], data_copy.size());
+  if (!metadata.DeSerialize(&in)) return false;
+  metadata.ScaleBoxes(scale_factor);
+  metadata.SetDecodedPix(nullptr);
+  std::vector<char> metadata_data;
+  TFile metadata_out;
+  metadata_out.OpenWrite(&metadata_data);
+  if (!metadata.Serialize(&metadata_out)) return false;
+  entry.metadata_offset = offset_;
+  entry.metadata_size = metadata_data.size();
+  if (!Write(metadata_data.data(), metadata_data.size())) return false;
+  index_.push_back(entry);
+  return true;
+}
+
+// Writes the index and closes the file. Returns false on error.
+bool ImageShardWriter::Close() {
+  if (fp_ == nullptr) return false;
+  static const char kPadding[kShardIndexAlignment] = {};
+  bool ok = Write(kPadding, (kShardIndexAlignment -
+                             offset_ % kShardIndexAlignment) %
+                                kShardIndexAlignment);
+  ShardHeader header = {};
+  memcpy(header.magic, kShardMagic, sizeof(kShardMagic));
+  header.version = kShardVersion;
+  header.num_samples = index_.size();
+  header.index_offset = offset_;
+  ok = ok && Write(index_.data(), index_.size() * sizeof(index_[0]));
+  ok = ok && fseek(fp_, 0, SEEK_SET) == 0 &&
+       fwrite(&header, sizeof(header), 1, fp_) == 1;
+  ok = fclose(fp_) == 0 && ok;
+  fp_ = nullptr;
+  return ok;
+}
+
+// Writes size bytes to the file, counting up offset_.
+bool ImageShardWriter::Write(const void* data, size_t size) {
+  if (size == 0) return true;
+  if (fwrite(data, 1, size, fp_) != size) return false;
+  offset_ += size;
+  return true;
+}
+
+}  // namespace tesseract.
@@ -0,0 +1,126 @@
+///////////////////////////////////////////////////////////////////////
+// File:        imageshard.h
+// Description: Memory-mapped file of line images ready for training.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_CCSTRUCT_IMAGESHARD_H_
+#define TESSERACT_CCSTRUCT_IMAGESHARD_H_
+
+#include <cstdint>  // for uint32_t, uint64_t
+#include <cstdio>   // for FILE
+#include <vector>   // for std::vector
+
+namespace tesseract {
+
+class ImageData;
+
+// A shard is an alternative to the lstmf file for training data. Instead of
+// PNG-encoded images, it holds the line images already scaled to the height
+// of the network and converted to greyscale, as raw 8-bit pixels, with a
+// fixed-size index at the end, so that any sample can be fetched directly
+// from the memory-mapped file without reading or decoding the rest.
+// The file layout, in native byte order, is:
+//   ShardHeader
+//   for each sample: height rows of width pixels, followed by the ImageData
+//     of the sample serialized without its image.
+//   num_samples ShardIndexEntry, at index_offset.
+// WARNING: Will not work across different endian machines.
+struct ShardHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t num_samples;
+  uint64_t index_offset;
+};
+
+struct ShardIndexEntry {
+  uint64_t image_offset;
+  uint64_t metadata_offset;
+  uint32_t width;
+  uint32_t height;
+  uint32_t metadata_size;
+  uint32_t reserved;
+};
+
+// Read-only access to the samples of a shard file.
+class ImageShard {
+ public:
+  ImageShard();
+  ~ImageShard();
+  ImageShard(const ImageShard&) = delete;
+  ImageShard& operator=(const ImageShard&) = delete;
+
+  // Returns true if the given file starts like a shard.
+  static bool IsShard(const char* filename);
+
+  // Maps the given shard file into memory and checks its index. Returns false
+  // on error.
+  bool Open(const char* filename);
+
+  int NumSamples() const {
+    return num_samples_;
+  }
+  // Returns a new ImageData for the sample with the given index, with its
+  // image ready to use, or nullptr on error. The caller owns the result.
+  // Safe to call from multiple threads.
+  ImageData* GetSample(int index) const;
+
+ private:
+  // Unmaps the file.
+  void Close();
+
+  // The contents of the file.
+  const char* data_;
+  uint64_t size_;
+  // The index, within data_.
+  const ShardIndexEntry* index_;
+  int num_samples_;
+  // True if data_ is mapped, false if it was read into buffer_.
+  bool mapped_;
+  std::vector<char> buffer_;
+};
+
+// Writes a shard file, one sample at a time.
+class ImageShardWriter {
+ public:
+  ImageShardWriter();
+  ~ImageShardWriter();
+  ImageShardWriter(const ImageShardWriter&) = delete;
+  ImageShardWriter& operator=(const ImageShardWriter&) = delete;
+
+  // Creates the given file. Returns false on error.
+  bool Open(const char* filename);
+  // Adds the given sample, with its image scaled to target_height, or if 0 to
+  // its own height limited to max_height, as the network input does, and its
+  // boxes scaled to match. Returns false on error.
+  bool AddSample(const ImageData& sample, int target_height, int max_height);
+  // Writes the index and closes the file. Returns false on error.
+  bool Close();
+
+  int num_samples() const {
+    return index_.size();
+  }
+
+ private:
+  // Writes size bytes to the file, counting up offset_.
+  bool Write(const void* data, size_t size);
+
+  FILE* fp_;
+  // Number of bytes written so far.
+  uint64_t offset_;
+  std::vector<ShardIndexEntry> index_;
+};
+
+}  // namespace tesseract.
+
+#endif  // TESSERACT_CCSTRUCT_IMAGESHARD_H_
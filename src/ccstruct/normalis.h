@@ -269,6 +269,9 @@ class DENORM {
   float y_scale() const {
     return y_scale_;
   }
+  const FCOORD* rotation() const {
+    return rotation_;
+  }
   const BLOCK* block() const {
     return block_;
   }
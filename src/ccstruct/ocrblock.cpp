@@ -84,6 +84,20 @@ void BLOCK::rotate(const FCOORD& rotation) {
   pdblk.box = *pdblk.poly_block()->bounding_box();
 }
 
+// Scales the polygon up by the given factor, subtracts y_shift from its
+// y coords, so a negative y_shift moves it up, pads it by padding and clips
+// it to limits, then recomputes the bounding_box and median_size. Does
+// nothing to any contained rows/words/blobs etc.
+void BLOCK::scale_polygon(int factor, int y_shift, int padding,
+                          const TBOX& limits) {
+  POLY_BLOCK* poly = pdblk.poly_block();
+  poly->scale(factor);
+  poly->move(ICOORD(0, -y_shift));
+  poly->pad(padding, limits);
+  pdblk.box = *poly->bounding_box();
+  median_size_ = ICOORD(median_size_.x() * factor, median_size_.y() * factor);
+}
+
 // Returns the bounding box including the desired combination of upper and
 // lower noise/diacritic elements.
 TBOX BLOCK::restricted_bounding_box(bool upper_dots, bool lower_dots) const {
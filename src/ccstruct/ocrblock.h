@@ -172,6 +172,13 @@ class BLOCK : public ELIST_LINK
 
   void rotate(const FCOORD& rotation);
 
+  // Scales the polygon up by the given factor, subtracts y_shift from its
+  // y coords, so a negative y_shift moves it up, pads it by padding and clips
+  // it to limits, then recomputes the bounding_box and median_size. Does
+  // nothing to any contained rows/words/blobs etc.
+  void scale_polygon(int factor, int y_shift, int padding,
+                     const TBOX& limits);
+
   /// decreasing y order
   void sort_rows();
 
@@ -24,6 +24,7 @@
 #include "elst.h"              // for ELIST_ITERATOR, ELIST_LINK, ELISTIZEH
 #include "matrix.h"            // for MATRIX
 #include "normalis.h"          // for DENORM
+#include "pagearena.h"         // for PageArena, PageArenaObject
 #include "ratngs.h"            // for WERD_CHOICE, BLOB_CHOICE (ptr only)
 #include "rect.h"              // for TBOX
 #include "rejctmap.h"          // for REJMAP
@@ -90,12 +91,16 @@ class PAGE_RES {                 // page result
   // caused misadaption could be marked. However, since words could be
   // deleted/split/merged, the log is stored on the PAGE_RES level.
   GenericVector<STRING> misadaption_log;
+  // The arena that the results of the page were allocated from, or nullptr.
+  // The PAGE_RES owns it, and releases it when it is deleted.
+  PageArena* arena;
 
   inline void Init() {
     char_count = 0;
     rej_count = 0;
     rejected = false;
     prev_word_best_choice = nullptr;
+    arena = nullptr;
     blame_reasons.init_to_size(IRR_NUM_REASONS, 0);
   }
 
@@ -105,14 +110,16 @@ class PAGE_RES {                 // page result
            BLOCK_LIST *block_list,   // real blocks
            WERD_CHOICE **prev_word_best_choice_ptr);
 
-  ~PAGE_RES () = default;
+  ~PAGE_RES () {
+    if (arena != nullptr) arena->Release();
+  }
 };
 
 /*************************************************************************
  * BLOCK_RES - Block results
  *************************************************************************/
 
-class BLOCK_RES:public ELIST_LINK {
+class BLOCK_RES:public ELIST_LINK, public PageArenaObject {
  public:
   BLOCK * block;               // real block
   int32_t char_count;            // chars in block
@@ -136,7 +143,7 @@ class BLOCK_RES:public ELIST_LINK {
  * ROW_RES - Row results
  *************************************************************************/
 
-class ROW_RES:public ELIST_LINK {
+class ROW_RES:public ELIST_LINK, public PageArenaObject {
  public:
   ROW * row;                   // real row
   int32_t char_count;            // chars in block
@@ -164,7 +171,7 @@ enum CRUNCH_MODE
 
 // WERD_RES is a collection of publicly accessible members that gathers
 // information about a word result.
-class WERD_RES : public ELIST_LINK {
+class WERD_RES : public ELIST_LINK, public PageArenaObject {
  public:
   // Which word is which?
   // There are 3 coordinate spaces in use here: a possibly rotated pixel space,
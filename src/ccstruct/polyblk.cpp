@@ -24,11 +24,14 @@
 
 #include "elst.h"
 
+#include <tesseract/helpers.h>  // for ClipToRange
+
 #include <cctype>
 #include <cinttypes>  // PRId32
 #include <cmath>
 #include <cstdio>
 #include <memory>     // std::unique_ptr
+#include <vector>     // std::vector
 
 namespace tesseract {
 
@@ -244,6 +247,73 @@ void POLY_BLOCK::move(ICOORD shift) {
 }
 
 
+/**
+ * POLY_BLOCK::scale
+ *
+ * Scale the POLY_BLOCK about the origin.
+ * @param factor multiplier for all coordinates
+ */
+
+void POLY_BLOCK::scale(int factor) {
+  ICOORDELT *pt;                 //current point
+  ICOORDELT_IT pts = &vertices;  //iterator
+
+  do {
+    pt = pts.data ();
+    pt->set_x(static_cast<int16_t>(pt->x() * factor));
+    pt->set_y(static_cast<int16_t>(pt->y() * factor));
+    pts.forward ();
+  }
+  while (!pts.at_first ());
+  compute_bb();
+}
+
+
+/**
+ * POLY_BLOCK::pad
+ *
+ * Move every edge of the POLY_BLOCK outwards.
+ * @param padding distance to move each edge in x and/or y
+ * @param limits box to keep the vertices inside
+ */
+
+void POLY_BLOCK::pad(int padding, const TBOX& limits) {
+  std::vector<ICOORD> pts;
+  ICOORDELT_IT it = &vertices;
+  for (it.mark_cycle_pt(); !it.cycled_list(); it.forward())
+    pts.push_back(*it.data());
+  int num_pts = pts.size();
+  if (num_pts < 3) return;
+  // Twice the signed area, positive for anticlockwise vertices.
+  int64_t area = 0;
+  for (int i = 0; i < num_pts; ++i) {
+    const ICOORD& next = pts[(i + 1) % num_pts];
+    area += static_cast<int64_t>(pts[i].x()) * next.y() -
+            static_cast<int64_t>(next.x()) * pts[i].y();
+  }
+  int orientation = area >= 0 ? 1 : -1;
+  // Returns the signs of the outward normal of the edge from a to b.
+  auto outward = [orientation](const ICOORD& a, const ICOORD& b) {
+    int dx = b.x() - a.x();
+    int dy = b.y() - a.y();
+    return ICOORD((dy > 0) - (dy < 0), (dx < 0) - (dx > 0)) * orientation;
+  };
+  // Each vertex moves to the intersection of its moved edges, which, for
+  // axis-aligned edges, is along the sum of their outward normals.
+  it.move_to_first();
+  for (int i = 0; i < num_pts; ++i, it.forward()) {
+    const ICOORD& prev = pts[(i + num_pts - 1) % num_pts];
+    const ICOORD& next = pts[(i + 1) % num_pts];
+    ICOORD normal = outward(prev, pts[i]) + outward(pts[i], next);
+    int x = pts[i].x() + ((normal.x() > 0) - (normal.x() < 0)) * padding;
+    int y = pts[i].y() + ((normal.y() > 0) - (normal.y() < 0)) * padding;
+    it.data()->set_x(ClipToRange<int>(x, limits.left(), limits.right()));
+    it.data()->set_y(ClipToRange<int>(y, limits.bottom(), limits.top()));
+  }
+  compute_bb();
+}
+
+
 #ifndef GRAPHICS_DISABLED
 void POLY_BLOCK::plot(ScrollView* window, int32_t num) {
   ICOORDELT_IT v = &vertices;
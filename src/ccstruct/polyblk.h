@@ -60,6 +60,10 @@ class DLLSYM POLY_BLOCK {
   void reflect_in_y_axis();
   // Move by adding shift to all coordinates.
   void move(ICOORD shift);
+  // Multiply all coordinates by the given integer factor.
+  void scale(int factor);
+  // Move every edge outwards by padding, keeping the vertices in limits.
+  void pad(int padding, const TBOX& limits);
 
   void plot(ScrollView* window, int32_t num);
 
@@ -29,6 +29,7 @@
 #include "fontinfo.h"
 #endif  // undef DISABLED_LEGACY_ENGINE
 #include "matrix.h"
+#include "pagearena.h"
 #include "unicharset.h"
 #include "werd.h"
 
@@ -54,7 +55,7 @@ enum BlobChoiceClassifier {
   BCC_FAKE,                // From some other process.
 };
 
-class BLOB_CHOICE: public ELIST_LINK
+class BLOB_CHOICE: public ELIST_LINK, public PageArenaObject
 {
   public:
     BLOB_CHOICE() {
@@ -163,6 +164,12 @@ class BLOB_CHOICE: public ELIST_LINK
     void set_classifier(BlobChoiceClassifier classifier) {
       classifier_ = classifier;
     }
+    void set_xheight_range(float min_xheight, float max_xheight,
+                           float yshift) {
+      min_xheight_ = min_xheight;
+      max_xheight_ = max_xheight;
+      yshift_ = yshift;
+    }
     static BLOB_CHOICE* deep_copy(const BLOB_CHOICE* src) {
       auto* choice = new BLOB_CHOICE;
       *choice = *src;
@@ -263,7 +270,7 @@ enum ScriptPos {
 
 const char *ScriptPosToString(ScriptPos script_pos);
 
-class WERD_CHOICE : public ELIST_LINK {
+class WERD_CHOICE : public ELIST_LINK, public PageArenaObject {
  public:
   static const float kBadRating;
   static const char *permuter_name(uint8_t permuter);
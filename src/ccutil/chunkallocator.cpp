@@ -0,0 +1,111 @@
+///////////////////////////////////////////////////////////////////////
+// File:        chunkallocator.cpp
+// Description: Memory for many small objects, carved from large chunks.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#include "chunkallocator.h"
+
+#include <new>  // for operator new
+
+namespace tesseract {
+
+// Blocks are a multiple of this size, which keeps them aligned.
+const size_t kGranularity = alignof(std::max_align_t);
+
+ChunkAllocator::ChunkAllocator(size_t chunk_size, size_t max_block)
+    : chunk_size_(chunk_size / kGranularity * kGranularity),
+      max_block_(max_block < chunk_size_ ? max_block : chunk_size_),
+      next_(nullptr),
+      remaining_(0),
+      num_allocated_(0) {}
+
+ChunkAllocator::~ChunkAllocator() {
+  Reset();
+}
+
+void* ChunkAllocator::Allocate(size_t size) {
+  size_t size_class = size == 0 ? 1 : (size + kGranularity - 1) / kGranularity;
+  size_t block_size = size_class * kGranularity;
+  if (block_size > max_block_) return nullptr;
+  ++num_allocated_;
+  if (size_class < free_lists_.size() && free_lists_[size_class] != nullptr) {
+    FreeBlock* block = free_lists_[size_class];
+    free_lists_[size_class] = block->next;
+    return block;
+  }
+  if (block_size > remaining_) {
+    // The rest of the last chunk becomes a free block of its own size.
+    if (remaining_ > 0) PushFree(next_, remaining_ / kGranularity);
+    chunks_.push_back(::operator new(chunk_size_));
+    next_ = static_cast<char*>(chunks_.back());
+    remaining_ = chunk_size_;
+  }
+  void* block = next_;
+  next_ += block_size;
+  remaining_ -= block_size;
+  return block;
+}
+
+void ChunkAllocator::Free(void* block, size_t size) {
+  if (block == nullptr) return;
+  --num_allocated_;
+  PushFree(block, size == 0 ? 1 : (size + kGranularity - 1) / kGranularity);
+}
+
+void ChunkAllocator::PushFree(void* block, size_t size_class) {
+  if (size_class >= free_lists_.size())
+    free_lists_.resize(size_class + 1, nullptr);
+  auto* free_block = static_cast<FreeBlock*>(block);
+  free_block->next = free_lists_[size_class];
+  free_lists_[size_class] = free_block;
+}
+
+void ChunkAllocator::Reset() {
+  for (void* chunk : chunks_) ::operator delete(chunk);
+  chunks_.clear();
+  free_lists_.clear();
+  next_ = nullptr;
+  remaining_ = 0;
+  num_allocated_ = 0;
+}
+
+void* ChunkAllocator::New(size_t size, ChunkAllocator* allocator) {
+  size_t total = sizeof(Header) + size;
+  Header* header = nullptr;
+  if (allocator != nullptr)
+    header = static_cast<Header*>(allocator->Allocate(total));
+  if (header == nullptr) {
+    allocator = nullptr;
+    header = static_cast<Header*>(::operator new(total));
+  }
+  header->allocator = allocator;
+  header->size = total;
+  return header + 1;
+}
+
+ChunkAllocator* ChunkAllocator::Owner(const void* p) {
+  return (static_cast<const Header*>(p) - 1)->allocator;
+}
+
+void ChunkAllocator::Delete(void* p) {
+  if (p == nullptr) return;
+  Header* header = static_cast<Header*>(p) - 1;
+  if (header->allocator == nullptr) {
+    ::operator delete(header);
+  } else {
+    header->allocator->Free(header, header->size);
+  }
+}
+
+}  // namespace tesseract.
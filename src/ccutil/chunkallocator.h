@@ -0,0 +1,95 @@
+///////////////////////////////////////////////////////////////////////
+// File:        chunkallocator.h
+// Description: Memory for many small objects, carved from large chunks.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_CCUTIL_CHUNKALLOCATOR_H_
+#define TESSERACT_CCUTIL_CHUNKALLOCATOR_H_
+
+#include <cstddef>  // for size_t, max_align_t
+#include <vector>   // for std::vector
+
+namespace tesseract {
+
+// Hands out blocks of memory for objects that are made and deleted in large
+// numbers. Blocks are carved out of large chunks, and their size is rounded
+// up to a multiple of the alignment of any type, which makes a size class.
+// A block that is given back goes on a free list for its size class, to be
+// handed out again. Reset, or the destructor, gives all the chunks back to
+// the heap in one go, without any need to give back the blocks.
+// A ChunkAllocator must only be used by one thread at a time.
+class ChunkAllocator {
+ public:
+  // Blocks of up to max_block bytes come from chunks of chunk_size bytes.
+  ChunkAllocator(size_t chunk_size, size_t max_block);
+  ~ChunkAllocator();
+  ChunkAllocator(const ChunkAllocator&) = delete;
+  ChunkAllocator& operator=(const ChunkAllocator&) = delete;
+
+  // Returns a block of at least size bytes, aligned for any type, or nullptr
+  // if size is more than the biggest block.
+  void* Allocate(size_t size);
+  // Gives back a block from Allocate, with the size that it was asked for.
+  void Free(void* block, size_t size);
+  // Gives all the chunks back to the heap. Every block handed out so far is
+  // invalid afterwards.
+  void Reset();
+
+  // Number of blocks handed out and not given back.
+  int num_allocated() const {
+    return num_allocated_;
+  }
+  // Number of chunks that the blocks come from.
+  int num_chunks() const {
+    return chunks_.size();
+  }
+
+  // For class operator new and delete. Returns memory for an object of the
+  // given size from allocator, or from the heap if allocator is nullptr or
+  // the object is too big for it. A header in front of the object records
+  // where it came from.
+  static void* New(size_t size, ChunkAllocator* allocator);
+  // Returns the allocator of an object made with New, nullptr for the heap.
+  static ChunkAllocator* Owner(const void* p);
+  // Gives back the memory of an object made with New to where it came from.
+  static void Delete(void* p);
+
+ private:
+  // Precedes each object made with New.
+  struct alignas(std::max_align_t) Header {
+    ChunkAllocator* allocator;  // nullptr for heap objects.
+    size_t size;                // Including the header.
+  };
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  // Puts a block of the given size class on its free list.
+  void PushFree(void* block, size_t size_class);
+
+  size_t chunk_size_;
+  size_t max_block_;
+  // Chunks of memory, given back by Reset.
+  std::vector<void*> chunks_;
+  // Unused space in the last chunk.
+  char* next_;
+  size_t remaining_;
+  // Free lists of blocks indexed by size class.
+  std::vector<FreeBlock*> free_lists_;
+  int num_allocated_;
+};
+
+}  // namespace tesseract.
+
+#endif  // TESSERACT_CCUTIL_CHUNKALLOCATOR_H_
@@ -0,0 +1,70 @@
+///////////////////////////////////////////////////////////////////////
+// File:        pagearena.cpp
+// Description: Memory for the recognition results of one page.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#include "pagearena.h"
+
+namespace tesseract {
+
+// Size of the chunks of a PageArena.
+const size_t kPageArenaChunkSize = 256 * 1024;
+// Biggest object that is taken from a chunk.
+const size_t kMaxPageArenaBlock = 4096;
+
+thread_local PageArena* PageArena::current_ = nullptr;
+
+PageArena::PageArena()
+    : ChunkAllocator(kPageArenaChunkSize, kMaxPageArenaBlock), refs_(1) {}
+
+void PageArena::Release() {
+  Unref();
+}
+
+void PageArena::Unref() {
+  if (--refs_ == 0) delete this;
+}
+
+void* PageArena::Allocate(size_t size) {
+  PageArena* arena = current_;
+  void* p = ChunkAllocator::New(size, arena);
+  if (arena != nullptr && ChunkAllocator::Owner(p) == arena) ++arena->refs_;
+  return p;
+}
+
+void PageArena::Free(void* p) {
+  if (p == nullptr) return;
+  auto* arena = static_cast<PageArena*>(ChunkAllocator::Owner(p));
+  if (arena == nullptr) {
+    ChunkAllocator::Delete(p);
+    return;
+  }
+  // The free lists of an arena are only used on the thread of its Scope.
+  // The blocks of objects deleted elsewhere go with the whole arena.
+  if (arena == current_) ChunkAllocator::Delete(p);
+  arena->Unref();
+}
+
+PageArena::Scope::Scope(PageArena* arena)
+    : arena_(arena), previous_(current_) {
+  if (arena_ != nullptr) ++arena_->refs_;
+  current_ = arena_;
+}
+
+PageArena::Scope::~Scope() {
+  current_ = previous_;
+  if (arena_ != nullptr) arena_->Unref();
+}
+
+}  // namespace tesseract.
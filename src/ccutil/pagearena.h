@@ -0,0 +1,121 @@
+///////////////////////////////////////////////////////////////////////
+// File:        pagearena.h
+// Description: Memory for the recognition results of one page.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_CCUTIL_PAGEARENA_H_
+#define TESSERACT_CCUTIL_PAGEARENA_H_
+
+#include <atomic>   // for std::atomic
+#include <cstddef>  // for size_t
+
+#include "chunkallocator.h"  // for ChunkAllocator
+
+namespace tesseract {
+
+// Memory for the many small objects that make up the results of a page:
+// the BLOCK_RES, ROW_RES and WERD_RES of the PAGE_RES, their WERD_CHOICEs
+// and BLOB_CHOICEs, and the TWERD/TBLOB/TESSLINE/EDGEPT polygonal outlines.
+// While a Scope is open on a thread, those objects that the thread makes
+// are carved out of the chunks of the arena instead of being allocated one
+// by one. When such an object is deleted on the same thread in the same
+// Scope, as the chopper's temporary blobs and choices are, its block is
+// reused. When it is deleted anywhere else, as all the results are when the
+// page is cleared, its block is left alone for the arena to give back with
+// all the others.
+// Each object still owns itself. The arena counts its owner, its open Scopes
+// and the objects made in it, and gives its chunks back to the heap when the
+// last of them has gone. So a result that an API user takes out of the page
+// stays valid after the PAGE_RES is deleted, and keeps the arena until it
+// is deleted itself.
+class PageArena : private ChunkAllocator {
+ public:
+  // The new arena is owned by the caller, who must Release it.
+  PageArena();
+  PageArena(const PageArena&) = delete;
+  PageArena& operator=(const PageArena&) = delete;
+
+  // Gives up the reference of the owner. The arena is deleted now, or when
+  // the last object made in it is deleted.
+  void Release();
+
+  // Returns memory for an object of the given size from the arena of the
+  // open Scope of this thread, or from the heap if there is none or the
+  // object is too big for it.
+  static void* Allocate(size_t size);
+  // Gives back memory obtained from Allocate to the heap, or to the arena
+  // that it came from.
+  static void Free(void* p);
+
+  // Number of references to the arena, counting the owner, the open Scopes
+  // and the objects, for testing.
+  int num_refs() const {
+    return refs_;
+  }
+  // Number of objects whose blocks have not been given back for reuse, for
+  // testing.
+  int num_allocated() const {
+    return ChunkAllocator::num_allocated();
+  }
+  // Number of chunks that the objects come from, for testing.
+  int num_chunks() const {
+    return ChunkAllocator::num_chunks();
+  }
+
+  // Makes the objects allocated on this thread come from arena, which may
+  // be nullptr to use the heap, until the Scope is destroyed. Scopes nest.
+  // An arena must not have Scopes open on more than one thread at a time.
+  class Scope {
+   public:
+    explicit Scope(PageArena* arena);
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    PageArena* arena_;
+    PageArena* previous_;
+  };
+
+ private:
+  ~PageArena() = default;
+  // Drops one reference, deleting the arena if it was the last.
+  void Unref();
+
+  // The arena of the innermost open Scope of the thread.
+  static thread_local PageArena* current_;
+
+  // One for the owner, one for each open Scope and one for each object made
+  // in the arena and not yet deleted. The objects may be deleted on any
+  // thread.
+  std::atomic<int> refs_;
+};
+
+// Base class for the objects that may live in a PageArena. They are made
+// with plain new and deleted with delete, including by the lists that own
+// them. Whether they come from an arena is decided at run time, by the
+// tessedit_page_arena parameter, so they always carry the header of
+// ChunkAllocator::New.
+struct PageArenaObject {
+  static void* operator new(size_t size) {
+    return PageArena::Allocate(size);
+  }
+  static void operator delete(void* p) {
+    PageArena::Free(p);
+  }
+};
+
+}  // namespace tesseract.
+
+#endif  // TESSERACT_CCUTIL_PAGEARENA_H_
@@ -23,6 +23,8 @@
 
 #include <cassert>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 namespace tesseract {
 
@@ -184,6 +186,84 @@ void free_adapted_templates(ADAPT_TEMPLATES templates) {
   }
 }
 
+/*----------------------------------------------------------------------------*/
+/**
+ * This routine makes a deep copy of an adapted class.
+ *
+ * @param Class  adapted class to copy
+ * @return Ptr to the new adapted class.
+ *
+ * @note Globals: none
+ */
+static ADAPT_CLASS CopyAdaptedClass(const ADAPT_CLASS_STRUCT* Class) {
+  ADAPT_CLASS Copy = NewAdaptedClass();
+  Copy->NumPermConfigs = Class->NumPermConfigs;
+  Copy->MaxNumTimesSeen = Class->MaxNumTimesSeen;
+  copy_all_bits(Class->PermProtos, Copy->PermProtos,
+                WordsInVectorOfSize(MAX_NUM_PROTOS));
+  copy_all_bits(Class->PermConfigs, Copy->PermConfigs,
+                WordsInVectorOfSize(MAX_NUM_CONFIGS));
+
+  LIST TempProtos = Class->TempProtos;
+  iterate(TempProtos) {
+    void* proto = first_node(TempProtos);
+    TEMP_PROTO TempProto = NewTempProto();
+    *TempProto = *static_cast<TEMP_PROTO>(proto);
+    Copy->TempProtos = push_last(Copy->TempProtos, TempProto);
+  }
+
+  for (int i = 0; i < MAX_NUM_CONFIGS; i++) {
+    if (ConfigIsPermanent(Class, i)) {
+      PERM_CONFIG Config = PermConfigFor(Class, i);
+      if (Config == nullptr) continue;
+      int NumAmbigs = 0;
+      while (Config->Ambigs[NumAmbigs] >= 0) ++NumAmbigs;
+      auto NewConfig =
+          static_cast<PERM_CONFIG>(malloc(sizeof(PERM_CONFIG_STRUCT)));
+      NewConfig->Ambigs = new UNICHAR_ID[NumAmbigs + 1];
+      memcpy(NewConfig->Ambigs, Config->Ambigs,
+             (NumAmbigs + 1) * sizeof(UNICHAR_ID));
+      NewConfig->FontinfoId = Config->FontinfoId;
+      PermConfigFor(Copy, i) = NewConfig;
+    } else {
+      TEMP_CONFIG Config = TempConfigFor(Class, i);
+      if (Config == nullptr) continue;
+      TEMP_CONFIG NewConfig =
+          NewTempConfig(Config->MaxProtoId, Config->FontinfoId);
+      NewConfig->NumTimesSeen = Config->NumTimesSeen;
+      copy_all_bits(Config->Protos, NewConfig->Protos,
+                    Config->ProtoVectorSize);
+      TempConfigFor(Copy, i) = NewConfig;
+    }
+  }
+  return Copy;
+}                                /* CopyAdaptedClass */
+
+
+/*----------------------------------------------------------------------------*/
+/**
+ * This routine makes a deep copy of a set of adapted templates, which
+ * shares nothing with the original.
+ *
+ * @param Templates  adapted templates to copy
+ * @return Ptr to the new adapted templates.
+ *
+ * @note Globals: none
+ */
+ADAPT_TEMPLATES CopyAdaptedTemplates(const ADAPT_TEMPLATES_STRUCT* Templates) {
+  auto Copy =
+      static_cast<ADAPT_TEMPLATES>(Emalloc(sizeof(ADAPT_TEMPLATES_STRUCT)));
+  Copy->Templates = CopyIntTemplates(Templates->Templates);
+  Copy->NumNonEmptyClasses = Templates->NumNonEmptyClasses;
+  Copy->NumPermClasses = Templates->NumPermClasses;
+  for (int i = 0; i < MAX_NUM_CLASSES; i++) {
+    Copy->Class[i] = Templates->Class[i] == nullptr
+                         ? nullptr
+                         : CopyAdaptedClass(Templates->Class[i]);
+  }
+  return Copy;
+}                                /* CopyAdaptedTemplates */
+
 
 /*---------------------------------------------------------------------------*/
 /**
@@ -107,6 +107,8 @@ void free_adapted_class(ADAPT_CLASS adapt_class);
 
 void free_adapted_templates(ADAPT_TEMPLATES templates);
 
+ADAPT_TEMPLATES CopyAdaptedTemplates(const ADAPT_TEMPLATES_STRUCT* Templates);
+
 TEMP_CONFIG NewTempConfig(int MaxProtoId, int FontinfoId);
 
 TEMP_PROTO NewTempProto();
@@ -25,6 +25,7 @@
 #include "adaptive.h"           // for ADAPT_CLASS, free_adapted_templates
 #include "ambigs.h"             // for UnicharIdVector, UnicharAmbigs
 #include "bitvec.h"             // for FreeBitVector, NewBitVector, BIT_VECTOR
+#include "blobfeatures.h"       // for BlobFeatureBuffer, PicoFeature
 #include "blobs.h"              // for TBLOB, TWERD
 #include "classify.h"           // for Classify, CST_FRAGMENT, CST_WHOLE
 #include "dict.h"               // for Dict
@@ -51,6 +52,7 @@
 #include "scrollview.h"         // for ScrollView, ScrollView::BROWN, Scroll...
 #include "seam.h"               // for SEAM
 #include "shapeclassifier.h"    // for ShapeClassifier
+#include "sharedadapt.h"        // for SharedAdaptedTemplates
 #include "shapetable.h"         // for UnicharRating, ShapeTable, Shape, Uni...
 #include "tessclassifier.h"     // for TessClassifier
 #include "tessdatamanager.h"    // for TessdataManager, TESSDATA_INTTEMP
@@ -72,6 +74,7 @@
 #include <cstdio>               // for fflush, fclose, fopen, stdout, FILE
 #include <cstdlib>              // for malloc
 #include <cstring>              // for strstr, memset, strcmp
+#include <utility>              // for std::swap
 
 namespace tesseract {
 
@@ -433,6 +436,21 @@ void Classify::LearnPieces(const char* fontname, int start, int length,
       AdaptToChar(rotated_blob, class_id, font_id, threshold,
                   BackupAdaptedTemplates);
     }
+    if (shared_adapted_templates_ != nullptr) {
+      // Replay the learning on the shared templates. UpdateAmbigsGroup works
+      // on AdaptedTemplates, so the shared ones stand in for them meanwhile.
+      // Once a class of the shared templates is full, they learn no more of
+      // it, and nor do the workers that copy them (see sharedadapt.h).
+      shared_adapted_templates_->Update([&](ADAPT_TEMPLATES* templates) {
+        if (*templates == nullptr) *templates = NewAdaptedTemplates(true);
+        int num_adaptations_failed = NumAdaptationsFailed;
+        std::swap(AdaptedTemplates, *templates);
+        AdaptToChar(rotated_blob, class_id, font_id, threshold,
+                    AdaptedTemplates);
+        std::swap(AdaptedTemplates, *templates);
+        NumAdaptationsFailed = num_adaptations_failed;
+      });
+    }
   } else if (classify_debug_level >= 1) {
     tprintf("Can't adapt to %s not in unicharset\n", correct_text);
   }
@@ -479,6 +497,7 @@ void Classify::EndAdaptiveClassifier() {
     free_adapted_templates(AdaptedTemplates);
     AdaptedTemplates = nullptr;
   }
+  ++adaptation_count_;
   if (BackupAdaptedTemplates != nullptr) {
     free_adapted_templates(BackupAdaptedTemplates);
     BackupAdaptedTemplates = nullptr;
@@ -529,6 +548,7 @@ void Classify::InitAdaptiveClassifier(TessdataManager* mgr) {
     return;
   if (AllProtosOn != nullptr)
     EndAdaptiveClassifier();  // Don't leak with multiple inits.
+  ++adaptation_count_;
 
   // If there is no language_data_path_prefix, the classifier will be
   // adaptive only.
@@ -606,6 +626,8 @@ void Classify::ResetAdaptiveClassifierInternal() {
     free_adapted_templates(BackupAdaptedTemplates);
   BackupAdaptedTemplates = nullptr;
   NumAdaptationsFailed = 0;
+  shared_adapted_version_ = 0;
+  ++adaptation_count_;
 }
 
 // If there are backup adapted templates, switches to those, otherwise resets
@@ -623,6 +645,7 @@ void Classify::SwitchAdaptiveClassifier() {
   AdaptedTemplates = BackupAdaptedTemplates;
   BackupAdaptedTemplates = nullptr;
   NumAdaptationsFailed = 0;
+  ++adaptation_count_;
 }
 
 // Resets the backup adaptive classifier to empty.
@@ -632,6 +655,32 @@ void Classify::StartBackupAdaptiveClassifier() {
   BackupAdaptedTemplates = NewAdaptedTemplates(true);
 }
 
+void Classify::ShareAdaptedTemplates(
+    const std::shared_ptr<SharedAdaptedTemplates>& shared) {
+  shared_adapted_templates_ = shared;
+  shared_adapted_version_ = 0;
+}
+
+void Classify::UpdateFromSharedAdaptedTemplates() {
+  if (shared_adapted_templates_ == nullptr) return;
+  ADAPT_TEMPLATES templates =
+      shared_adapted_templates_->UpdatedCopy(&shared_adapted_version_);
+  if (templates == nullptr) return;
+  if (classify_learning_debug_level > 0) {
+    tprintf("Updating from shared adapted templates version %d\n",
+            shared_adapted_version_);
+  }
+  free_adapted_templates(AdaptedTemplates);
+  AdaptedTemplates = templates;
+  // The classes learned elsewhere need their cutoffs, as in InitAdaptedClass.
+  for (int i = 0; i < AdaptedTemplates->Templates->NumClasses; i++) {
+    if (!IsEmptyAdaptedClass(AdaptedTemplates->Class[i]))
+      BaselineCutoffs[i] = CharNormCutoffs[i];
+  }
+  NumAdaptationsFailed = 0;
+  ++adaptation_count_;
+}
+
 /*---------------------------------------------------------------------------*/
 /**
  * This routine prepares the adaptive
@@ -775,7 +824,8 @@ void Classify::InitAdaptedClass(TBLOB *Blob,
  * The extracted pico-features are converted
  * to integer form and placed in IntFeatures. The
  * original floating-pt. features are returned in
- * FloatFeatures.
+ * FloatFeatures, which points into the BlobFeatureBuffer
+ * of the calling thread, and so needs no freeing.
  *
  * Globals: none
  * @param Blob blob to extract features from
@@ -785,25 +835,21 @@ void Classify::InitAdaptedClass(TBLOB *Blob,
  * @return Number of pico-features returned (0 if
  * an error occurred)
  */
-int Classify::GetAdaptiveFeatures(TBLOB *Blob,
-                                  INT_FEATURE_ARRAY IntFeatures,
-                                  FEATURE_SET *FloatFeatures) {
-  FEATURE_SET Features;
-  int NumFeatures;
-
+int Classify::GetAdaptiveFeatures(
+    TBLOB *Blob, INT_FEATURE_ARRAY IntFeatures,
+    const GenericVector<PicoFeature>** FloatFeatures) {
   classify_norm_method.set_value(baseline);
-  Features = ExtractPicoFeatures(Blob);
-
-  NumFeatures = Features->NumFeatures;
-  if (NumFeatures == 0 || NumFeatures > UNLIKELY_NUM_FEAT) {
-    FreeFeatureSet(Features);
+  BlobFeatureBuffer* buffer = BlobFeatureBuffer::ForThisThread();
+  if (!buffer->ExtractPicoFeatures(*Blob, classify_pico_feature_length,
+                                   UNLIKELY_NUM_FEAT))
     return 0;
-  }
+  const GenericVector<PicoFeature>& Features = buffer->pico_features();
+  if (Features.empty()) return 0;
 
   ComputeIntFeatures(Features, IntFeatures);
-  *FloatFeatures = Features;
+  *FloatFeatures = &Features;
 
-  return NumFeatures;
+  return Features.size();
 }                                /* GetAdaptiveFeatures */
 
 
@@ -861,12 +907,13 @@ void Classify::AdaptToChar(TBLOB* Blob, CLASS_ID ClassId, int FontinfoId,
   INT_CLASS IClass;
   ADAPT_CLASS Class;
   TEMP_CONFIG TempConfig;
-  FEATURE_SET FloatFeatures;
+  const GenericVector<PicoFeature>* FloatFeatures;
   int NewTempConfigId;
 
   if (!LegalClassId (ClassId))
     return;
 
+  ++adaptation_count_;
   int_result.unichar_id = ClassId;
   Class = adaptive_templates->Class[ClassId];
   assert(Class != nullptr);
@@ -877,7 +924,7 @@ void Classify::AdaptToChar(TBLOB* Blob, CLASS_ID ClassId, int FontinfoId,
 
     NumFeatures = GetAdaptiveFeatures(Blob, IntFeatures, &FloatFeatures);
     if (NumFeatures <= 0) {
-      return;  // Features already freed by GetAdaptiveFeatures.
+      return;
     }
 
     // Only match configs with the matching font.
@@ -902,7 +949,6 @@ void Classify::AdaptToChar(TBLOB* Blob, CLASS_ID ClassId, int FontinfoId,
         if (classify_learning_debug_level >= 1)
           tprintf("Found good match to perm config %d = %4.1f%%.\n",
                   int_result.config, int_result.rating * 100.0);
-        FreeFeatureSet(FloatFeatures);
         return;
       }
 
@@ -930,7 +976,7 @@ void Classify::AdaptToChar(TBLOB* Blob, CLASS_ID ClassId, int FontinfoId,
       }
       NewTempConfigId =
           MakeNewTemporaryConfig(adaptive_templates, ClassId, FontinfoId,
-                                 NumFeatures, IntFeatures, FloatFeatures);
+                                 NumFeatures, IntFeatures, *FloatFeatures);
       if (NewTempConfigId >= 0 &&
           TempConfigReliable(ClassId, TempConfigFor(Class, NewTempConfigId))) {
         MakePermanent(adaptive_templates, ClassId, NewTempConfigId, Blob);
@@ -943,7 +989,6 @@ void Classify::AdaptToChar(TBLOB* Blob, CLASS_ID ClassId, int FontinfoId,
       }
 #endif
     }
-    FreeFeatureSet(FloatFeatures);
   }
 }                                /* AdaptToChar */
 
@@ -1538,19 +1583,17 @@ void Classify::DebugAdaptiveClassifier(TBLOB *blob,
 void Classify::DoAdaptiveMatch(TBLOB *Blob, ADAPT_RESULTS *Results) {
   UNICHAR_ID *Ambiguities;
 
-  INT_FX_RESULT_STRUCT fx_info;
-  GenericVector<INT_FEATURE_STRUCT> bl_features;
-  TrainingSample* sample =
-      BlobToTrainingSample(*Blob, classify_nonlinear_norm, &fx_info,
-                           &bl_features);
+  BlobFeatureBuffer* buffer = BlobFeatureBuffer::ForThisThread();
+  const TrainingSample* sample =
+      buffer->ExtractIntFeatures(*Blob, classify_nonlinear_norm);
   if (sample == nullptr) return;
+  const INT_FX_RESULT_STRUCT& fx_info = buffer->fx_info();
+  const GenericVector<INT_FEATURE_STRUCT>& bl_features =
+      buffer->bl_features();
 
   // TODO: With LSTM, static_classifier_ is nullptr.
   // Return to avoid crash in CharNormClassifier.
-  if (static_classifier_ == nullptr) {
-    delete sample;
-    return;
-  }
+  if (static_classifier_ == nullptr) return;
 
   if (AdaptedTemplates->NumPermClasses < matcher_permanent_classes_min ||
       tess_cn_matching) {
@@ -1579,7 +1622,6 @@ void Classify::DoAdaptiveMatch(TBLOB *Blob, ADAPT_RESULTS *Results) {
   // just adding a nullptr classification.
   if (!Results->HasNonfragment || Results->match.empty())
     ClassifyAsNoise(Results);
-  delete sample;
 }   /* DoAdaptiveMatch */
 
 /*---------------------------------------------------------------------------*/
@@ -1604,18 +1646,15 @@ UNICHAR_ID *Classify::GetAmbiguities(TBLOB *Blob,
   int i;
 
   Results->Initialize();
-  INT_FX_RESULT_STRUCT fx_info;
-  GenericVector<INT_FEATURE_STRUCT> bl_features;
-  TrainingSample* sample =
-      BlobToTrainingSample(*Blob, classify_nonlinear_norm, &fx_info,
-                           &bl_features);
+  const TrainingSample* sample =
+      BlobFeatureBuffer::ForThisThread()->ExtractIntFeatures(
+          *Blob, classify_nonlinear_norm);
   if (sample == nullptr) {
     delete Results;
     return nullptr;
   }
 
   CharNormClassifier(Blob, *sample, Results);
-  delete sample;
   RemoveBadMatches(Results);
   Results->match.sort(&UnicharRating::SortDescendingRating);
 
@@ -1750,7 +1789,7 @@ int Classify::MakeNewTemporaryConfig(ADAPT_TEMPLATES Templates,
                            int FontinfoId,
                            int NumFeatures,
                            INT_FEATURE_ARRAY Features,
-                           FEATURE_SET FloatFeatures) {
+                           const GenericVector<PicoFeature>& FloatFeatures) {
   INT_CLASS IClass;
   ADAPT_CLASS Class;
   PROTO_ID OldProtos[MAX_NUM_PROTOS];
@@ -1839,7 +1878,7 @@ int Classify::MakeNewTemporaryConfig(ADAPT_TEMPLATES Templates,
  *
  * @return Max proto id in class after all protos have been added.
  */
-PROTO_ID Classify::MakeNewTempProtos(FEATURE_SET Features,
+PROTO_ID Classify::MakeNewTempProtos(const GenericVector<PicoFeature>& Features,
                                      int NumBadFeat,
                                      FEATURE_ID BadFeat[],
                                      INT_CLASS IClass,
@@ -1850,7 +1889,6 @@ PROTO_ID Classify::MakeNewTempProtos(FEATURE_SET Features,
   FEATURE_ID *LastBad;
   TEMP_PROTO TempProto;
   PROTO Proto;
-  FEATURE F1, F2;
   float X1, X2, Y1, Y2;
   float A1, A2, AngleDelta;
   float SegmentLength;
@@ -1858,19 +1896,17 @@ PROTO_ID Classify::MakeNewTempProtos(FEATURE_SET Features,
 
   for (ProtoStart = BadFeat, LastBad = ProtoStart + NumBadFeat;
        ProtoStart < LastBad; ProtoStart = ProtoEnd) {
-    F1 = Features->Features[*ProtoStart];
-    X1 = F1->Params[PicoFeatX];
-    Y1 = F1->Params[PicoFeatY];
-    A1 = F1->Params[PicoFeatDir];
+    X1 = Features[*ProtoStart].x;
+    Y1 = Features[*ProtoStart].y;
+    A1 = Features[*ProtoStart].dir;
 
     for (ProtoEnd = ProtoStart + 1,
          SegmentLength = GetPicoFeatureLength();
          ProtoEnd < LastBad;
          ProtoEnd++, SegmentLength += GetPicoFeatureLength()) {
-      F2 = Features->Features[*ProtoEnd];
-      X2 = F2->Params[PicoFeatX];
-      Y2 = F2->Params[PicoFeatY];
-      A2 = F2->Params[PicoFeatDir];
+      X2 = Features[*ProtoEnd].x;
+      Y2 = Features[*ProtoEnd].y;
+      A2 = Features[*ProtoEnd].dir;
 
       AngleDelta = fabs(A1 - A2);
       if (AngleDelta > 0.5)
@@ -1882,10 +1918,9 @@ PROTO_ID Classify::MakeNewTempProtos(FEATURE_SET Features,
         break;
     }
 
-    F2 = Features->Features[*(ProtoEnd - 1)];
-    X2 = F2->Params[PicoFeatX];
-    Y2 = F2->Params[PicoFeatY];
-    A2 = F2->Params[PicoFeatDir];
+    X2 = Features[*(ProtoEnd - 1)].x;
+    Y2 = Features[*(ProtoEnd - 1)].y;
+    A2 = Features[*(ProtoEnd - 1)].dir;
 
     Pid = AddIntProto(IClass);
     if (Pid == NO_PROTO)
@@ -0,0 +1,133 @@
+///////////////////////////////////////////////////////////////////////
+// File:        blobfeatures.cpp
+// Description: Reusable per-thread storage for the features of a blob.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifdef HAVE_CONFIG_H
+#include "config_auto.h"
+#endif
+
+#include "blobfeatures.h"
+
+#include <cmath>  // for floor
+
+#include "blobs.h"      // for TBLOB, TESSLINE, EDGEPT
+#include "classify.h"   // for Classify::ExtractFeatures
+#include "mfoutline.h"  // for MF_SCALE_FACTOR
+#include "normalis.h"   // for kBlnBaselineOffset
+
+namespace tesseract {
+
+BlobFeatureBuffer* BlobFeatureBuffer::ForThisThread() {
+  static thread_local BlobFeatureBuffer buffer;
+  return &buffer;
+}
+
+const TrainingSample* BlobFeatureBuffer::ExtractIntFeatures(
+    const TBLOB& blob, bool nonlinear_norm) {
+  bl_features_.truncate(0);
+  cn_features_.truncate(0);
+  Classify::ExtractFeatures(blob, nonlinear_norm, &bl_features_,
+                            &cn_features_, &fx_info_, nullptr);
+  if (fx_info_.NumCN <= 0) return nullptr;
+  TBOX box = blob.bounding_box();
+  sample_.SetFromFeatures(fx_info_, box, &cn_features_[0], fx_info_.NumCN);
+  // Set the bounding box (in original image coordinates) in the sample.
+  TPOINT topleft(box.left(), box.top());
+  TPOINT botright(box.right(), box.bottom());
+  TPOINT original_topleft, original_botright;
+  blob.denorm().DenormTransform(nullptr, topleft, &original_topleft);
+  blob.denorm().DenormTransform(nullptr, botright, &original_botright);
+  sample_.set_bounding_box(TBOX(original_topleft.x, original_botright.y,
+                                original_botright.x, original_topleft.y));
+  return &sample_;
+}
+
+// ConvertBlob pushes each outline, and each point of an outline, onto the
+// front of a list, so the outlines and their points are visited backwards
+// here, to make the same features in the same order, and so the same sum
+// in the x normalization.
+bool BlobFeatureBuffer::ExtractPicoFeatures(const TBLOB& blob,
+                                            double pico_feature_length,
+                                            int max_features) {
+  pico_features_.truncate(0);
+  outlines_.truncate(0);
+  for (const TESSLINE* ol = blob.outlines; ol != nullptr; ol = ol->next)
+    outlines_.push_back(ol);
+  for (int o = outlines_.size() - 1; o >= 0; --o) {
+    const EDGEPT* start_pt = outlines_[o]->loop;
+    if (start_pt == nullptr) continue;
+    // The points of the outline, without duplicates, normalized as
+    // NormalizeOutline.
+    points_.truncate(0);
+    hidden_.truncate(0);
+    const EDGEPT* pt = start_pt;
+    do {
+      const EDGEPT* next_pt = pt->next;
+      if (pt->pos.x != next_pt->pos.x || pt->pos.y != next_pt->pos.y) {
+        FPOINT point;
+        point.x = pt->pos.x;
+        point.y = pt->pos.y;
+        point.x = MF_SCALE_FACTOR * point.x;
+        point.y = MF_SCALE_FACTOR * (point.y - kBlnBaselineOffset);
+        points_.push_back(point);
+        hidden_.push_back(pt->IsHidden());
+      }
+      pt = next_pt;
+    } while (pt != start_pt);
+    int num_points = points_.size();
+    if (num_points < 2) continue;  // A degenerate outline.
+    // Cut each segment into pico-features as ConvertSegmentToPicoFeat.
+    // The edge is hidden if its end point is hidden.
+    for (int i = num_points - 1; i >= 0; --i) {
+      int end = i > 0 ? i - 1 : num_points - 1;
+      if (hidden_[end]) continue;
+      FPOINT start_pos = points_[i];
+      FPOINT end_pos = points_[end];
+      float angle = NormalizedAngleFrom(&start_pos, &end_pos, 1.0);
+      float length = DistanceBetween(start_pos, end_pos);
+      int num_features =
+          static_cast<int>(floor(length / pico_feature_length + 0.5));
+      if (num_features < 1) num_features = 1;
+      if (pico_features_.size() + num_features > max_features) return false;
+      FPOINT delta;
+      delta.x = XDelta(start_pos, end_pos) / num_features;
+      delta.y = YDelta(start_pos, end_pos) / num_features;
+      FPOINT center;
+      center.x = start_pos.x + delta.x / 2.0;
+      center.y = start_pos.y + delta.y / 2.0;
+      for (int f = 0; f < num_features; ++f) {
+        PicoFeature feature;
+        feature.x = center.x;
+        feature.y = center.y;
+        feature.dir = angle;
+        pico_features_.push_back(feature);
+        center.x += delta.x;
+        center.y += delta.y;
+      }
+    }
+  }
+  // Make the mean x zero, as NormalizePicoX.
+  if (!pico_features_.empty()) {
+    float origin = 0.0;
+    for (int i = 0; i < pico_features_.size(); ++i)
+      origin += pico_features_[i].x;
+    origin /= pico_features_.size();
+    for (int i = 0; i < pico_features_.size(); ++i)
+      pico_features_[i].x -= origin;
+  }
+  return true;
+}
+
+}  // namespace tesseract.
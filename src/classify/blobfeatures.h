@@ -0,0 +1,87 @@
+///////////////////////////////////////////////////////////////////////
+// File:        blobfeatures.h
+// Description: Reusable per-thread storage for the features of a blob.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_CLASSIFY_BLOBFEATURES_H_
+#define TESSERACT_CLASSIFY_BLOBFEATURES_H_
+
+#include "fpoint.h"          // for FPOINT
+#include "genericvector.h"   // for GenericVector
+#include "intfx.h"           // for INT_FX_RESULT_STRUCT
+#include "trainingsample.h"  // for TrainingSample
+
+namespace tesseract {
+
+// A pico-feature, with the values of the PicoFeatX, PicoFeatY and
+// PicoFeatDir params of the FEATURE_STRUCT made by ExtractPicoFeatures.
+struct PicoFeature {
+  float x;
+  float y;
+  float dir;
+};
+
+// The features of one blob, in flat arrays that keep their capacity from
+// one blob to the next, so that once the buffer of a thread has grown to
+// fit the largest blob it has seen, extracting the features of a blob for
+// the classifiers allocates no memory.
+// Each thread has its own buffer, which holds the features of the last
+// blob extracted into it, so the features must be used before the thread
+// extracts the same kind of features from another blob.
+class BlobFeatureBuffer {
+ public:
+  // Returns the buffer of the calling thread.
+  static BlobFeatureBuffer* ForThisThread();
+
+  // Extracts the baseline and character normalized integer features of
+  // blob, as BlobToTrainingSample, into bl_features, cn_features and
+  // fx_info, and returns a sample of the cn_features, or nullptr if there
+  // are none.
+  const TrainingSample* ExtractIntFeatures(const TBLOB& blob,
+                                           bool nonlinear_norm);
+
+  // Extracts the baseline normalized pico-features of blob, as
+  // Classify::ExtractPicoFeatures, but straight from the polygonal
+  // outlines, without building MFOUTLINE lists, into pico_features.
+  // Stops early, returning false, if there would be more than
+  // max_features.
+  bool ExtractPicoFeatures(const TBLOB& blob, double pico_feature_length,
+                           int max_features);
+
+  const INT_FX_RESULT_STRUCT& fx_info() const {
+    return fx_info_;
+  }
+  const GenericVector<INT_FEATURE_STRUCT>& bl_features() const {
+    return bl_features_;
+  }
+  const GenericVector<PicoFeature>& pico_features() const {
+    return pico_features_;
+  }
+
+ private:
+  INT_FX_RESULT_STRUCT fx_info_;
+  GenericVector<INT_FEATURE_STRUCT> bl_features_;
+  GenericVector<INT_FEATURE_STRUCT> cn_features_;
+  TrainingSample sample_;
+  GenericVector<PicoFeature> pico_features_;
+  // Scratch space for the outlines of the blob, and for the points of one
+  // outline, with their hidden flags.
+  GenericVector<const TESSLINE*> outlines_;
+  GenericVector<FPOINT> points_;
+  GenericVector<bool> hidden_;
+};
+
+}  // namespace tesseract.
+
+#endif  // TESSERACT_CLASSIFY_BLOBFEATURES_H_
@@ -74,9 +74,12 @@ class Classify : public CCStruct {
 #include "ocrfeatures.h"
 #include "unicity_table.h"
 
+#include <memory>  // for std::shared_ptr
+
 namespace tesseract {
 
 class ScrollView;
+class SharedAdaptedTemplates;
 class WERD_CHOICE;
 class WERD_RES;
 struct ADAPT_RESULTS;
@@ -86,6 +89,7 @@ static const int kUnknownFontinfoId = -1;
 static const int kBlankFontinfoId = -2;
 
 class ShapeClassifier;
+struct PicoFeature;
 struct ShapeRating;
 class ShapeTable;
 struct UnicharRating;
@@ -230,13 +234,13 @@ class Classify : public CCStruct {
   void AddNewResult(const UnicharRating& new_result, ADAPT_RESULTS *results);
   int GetAdaptiveFeatures(TBLOB *Blob,
                           INT_FEATURE_ARRAY IntFeatures,
-                          FEATURE_SET *FloatFeatures);
+                          const GenericVector<PicoFeature>** FloatFeatures);
 
 #ifndef GRAPHICS_DISABLED
   void DebugAdaptiveClassifier(TBLOB *Blob,
                                ADAPT_RESULTS *Results);
 #endif
-  PROTO_ID MakeNewTempProtos(FEATURE_SET Features,
+  PROTO_ID MakeNewTempProtos(const GenericVector<PicoFeature>& Features,
                              int NumBadFeat,
                              FEATURE_ID BadFeat[],
                              INT_CLASS IClass,
@@ -247,7 +251,7 @@ class Classify : public CCStruct {
                              int FontinfoId,
                              int NumFeatures,
                              INT_FEATURE_ARRAY Features,
-                             FEATURE_SET FloatFeatures);
+                             const GenericVector<PicoFeature>& FloatFeatures);
   void MakePermanent(ADAPT_TEMPLATES Templates,
                      CLASS_ID ClassId,
                      int ConfigId,
@@ -305,6 +309,18 @@ class Classify : public CCStruct {
   void ResetAdaptiveClassifierInternal();
   void SwitchAdaptiveClassifier();
   void StartBackupAdaptiveClassifier();
+  // Makes this classifier learn into, and pick up what other classifiers
+  // have learned from, the given document-level templates, which must be
+  // for the same unicharset. Learning done before the call stays private.
+  void ShareAdaptedTemplates(
+      const std::shared_ptr<SharedAdaptedTemplates>& shared);
+  const std::shared_ptr<SharedAdaptedTemplates>& shared_adapted_templates()
+      const {
+    return shared_adapted_templates_;
+  }
+  // Replaces the adapted templates with a copy of the shared templates, if
+  // they have changed since the last call. Call at the start of a page.
+  void UpdateFromSharedAdaptedTemplates();
 
   int GetCharNormFeature(const INT_FX_RESULT_STRUCT& fx_info,
                          INT_TEMPLATES templates,
@@ -322,6 +338,10 @@ class Classify : public CCStruct {
   void UpdateAmbigsGroup(CLASS_ID class_id, TBLOB *Blob);
 
   bool AdaptiveClassifierIsFull() const { return NumAdaptationsFailed > 0; }
+  // Returns the number of changes made so far to the adapted templates, so
+  // that results of classifications made with older templates can be told
+  // apart.
+  int adaptation_count() const { return adaptation_count_; }
   bool AdaptiveClassifierIsEmpty() const {
     return AdaptedTemplates->NumPermClasses == 0;
   }
@@ -373,7 +393,8 @@ class Classify : public CCStruct {
   void ClearCharNormArray(uint8_t* char_norm_array);
   void ComputeIntCharNormArray(const FEATURE_STRUCT& norm_feature,
                                uint8_t* char_norm_array);
-  void ComputeIntFeatures(FEATURE_SET Features, INT_FEATURE_ARRAY IntFeatures);
+  void ComputeIntFeatures(const GenericVector<PicoFeature>& Features,
+                          INT_FEATURE_ARRAY IntFeatures);
   /* intproto.cpp *************************************************************/
   INT_TEMPLATES ReadIntTemplates(TFile* fp);
   void WriteIntTemplates(FILE *File, INT_TEMPLATES Templates,
@@ -560,6 +581,12 @@ class Classify : public CCStruct {
 
   /* variables used to hold performance statistics */
   int NumAdaptationsFailed = 0;
+  // Incremented whenever the adapted templates change.
+  int adaptation_count_ = 0;
+  // The document-level templates shared with other classifiers, if any,
+  // and the version of them last copied into AdaptedTemplates.
+  std::shared_ptr<SharedAdaptedTemplates> shared_adapted_templates_;
+  int shared_adapted_version_ = 0;
 
   // Expected number of features in the class pruner, used to penalize
   // unknowns that have too few features (like a c being classified as e) so
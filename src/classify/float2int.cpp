@@ -16,6 +16,7 @@
  ******************************************************************************/
 
 #include "float2int.h"
+#include "blobfeatures.h"
 
 #include "normmatch.h"
 #include "mfoutline.h"
@@ -84,7 +85,7 @@ void Classify::ComputeIntCharNormArray(const FEATURE_STRUCT& norm_feature,
  * @param Features floating point pico-features to be converted
  * @param[out] IntFeatures array to put converted features into
  */
-void Classify::ComputeIntFeatures(FEATURE_SET Features,
+void Classify::ComputeIntFeatures(const GenericVector<PicoFeature>& Features,
                                   INT_FEATURE_ARRAY IntFeatures) {
   float YShift;
 
@@ -93,15 +94,13 @@ void Classify::ComputeIntFeatures(FEATURE_SET Features,
   else
     YShift = Y_SHIFT;
 
-  for (int Fid = 0; Fid < Features->NumFeatures; Fid++) {
-    FEATURE Feature = Features->Features[Fid];
+  for (int Fid = 0; Fid < Features.size(); Fid++) {
+    const PicoFeature& Feature = Features[Fid];
 
-    IntFeatures[Fid].X =
-        Bucket8For(Feature->Params[PicoFeatX], X_SHIFT, INT_FEAT_RANGE);
-    IntFeatures[Fid].Y =
-        Bucket8For(Feature->Params[PicoFeatY], YShift, INT_FEAT_RANGE);
-    IntFeatures[Fid].Theta = CircBucketFor(Feature->Params[PicoFeatDir],
-                                           ANGLE_SHIFT, INT_FEAT_RANGE);
+    IntFeatures[Fid].X = Bucket8For(Feature.x, X_SHIFT, INT_FEAT_RANGE);
+    IntFeatures[Fid].Y = Bucket8For(Feature.y, YShift, INT_FEAT_RANGE);
+    IntFeatures[Fid].Theta =
+        CircBucketFor(Feature.dir, ANGLE_SHIFT, INT_FEAT_RANGE);
     IntFeatures[Fid].CP_misses = 0;
   }
 }                                /* ComputeIntFeatures */
@@ -21,17 +21,23 @@
 
 #include "intmatcher.h"
 
+#include "classpruner.h"  // for kClassPrunerClasses
+#include "protodistance.h"  // for ProtoDistance, ProtoDistancesGeneric
 #include "fontinfo.h"
 #include "intproto.h"
 #include "scrollview.h"
 #include "float2int.h"
 #include "classify.h"
 #include "shapetable.h"
+#include "simddetect.h"  // for ClassPrunerScores, ProtoDistances
 
 #include <tesseract/helpers.h>
 
+#include <algorithm>  // for std::min
 #include <cassert>
 #include <cmath>
+#include <cstddef>  // for offsetof
+#include <cstring>  // for memcpy
 
 namespace tesseract {
 
@@ -142,9 +148,9 @@ HeapSort (int n, int ra[], int rb[]) {
 class ClassPruner {
  public:
   ClassPruner(int max_classes) {
-    // The unrolled loop in ComputeScores means that the array sizes need to
-    // be rounded up so that the array is big enough to accommodate the extra
-    // entries accessed by the unrolling. Each pruner word is of sized
+    // The kernels in ComputeScores update whole pruners, so the array sizes
+    // need to be rounded up so that the array is big enough to accommodate
+    // the extra entries accessed by them. Each pruner word is of sized
     // BITS_PER_WERD and each entry is NUM_BITS_PER_CLASS, so there are
     // BITS_PER_WERD / NUM_BITS_PER_CLASS entries.
     // See ComputeScores.
@@ -172,68 +178,37 @@ class ClassPruner {
 
   /// Computes the scores for every class in the character set, by summing the
   /// weights for each feature and stores the sums internally in class_count_.
+  /// The sums are done a CLASS_PRUNER_STRUCT at a time by the ClassPrunerScores
+  /// kernel selected by SIMDDetect.
   void ComputeScores(const INT_TEMPLATES_STRUCT* int_templates,
                      int num_features, const INT_FEATURE_STRUCT* features) {
+    static_assert(CLASSES_PER_CP == kClassPrunerClasses &&
+                      NUM_BITS_PER_CLASS == 2 && WERDS_PER_CP_VECTOR == 2,
+                  "Class pruner kernels assume 32 2-bit classes per vector");
     num_features_ = num_features;
     int num_pruners = int_templates->NumClassPruners;
-    for (int f = 0; f < num_features; ++f) {
-      const INT_FEATURE_STRUCT* feature = &features[f];
-      // Quantize the feature to NUM_CP_BUCKETS*NUM_CP_BUCKETS*NUM_CP_BUCKETS.
-      int x = feature->X * NUM_CP_BUCKETS >> 8;
-      int y = feature->Y * NUM_CP_BUCKETS >> 8;
-      int theta = feature->Theta * NUM_CP_BUCKETS >> 8;
-      int class_id = 0;
+    // The index of each feature's quantized bucket in a pruner, which is the
+    // same for all the CLASS_PRUNER_STRUCTs. Blobs rarely have more than
+    // MAX_NUM_INT_FEATURES, but any more are done in further batches.
+    int offsets[MAX_NUM_INT_FEATURES];
+    for (int start = 0; start < num_features; start += MAX_NUM_INT_FEATURES) {
+      int batch_size = std::min(num_features - start, MAX_NUM_INT_FEATURES);
+      for (int f = 0; f < batch_size; ++f) {
+        const INT_FEATURE_STRUCT* feature = &features[start + f];
+        // Quantize the feature to NUM_CP_BUCKETS^3.
+        int x = feature->X * NUM_CP_BUCKETS >> 8;
+        int y = feature->Y * NUM_CP_BUCKETS >> 8;
+        int theta = feature->Theta * NUM_CP_BUCKETS >> 8;
+        offsets[f] = ((x * NUM_CP_BUCKETS + y) * NUM_CP_BUCKETS + theta) *
+                     WERDS_PER_CP_VECTOR;
+      }
       // Each CLASS_PRUNER_STRUCT only covers CLASSES_PER_CP(32) classes, so
       // we need a collection of them, indexed by pruner_set.
       for (int pruner_set = 0; pruner_set < num_pruners; ++pruner_set) {
-        // Look up quantized feature in a 3-D array, an array of weights for
-        // each class.
-        const uint32_t* pruner_word_ptr =
-            int_templates->ClassPruners[pruner_set]->p[x][y][theta];
-        for (int word = 0; word < WERDS_PER_CP_VECTOR; ++word) {
-          uint32_t pruner_word = *pruner_word_ptr++;
-          // This inner loop is unrolled to speed up the ClassPruner.
-          // Currently gcc would not unroll it unless it is set to O3
-          // level of optimization or -funroll-loops is specified.
-          /*
-          uint32_t class_mask = (1 << NUM_BITS_PER_CLASS) - 1;
-          for (int bit = 0; bit < BITS_PER_WERD/NUM_BITS_PER_CLASS; bit++) {
-            class_count_[class_id++] += pruner_word & class_mask;
-            pruner_word >>= NUM_BITS_PER_CLASS;
-          }
-          */
-          class_count_[class_id++] += pruner_word & CLASS_PRUNER_CLASS_MASK;
-          pruner_word >>= NUM_BITS_PER_CLASS;
-          class_count_[class_id++] += pruner_word & CLASS_PRUNER_CLASS_MASK;
-          pruner_word >>= NUM_BITS_PER_CLASS;
-          class_count_[class_id++] += pruner_word & CLASS_PRUNER_CLASS_MASK;
-          pruner_word >>= NUM_BITS_PER_CLASS;
-          class_count_[class_id++] += pruner_word & CLASS_PRUNER_CLASS_MASK;
-          pruner_word >>= NUM_BITS_PER_CLASS;
-          class_count_[class_id++] += pruner_word & CLASS_PRUNER_CLASS_MASK;
-          pruner_word >>= NUM_BITS_PER_CLASS;
-          class_count_[class_id++] += pruner_word & CLASS_PRUNER_CLASS_MASK;
-          pruner_word >>= NUM_BITS_PER_CLASS;
-          class_count_[class_id++] += pruner_word & CLASS_PRUNER_CLASS_MASK;
-          pruner_word >>= NUM_BITS_PER_CLASS;
-          class_count_[class_id++] += pruner_word & CLASS_PRUNER_CLASS_MASK;
-          pruner_word >>= NUM_BITS_PER_CLASS;
-          class_count_[class_id++] += pruner_word & CLASS_PRUNER_CLASS_MASK;
-          pruner_word >>= NUM_BITS_PER_CLASS;
-          class_count_[class_id++] += pruner_word & CLASS_PRUNER_CLASS_MASK;
-          pruner_word >>= NUM_BITS_PER_CLASS;
-          class_count_[class_id++] += pruner_word & CLASS_PRUNER_CLASS_MASK;
-          pruner_word >>= NUM_BITS_PER_CLASS;
-          class_count_[class_id++] += pruner_word & CLASS_PRUNER_CLASS_MASK;
-          pruner_word >>= NUM_BITS_PER_CLASS;
-          class_count_[class_id++] += pruner_word & CLASS_PRUNER_CLASS_MASK;
-          pruner_word >>= NUM_BITS_PER_CLASS;
-          class_count_[class_id++] += pruner_word & CLASS_PRUNER_CLASS_MASK;
-          pruner_word >>= NUM_BITS_PER_CLASS;
-          class_count_[class_id++] += pruner_word & CLASS_PRUNER_CLASS_MASK;
-          pruner_word >>= NUM_BITS_PER_CLASS;
-          class_count_[class_id++] += pruner_word & CLASS_PRUNER_CLASS_MASK;
-        }
+        const uint32_t* pruner =
+            &int_templates->ClassPruners[pruner_set]->p[0][0][0][0];
+        ClassPrunerScores(pruner, offsets, batch_size,
+                          class_count_ + pruner_set * CLASSES_PER_CP);
       }
     }
   }
@@ -770,10 +745,66 @@ static void IMDebugConfigurationSum(int FeatureNum, uint8_t *FeatureEvidence,
   tprintf("\n");
 }
 
+/**
+ * Updates the feature evidence of the configs of the proto at proto_num in
+ * ClassTemplate, and its proto evidence, with the evidence of the given
+ * distance to the feature.
+ */
+void IntegerMatcher::UpdateTablesForProto(INT_CLASS ClassTemplate,
+                                          BIT_VECTOR ConfigMask,
+                                          int FeatureNum, uint32_t proto_num,
+                                          INT_PROTO Proto, uint32_t distance,
+                                          ScratchEvidence *tables, int Debug) {
+  uint8_t Evidence;
+  uint32_t ConfigWord = Proto->Configs[0];
+  if (distance > evidence_table_mask_)
+    Evidence = 0;
+  else
+    Evidence = similarity_evidence_table_[distance];
+
+  if (PrintFeatureMatchesOn (Debug))
+    IMDebugConfiguration (FeatureNum, proto_num, Evidence, ConfigWord);
+
+  ConfigWord &= *ConfigMask;
+
+  uint8_t feature_evidence_index = 0;
+  uint8_t config_byte = 0;
+  while (ConfigWord != 0 || config_byte != 0) {
+    while (config_byte == 0) {
+      config_byte = ConfigWord & 0xff;
+      ConfigWord >>= 8;
+      feature_evidence_index += 8;
+    }
+    const uint8_t config_offset =
+      offset_table[config_byte] + feature_evidence_index - 8;
+    config_byte = next_table[config_byte];
+    if (Evidence > tables->feature_evidence_[config_offset])
+      tables->feature_evidence_[config_offset] = Evidence;
+  }
+
+  uint8_t ProtoIndex = ClassTemplate->ProtoLengths[proto_num];
+  if (ProtoIndex > MAX_PROTO_INDEX) {
+    // Avoid buffer overflow.
+    // TODO: A better fix is still open.
+    ProtoIndex = MAX_PROTO_INDEX;
+  }
+  uint8_t* UINT8Pointer = &(tables->proto_evidence_[proto_num][0]);
+  for (; Evidence > 0 && ProtoIndex > 0; ProtoIndex--, UINT8Pointer++) {
+    if (Evidence > *UINT8Pointer) {
+      uint8_t Temp = *UINT8Pointer;
+      *UINT8Pointer = Evidence;
+      Evidence = Temp;
+    }
+  }
+}
+
 /**
  * For the given feature: prune protos, compute evidence,
  * update Feature Evidence, Proto Evidence, and Sum of Feature
  * Evidence tables.
+ * With a SIMD ProtoDistances kernel, the distances to the protos of each
+ * proto set that survive the pruning are computed together by it. Otherwise
+ * each proto is done as the pruning finds it, which saves packing them.
  * @param ClassTemplate Prototypes & tables for a class
  * @param FeatureNum Current feature number (for DEBUG only)
  * @param Feature Pointer to a feature struct
@@ -789,7 +820,6 @@ int IntegerMatcher::UpdateTablesForFeature(
     const INT_FEATURE_STRUCT* Feature,
     ScratchEvidence *tables,
     int Debug) {
-  uint32_t ConfigWord;
   uint32_t ProtoWord;
   uint32_t ProtoNum;
   uint32_t ActualProtoNum;
@@ -798,12 +828,29 @@ int IntegerMatcher::UpdateTablesForFeature(
   int32_t proto_offset;
   PROTO_SET ProtoSet;
   uint32_t *ProtoPrunerPtr;
-  INT_PROTO Proto;
   int ProtoSetIndex;
-  uint8_t Evidence;
   uint32_t XFeatureAddress;
   uint32_t YFeatureAddress;
   uint32_t ThetaFeatureAddress;
+  // The generic kernel is no faster on a batch than on each proto alone.
+  const bool batched = ProtoDistances != ProtoDistancesGeneric;
+  // The protos of a set that survive the pruning, as their index in the set
+  // and their A, B, C and Angle packed into a word, so that the distances
+  // to all of them can be computed together by ProtoDistances.
+  uint8_t proto_indices[PROTOS_PER_PROTO_SET];
+  alignas(32) uint32_t packed_protos[PROTOS_PER_PROTO_SET];
+  alignas(32) uint32_t distances[PROTOS_PER_PROTO_SET];
+  static_assert(offsetof(INT_PROTO_STRUCT, A) == 0 &&
+                offsetof(INT_PROTO_STRUCT, Angle) == 3,
+                "ProtoDistance expects A, B, C and Angle in the first word");
+  ProtoDistanceParams params;
+  params.x = Feature->X;
+  params.y = Feature->Y;
+  params.theta = Feature->Theta;
+  params.theta_fudge = kIntThetaFudge;
+  params.mult_trunc_shift_bits = mult_trunc_shift_bits_;
+  params.evidence_mult_mask = evidence_mult_mask_;
+  params.table_trunc_shift_bits = table_trunc_shift_bits_;
 
   tables->ClearFeatureEvidence(ClassTemplate);
 
@@ -813,12 +860,13 @@ int IntegerMatcher::UpdateTablesForFeature(
   ThetaFeatureAddress = (NUM_PP_BUCKETS << 2) + ((Feature->Theta >> 2) << 1);
 
   for (ProtoSetIndex = 0, ActualProtoNum = 0;
-  ProtoSetIndex < ClassTemplate->NumProtoSets; ProtoSetIndex++) {
+  ProtoSetIndex < ClassTemplate->NumProtoSets;
+  ProtoSetIndex++, ActualProtoNum += PROTOS_PER_PROTO_SET) {
     ProtoSet = ClassTemplate->ProtoSets[ProtoSetIndex];
     ProtoPrunerPtr = reinterpret_cast<uint32_t *>((*ProtoSet).ProtoPruner);
+    int num_protos = 0;
     for (ProtoNum = 0; ProtoNum < PROTOS_PER_PROTO_SET;
-      ProtoNum += (PROTOS_PER_PROTO_SET >> 1), ActualProtoNum +=
-    (PROTOS_PER_PROTO_SET >> 1), ProtoMask++, ProtoPrunerPtr++) {
+      ProtoNum += (PROTOS_PER_PROTO_SET >> 1), ProtoMask++, ProtoPrunerPtr++) {
       /* Prune Protos of current Proto Set */
       ProtoWord = *(ProtoPrunerPtr + XFeatureAddress);
       ProtoWord &= *(ProtoPrunerPtr + YFeatureAddress);
@@ -837,72 +885,32 @@ int IntegerMatcher::UpdateTablesForFeature(
           }
           proto_offset = offset_table[proto_byte] + proto_word_offset;
           proto_byte = next_table[proto_byte];
-          Proto = &(ProtoSet->Protos[ProtoNum + proto_offset]);
-          ConfigWord = Proto->Configs[0];
-          int32_t A3 = (((Proto->A * (Feature->X - 128)) * 2)
-            - (Proto->B * (Feature->Y - 128)) + (Proto->C * 512));
-          int32_t M3 = ((static_cast<int8_t>(Feature->Theta - Proto->Angle)) *
-                        kIntThetaFudge) * 2;
-
-          if (A3 < 0)
-            A3 = ~A3;
-          if (M3 < 0)
-            M3 = ~M3;
-          A3 >>= mult_trunc_shift_bits_;
-          M3 >>= mult_trunc_shift_bits_;
-          if (static_cast<uint32_t>(A3) > evidence_mult_mask_)
-            A3 = evidence_mult_mask_;
-          if (static_cast<uint32_t>(M3) > evidence_mult_mask_)
-            M3 = evidence_mult_mask_;
-
-          uint32_t A4 = (A3 * A3) + (M3 * M3);
-          A4 >>= table_trunc_shift_bits_;
-          if (A4 > evidence_table_mask_)
-            Evidence = 0;
-          else
-            Evidence = similarity_evidence_table_[A4];
-
-          if (PrintFeatureMatchesOn (Debug))
-            IMDebugConfiguration (FeatureNum,
-              ActualProtoNum + proto_offset,
-              Evidence, ConfigWord);
-
-          ConfigWord &= *ConfigMask;
-
-          uint8_t feature_evidence_index = 0;
-          uint8_t config_byte = 0;
-          while (ConfigWord != 0 || config_byte != 0) {
-            while (config_byte == 0) {
-              config_byte = ConfigWord & 0xff;
-              ConfigWord >>= 8;
-              feature_evidence_index += 8;
-            }
-            const uint8_t config_offset =
-              offset_table[config_byte] + feature_evidence_index - 8;
-            config_byte = next_table[config_byte];
-            if (Evidence > tables->feature_evidence_[config_offset])
-              tables->feature_evidence_[config_offset] = Evidence;
-          }
-
-          uint8_t ProtoIndex =
-            ClassTemplate->ProtoLengths[ActualProtoNum + proto_offset];
-          if (ProtoIndex > MAX_PROTO_INDEX) {
-            // Avoid buffer overflow.
-            // TODO: A better fix is still open.
-            ProtoIndex = MAX_PROTO_INDEX;
-          }
-          uint8_t* UINT8Pointer =
-            &(tables->proto_evidence_[ActualProtoNum + proto_offset][0]);
-          for (; Evidence > 0 && ProtoIndex > 0; ProtoIndex--, UINT8Pointer++) {
-            if (Evidence > *UINT8Pointer) {
-              uint8_t Temp = *UINT8Pointer;
-              *UINT8Pointer = Evidence;
-              Evidence = Temp;
-            }
+          INT_PROTO Proto = &ProtoSet->Protos[ProtoNum + proto_offset];
+          uint32_t packed_proto;
+          memcpy(&packed_proto, Proto, sizeof(packed_proto));
+          if (batched) {
+            proto_indices[num_protos] = ProtoNum + proto_offset;
+            packed_protos[num_protos++] = packed_proto;
+          } else {
+            UpdateTablesForProto(ClassTemplate, ConfigMask, FeatureNum,
+                                 ActualProtoNum + ProtoNum + proto_offset,
+                                 Proto, ProtoDistance(packed_proto, params),
+                                 tables, Debug);
           }
         }
       }
     }
+    if (num_protos == 0)
+      continue;
+
+    ProtoDistances(packed_protos, num_protos, params, distances);
+
+    for (int i = 0; i < num_protos; ++i) {
+      UpdateTablesForProto(ClassTemplate, ConfigMask, FeatureNum,
+                           ActualProtoNum + proto_indices[i],
+                           &ProtoSet->Protos[proto_indices[i]], distances[i],
+                           tables, Debug);
+    }
   }
 
   if (PrintFeatureMatchesOn(Debug)) {
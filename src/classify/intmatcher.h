@@ -50,10 +50,12 @@ struct CP_RESULT_STRUCT {
 #define  SE_TABLE_BITS    9
 #define  SE_TABLE_SIZE  512
 
+// The arrays are aligned for the SIMD loads and stores that the compiler
+// generates for the loops over them.
 struct ScratchEvidence {
-  uint8_t feature_evidence_[MAX_NUM_CONFIGS];
-  int sum_feature_evidence_[MAX_NUM_CONFIGS];
-  uint8_t proto_evidence_[MAX_NUM_PROTOS][MAX_PROTO_INDEX];
+  alignas(32) uint8_t feature_evidence_[MAX_NUM_CONFIGS];
+  alignas(32) int sum_feature_evidence_[MAX_NUM_CONFIGS];
+  alignas(32) uint8_t proto_evidence_[MAX_NUM_PROTOS][MAX_PROTO_INDEX];
 
   void Clear(const INT_CLASS class_template);
   void ClearFeatureEvidence(const INT_CLASS class_template);
@@ -112,6 +114,11 @@ class IntegerMatcher {
                       int Debug);
 
  private:
+  void UpdateTablesForProto(INT_CLASS ClassTemplate, BIT_VECTOR ConfigMask,
+                            int FeatureNum, uint32_t proto_num,
+                            INT_PROTO Proto, uint32_t distance,
+                            ScratchEvidence *tables, int Debug);
+
   int UpdateTablesForFeature(
       INT_CLASS ClassTemplate,
       BIT_VECTOR ProtoMask,
@@ -715,6 +715,38 @@ void free_int_templates(INT_TEMPLATES templates) {
   Efree(templates);
 }
 
+/*---------------------------------------------------------------------------*/
+/**
+ * This routine makes a deep copy of a set of integer templates.
+ * @param templates  templates to copy
+ * @return The new integer templates.
+ * @note Globals: none
+ */
+INT_TEMPLATES CopyIntTemplates(const INT_TEMPLATES_STRUCT* templates) {
+  INT_TEMPLATES T = NewIntTemplates();
+  T->NumClasses = templates->NumClasses;
+  T->NumClassPruners = templates->NumClassPruners;
+  for (int i = 0; i < templates->NumClasses; i++) {
+    const INT_CLASS_STRUCT* src = templates->Class[i];
+    auto Class = static_cast<INT_CLASS>(Emalloc(sizeof(INT_CLASS_STRUCT)));
+    *Class = *src;
+    for (int j = 0; j < src->NumProtoSets; j++) {
+      Class->ProtoSets[j] =
+          static_cast<PROTO_SET>(Emalloc(sizeof(PROTO_SET_STRUCT)));
+      memcpy(Class->ProtoSets[j], src->ProtoSets[j], sizeof(PROTO_SET_STRUCT));
+    }
+    if (src->ProtoLengths != nullptr) {
+      int size = MaxNumIntProtosIn(src) * sizeof(uint8_t);
+      Class->ProtoLengths = static_cast<uint8_t*>(Emalloc(size));
+      memcpy(Class->ProtoLengths, src->ProtoLengths, size);
+    }
+    ClassForClassId(T, i) = Class;
+  }
+  for (int i = 0; i < templates->NumClassPruners; i++)
+    T->ClassPruners[i] = new CLASS_PRUNER_STRUCT(*templates->ClassPruners[i]);
+  return T;
+}                                /* CopyIntTemplates */
+
 /**
  * This routine reads a set of integer templates from
  * File.  File must already be open and must be in the
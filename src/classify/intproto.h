@@ -237,6 +237,8 @@ INT_TEMPLATES NewIntTemplates();
 
 void free_int_templates(INT_TEMPLATES templates);
 
+INT_TEMPLATES CopyIntTemplates(const INT_TEMPLATES_STRUCT* templates);
+
 void ShowMatchDisplay();
 
 // Clears the given window and draws the featurespace guides for the
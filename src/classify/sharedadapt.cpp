@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////
+// File:        sharedadapt.cpp
+// Description: Adapted templates shared by the page workers of a document.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifdef HAVE_CONFIG_H
+#include "config_auto.h"
+#endif
+
+#include "sharedadapt.h"
+
+namespace tesseract {
+
+std::shared_ptr<ADAPT_TEMPLATES_STRUCT> SharedAdaptedTemplates::MakeShared(
+    ADAPT_TEMPLATES templates) {
+  return std::shared_ptr<ADAPT_TEMPLATES_STRUCT>(
+      templates, [](ADAPT_TEMPLATES templates) {
+        if (templates != nullptr) free_adapted_templates(templates);
+      });
+}
+
+void SharedAdaptedTemplates::Update(
+    const std::function<void(ADAPT_TEMPLATES*)>& learn) {
+  std::lock_guard<std::mutex> update_lock(update_mutex_);
+  std::shared_ptr<ADAPT_TEMPLATES_STRUCT> master;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (templates_.use_count() <= 1) {
+      // No reader is copying the master, and none can start to, so it is
+      // changed in place.
+      ADAPT_TEMPLATES templates = templates_.get();
+      learn(&templates);
+      if (templates != templates_.get()) templates_ = MakeShared(templates);
+      ++version_;
+      return;
+    }
+    master = templates_;
+  }
+  // Learn on a copy. The master cannot change meanwhile, as this is the only
+  // writer.
+  ADAPT_TEMPLATES templates = CopyAdaptedTemplates(master.get());
+  learn(&templates);
+  std::shared_ptr<ADAPT_TEMPLATES_STRUCT> copy = MakeShared(templates);
+  std::lock_guard<std::mutex> lock(mutex_);
+  templates_.swap(copy);
+  ++version_;
+  // The old master goes with the last reader to let go of it.
+}
+
+ADAPT_TEMPLATES SharedAdaptedTemplates::UpdatedCopy(int* version) {
+  std::shared_ptr<ADAPT_TEMPLATES_STRUCT> master;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (templates_ == nullptr || version_ == *version) return nullptr;
+    master = templates_;
+    *version = version_;
+  }
+  ADAPT_TEMPLATES copy = CopyAdaptedTemplates(master.get());
+  {
+    // A reference to the current master is dropped under the lock, which
+    // lets a writer change the master after the copy is done.
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (master == templates_) master.reset();
+  }
+  return copy;
+}
+
+int SharedAdaptedTemplates::version() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return version_;
+}
+
+}  // namespace tesseract.
@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////
+// File:        sharedadapt.h
+// Description: Adapted templates shared by the page workers of a document.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_CLASSIFY_SHAREDADAPT_H_
+#define TESSERACT_CLASSIFY_SHAREDADAPT_H_
+
+#include <functional>  // for std::function
+#include <memory>      // for std::shared_ptr
+#include <mutex>       // for std::mutex
+
+#include "adaptive.h"  // for ADAPT_TEMPLATES
+
+namespace tesseract {
+
+// The adapted templates of a document, shared by several Classify
+// instances (one per page worker) of the same language, so that what one
+// worker learns helps the others.
+// Each worker keeps adapting its own private templates, without locking,
+// and also replays every learning event on the shared master templates,
+// which serializes the writers. At the start of a page, a worker whose
+// copy is out of date replaces it with a copy of the master.
+// The master is copy on write: a reader takes a reference to it under the
+// lock and copies it without the lock. A writer changes the master in
+// place if no reader is copying it, and otherwise learns on a copy of its
+// own, also made without the lock, which then becomes the master. The old
+// master lives on until its last reader has finished with it.
+// The master is never reset. Once a class of it is full, as when
+// Classify::MakeNewTemporaryConfig runs out of configs or protos, the
+// master learns no more of that class, and neither does any worker after
+// its next update, because its copy is full too. Switching to the backup
+// templates when a worker's templates are full only lasts until then. So
+// learning of a full class stops for the rest of the document, until the
+// sharing ends with ClearAdaptiveClassifier.
+// All the methods may be called from several threads at once.
+class SharedAdaptedTemplates {
+ public:
+  SharedAdaptedTemplates() = default;
+  SharedAdaptedTemplates(const SharedAdaptedTemplates&) = delete;
+  SharedAdaptedTemplates& operator=(const SharedAdaptedTemplates&) = delete;
+
+  // Calls learn with a pointer to the master templates, which it may
+  // change, or create if nullptr, and counts a new version of them.
+  void Update(const std::function<void(ADAPT_TEMPLATES*)>& learn);
+  // If the master templates have changed since *version, returns a new copy
+  // of them, and sets *version to the version of the copy. Otherwise
+  // returns nullptr.
+  ADAPT_TEMPLATES UpdatedCopy(int* version);
+
+  // Number of learning events applied to the master templates.
+  int version() const;
+
+ private:
+  // Makes a reference that frees templates when the last copy goes.
+  static std::shared_ptr<ADAPT_TEMPLATES_STRUCT> MakeShared(
+      ADAPT_TEMPLATES templates);
+
+  // Serializes the writers.
+  std::mutex update_mutex_;
+  // Guards templates_, version_ and the number of references to the current
+  // master, which are only taken and dropped under it, so that a writer
+  // holding it can tell whether a reader is copying the master.
+  mutable std::mutex mutex_;
+  // The master templates.
+  std::shared_ptr<ADAPT_TEMPLATES_STRUCT> templates_;
+  // Incremented for each change to templates_.
+  int version_ = 0;
+};
+
+}  // namespace tesseract.
+
+#endif  // TESSERACT_CLASSIFY_SHAREDADAPT_H_
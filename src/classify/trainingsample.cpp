@@ -106,6 +106,7 @@ bool TrainingSample::DeSerialize(bool swap, FILE* fp) {
   if (num_micro_features_ > UINT16_MAX) return false;
   delete [] features_;
   features_ = new INT_FEATURE_STRUCT[num_features_];
+  features_capacity_ = 0;
   if (fread(features_, sizeof(*features_), num_features_, fp)
       != num_features_)
     return false;
@@ -128,25 +129,38 @@ TrainingSample* TrainingSample::CopyFromFeatures(
     const INT_FEATURE_STRUCT* features,
     int num_features) {
   auto* sample = new TrainingSample;
-  sample->num_features_ = num_features;
-  sample->features_ = new INT_FEATURE_STRUCT[num_features];
-  sample->outline_length_ = fx_info.Length;
-  memcpy(sample->features_, features, num_features * sizeof(features[0]));
-  sample->geo_feature_[GeoBottom] = bounding_box.bottom();
-  sample->geo_feature_[GeoTop] = bounding_box.top();
-  sample->geo_feature_[GeoWidth] = bounding_box.width();
+  sample->SetFromFeatures(fx_info, bounding_box, features, num_features);
+  return sample;
+}
+
+// As CopyFromFeatures, but into this sample, whose features array is
+// reused if it was made by an earlier call and is big enough.
+void TrainingSample::SetFromFeatures(const INT_FX_RESULT_STRUCT& fx_info,
+                                     const TBOX& bounding_box,
+                                     const INT_FEATURE_STRUCT* features,
+                                     int num_features) {
+  if (features_capacity_ < static_cast<uint32_t>(num_features)) {
+    delete [] features_;
+    features_ = new INT_FEATURE_STRUCT[num_features];
+    features_capacity_ = num_features;
+  }
+  num_features_ = num_features;
+  outline_length_ = fx_info.Length;
+  memcpy(features_, features, num_features * sizeof(features[0]));
+  geo_feature_[GeoBottom] = bounding_box.bottom();
+  geo_feature_[GeoTop] = bounding_box.top();
+  geo_feature_[GeoWidth] = bounding_box.width();
 
   // Generate the cn_feature_ from the fx_info.
-  sample->cn_feature_[CharNormY] =
+  cn_feature_[CharNormY] =
       MF_SCALE_FACTOR * (fx_info.Ymean - kBlnBaselineOffset);
-  sample->cn_feature_[CharNormLength] =
+  cn_feature_[CharNormLength] =
       MF_SCALE_FACTOR * fx_info.Length / LENGTH_COMPRESSION;
-  sample->cn_feature_[CharNormRx] = MF_SCALE_FACTOR * fx_info.Rx;
-  sample->cn_feature_[CharNormRy] = MF_SCALE_FACTOR * fx_info.Ry;
+  cn_feature_[CharNormRx] = MF_SCALE_FACTOR * fx_info.Rx;
+  cn_feature_[CharNormRy] = MF_SCALE_FACTOR * fx_info.Ry;
 
-  sample->features_are_indexed_ = false;
-  sample->features_are_mapped_ = false;
-  return sample;
+  features_are_indexed_ = false;
+  features_are_mapped_ = false;
 }
 
 // Returns the cn_feature as a FEATURE_STRUCT* needed by cntraining.
@@ -209,6 +223,7 @@ void TrainingSample::ExtractCharDesc(int int_feature_type,
                                      CHAR_DESC_STRUCT* char_desc) {
   // Extract the INT features.
   delete[] features_;
+  features_capacity_ = 0;
   FEATURE_SET_STRUCT* char_features = char_desc->FeatureSets[int_feature_type];
   if (char_features == nullptr) {
     tprintf("Error: no features to train on of type %s\n",
@@ -58,7 +58,7 @@ class TrainingSample : public ELIST_LINK {
       features_(nullptr), micro_features_(nullptr), weight_(1.0),
       max_dist_(0.0), sample_index_(0),
       features_are_indexed_(false), features_are_mapped_(false),
-      is_error_(false) {
+      is_error_(false), features_capacity_(0) {
   }
   ~TrainingSample();
 
@@ -68,6 +68,11 @@ class TrainingSample : public ELIST_LINK {
                                           const TBOX& bounding_box,
                                           const INT_FEATURE_STRUCT* features,
                                           int num_features);
+  // As CopyFromFeatures, but into this sample, whose features array is
+  // reused if it was made by an earlier call and is big enough.
+  void SetFromFeatures(const INT_FX_RESULT_STRUCT& fx_info,
+                       const TBOX& bounding_box,
+                       const INT_FEATURE_STRUCT* features, int num_features);
   // Returns the cn_feature as a FEATURE_STRUCT* needed by cntraining.
   FEATURE_STRUCT* GetCNFeature() const;
   // Constructs and returns a copy "randomized" by the method given by
@@ -237,6 +242,8 @@ class TrainingSample : public ELIST_LINK {
   bool features_are_mapped_;
   // True if the last classification was an error by the current definition.
   bool is_error_;
+  // Size of the features_ array if made by SetFromFeatures, otherwise 0.
+  uint32_t features_capacity_;
 
   // Randomizing factors.
   static const int kYShiftValues[kSampleYShiftSize];
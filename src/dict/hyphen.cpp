@@ -18,6 +18,7 @@
  *****************************************************************************/
 
 #include "dict.h"
+#include "pagearena.h"
 
 namespace tesseract {
 
@@ -44,6 +45,9 @@ void Dict::reset_hyphen_vars(bool last_word_on_line) {
 void Dict::set_hyphen_word(const WERD_CHOICE &word,
                            const DawgPositionVector &active_dawgs) {
   if (hyphen_word_ == nullptr) {
+    // The hyphen word is kept for the next page, so it is not in the arena
+    // of this one, which it would keep alive.
+    PageArena::Scope heap_scope(nullptr);
     hyphen_word_ = new WERD_CHOICE(word.unicharset());
     hyphen_word_->make_bad();
   }
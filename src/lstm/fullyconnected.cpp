@@ -320,4 +320,25 @@ void FullyConnected::CountAlternators(const Network& other, double* same,
   weights_.CountAlternators(fc->weights_, same, changed);
 }
 
+// Zeroes the weight deltas computed by Backward, keeping the momentum.
+void FullyConnected::ZeroDeltas() {
+  weights_.ZeroDeltas();
+}
+
+// Adds the weight deltas of other, which must have the same structure, to
+// the deltas of *this.
+void FullyConnected::AddDeltas(const Network& other) {
+  ASSERT_HOST(other.type() == type_);
+  const auto* fc = static_cast<const FullyConnected*>(&other);
+  weights_.AddDeltas(fc->weights_);
+}
+
+// Copies the weights of other, which must have the same structure, into
+// *this, leaving the deltas and momentum alone.
+void FullyConnected::CopyWeights(const Network& other) {
+  ASSERT_HOST(other.type() == type_);
+  const auto* fc = static_cast<const FullyConnected*>(&other);
+  weights_.CopyWeights(fc->weights_);
+}
+
 }  // namespace tesseract.
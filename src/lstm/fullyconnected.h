@@ -112,6 +112,14 @@ class FullyConnected : public Network {
   // *changed.
   void CountAlternators(const Network& other, double* same,
                         double* changed) const override;
+  // Zeroes the weight deltas computed by Backward, keeping the momentum.
+  void ZeroDeltas() override;
+  // Adds the weight deltas of other, which must have the same structure, to
+  // the deltas of *this.
+  void AddDeltas(const Network& other) override;
+  // Copies the weights of other, which must have the same structure, into
+  // *this, leaving the deltas and momentum alone.
+  void CopyWeights(const Network& other) override;
 
  protected:
   // Weight arrays of size [no, ni + 1].
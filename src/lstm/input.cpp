@@ -101,15 +101,9 @@ Pix* Input::PrepareLSTMInputs(const ImageData& image_data,
   return pix;
 }
 
-// Converts the given pix to a NetworkIO of height and depth appropriate to the
-// given StaticShape:
-// If depth == 3, convert to 24 bit color, otherwise normalized grey.
-// Scale to target height, if the shape's height is > 1, or its depth if the
-// height == 1. If height == 0 then no scaling.
-// NOTE: It isn't safe for multiple threads to call this on the same pix.
-/* static */
-void Input::PreparePixInput(const StaticShape& shape, const Pix* pix,
-                            TRand* randomizer, NetworkIO* input) {
+// Returns a copy of the given pix converted to the depth and scaled to the
+// height appropriate to the given StaticShape, as for PreparePixInput.
+static Pix* NormalizePix(const StaticShape& shape, const Pix* pix) {
   bool color = shape.depth() == 3;
   Pix* var_pix = const_cast<Pix*>(pix);
   int depth = pixGetDepth(var_pix);
@@ -139,8 +133,35 @@ void Input::PreparePixInput(const StaticShape& shape, const Pix* pix,
     pixDestroy(&normed_pix);
     normed_pix = scaled_pix;
   }
+  return normed_pix;
+}
+
+// Converts the given pix to a NetworkIO of height and depth appropriate to the
+// given StaticShape:
+// If depth == 3, convert to 24 bit color, otherwise normalized grey.
+// Scale to target height, if the shape's height is > 1, or its depth if the
+// height == 1. If height == 0 then no scaling.
+// NOTE: It isn't safe for multiple threads to call this on the same pix.
+/* static */
+void Input::PreparePixInput(const StaticShape& shape, const Pix* pix,
+                            TRand* randomizer, NetworkIO* input) {
+  Pix* normed_pix = NormalizePix(shape, pix);
   input->FromPix(shape, normed_pix, randomizer);
   pixDestroy(&normed_pix);
 }
 
+// As PreparePixInput, but converts each of the given pixes to one item of a
+// batch in the NetworkIO.
+/* static */
+void Input::PreparePixInputs(const StaticShape& shape,
+                             const std::vector<const Pix*>& pixes,
+                             TRand* randomizer, NetworkIO* input) {
+  std::vector<Pix*> normed_pixes;
+  for (const Pix* pix : pixes) normed_pixes.push_back(NormalizePix(shape, pix));
+  input->FromPixes(shape, std::vector<const Pix*>(normed_pixes.begin(),
+                                                  normed_pixes.end()),
+                   randomizer);
+  for (Pix* normed_pix : normed_pixes) pixDestroy(&normed_pix);
+}
+
 }  // namespace tesseract.
@@ -18,6 +18,8 @@
 #ifndef TESSERACT_LSTM_INPUT_H_
 #define TESSERACT_LSTM_INPUT_H_
 
+#include <vector>
+
 #include "network.h"
 
 namespace tesseract {
@@ -90,6 +92,11 @@ class Input : public Network {
   // NOTE: It isn't safe for multiple threads to call this on the same pix.
   static void PreparePixInput(const StaticShape& shape, const Pix* pix,
                               TRand* randomizer, NetworkIO* input);
+  // As PreparePixInput, but converts each of the given pixes to one item of
+  // a batch in the NetworkIO.
+  static void PreparePixInputs(const StaticShape& shape,
+                               const std::vector<const Pix*>& pixes,
+                               TRand* randomizer, NetworkIO* input);
 
  private:
   void DebugWeights() override {
@@ -708,6 +708,39 @@ void LSTM::CountAlternators(const Network& other, double* same,
   }
 }
 
+// Zeroes the weight deltas computed by Backward, keeping the momentum.
+void LSTM::ZeroDeltas() {
+  for (int w = 0; w < WT_COUNT; ++w) {
+    if (w == GFS && !Is2D()) continue;
+    gate_weights_[w].ZeroDeltas();
+  }
+  if (softmax_ != nullptr) softmax_->ZeroDeltas();
+}
+
+// Adds the weight deltas of other, which must have the same structure, to
+// the deltas of *this.
+void LSTM::AddDeltas(const Network& other) {
+  ASSERT_HOST(other.type() == type_);
+  const LSTM* lstm = static_cast<const LSTM*>(&other);
+  for (int w = 0; w < WT_COUNT; ++w) {
+    if (w == GFS && !Is2D()) continue;
+    gate_weights_[w].AddDeltas(lstm->gate_weights_[w]);
+  }
+  if (softmax_ != nullptr) softmax_->AddDeltas(*lstm->softmax_);
+}
+
+// Copies the weights of other, which must have the same structure, into
+// *this, leaving the deltas and momentum alone.
+void LSTM::CopyWeights(const Network& other) {
+  ASSERT_HOST(other.type() == type_);
+  const LSTM* lstm = static_cast<const LSTM*>(&other);
+  for (int w = 0; w < WT_COUNT; ++w) {
+    if (w == GFS && !Is2D()) continue;
+    gate_weights_[w].CopyWeights(lstm->gate_weights_[w]);
+  }
+  if (softmax_ != nullptr) softmax_->CopyWeights(*lstm->softmax_);
+}
+
 // Prints the weights for debug purposes.
 void LSTM::PrintW() {
   tprintf("Weight state:%s\n", name_.c_str());
@@ -109,6 +109,14 @@ class LSTM : public Network {
   // *changed.
   void CountAlternators(const Network& other, double* same,
                         double* changed) const override;
+  // Zeroes the weight deltas computed by Backward, keeping the momentum.
+  void ZeroDeltas() override;
+  // Adds the weight deltas of other, which must have the same structure, to
+  // the deltas of *this.
+  void AddDeltas(const Network& other) override;
+  // Copies the weights of other, which must have the same structure, into
+  // *this, leaving the deltas and momentum alone.
+  void CopyWeights(const Network& other) override;
   // Prints the weights for debug purposes.
   void PrintW();
   // Prints the weight deltas for debug purposes.
@@ -263,26 +263,8 @@ bool LSTMRecognizer::RecognizeLine(const ImageData& image_data, bool invert,
                                    bool debug, bool re_invert, bool upside_down,
                                    float* scale_factor, NetworkIO* inputs,
                                    NetworkIO* outputs) {
-  // This ensures consistent recognition results.
-  SetRandomSeed();
-  int min_width = network_->XScaleFactor();
-  Pix* pix = Input::PrepareLSTMInputs(image_data, network_, min_width,
-                                      &randomizer_, scale_factor);
-  if (pix == nullptr) {
-    tprintf("Line cannot be recognized!!\n");
-    return false;
-  }
-  // Maximum width of image to train on.
-  const int kMaxImageWidth = 128 * pixGetHeight(pix);
-  if (network_->IsTraining() && pixGetWidth(pix) > kMaxImageWidth) {
-    tprintf("Image too large to learn!! Size = %dx%d\n", pixGetWidth(pix),
-            pixGetHeight(pix));
-    pixDestroy(&pix);
-    return false;
-  }
-  if (upside_down) pixRotate180(pix, pix);
-  // Reduction factor from image to coords.
-  *scale_factor = min_width / *scale_factor;
+  Pix* pix = PrepareLineImage(image_data, upside_down, scale_factor);
+  if (pix == nullptr) return false;
   inputs->set_int_mode(IsIntMode());
   SetRandomSeed();
   Input::PreparePixInput(network_->InputShape(), pix, &randomizer_, inputs);
@@ -329,6 +311,35 @@ bool LSTMRecognizer::RecognizeLine(const ImageData& image_data, bool invert,
   return true;
 }
 
+// Returns the image of the line in image_data, scaled for the network and
+// rotated if upside_down, or nullptr if it cannot be recognized or, when
+// training, is too wide to learn. Returned in scale_factor is the reduction
+// factor between the image and the output coords.
+Pix* LSTMRecognizer::PrepareLineImage(const ImageData& image_data,
+                                      bool upside_down, float* scale_factor) {
+  // This ensures consistent recognition results.
+  SetRandomSeed();
+  int min_width = network_->XScaleFactor();
+  Pix* pix = Input::PrepareLSTMInputs(image_data, network_, min_width,
+                                      &randomizer_, scale_factor);
+  if (pix == nullptr) {
+    tprintf("Line cannot be recognized!!\n");
+    return nullptr;
+  }
+  // Maximum width of image to train on.
+  const int kMaxImageWidth = 128 * pixGetHeight(pix);
+  if (network_->IsTraining() && pixGetWidth(pix) > kMaxImageWidth) {
+    tprintf("Image too large to learn!! Size = %dx%d\n", pixGetWidth(pix),
+            pixGetHeight(pix));
+    pixDestroy(&pix);
+    return nullptr;
+  }
+  if (upside_down) pixRotate180(pix, pix);
+  // Reduction factor from image to coords.
+  *scale_factor = min_width / *scale_factor;
+  return pix;
+}
+
 // Converts an array of labels to utf-8, whether or not the labels are
 // augmented with character boundaries.
 STRING LSTMRecognizer::DecodeLabels(const GenericVector<int>& labels) {
@@ -195,6 +195,13 @@ class LSTMRecognizer {
   bool RecognizeLine(const ImageData& image_data, bool invert, bool debug,
                      bool re_invert, bool upside_down, float* scale_factor,
                      NetworkIO* inputs, NetworkIO* outputs);
+  // Returns the image of the line in image_data, scaled for the network and
+  // rotated if upside_down, or nullptr if it cannot be recognized or, when
+  // training, is too wide to learn. Returned in scale_factor is the reduction
+  // factor between the image and the output coords.
+  // Virtual, so that the trainer can augment the image.
+  virtual Pix* PrepareLineImage(const ImageData& image_data, bool upside_down,
+                                float* scale_factor);
 
   // Converts an array of labels to utf-8, whether or not the labels are
   // augmented with character boundaries.
@@ -235,6 +235,15 @@ class Network {
   // *changed.
   virtual void CountAlternators(const Network& other, double* same,
                                 double* changed) const {}
+  // Zeroes the weight deltas computed by Backward, keeping the momentum.
+  virtual void ZeroDeltas() {}
+  // Adds the weight deltas of other, which must have the same structure, to
+  // the deltas of *this, so several networks can be trained on different
+  // samples with a single Update.
+  virtual void AddDeltas(const Network& other) {}
+  // Copies the weights of other, which must have the same structure, into
+  // *this, leaving the deltas and momentum alone.
+  virtual void CopyWeights(const Network& other) {}
 
   // Reads from the given file. Returns nullptr in case of error.
   // Determines the type of the serialized class and calls its DeSerialize
@@ -911,6 +911,32 @@ void NetworkIO::CopyWithXYTranspose(const NetworkIO& src) {
            dest_b_index.AddOffset(1, FD_BATCH));
 }
 
+// Copies the time steps of the given batch item of src to *this, which
+// becomes a single item array of the same height and width.
+void NetworkIO::CopyBatchItemFrom(const NetworkIO& src, int batch) {
+  StrideMap::Index index(src.stride_map_, batch, 0, 0);
+  int height = index.MaxIndexOfDim(FD_HEIGHT) + 1;
+  int width = index.MaxIndexOfDim(FD_WIDTH) + 1;
+  StrideMap item_map;
+  item_map.SetStride({std::make_pair(height, width)});
+  ResizeToMap(src.int_mode(), item_map, src.NumFeatures());
+  int t = 0;
+  do {
+    CopyTimeStepFrom(t++, src, index.t());
+  } while (index.Increment() && index.index(FD_BATCH) == batch);
+}
+
+// Copies *this, as made by CopyBatchItemFrom, back to the time steps of the
+// given batch item of dest.
+void NetworkIO::CopyBatchItemTo(int batch, NetworkIO* dest) const {
+  StrideMap::Index index(dest->stride_map_, batch, 0, 0);
+  int t = 0;
+  do {
+    dest->CopyTimeStepFrom(index.t(), *this, t++);
+  } while (index.Increment() && index.index(FD_BATCH) == batch);
+  ASSERT_HOST(t == Width());
+}
+
 // Copies src to *this, at the given feature_offset, returning the total
 // feature offset after the copy. Multiple calls will stack outputs from
 // multiple sources in feature space.
@@ -238,6 +238,12 @@ class NetworkIO {
   void CopyWithXReversal(const NetworkIO& src);
   // Copies src to *this with independent transpose of the x and y dimensions.
   void CopyWithXYTranspose(const NetworkIO& src);
+  // Copies the time steps of the given batch item of src to *this, which
+  // becomes a single item array of the same height and width.
+  void CopyBatchItemFrom(const NetworkIO& src, int batch);
+  // Copies *this, as made by CopyBatchItemFrom, back to the time steps of the
+  // given batch item of dest.
+  void CopyBatchItemTo(int batch, NetworkIO* dest) const;
   // Copies src to *this, at the given feature_offset, returning the total
   // feature offset after the copy. Multiple calls will stack outputs from
   // multiple sources in feature space.
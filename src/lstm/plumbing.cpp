@@ -240,4 +240,33 @@ void Plumbing::CountAlternators(const Network& other, double* same,
     stack_[i]->CountAlternators(*plumbing->stack_[i], same, changed);
 }
 
+// Zeroes the weight deltas computed by Backward, keeping the momentum.
+void Plumbing::ZeroDeltas() {
+  for (int i = 0; i < stack_.size(); ++i) {
+    if (stack_[i]->IsTraining()) stack_[i]->ZeroDeltas();
+  }
+}
+
+// Adds the weight deltas of other, which must have the same structure, to
+// the deltas of *this.
+void Plumbing::AddDeltas(const Network& other) {
+  ASSERT_HOST(other.type() == type_);
+  const auto* plumbing = static_cast<const Plumbing*>(&other);
+  ASSERT_HOST(plumbing->stack_.size() == stack_.size());
+  for (int i = 0; i < stack_.size(); ++i) {
+    if (stack_[i]->IsTraining()) stack_[i]->AddDeltas(*plumbing->stack_[i]);
+  }
+}
+
+// Copies the weights of other, which must have the same structure, into
+// *this, leaving the deltas and momentum alone.
+void Plumbing::CopyWeights(const Network& other) {
+  ASSERT_HOST(other.type() == type_);
+  const auto* plumbing = static_cast<const Plumbing*>(&other);
+  ASSERT_HOST(plumbing->stack_.size() == stack_.size());
+  for (int i = 0; i < stack_.size(); ++i) {
+    if (stack_[i]->IsTraining()) stack_[i]->CopyWeights(*plumbing->stack_[i]);
+  }
+}
+
 }  // namespace tesseract.
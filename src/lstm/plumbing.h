@@ -129,6 +129,14 @@ class Plumbing : public Network {
   // *changed.
   void CountAlternators(const Network& other, double* same,
                         double* changed) const override;
+  // Zeroes the weight deltas computed by Backward, keeping the momentum.
+  void ZeroDeltas() override;
+  // Adds the weight deltas of other, which must have the same structure, to
+  // the deltas of *this.
+  void AddDeltas(const Network& other) override;
+  // Copies the weights of other, which must have the same structure, into
+  // *this, leaving the deltas and momentum alone.
+  void CopyWeights(const Network& other) override;
 
  protected:
   // The networks.
@@ -17,11 +17,13 @@
 
 #include "weightmatrix.h"
 
+#include <algorithm>            // for std::max, std::min
 #include <cassert>              // for assert
 #include "intsimdmatrix.h"
-#include "simddetect.h"         // for DotProduct
+#include "simddetect.h"         // for DotProduct, AdamUpdateWeights, ...
 #include "statistc.h"
 #include "tprintf.h"
+#include "weightupdate.h"       // for WeightUpdateParams
 
 namespace tesseract {
 
@@ -35,6 +37,15 @@ static inline double log2(double n) {
 const int kAdamCorrectionIterations = 200000;
 // Epsilon in Adam to prevent division by zero.
 const double kAdamEpsilon = 1e-8;
+// Number of rows of u and of v in a block of SumOuterTransposed. The rows of
+// a block are reused while they are in the cache.
+const int kOuterBlockSize = 8;
+// Min number of weights in a matrix for Update to use multiple threads.
+const int kMinParallelUpdateSize = 1 << 16;
+
+INT_VAR(weight_matrix_threads, 4,
+        "Number of threads to compute the deltas and updates of each large"
+        " weight matrix in training");
 
 // Computes matrix.vector v = Wu.
 // u is of size W.dim2() - add_bias_fwd and the output v is of size
@@ -313,19 +324,33 @@ void WeightMatrix::SumOuterTransposed(const TransposedArray& u,
   int num_samples = u.dim2();
   // v is missing the last element in dim1.
   assert(v.dim1() == num_inputs);
+  int num_blocks = (num_outputs + kOuterBlockSize - 1) / kOuterBlockSize;
 #ifdef _OPENMP
-#pragma omp parallel for num_threads(4) if (in_parallel)
+  // OpenMP rejects a num_threads that is not positive.
+  int num_threads = std::max(1, static_cast<int>(weight_matrix_threads));
+#pragma omp parallel for num_threads(num_threads) schedule(dynamic) \
+    if (in_parallel)
 #endif
-  for (int i = 0; i < num_outputs; ++i) {
-    double* dwi = dw_[i];
-    const double* ui = u[i];
-    for (int j = 0; j < num_inputs; ++j) {
-      dwi[j] = DotProduct(ui, v[j], num_samples);
+  for (int b = 0; b < num_blocks; ++b) {
+    int start = b * kOuterBlockSize;
+    int end = std::min(start + kOuterBlockSize, num_outputs);
+    for (int j_start = 0; j_start < num_inputs; j_start += kOuterBlockSize) {
+      int j_end = std::min(j_start + kOuterBlockSize, num_inputs);
+      for (int i = start; i < end; ++i) {
+        double* dwi = dw_[i];
+        const double* ui = u[i];
+        for (int j = j_start; j < j_end; ++j) {
+          dwi[j] = DotProduct(ui, v[j], num_samples);
+        }
+      }
+    }
+    for (int i = start; i < end; ++i) {
+      // The last element of v is missing, presumed 1.0f.
+      const double* ui = u[i];
+      double total = 0.0;
+      for (int k = 0; k < num_samples; ++k) total += ui[k];
+      dw_[i][num_inputs] = total;
     }
-    // The last element of v is missing, presumed 1.0f.
-    double total = 0.0;
-    for (int k = 0; k < num_samples; ++k) total += ui[k];
-    dwi[num_inputs] = total;
   }
 }
 
@@ -339,17 +364,26 @@ void WeightMatrix::Update(double learning_rate, double momentum,
     learning_rate *= sqrt(1.0 - pow(adam_beta, num_samples));
     learning_rate /= 1.0 - pow(momentum, num_samples);
   }
-  if (use_adam_ && num_samples > 0 && momentum > 0.0) {
-    dw_sq_sum_.SumSquares(dw_, adam_beta);
-    dw_ *= learning_rate * (1.0 - momentum);
-    updates_ *= momentum;
-    updates_ += dw_;
-    wf_.AdamUpdate(updates_, dw_sq_sum_, learning_rate * kAdamEpsilon);
-  } else {
-    dw_ *= learning_rate;
-    updates_ += dw_;
-    if (momentum > 0.0) wf_ += updates_;
-    if (momentum >= 0.0) updates_ *= momentum;
+  bool adam = use_adam_ && num_samples > 0 && momentum > 0.0;
+  WeightUpdateParams params;
+  params.dw_scale = adam ? learning_rate * (1.0 - momentum) : learning_rate;
+  params.momentum = momentum;
+  params.beta = adam_beta;
+  params.epsilon = learning_rate * kAdamEpsilon;
+  int num_rows = wf_.dim1();
+  int row_size = wf_.dim2();
+#ifdef _OPENMP
+  int num_threads = std::max(1, static_cast<int>(weight_matrix_threads));
+#pragma omp parallel for num_threads(num_threads) \
+    if (wf_.num_elements() >= kMinParallelUpdateSize)
+#endif
+  for (int i = 0; i < num_rows; ++i) {
+    if (adam) {
+      AdamUpdateWeights(params, row_size, dw_[i], updates_[i], dw_sq_sum_[i],
+                        wf_[i]);
+    } else {
+      MomentumUpdateWeights(params, row_size, dw_[i], updates_[i], wf_[i]);
+    }
   }
   wf_t_.Transpose(wf_);
 }
@@ -361,6 +395,16 @@ void WeightMatrix::AddDeltas(const WeightMatrix& other) {
   dw_ += other.dw_;
 }
 
+// Copies the weights of other, which must be the same shape, into *this,
+// leaving the deltas and updates alone.
+void WeightMatrix::CopyWeights(const WeightMatrix& other) {
+  assert(!int_mode_ && !other.int_mode_);
+  assert(wf_.dim1() == other.wf_.dim1());
+  assert(wf_.dim2() == other.wf_.dim2());
+  wf_ = other.wf_;
+  wf_t_ = other.wf_t_;
+}
+
 // Sums the products of weight updates in *this and other, splitting into
 // positive (same direction) in *same and negative (different direction) in
 // *changed.
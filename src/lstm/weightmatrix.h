@@ -22,10 +22,16 @@
 #include <vector>
 #include "intsimdmatrix.h"
 #include "matrix.h"
+#include "params.h"
 #include "tprintf.h"
 
 namespace tesseract {
 
+// Number of threads for the outer products and updates of a weight matrix.
+extern INT_VAR_H(weight_matrix_threads, 4,
+                 "Number of threads to compute the deltas and updates of each"
+                 " large weight matrix in training");
+
 // Convenience instantiation of GENERIC_2D_ARRAY<double> with additional
 // operations to write a strided vector, so the transposed form of the input
 // is memory-contiguous.
@@ -134,15 +140,23 @@ class WeightMatrix {
   // Fills dw_[i][j] with the dot product u[i][] . v[j][], using elements
   // from u and v, starting with u[i][offset] and v[j][offset].
   // Note that (matching MatrixDotVector) v[last][] is missing, presumed 1.0.
-  // Runs parallel if requested. Note that inputs must be transposed.
+  // Runs parallel on weight_matrix_threads if requested, on blocks of rows of
+  // u and v that stay in the cache. Note that inputs must be transposed.
   void SumOuterTransposed(const TransposedArray& u, const TransposedArray& v,
                           bool parallel);
   // Updates the weights using the given learning rate, momentum and adam_beta.
   // num_samples is used in the Adam correction factor.
+  // All the arrays are updated in a single pass by the best SIMD kernel, on
+  // weight_matrix_threads if the matrix is large.
   void Update(double learning_rate, double momentum, double adam_beta,
               int num_samples);
+  // Zeroes the deltas (dw_), leaving the momentum in updates_ alone.
+  void ZeroDeltas() { dw_.Clear(); }
   // Adds the dw_ in other to the dw_ is *this.
   void AddDeltas(const WeightMatrix& other);
+  // Copies the weights of other, which must be the same shape, into *this,
+  // leaving the deltas and updates alone.
+  void CopyWeights(const WeightMatrix& other);
   // Sums the products of weight updates in *this and other, splitting into
   // positive (same direction) in *same and negative (different direction) in
   // *changed.
@@ -27,6 +27,7 @@
 #include <algorithm>
 #include <cfloat>               // for FLT_MAX
 #include <cmath>                // for M_PI
+#include <vector>               // for std::vector
 #include "allheaders.h"
 #include "blobbox.h"
 #include "detlinefit.h"
@@ -817,13 +818,23 @@ BaselineDetect::BaselineDetect(int debug_level, const FCOORD& page_skew,
 // block-wise and page-wise data to smooth small blocks/rows, and applies
 // smoothing based on block/page-level skew and block-level linespacing.
 void BaselineDetect::ComputeStraightBaselines(bool use_box_bottoms) {
-  GenericVector<double> block_skew_angles;
+  // Each BaselineBlock holds all the scratch state for its own fitting, so
+  // the blocks can be fitted concurrently. The skew angles are gathered in
+  // block order afterwards, so the result does not depend on the threads.
+  std::vector<char> good_skew(blocks_.size(), false);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(BlockThreads()) schedule(dynamic)
+#endif  // _OPENMP
   for (int i = 0; i < blocks_.size(); ++i) {
     BaselineBlock* bl_block = blocks_[i];
     if (debug_level_ > 0)
       tprintf("Fitting initial baselines...\n");
-    if (bl_block->FitBaselinesAndFindSkew(use_box_bottoms)) {
-      block_skew_angles.push_back(bl_block->skew_angle());
+    good_skew[i] = bl_block->FitBaselinesAndFindSkew(use_box_bottoms);
+  }
+  GenericVector<double> block_skew_angles;
+  for (int i = 0; i < blocks_.size(); ++i) {
+    if (good_skew[i]) {
+      block_skew_angles.push_back(blocks_[i]->skew_angle());
     }
   }
   // Compute a page-wide default skew for blocks with too little information.
@@ -836,6 +847,9 @@ void BaselineDetect::ComputeStraightBaselines(bool use_box_bottoms) {
   }
   // Set bad lines in each block to the default block skew and then force fit
   // a linespacing model where it makes sense to do so.
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(BlockThreads()) schedule(dynamic)
+#endif  // _OPENMP
   for (int i = 0; i < blocks_.size(); ++i) {
     BaselineBlock* bl_block = blocks_[i];
     bl_block->ParallelizeBaselines(default_block_skew);
@@ -853,6 +867,9 @@ void BaselineDetect::ComputeBaselineSplinesAndXheights(const ICOORD& page_tr,
                                                        bool remove_noise,
                                                        bool show_final_rows,
                                                       Textord* textord) {
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(BlockThreads()) schedule(dynamic)
+#endif  // _OPENMP
   for (int i = 0; i < blocks_.size(); ++i) {
     BaselineBlock* bl_block = blocks_[i];
     if (enable_splines)
@@ -866,4 +883,12 @@ void BaselineDetect::ComputeBaselineSplinesAndXheights(const ICOORD& page_tr,
   }
 }
 
+// Returns the number of threads to use over blocks_. Debug output is kept
+// serial so that it stays readable.
+int BaselineDetect::BlockThreads() const {
+  if (debug_level_ > 0 || textord_show_final_rows)
+    return 1;
+  return textord_block_threads(blocks_.size());
+}
+
 }  // namespace tesseract.
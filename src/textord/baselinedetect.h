@@ -264,6 +264,10 @@ class BaselineDetect {
                                          Textord* textord);
 
  private:
+  // Returns the number of threads to use for the independent per-block
+  // fitting, as controlled by textord_parallel_blocks.
+  int BlockThreads() const;
+
   // Average (median) skew of the blocks on the page among those that have
   // a good angle of their own.
   FCOORD page_skew_;
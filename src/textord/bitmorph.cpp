@@ -0,0 +1,212 @@
+///////////////////////////////////////////////////////////////////////
+// File:        bitmorph.cpp
+// Description: Word-parallel brick morphology on packed 1bpp images.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifdef HAVE_CONFIG_H
+#include "config_auto.h"
+#endif
+
+#include "bitmorph.h"
+#include "allheaders.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+namespace tesseract {
+
+// Number of rows given to a thread at a time by the horizontal operations.
+const int kTileRows = 64;
+
+// Returns a mask of the bits of the last word of a row that are inside an
+// image of the given width.
+static l_uint32 LastWordMask(int width) {
+  int bits = width & 31;
+  return bits == 0 ? ~0u : ~0u << (32 - bits);
+}
+
+// Sets dst(x) = src(x + shift) for each pixel x of the row of wpl words,
+// with the pixels that come from outside the row OFF.
+static void ShiftRow(const l_uint32* src, int wpl, int shift, l_uint32* dst) {
+  int words = std::abs(shift) >> 5;
+  int bits = std::abs(shift) & 31;
+  if (shift >= 0) {
+    for (int i = 0; i < wpl; ++i) {
+      int j = i + words;
+      l_uint32 word = j < wpl ? src[j] << bits : 0;
+      if (bits > 0 && j + 1 < wpl) word |= src[j + 1] >> (32 - bits);
+      dst[i] = word;
+    }
+  } else {
+    for (int i = 0; i < wpl; ++i) {
+      int j = i - words;
+      l_uint32 word = j >= 0 ? src[j] >> bits : 0;
+      if (bits > 0 && j >= 1) word |= src[j - 1] << (32 - bits);
+      dst[i] = word;
+    }
+  }
+}
+
+// Combines src into dst with AND if use_and, or OR otherwise.
+static void CombineWords(bool use_and, const l_uint32* src, int count,
+                         l_uint32* dst) {
+  if (use_and) {
+    for (int i = 0; i < count; ++i) dst[i] &= src[i];
+  } else {
+    for (int i = 0; i < count; ++i) dst[i] |= src[i];
+  }
+}
+
+// Replaces each pixel (x, y) of the 1bpp pix with the AND (erosion) or OR
+// (dilation) of the pixels [x + lo, x + hi] of row y, where pixels outside
+// the image are OFF. After the k-th doubling pass, each bit holds the
+// result for the run of 2^k pixels starting at it, so a run of n pixels
+// needs only about log2(n) word shifts of the row. The row is copied into a
+// buffer with room on the left for the runs that start before the image.
+static void HorizontalRunOp(bool use_and, int lo, int hi, int num_threads,
+                            Pix* pix) {
+  int width = pixGetWidth(pix);
+  int height = pixGetHeight(pix);
+  int wpl = pixGetWpl(pix);
+  l_uint32* data = pixGetData(pix);
+  l_uint32 last_mask = LastWordMask(width);
+  int span = hi - lo + 1;
+  int pad = lo < 0 ? (31 - lo) / 32 : 0;
+  int buffer_wpl = wpl + pad;
+  int num_tiles = (height + kTileRows - 1) / kTileRows;
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(num_threads) schedule(dynamic)
+#endif  // _OPENMP
+  for (int tile = 0; tile < num_tiles; ++tile) {
+    std::vector<l_uint32> run(buffer_wpl);
+    std::vector<l_uint32> shifted(buffer_wpl);
+    int end_y = std::min(height, (tile + 1) * kTileRows);
+    for (int y = tile * kTileRows; y < end_y; ++y) {
+      l_uint32* line = data + y * wpl;
+      line[wpl - 1] &= last_mask;
+      // Blank rows are very common, and stay blank.
+      if (std::all_of(line, line + wpl, [](l_uint32 w) { return w == 0; }))
+        continue;
+      std::fill(run.begin(), run.begin() + pad, 0);
+      std::copy(line, line + wpl, run.begin() + pad);
+      int covered = 1;
+      while (covered * 2 <= span) {
+        ShiftRow(&run[0], buffer_wpl, covered, &shifted[0]);
+        CombineWords(use_and, &shifted[0], buffer_wpl, &run[0]);
+        covered *= 2;
+      }
+      if (covered < span) {
+        // Overlapping the last two runs is harmless for AND and OR.
+        ShiftRow(&run[0], buffer_wpl, span - covered, &shifted[0]);
+        CombineWords(use_and, &shifted[0], buffer_wpl, &run[0]);
+      }
+      ShiftRow(&run[0], buffer_wpl, lo, &shifted[0]);
+      std::copy(shifted.begin() + pad, shifted.end(), line);
+      line[wpl - 1] &= last_mask;
+    }
+  }
+}
+
+// As HorizontalRunOp, but over the pixels [y + lo, y + hi] of column x.
+// The doubling passes combine whole rows, so each word operation handles
+// 32 columns at once.
+static void VerticalRunOp(bool use_and, int lo, int hi, int num_threads,
+                          Pix* pix) {
+  int height = pixGetHeight(pix);
+  int wpl = pixGetWpl(pix);
+  l_uint32* data = pixGetData(pix);
+  int span = hi - lo + 1;
+  // Blank rows above the image for the runs that start before it.
+  int pad = std::max(0, -lo);
+  int buffer_height = height + pad;
+  std::vector<l_uint32> run(buffer_height * wpl);
+  std::copy(data, data + height * wpl, run.begin() + pad * wpl);
+  std::vector<l_uint32> next(buffer_height * wpl);
+  // Sets next[y] = run[y] op run[y + offset], then swaps next into run.
+  auto combine_rows = [&](int offset) {
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(num_threads) schedule(static)
+#endif  // _OPENMP
+    for (int y = 0; y < buffer_height; ++y) {
+      const l_uint32* src = &run[y * wpl];
+      l_uint32* dst = &next[y * wpl];
+      if (y + offset < buffer_height) {
+        std::copy(src, src + wpl, dst);
+        CombineWords(use_and, src + offset * wpl, wpl, dst);
+      } else if (use_and) {
+        std::fill(dst, dst + wpl, 0);
+      } else {
+        std::copy(src, src + wpl, dst);
+      }
+    }
+    run.swap(next);
+  };
+  int covered = 1;
+  while (covered * 2 <= span) {
+    combine_rows(covered);
+    covered *= 2;
+  }
+  if (covered < span) combine_rows(span - covered);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(num_threads) schedule(static)
+#endif  // _OPENMP
+  for (int y = 0; y < height; ++y) {
+    l_uint32* line = data + y * wpl;
+    int src_y = y + lo + pad;
+    if (src_y < buffer_height)
+      std::copy(&run[src_y * wpl], &run[src_y * wpl] + wpl, line);
+    else
+      std::fill(line, line + wpl, 0);
+  }
+}
+
+// Erodes pix in place with an hsize x vsize brick.
+static void ErodeBrick(int hsize, int vsize, int num_threads, Pix* pix) {
+  if (hsize > 1)
+    HorizontalRunOp(true, -(hsize / 2), hsize - 1 - hsize / 2, num_threads,
+                    pix);
+  if (vsize > 1)
+    VerticalRunOp(true, -(vsize / 2), vsize - 1 - vsize / 2, num_threads, pix);
+}
+
+// Dilates pix in place with an hsize x vsize brick. The window is the
+// reflection of the erosion window, so the origin cancels out in the
+// opening and closing.
+static void DilateBrick(int hsize, int vsize, int num_threads, Pix* pix) {
+  if (hsize > 1)
+    HorizontalRunOp(false, -(hsize - 1 - hsize / 2), hsize / 2, num_threads,
+                    pix);
+  if (vsize > 1)
+    VerticalRunOp(false, -(vsize - 1 - vsize / 2), vsize / 2, num_threads,
+                  pix);
+}
+
+Pix* OpenBrickPacked(Pix* pix, int hsize, int vsize, int num_threads) {
+  if (pix == nullptr || pixGetDepth(pix) != 1) return nullptr;
+  Pix* result = pixCopy(nullptr, pix);
+  ErodeBrick(hsize, vsize, num_threads, result);
+  DilateBrick(hsize, vsize, num_threads, result);
+  return result;
+}
+
+Pix* CloseBrickPacked(Pix* pix, int hsize, int vsize, int num_threads) {
+  if (pix == nullptr || pixGetDepth(pix) != 1) return nullptr;
+  Pix* result = pixCopy(nullptr, pix);
+  DilateBrick(hsize, vsize, num_threads, result);
+  ErodeBrick(hsize, vsize, num_threads, result);
+  return result;
+}
+
+}  // namespace tesseract.
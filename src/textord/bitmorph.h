@@ -0,0 +1,41 @@
+///////////////////////////////////////////////////////////////////////
+// File:        bitmorph.h
+// Description: Word-parallel brick morphology on packed 1bpp images.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_TEXTORD_BITMORPH_H_
+#define TESSERACT_TEXTORD_BITMORPH_H_
+
+struct Pix;
+
+namespace tesseract {
+
+// Replacements for Leptonica's pixOpenBrick and pixCloseBrick for 1bpp
+// images, working directly on the packed 32-bit words of the image.
+// A run of n pixels is tested or grown with O(log n) shift-and-combine
+// passes over each row (or over the rows of each column, 32 columns at a
+// time), instead of one pass per element of the structuring element, and
+// the rows (or row bands) are shared between up to num_threads threads.
+// The brick has its origin at (hsize / 2, vsize / 2), as in Leptonica,
+// and pixels outside the image are OFF for both the dilation and the
+// erosion, as with Leptonica's default asymmetric boundary condition, so
+// the results are identical to pixOpenBrick and pixCloseBrick, including
+// the closing clearing the pixels whose brick reaches outside the image.
+// Both return a new image, or nullptr if pix is not 1bpp.
+Pix* OpenBrickPacked(Pix* pix, int hsize, int vsize, int num_threads);
+Pix* CloseBrickPacked(Pix* pix, int hsize, int vsize, int num_threads);
+
+}  // namespace tesseract.
+
+#endif  // TESSERACT_TEXTORD_BITMORPH_H_
@@ -24,6 +24,8 @@
 
 #include "linefind.h"
 #include "alignedblob.h"
+#include "bitmorph.h"
+#include "params.h"
 #include "tabvector.h"
 #include "blobbox.h"
 #include "edgblob.h"
@@ -37,6 +39,12 @@
 
 namespace tesseract {
 
+static BOOL_VAR(textord_fast_line_masks, false,
+                "Find the line masks with word-parallel morphology on the"
+                " packed image instead of Leptonica brick operations");
+static INT_VAR(textord_line_mask_threads, 1,
+               "Max threads for textord_fast_line_masks");
+
 /// Denominator of resolution makes max pixel width to allow thin lines.
 const int kThinLineFraction = 20;
 /// Denominator of resolution makes min pixels to demand line lengths to be.
@@ -555,6 +563,21 @@ static Pix* FilterMusic(int resolution, Pix* pix_closed,
   return music_mask;
 }
 
+// Returns pix closed with an hsize x vsize brick, using the packed word
+// morphology if textord_fast_line_masks, or Leptonica otherwise.
+static Pix* CloseLineBrick(Pix* pix, int hsize, int vsize) {
+  if (textord_fast_line_masks)
+    return CloseBrickPacked(pix, hsize, vsize, textord_line_mask_threads);
+  return pixCloseBrick(nullptr, pix, hsize, vsize);
+}
+
+// As CloseLineBrick, but opens.
+static Pix* OpenLineBrick(Pix* pix, int hsize, int vsize) {
+  if (textord_fast_line_masks)
+    return OpenBrickPacked(pix, hsize, vsize, textord_line_mask_threads);
+  return pixOpenBrick(nullptr, pix, hsize, vsize);
+}
+
 // Most of the heavy lifting of line finding. Given src_pix and its separate
 // resolution, returns image masks:
 // pix_vline           candidate vertical lines.
@@ -600,13 +623,12 @@ void LineFinder::GetLineMasks(int resolution, Pix* src_pix,
   // Close up small holes, making it less likely that false alarms are found
   // in thickened text (as it will become more solid) and also smoothing over
   // some line breaks and nicks in the edges of the lines.
-  pix_closed = pixCloseBrick(nullptr, src_pix, closing_brick, closing_brick);
+  pix_closed = CloseLineBrick(src_pix, closing_brick, closing_brick);
   if (pixa_display != nullptr)
     pixaAddPix(pixa_display, pix_closed, L_CLONE);
   // Open up with a big box to detect solid areas, which can then be subtracted.
   // This is very generous and will leave in even quite wide lines.
-  Pix* pix_solid = pixOpenBrick(nullptr, pix_closed, max_line_width,
-                                max_line_width);
+  Pix* pix_solid = OpenLineBrick(pix_closed, max_line_width, max_line_width);
   if (pixa_display != nullptr)
     pixaAddPix(pixa_display, pix_solid, L_CLONE);
   pix_hollow = pixSubtract(nullptr, pix_closed, pix_solid);
@@ -617,8 +639,8 @@ void LineFinder::GetLineMasks(int resolution, Pix* src_pix,
   // 1 inch/kMinLineLengthFraction in length.
   if (pixa_display != nullptr)
     pixaAddPix(pixa_display, pix_hollow, L_CLONE);
-  *pix_vline = pixOpenBrick(nullptr, pix_hollow, 1, min_line_length);
-  *pix_hline = pixOpenBrick(nullptr, pix_hollow, min_line_length, 1);
+  *pix_vline = OpenLineBrick(pix_hollow, 1, min_line_length);
+  *pix_hline = OpenLineBrick(pix_hollow, min_line_length, 1);
 
   pixDestroy(&pix_hollow);
 #ifdef USE_OPENCL
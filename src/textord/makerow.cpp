@@ -49,6 +49,8 @@ BOOL_VAR(textord_show_expanded_rows, false, "Display rows after expanding");
 BOOL_VAR(textord_show_final_rows, false, "Display rows after final fitting");
 BOOL_VAR(textord_show_final_blobs, false, "Display blob bounds after pre-ass");
 BOOL_VAR(textord_test_landscape, false, "Tests refer to land/port");
+INT_VAR(textord_parallel_blocks, 0,
+        "Max threads for per-block row and baseline fitting (<= 1: serial)");
 BOOL_VAR(textord_parallel_baselines, true, "Force parallel baselines");
 BOOL_VAR(textord_straight_baselines, false, "Force straight baselines");
 BOOL_VAR(textord_old_baselines, true, "Use old baseline algorithm");
@@ -195,6 +197,28 @@ float make_single_row(ICOORD page_tr, bool allow_sub_blobs,
   return gradient;
 }
 
+/**
+ * @name textord_block_threads
+ *
+ * Returns the number of threads to use for per-block layout work, which
+ * only touches the block itself, or 1 if the blocks must be done serially.
+ * The debug displays share a single window, so they force serial operation.
+ */
+int textord_block_threads(int num_blocks) {
+#ifdef _OPENMP
+  if (textord_parallel_blocks <= 1 || num_blocks <= 1)
+    return 1;
+  if (textord_show_initial_rows || textord_show_parallel_rows ||
+      textord_show_expanded_rows || textord_show_final_rows ||
+      textord_show_final_blobs || textord_show_initial_words ||
+      textord_show_new_words || textord_show_fixed_words)
+    return 1;
+  return std::min(static_cast<int>(textord_parallel_blocks), num_blocks);
+#else
+  return 1;
+#endif  // _OPENMP
+}
+
 /**
  * @name make_rows
  *
@@ -204,19 +228,30 @@ float make_rows(ICOORD page_tr, TO_BLOCK_LIST *port_blocks) {
   float port_m;                  // global skew
   float port_err;                // global noise
   TO_BLOCK_IT block_it;          // iterator
+  GenericVector<TO_BLOCK*> blocks;  // in list order
 
   block_it.set_to_list(port_blocks);
   for (block_it.mark_cycle_pt(); !block_it.cycled_list();
        block_it.forward())
-  make_initial_textrows(page_tr, block_it.data(), FCOORD(1.0f, 0.0f),
-      !textord_test_landscape);
+    blocks.push_back(block_it.data());
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(textord_block_threads(blocks.size())) \
+    schedule(dynamic)
+#endif  // _OPENMP
+  for (int b = 0; b < blocks.size(); ++b) {
+    make_initial_textrows(page_tr, blocks[b], FCOORD(1.0f, 0.0f),
+                          !textord_test_landscape);
+  }
                                  // compute globally
   compute_page_skew(port_blocks, port_m, port_err);
-  block_it.set_to_list(port_blocks);
-  for (block_it.mark_cycle_pt(); !block_it.cycled_list(); block_it.forward()) {
-    cleanup_rows_making(page_tr, block_it.data(), port_m, FCOORD(1.0f, 0.0f),
-                 block_it.data()->block->pdblk.bounding_box().left(),
-                 !textord_test_landscape);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(textord_block_threads(blocks.size())) \
+    schedule(dynamic)
+#endif  // _OPENMP
+  for (int b = 0; b < blocks.size(); ++b) {
+    cleanup_rows_making(page_tr, blocks[b], port_m, FCOORD(1.0f, 0.0f),
+                        blocks[b]->block->pdblk.bounding_box().left(),
+                        !textord_test_landscape);
   }
   return port_m;                 // global skew
 }
@@ -53,6 +53,8 @@ extern BOOL_VAR_H (textord_show_final_rows, false,
 extern BOOL_VAR_H (textord_show_final_blobs, false,
 "Display blob bounds after pre-ass");
 extern BOOL_VAR_H (textord_test_landscape, false, "Tests refer to land/port");
+extern INT_VAR_H (textord_parallel_blocks, 0,
+"Max threads for per-block row and baseline fitting (<= 1: serial)");
 extern BOOL_VAR_H (textord_parallel_baselines, true,
 "Force parallel baselines");
 extern BOOL_VAR_H (textord_straight_baselines, false,
@@ -136,6 +138,7 @@ void fill_heights(TO_ROW *row, float gradient, int min_height,
 
 float make_single_row(ICOORD page_tr, bool allow_sub_blobs, TO_BLOCK* block,
                       TO_BLOCK_LIST* blocks);
+int textord_block_threads(int num_blocks);
 float make_rows(ICOORD page_tr,              // top right
                 TO_BLOCK_LIST *port_blocks);
 void make_initial_textrows(ICOORD page_tr,
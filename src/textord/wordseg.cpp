@@ -111,10 +111,20 @@ void make_words(tesseract::Textord *textord,
                         !bool(textord_test_landscape));
   }
   textord->to_spacing(page_tr, port_blocks);
+  GenericVector<TO_BLOCK*> to_blocks;  // in list order
   block_it.set_to_list(port_blocks);
   for (block_it.mark_cycle_pt(); !block_it.cycled_list(); block_it.forward()) {
     block = block_it.data();
-    make_real_words(textord, block, FCOORD(1.0f, 0.0f));
+    to_blocks.push_back(block);
+  }
+  // Each block only adds ROWs to its own row_list, so the blocks can be
+  // done concurrently without changing the output.
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(textord_block_threads(to_blocks.size())) \
+    schedule(dynamic)
+#endif  // _OPENMP
+  for (int b = 0; b < to_blocks.size(); ++b) {
+    make_real_words(textord, to_blocks[b], FCOORD(1.0f, 0.0f));
   }
 }
 
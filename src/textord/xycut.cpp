@@ -0,0 +1,215 @@
+///////////////////////////////////////////////////////////////////////
+// File:        xycut.cpp
+// Description: Fast page layout by recursive XY-cuts of projection profiles.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifdef HAVE_CONFIG_H
+#include "config_auto.h"
+#endif
+
+#include "xycut.h"
+#include "allheaders.h"
+#include "ocrblock.h"
+
+#include <algorithm>
+
+namespace tesseract {
+
+// Resolution at which the projection profiles are computed.
+const int kTargetResolution = 100;
+// Max number of 2x reductions.
+const int kMaxReductions = 4;
+// Min white gap, in inches, between blocks stacked vertically. This is
+// larger than a normal interline gap, so paragraphs of the same column
+// stay together unless separated by a blank line.
+const double kMinRowGapInches = 0.1;
+// Min white gap, in inches, between side-by-side columns. This is kept
+// well above the width of a word space.
+const double kMinColGapInches = 0.15;
+// Smallest size, in inches, of a box that is worth cutting further.
+const double kMinBlockInches = 0.05;
+// Max depth of recursion, as a guard against pathological inputs.
+const int kMaxCutDepth = 32;
+
+XYCut::XYCut(int resolution)
+    : pix_(nullptr), reduction_(0), right_to_left_(false) {
+  while (reduction_ < kMaxReductions &&
+         (resolution >> (reduction_ + 1)) >= kTargetResolution) {
+    ++reduction_;
+  }
+  double reduced_res = static_cast<double>(resolution >> reduction_);
+  min_row_gap_ = std::max(1, static_cast<int>(kMinRowGapInches * reduced_res));
+  min_col_gap_ = std::max(2, static_cast<int>(kMinColGapInches * reduced_res));
+  min_block_size_ =
+      std::max(1, static_cast<int>(kMinBlockInches * reduced_res));
+}
+
+// Finds the text blocks in the 1bpp pix and adds a BLOCK for each to the
+// end of blocks, in reading order (top to bottom, and left to right, or
+// right to left if right_to_left).
+// Returns the number of blocks found.
+int XYCut::FindBlocks(Pix* pix, bool right_to_left, BLOCK_LIST* blocks) {
+  right_to_left_ = right_to_left;
+  int width = pixGetWidth(pix);
+  int height = pixGetHeight(pix);
+  // Rank 1 reduction keeps every speck of ink, so no gap is created that was
+  // not in the original.
+  if (reduction_ > 0) {
+    int levels[kMaxReductions] = {0, 0, 0, 0};
+    for (int i = 0; i < reduction_; ++i) levels[i] = 1;
+    pix_ = pixReduceRankBinaryCascade(pix, levels[0], levels[1], levels[2],
+                                      levels[3]);
+  } else {
+    pix_ = pixClone(pix);
+  }
+  if (pix_ == nullptr) return 0;
+  TBOX page_box(0, 0, pixGetWidth(pix_), pixGetHeight(pix_));
+  GenericVector<TBOX> leaves;
+  Cut(page_box, 0, &leaves);
+  pixDestroy(&pix_);
+
+  BLOCK_IT block_it(blocks);
+  block_it.move_to_last();
+  int scale = 1 << reduction_;
+  // The reduction keeps the top edge aligned and drops the last rows when
+  // the height is not a multiple of scale, so the scaled y-up coords are too
+  // low by the number of rows dropped. y_shift is minus that, so subtracting
+  // it moves the blocks up.
+  int y_shift = page_box.height() * scale - height;
+  for (int i = 0; i < leaves.size(); ++i) {
+    const TBOX& leaf = leaves[i];
+    // Scale up, adding a pixel of padding at each side to make sure that
+    // no ink is clipped by the rounding in the reduction.
+    int left = std::max(0, (leaf.left() - 1) * scale);
+    int bottom = std::max(0, (leaf.bottom() - 1) * scale - y_shift);
+    int right = std::min(width, (leaf.right() + 1) * scale);
+    int top = std::min(height, (leaf.top() + 1) * scale - y_shift);
+    auto* block = new BLOCK("", true, 0, 0, left, bottom, right, top);
+    block->set_right_to_left(right_to_left);
+    block_it.add_after_then_move(block);
+  }
+  return leaves.size();
+}
+
+// Recursively cuts the box (in reduced image coords with y up) and
+// appends the leaf boxes to leaves in reading order.
+void XYCut::Cut(const TBOX& box, int depth, GenericVector<TBOX>* leaves) {
+  GenericVector<int> rows;
+  GenericVector<int> cols;
+  ComputeProfile(box, false, &rows);
+  ComputeProfile(box, true, &cols);
+  // Shrink the box to the ink, dropping it completely if there is none.
+  int first_row = 0;
+  while (first_row < rows.size() && rows[first_row] == 0) ++first_row;
+  if (first_row == rows.size()) return;
+  int last_row = rows.size() - 1;
+  while (rows[last_row] == 0) --last_row;
+  int first_col = 0;
+  while (cols[first_col] == 0) ++first_col;
+  int last_col = cols.size() - 1;
+  while (cols[last_col] == 0) --last_col;
+  TBOX ink_box(box.left() + first_col, box.top() - 1 - last_row,
+               box.left() + last_col + 1, box.top() - first_row);
+  if (depth >= kMaxCutDepth || (ink_box.width() < min_block_size_ &&
+                                ink_box.height() < min_block_size_)) {
+    leaves->push_back(ink_box);
+    return;
+  }
+  // Find the widest internal gap in each direction, relative to the minimum
+  // for that direction. The shrinking above may have changed the profiles
+  // only at the ends, so the internal gaps are unaffected.
+  int best_row_gap = 0;
+  for (int r = first_row, gap = 0; r <= last_row; ++r) {
+    gap = rows[r] == 0 ? gap + 1 : 0;
+    best_row_gap = std::max(best_row_gap, gap);
+  }
+  int best_col_gap = 0;
+  for (int c = first_col, gap = 0; c <= last_col; ++c) {
+    gap = cols[c] == 0 ? gap + 1 : 0;
+    best_col_gap = std::max(best_col_gap, gap);
+  }
+  bool cut_rows = best_row_gap >= min_row_gap_;
+  bool cut_cols = best_col_gap >= min_col_gap_;
+  if (cut_rows && cut_cols) {
+    // Cut in the direction with the relatively bigger gap, preferring rows
+    // so headings spanning several columns come first.
+    cut_cols = best_col_gap * min_row_gap_ > best_row_gap * min_col_gap_;
+    cut_rows = !cut_cols;
+  }
+  if (!cut_rows && !cut_cols) {
+    leaves->push_back(ink_box);
+    return;
+  }
+  // Cut at all the gaps in the chosen direction that are big enough.
+  GenericVector<TBOX> pieces;
+  if (cut_rows) {
+    int start = first_row;
+    for (int r = first_row, gap = 0; r <= last_row + 1; ++r) {
+      if (r <= last_row && rows[r] == 0) {
+        ++gap;
+        continue;
+      }
+      if (r > last_row || gap >= min_row_gap_) {
+        int end = r > last_row ? last_row + 1 : r - gap;
+        pieces.push_back(TBOX(ink_box.left(), box.top() - end,
+                              ink_box.right(), box.top() - start));
+        start = r;
+      }
+      gap = 0;
+    }
+  } else {
+    int start = first_col;
+    for (int c = first_col, gap = 0; c <= last_col + 1; ++c) {
+      if (c <= last_col && cols[c] == 0) {
+        ++gap;
+        continue;
+      }
+      if (c > last_col || gap >= min_col_gap_) {
+        int end = c > last_col ? last_col + 1 : c - gap;
+        pieces.push_back(TBOX(box.left() + start, ink_box.bottom(),
+                              box.left() + end, ink_box.top()));
+        start = c;
+      }
+      gap = 0;
+    }
+    if (right_to_left_) pieces.reverse();
+  }
+  for (int i = 0; i < pieces.size(); ++i) {
+    Cut(pieces[i], depth + 1, leaves);
+  }
+}
+
+// Computes the number of black pixels in each row of the box, from the top
+// down, or in each column if columns, into profile.
+void XYCut::ComputeProfile(const TBOX& box, bool columns,
+                           GenericVector<int>* profile) const {
+  int height = pixGetHeight(pix_);
+  int wpl = pixGetWpl(pix_);
+  l_uint32* data = pixGetData(pix_);
+  profile->init_to_size(columns ? box.width() : box.height(), 0);
+  for (int y = box.top() - 1; y >= box.bottom(); --y) {
+    int row_index = box.top() - 1 - y;
+    l_uint32* line = data + (height - 1 - y) * wpl;
+    for (int x = box.left(); x < box.right(); ++x) {
+      if (GET_DATA_BIT(line, x)) {
+        if (columns)
+          ++(*profile)[x - box.left()];
+        else
+          ++(*profile)[row_index];
+      }
+    }
+  }
+}
+
+}  // namespace tesseract.
@@ -0,0 +1,74 @@
+///////////////////////////////////////////////////////////////////////
+// File:        xycut.h
+// Description: Fast page layout by recursive XY-cuts of projection profiles.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_TEXTORD_XYCUT_H_
+#define TESSERACT_TEXTORD_XYCUT_H_
+
+#include "genericvector.h"
+#include "rect.h"
+
+struct Pix;
+
+namespace tesseract {
+
+class BLOCK_LIST;
+
+// Divides a clean page into rectangular text blocks by recursively cutting
+// it at the widest white gaps in its horizontal and vertical projection
+// profiles. This is much cheaper than the ColumnFinder, as it needs no
+// connected components, tab stops or partitions, but it assumes a
+// Manhattan layout with white space between the columns and no pictures,
+// so it is only suitable for born-digital renders and clean scans.
+// The textlines and words inside the blocks are found later by the usual
+// Textord::TextordPage.
+class XYCut {
+ public:
+  // The profiles are computed on a copy of the image reduced to about
+  // 100 dpi, whatever the input resolution.
+  explicit XYCut(int resolution);
+
+  // Finds the text blocks in the 1bpp pix and adds a BLOCK for each to the
+  // end of blocks, in reading order (top to bottom, and left to right, or
+  // right to left if right_to_left).
+  // Returns the number of blocks found.
+  int FindBlocks(Pix* pix, bool right_to_left, BLOCK_LIST* blocks);
+
+ private:
+  // Recursively cuts the box (in reduced image coords with y up) and
+  // appends the leaf boxes to leaves in reading order.
+  void Cut(const TBOX& box, int depth, GenericVector<TBOX>* leaves);
+  // Computes the number of black pixels in each row of the box, from the top
+  // down, or in each column if columns, into profile.
+  void ComputeProfile(const TBOX& box, bool columns,
+                      GenericVector<int>* profile) const;
+
+  // The reduced image.
+  Pix* pix_;
+  // Number of times the image is reduced by 2.
+  int reduction_;
+  // Min gap, in reduced pixels, between blocks stacked vertically.
+  int min_row_gap_;
+  // Min gap, in reduced pixels, between side-by-side blocks (columns).
+  int min_col_gap_;
+  // Smallest box, in reduced pixels, that can become a block.
+  int min_block_size_;
+  // Whether the columns are read from right to left.
+  bool right_to_left_;
+};
+
+}  // namespace tesseract.
+
+#endif  // TESSERACT_TEXTORD_XYCUT_H_
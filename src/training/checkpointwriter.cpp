@@ -0,0 +1,154 @@
+///////////////////////////////////////////////////////////////////////
+// File:        checkpointwriter.cpp
+// Description: Writes training checkpoints to disk on a background thread.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+///////////////////////////////////////////////////////////////////////
+
+#include "checkpointwriter.h"
+
+#include <cstdio>      // for fopen, fwrite, rename, remove
+#ifndef _WIN32
+#include <unistd.h>    // for fsync
+#endif
+
+namespace tesseract {
+
+CheckpointWriter::CheckpointWriter() : writing_(false), stop_(false) {}
+
+// Finishes all queued writes.
+CheckpointWriter::~CheckpointWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  if (thread_.joinable()) thread_.join();
+}
+
+// Queues a write of *data to filename, taking the contents of *data. Never
+// waits for the disk.
+void CheckpointWriter::Write(const STRING& filename, std::vector<char>* data) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!thread_.joinable()) {
+    thread_ = std::thread(&CheckpointWriter::ThreadFunc, this);
+  }
+  // Any waiting snapshot of the same file is out of date, so it is replaced,
+  // and keeps its place in the queue.
+  Snapshot* snapshot = nullptr;
+  for (auto& waiting : waiting_) {
+    if (waiting.filename == filename) snapshot = &waiting;
+  }
+  if (snapshot == nullptr) {
+    waiting_.emplace_back();
+    snapshot = &waiting_.back();
+    snapshot->filename = filename;
+  }
+  snapshot->data.swap(*data);
+  snapshot->queued = std::chrono::steady_clock::now();
+  data->clear();
+  lock.unlock();
+  cv_.notify_all();
+}
+
+// Waits until all queued writes have finished.
+void CheckpointWriter::Flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this] { return waiting_.empty() && !writing_; });
+}
+
+// Returns a message describing the writes that have finished since the
+// previous call, with their latency, or an empty string if there are none.
+STRING CheckpointWriter::TakeResults() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  STRING results = results_;
+  results_ = "";
+  return results;
+}
+
+// Returns the names of the files whose writes have finished since the
+// previous call, each with true if it was written, false if it failed.
+std::vector<std::pair<STRING, bool>> CheckpointWriter::TakeFinished() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::pair<STRING, bool>> finished;
+  finished.swap(finished_);
+  return finished;
+}
+
+// Body of the background thread, which writes the waiting snapshots.
+void CheckpointWriter::ThreadFunc() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  Snapshot snapshot;
+  for (;;) {
+    cv_.wait(lock, [this] { return !waiting_.empty() || stop_; });
+    // The destructor only ends the thread once every snapshot is written.
+    if (waiting_.empty()) break;
+    snapshot.filename = waiting_.front().filename;
+    snapshot.data.swap(waiting_.front().data);
+    snapshot.queued = waiting_.front().queued;
+    waiting_.erase(waiting_.begin());
+    writing_ = true;
+    lock.unlock();
+    cv_.notify_all();
+    auto start = std::chrono::steady_clock::now();
+    bool ok = WriteAndRename(snapshot.filename, snapshot.data);
+    auto end = std::chrono::steady_clock::now();
+    lock.lock();
+    writing_ = false;
+    finished_.emplace_back(snapshot.filename, ok);
+    if (ok) {
+      using std::chrono::duration_cast;
+      using std::chrono::milliseconds;
+      int write_ms = duration_cast<milliseconds>(end - start).count();
+      int total_ms = duration_cast<milliseconds>(end - snapshot.queued).count();
+      results_ += " wrote ";
+      results_ += snapshot.filename;
+      results_.add_str_int(" in ", write_ms);
+      results_.add_str_int("ms (", total_ms);
+      results_ += "ms after queueing).";
+    } else {
+      results_ += " failed to write ";
+      results_ += snapshot.filename;
+      results_ += ".";
+    }
+    snapshot.data.clear();
+    cv_.notify_all();
+  }
+}
+
+// Writes data to a temporary file and renames it to filename. Returns false
+// on error.
+bool CheckpointWriter::WriteAndRename(const STRING& filename,
+                                      const std::vector<char>& data) {
+  STRING temp_name = filename + ".tmp";
+  FILE* fp = fopen(temp_name.c_str(), "wb");
+  if (fp == nullptr) return false;
+  bool ok = data.empty() ||
+            fwrite(data.data(), 1, data.size(), fp) == data.size();
+  ok = fflush(fp) == 0 && ok;
+#ifndef _WIN32
+  // Makes sure that the data is on disk before the rename replaces the old
+  // file, so that a crash can't leave an empty file in its place.
+  ok = ok && fsync(fileno(fp)) == 0;
+#endif
+  ok = fclose(fp) == 0 && ok;
+  if (!ok) {
+    remove(temp_name.c_str());
+    return false;
+  }
+#ifdef _WIN32
+  // rename won't replace an existing file on Windows.
+  remove(filename.c_str());
+#endif
+  return rename(temp_name.c_str(), filename.c_str()) == 0;
+}
+
+}  // namespace tesseract.
@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////
+// File:        checkpointwriter.h
+// Description: Writes training checkpoints to disk on a background thread.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_TRAINING_CHECKPOINTWRITER_H_
+#define TESSERACT_TRAINING_CHECKPOINTWRITER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "strngs.h"
+
+namespace tesseract {
+
+// Writes snapshots of serialized data to files on a background thread, so
+// that training doesn't wait for the disk. One snapshot is written while
+// at most one more per file waits, and a newer snapshot for the same file
+// replaces the waiting one, so Write never blocks. Each file is written under
+// a temporary name and then renamed, so that a reader never sees a partly
+// written file.
+class CheckpointWriter {
+ public:
+  CheckpointWriter();
+  // Finishes all queued writes.
+  ~CheckpointWriter();
+  CheckpointWriter(const CheckpointWriter&) = delete;
+  CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+  // Queues a write of *data to filename, taking the contents of *data. Never
+  // waits for the disk.
+  void Write(const STRING& filename, std::vector<char>* data);
+  // Waits until all queued writes have finished.
+  void Flush();
+  // Returns a message describing the writes that have finished since the
+  // previous call, with their latency, or an empty string if there are none.
+  STRING TakeResults();
+  // Returns the names of the files whose writes have finished since the
+  // previous call, each with true if it was written, false if it failed.
+  std::vector<std::pair<STRING, bool>> TakeFinished();
+
+ private:
+  // A snapshot to write, and when it was queued.
+  struct Snapshot {
+    STRING filename;
+    std::vector<char> data;
+    std::chrono::steady_clock::time_point queued;
+  };
+
+  // Body of the background thread, which writes the waiting snapshots.
+  void ThreadFunc();
+  // Writes data to a temporary file and renames it to filename. Returns false
+  // on error.
+  static bool WriteAndRename(const STRING& filename,
+                             const std::vector<char>& data);
+
+  // Guards all the members below.
+  std::mutex mutex_;
+  // Signalled when a snapshot is waiting or when one has been written.
+  std::condition_variable cv_;
+  // The waiting snapshots, at most one per file, in the order of queueing.
+  std::vector<Snapshot> waiting_;
+  // True while the background thread is writing a snapshot.
+  bool writing_;
+  // Set by the destructor to end the thread once nothing is waiting.
+  bool stop_;
+  // Log of the finished writes, not yet returned by TakeResults.
+  STRING results_;
+  // The finished writes, not yet returned by TakeFinished.
+  std::vector<std::pair<STRING, bool>> finished_;
+  // Started on the first call to Write.
+  std::thread thread_;
+};
+
+}  // namespace tesseract.
+
+#endif  // TESSERACT_TRAINING_CHECKPOINTWRITER_H_
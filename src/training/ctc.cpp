@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <cfloat>      // for FLT_MAX
 #include <memory>
+#include <vector>
 
 #include "genericvector.h"
 #include "matrix.h"
@@ -54,6 +55,26 @@ const double CTC::kMinTotalFinalProb_ = 1e-6;
 bool CTC::ComputeCTCTargets(const GenericVector<int>& labels, int null_char,
                             const GENERIC_2D_ARRAY<float>& outputs,
                             NetworkIO* targets) {
+  return ComputeTargets(labels, null_char, outputs, true, targets);
+}
+
+// As ComputeCTCTargets, but runs the forward-backward passes over the full
+// time x labels arrays, as the original implementation did. Kept as a
+// reference to test the banded passes against.
+/* static */
+bool CTC::ComputeCTCTargetsReference(const GenericVector<int>& labels,
+                                     int null_char,
+                                     const GENERIC_2D_ARRAY<float>& outputs,
+                                     NetworkIO* targets) {
+  return ComputeTargets(labels, null_char, outputs, false, targets);
+}
+
+// Computes the targets, with the banded passes if banded, otherwise with
+// the reference ones.
+/* static */
+bool CTC::ComputeTargets(const GenericVector<int>& labels, int null_char,
+                         const GENERIC_2D_ARRAY<float>& outputs, bool banded,
+                         NetworkIO* targets) {
   std::unique_ptr<CTC> ctc(new CTC(labels, null_char, outputs));
   if (!ctc->ComputeLabelLimits()) {
     return false;  // Not enough time.
@@ -68,14 +89,22 @@ bool CTC::ComputeCTCTargets(const GenericVector<int>& labels, int null_char,
   ctc->outputs_ += simple_targets;
   NormalizeProbs(&ctc->outputs_);
   // Run regular CTC on the biased outputs.
-  // Run forward and backward
-  GENERIC_2D_ARRAY<double> log_alphas, log_betas;
-  ctc->Forward(&log_alphas);
-  ctc->Backward(&log_betas);
-  // Normalize and come out of log space with a clipped softmax over time.
-  log_alphas += log_betas;
-  ctc->NormalizeSequence(&log_alphas);
-  ctc->LabelsToClasses(log_alphas, targets);
+  if (banded) {
+    ctc->ComputeBands();
+    std::vector<double> log_outputs, log_probs;
+    ctc->BandedForward(&log_outputs, &log_probs);
+    double max_logprob = ctc->BandedBackward(log_outputs, &log_probs);
+    ctc->BandedNormalizeToClasses(max_logprob, &log_probs, targets);
+  } else {
+    // Run forward and backward
+    GENERIC_2D_ARRAY<double> log_alphas, log_betas;
+    ctc->Forward(&log_alphas);
+    ctc->Backward(&log_betas);
+    // Normalize and come out of log space with a clipped softmax over time.
+    log_alphas += log_betas;
+    ctc->NormalizeSequence(&log_alphas);
+    ctc->LabelsToClasses(log_alphas, targets);
+  }
   NormalizeProbs(targets);
   return true;
 }
@@ -120,6 +149,22 @@ bool CTC::ComputeLabelLimits() {
   return true;
 }
 
+// Computes the offsets of the bands of the banded arrays and the mask of
+// labels that may be reached by skipping a null.
+void CTC::ComputeBands() {
+  band_offsets_.resize(num_timesteps_ + 1);
+  band_offsets_[0] = 0;
+  for (int t = 0; t < num_timesteps_; ++t) {
+    band_offsets_[t + 1] =
+        band_offsets_[t] + max_labels_[t] - min_labels_[t] + 1;
+  }
+  skippable_.resize(num_labels_);
+  for (int u = 0; u < num_labels_; ++u) {
+    skippable_[u] = u >= 2 && labels_[u - 1] == null_char_ &&
+                    labels_[u] != labels_[u - 2];
+  }
+}
+
 // Computes targets based purely on the labels by spreading the labels evenly
 // over the available timesteps.
 void CTC::ComputeSimpleTargets(GENERIC_2D_ARRAY<float>* targets) const {
@@ -220,10 +265,12 @@ static int BestLabel(const GENERIC_2D_ARRAY<float>& outputs, int t) {
 float CTC::CalculateBiasFraction() {
   // Compute output labels via basic decoding.
   GenericVector<int> output_labels;
+  int prev_label = -1;
   for (int t = 0; t < num_timesteps_; ++t) {
     int label = BestLabel(outputs_, t);
-    while (t + 1 < num_timesteps_ && BestLabel(outputs_, t + 1) == label) ++t;
-    if (label != null_char_) output_labels.push_back(label);
+    if (label != prev_label && label != null_char_)
+      output_labels.push_back(label);
+    prev_label = label;
   }
   // Simple bag of labels error calculation.
   GenericVector<int> truth_counts(num_classes_, 0);
@@ -267,6 +314,159 @@ static double LogSumExp(double ln_x, double ln_y) {
   }
 }
 
+// Given ln(x), ln(y) and ln(z), returns ln(x + y + z), subtracting the
+// biggest to keep the exps in range. As with the two argument version, an
+// impossible -FLT_MAX input contributes nothing, and the result stays at
+// -FLT_MAX if all of them are impossible.
+static inline double LogSumExp(double ln_x, double ln_y, double ln_z) {
+  // Sort without branches, so the exp of the biggest is known to be 1.
+  double ln_max = std::max(ln_x, std::max(ln_y, ln_z));
+  double ln_min = std::min(ln_x, std::min(ln_y, ln_z));
+  double ln_mid =
+      std::max(std::min(ln_x, ln_y), std::min(std::max(ln_x, ln_y), ln_z));
+  return ln_max + log(1.0 + exp(ln_mid - ln_max) + exp(ln_min - ln_max));
+}
+
+// Runs the banded forward pass, filling in the log probs of the labels in
+// log_outputs and the log_alphas.
+void CTC::BandedForward(std::vector<double>* log_outputs,
+                        std::vector<double>* log_alphas) const {
+  log_outputs->resize(band_offsets_[num_timesteps_]);
+  log_alphas->resize(band_offsets_[num_timesteps_]);
+  // The alphas of the previous timestep, indexed by label + 2, so that the
+  // labels before the start of the band and before the first label are
+  // padding that holds impossible values.
+  std::vector<double> prev_alphas(num_labels_ + 2, -FLT_MAX);
+  for (int t = 0; t < num_timesteps_; ++t) {
+    int min_u = min_labels_[t];
+    int max_u = max_labels_[t];
+    const float* outputs_t = outputs_[t];
+    // The elements of the band are at base + u in the banded arrays.
+    int base = band_offsets_[t] - min_u;
+    double* log_outs = log_outputs->data();
+    double* alphas = log_alphas->data();
+    for (int u = min_u; u <= max_u; ++u) {
+      log_outs[base + u] = log(outputs_t[labels_[u]]);
+    }
+    if (t == 0) {
+      for (int u = min_u; u <= max_u; ++u) alphas[base + u] = -FLT_MAX;
+      // Valid paths start at the first label, or the second after a null.
+      if (min_u == 0) alphas[base] = log_outs[base];
+      if (labels_[0] == null_char_ && min_u <= 1 && max_u >= 1) {
+        alphas[base + 1] = log_outs[base + 1];
+      }
+      continue;
+    }
+    // Copy the band of the previous timestep over the part of prev_alphas
+    // that is read, with impossible values outside it.
+    int prev_min_u = min_labels_[t - 1];
+    int prev_max_u = max_labels_[t - 1];
+    int prev_base = band_offsets_[t - 1] - prev_min_u;
+    for (int u = min_u - 2; u <= max_u; ++u) {
+      prev_alphas[u + 2] =
+          u >= prev_min_u && u <= prev_max_u ? alphas[prev_base + u]
+                                             : -FLT_MAX;
+    }
+    for (int u = min_u; u <= max_u; ++u) {
+      // Continuing the same label, changing from the previous label, or
+      // skipping the null if allowed.
+      double skip = skippable_[u] ? prev_alphas[u] : -FLT_MAX;
+      alphas[base + u] =
+          LogSumExp(prev_alphas[u + 2], prev_alphas[u + 1], skip) +
+          log_outs[base + u];
+    }
+  }
+}
+
+// Runs the banded backward pass, keeping only one timestep of betas at a
+// time, and adds them into log_probs, which must hold the log_alphas on input.
+// Returns the max of the resulting log_probs.
+double CTC::BandedBackward(const std::vector<double>& log_outputs,
+                           std::vector<double>* log_probs) const {
+  double max_logprob = -FLT_MAX;
+  // The betas of the next timestep plus the log probs of their labels, and
+  // those of the current timestep, indexed by label, with room for the two
+  // labels past the end. Everything outside the bands is impossible.
+  std::vector<double> next_betas(num_labels_ + 2, -FLT_MAX);
+  std::vector<double> betas(num_labels_ + 2, -FLT_MAX);
+  for (int t = num_timesteps_ - 1; t >= 0; --t) {
+    int min_u = min_labels_[t];
+    int max_u = max_labels_[t];
+    int base = band_offsets_[t] - min_u;
+    double* probs = log_probs->data();
+    // Only the labels from the band of the previous timestep up to two past
+    // this band are read from betas on the next iteration.
+    int reset_min_u = t > 0 ? min_labels_[t - 1] : min_u;
+    std::fill(betas.begin() + reset_min_u, betas.begin() + max_u + 3,
+              -FLT_MAX);
+    if (t == num_timesteps_ - 1) {
+      // Valid paths end at the last label, or the one before a final null.
+      for (int u = min_u; u <= max_u; ++u) {
+        double beta = u == num_labels_ - 1 ||
+                              (u == num_labels_ - 2 &&
+                               labels_[num_labels_ - 1] == null_char_)
+                          ? 0.0
+                          : -FLT_MAX;
+        probs[base + u] += beta;
+        max_logprob = std::max(max_logprob, probs[base + u]);
+      }
+      // The end labels are kept even if they are outside the band, to match
+      // Backward.
+      const float* outputs_t = outputs_[t];
+      betas[num_labels_ - 1] = log(outputs_t[labels_[num_labels_ - 1]]);
+      if (labels_[num_labels_ - 1] == null_char_) {
+        betas[num_labels_ - 2] = log(outputs_t[labels_[num_labels_ - 2]]);
+      }
+    } else {
+      for (int u = min_u; u <= max_u; ++u) {
+        // Continuing the same label, changing to the next label, or skipping
+        // the null if allowed.
+        double skip = u + 2 < num_labels_ && skippable_[u + 2]
+                          ? next_betas[u + 2]
+                          : -FLT_MAX;
+        double beta = LogSumExp(next_betas[u], next_betas[u + 1], skip);
+        probs[base + u] += beta;
+        max_logprob = std::max(max_logprob, probs[base + u]);
+        betas[u] = beta + log_outputs[base + u];
+      }
+    }
+    betas.swap(next_betas);
+  }
+  return max_logprob;
+}
+
+// Does NormalizeSequence and LabelsToClasses in one pass over the band.
+void CTC::BandedNormalizeToClasses(double max_logprob,
+                                   std::vector<double>* probs,
+                                   NetworkIO* targets) const {
+  std::vector<double> totals(num_labels_, 0.0);
+  for (int t = 0; t < num_timesteps_; ++t) {
+    int base = band_offsets_[t] - min_labels_[t];
+    for (int u = min_labels_[t]; u <= max_labels_[t]; ++u) {
+      // Separate impossible path from unlikely probs.
+      double& prob = (*probs)[base + u];
+      prob = prob > -FLT_MAX ? ClippedExp(prob - max_logprob) : 0.0;
+      totals[u] += prob;
+    }
+  }
+  // As in NormalizeSequence, labels are allowed to be all but zero.
+  for (double& total : totals) total = std::max(total, kMinTotalTimeProb_);
+  // As in LabelsToClasses, whose init_to_size keeps the elements of the
+  // previous timestep, the max of each class carries over from the earlier
+  // timesteps.
+  std::vector<float> class_probs(num_classes_, 0.0f);
+  for (int t = 0; t < num_timesteps_; ++t) {
+    int base = band_offsets_[t] - min_labels_[t];
+    for (int u = min_labels_[t]; u <= max_labels_[t]; ++u) {
+      // Max over the instances of the class, as in LabelsToClasses.
+      float prob = (*probs)[base + u] / totals[u];
+      float* class_prob = &class_probs[labels_[u]];
+      *class_prob = std::max(*class_prob, prob);
+    }
+    std::copy(class_probs.begin(), class_probs.end(), targets->f(t));
+  }
+}
+
 // Runs the forward CTC pass, filling in log_probs.
 void CTC::Forward(GENERIC_2D_ARRAY<double>* log_probs) const {
   log_probs->Resize(num_timesteps_, num_labels_, -FLT_MAX);
@@ -19,6 +19,8 @@
 #ifndef TESSERACT_LSTM_CTC_H_
 #define TESSERACT_LSTM_CTC_H_
 
+#include <vector>
+
 #include "genericvector.h"
 #include "network.h"
 #include "networkio.h"
@@ -53,6 +55,13 @@ class CTC {
                                 int null_char,
                                 const GENERIC_2D_ARRAY<float>& outputs,
                                 NetworkIO* targets);
+  // As ComputeCTCTargets, but runs the forward-backward passes over the full
+  // time x labels arrays, as the original implementation did. Kept as a
+  // reference to test the banded passes against.
+  static bool ComputeCTCTargetsReference(const GenericVector<int>& truth_labels,
+                                         int null_char,
+                                         const GENERIC_2D_ARRAY<float>& outputs,
+                                         NetworkIO* targets);
 
  private:
   // Constructor is private as the instance only holds information specific to
@@ -63,6 +72,9 @@ class CTC {
   // Computes vectors of min and max label index for each timestep, based on
   // whether skippability of nulls makes it possible to complete a valid path.
   bool ComputeLabelLimits();
+  // Computes the offsets of the bands of the banded arrays and the mask of
+  // labels that may be reached by skipping a null.
+  void ComputeBands();
   // Computes targets based purely on the labels by spreading the labels evenly
   // over the available timesteps.
   void ComputeSimpleTargets(GENERIC_2D_ARRAY<float>* targets) const;
@@ -77,6 +89,24 @@ class CTC {
   void Forward(GENERIC_2D_ARRAY<double>* log_probs) const;
   // Runs the backward CTC pass, filling in log_probs.
   void Backward(GENERIC_2D_ARRAY<double>* log_probs) const;
+  // Banded versions of Forward, Backward, NormalizeSequence and
+  // LabelsToClasses, which only touch the labels from min_labels_[t] to
+  // max_labels_[t] for each timestep t, as nothing else can be on a valid
+  // path. The banded arrays hold just those elements, the band for timestep t
+  // starting at band_offsets_[t]. The loops over the labels in a band have no
+  // dependencies between iterations, so they can be vectorized.
+  // Runs the forward pass, filling in the log probs of the labels in
+  // log_outputs and the log_alphas.
+  void BandedForward(std::vector<double>* log_outputs,
+                     std::vector<double>* log_alphas) const;
+  // Runs the backward pass, keeping only one timestep of betas at a time, and
+  // adds them into log_probs, which must hold the log_alphas on input.
+  // Returns the max of the resulting log_probs.
+  double BandedBackward(const std::vector<double>& log_outputs,
+                        std::vector<double>* log_probs) const;
+  // Does NormalizeSequence and LabelsToClasses in one pass over the band.
+  void BandedNormalizeToClasses(double max_logprob, std::vector<double>* probs,
+                                NetworkIO* targets) const;
   // Normalizes and brings probs out of log space with a softmax over time.
   void NormalizeSequence(GENERIC_2D_ARRAY<double>* probs) const;
   // For each timestep computes the max prob for each class over all
@@ -89,6 +119,11 @@ class CTC {
   // probs will sum to 1, otherwise to sum/min_total_prob. The maximum output
   // probability is thus 1 - (num_classes-1)*min_prob.
   static void NormalizeProbs(GENERIC_2D_ARRAY<float>* probs);
+  // Computes the targets, with the banded passes if banded, otherwise with
+  // the reference ones.
+  static bool ComputeTargets(const GenericVector<int>& labels, int null_char,
+                             const GENERIC_2D_ARRAY<float>& outputs,
+                             bool banded, NetworkIO* targets);
   // Returns true if the label at index is a needed null.
   bool NeededNull(int index) const;
   // Returns exp(clipped(x)), clipping x to a reasonable range to prevent over/
@@ -123,6 +158,12 @@ class CTC {
   // Min and max valid label indices for each timestep.
   GenericVector<int> min_labels_;
   GenericVector<int> max_labels_;
+  // Index in the banded arrays of the band of each timestep, plus the total
+  // size at the end.
+  std::vector<int> band_offsets_;
+  // For each label, whether it may be reached from two labels back by
+  // skipping the null in between.
+  std::vector<char> skippable_;
 };
 
 }  // namespace tesseract
@@ -21,7 +21,9 @@
 #include "degradeimage.h"
 
 #include <cstdlib>
+#include <vector>
 #include "allheaders.h"   // from leptonica
+#include "degradekernel.h"  // for DegradeRowParams, BestDegradeRow
 #include "genericvector.h"
 #include <tesseract/helpers.h>  // For TRand.
 #include "rect.h"
@@ -60,6 +62,32 @@ const int kExposureFactor = 16;
 const int kSaltnPepper = 5;
 // Min sum of width + height on which to operate the ramp.
 const int kMinRampSize = 1000;
+// Number of grey levels by which the ramp darkens the far corner.
+const int kRampRange = 32;
+
+// Returns the rotation to apply as described for DegradeImage.
+static float ChooseRotation(float rotation, TRand* randomizer) {
+  if (rotation) return rotation;
+  if (randomizer != nullptr) return randomizer->SignedRand(kRotationRange);
+  return 0.0f;
+}
+
+// Returns the offset to add to the greyscales for the exposure level.
+static int ExposureOffset(int exposure) {
+  // The convolution really needed to be 2x2 to be realistic enough, but
+  // we only have 3x3, so we have to bias the image darker or lose thin
+  // strokes.
+  int erosion_offset = 0;
+  // For light and 0 exposure, there is no dilation, so compensate for the
+  // convolution with a big darkening bias which is undone for lighter
+  // exposures.
+  if (exposure <= 0)
+    erosion_offset = -3 * kExposureFactor;
+  // Add in a general offset of the greyscales for the exposure level so
+  // a threshold of 128 gives a reasonable binary result.
+  erosion_offset -= exposure * kExposureFactor;
+  return erosion_offset;
+}
 
 // Degrade the pix as if by a print/copy/scan cycle with exposure > 0
 // corresponding to darkening on the copier and <0 lighter and 0 not copied.
@@ -110,13 +138,7 @@ Pix* DegradeImage(Pix* input, int exposure, TRand* randomizer,
   pixDestroy(&input);
   // A small random rotation helps to make the edges jaggy in a realistic way.
   if (rotation != nullptr) {
-    float radians_clockwise = 0.0f;
-    if (*rotation) {
-      radians_clockwise = *rotation;
-    } else if (randomizer != nullptr) {
-      radians_clockwise = randomizer->SignedRand(kRotationRange);
-    }
-
+    float radians_clockwise = ChooseRotation(*rotation, randomizer);
     input = pixRotate(pix, radians_clockwise,
                       L_ROTATE_AREA_MAP, L_BRING_IN_WHITE,
                       0, 0);
@@ -136,18 +158,7 @@ Pix* DegradeImage(Pix* input, int exposure, TRand* randomizer,
     input = pixErodeGray(pix, 3, 3);
     pixDestroy(&pix);
   }
-  // The convolution really needed to be 2x2 to be realistic enough, but
-  // we only have 3x3, so we have to bias the image darker or lose thin
-  // strokes.
-  int erosion_offset = 0;
-  // For light and 0 exposure, there is no dilation, so compensate for the
-  // convolution with a big darkening bias which is undone for lighter
-  // exposures.
-  if (exposure <= 0)
-    erosion_offset = -3 * kExposureFactor;
-  // Add in a general offset of the greyscales for the exposure level so
-  // a threshold of 128 gives a reasonable binary result.
-  erosion_offset -= exposure * kExposureFactor;
+  int erosion_offset = ExposureOffset(exposure);
   // Add a gradual fade over the page and a small amount of salt and pepper
   // noise to simulate noise in the sensor/paper fibres and varying
   // illumination.
@@ -158,7 +169,7 @@ Pix* DegradeImage(Pix* input, int exposure, TRand* randomizer,
       if (randomizer != nullptr)
         pixel += randomizer->IntRand() % (kSaltnPepper*2 + 1) - kSaltnPepper;
       if (height + width > kMinRampSize)
-        pixel -= (2*x + y) * 32 / (height + width);
+        pixel -= (2*x + y) * kRampRange / (height + width);
       pixel += erosion_offset;
       if (pixel < 0)
         pixel = 0;
@@ -171,6 +182,134 @@ Pix* DegradeImage(Pix* input, int exposure, TRand* randomizer,
   return input;
 }
 
+// Unpacks width pixels of the 8 bit line to row.
+static void UnpackRow(const l_uint32* line, int width, uint8_t* row) {
+  for (int x = 0; x < width; ++x) {
+    row[x] = GET_DATA_BYTE(line, x);
+  }
+}
+
+// Degrades the 8 bit grey pix according to params in a single pass over its
+// rows, with no intermediate images, using the best SIMD kernel available.
+// The noise is seeded from randomizer, and omitted if it is nullptr.
+// Returns nullptr on error. The returned Pix must be pixDestroyed.
+Pix* DegradeFused(const Pix* pix, const FusedDegradeParams& params,
+                  TRand* randomizer) {
+  Pix* src = const_cast<Pix*>(pix);
+  if (src == nullptr || pixGetDepth(src) != 8 ||
+      pixGetColormap(src) != nullptr) {
+    return nullptr;
+  }
+  int width = pixGetWidth(src);
+  int height = pixGetHeight(src);
+  bool binary = params.threshold > 0;
+  Pix* result = pixCreate(width, height, binary ? 1 : 8);
+  if (result == nullptr) return nullptr;
+  pixCopyResolution(result, src);
+  DegradeRowParams row_params;
+  row_params.blur = params.blur;
+  row_params.noise = randomizer != nullptr ? params.noise : 0;
+  // The ramp is in 16 bit fixed point. (2x + y) < 2(width + height), so the
+  // product with ramp_scale never overflows.
+  row_params.ramp_scale =
+      params.ramp ? (kRampRange << 16) / (width + height) : 0;
+  row_params.offset = params.offset;
+  row_params.seed = randomizer != nullptr ? randomizer->IntRand() : 0;
+  // Only the 3 rows that the blur needs are unpacked at a time, so the
+  // working set stays in the cache, however big the image is.
+  std::vector<uint8_t> rows(3 * width);
+  std::vector<uint8_t> out(width);
+  static const DegradeRowFunction degrade_row = BestDegradeRow();
+  const l_uint32* src_data = pixGetData(src);
+  int src_wpl = pixGetWpl(src);
+  l_uint32* dest_data = pixGetData(result);
+  int dest_wpl = pixGetWpl(result);
+  UnpackRow(src_data, width, &rows[0]);
+  for (int y = 0; y < height; ++y) {
+    const uint8_t* row = &rows[y % 3 * width];
+    const uint8_t* above = y > 0 ? &rows[(y - 1) % 3 * width] : row;
+    const uint8_t* below = row;
+    if (y + 1 < height) {
+      uint8_t* next = &rows[(y + 1) % 3 * width];
+      UnpackRow(src_data + (y + 1) * src_wpl, width, next);
+      below = next;
+    }
+    degrade_row(above, row, below, width, y, row_params, &out[0]);
+    l_uint32* line = dest_data + y * dest_wpl;
+    if (binary) {
+      for (int x = 0; x < width; ++x) {
+        if (out[x] < params.threshold) SET_DATA_BIT(line, x);
+      }
+    } else {
+      for (int x = 0; x < width; ++x) {
+        SET_DATA_BYTE(line, x, out[x]);
+      }
+    }
+  }
+  return result;
+}
+
+// As DegradeImage, but with the blur, noise, ramp and exposure offset fused
+// into a single pass by DegradeFused, which also thresholds the result to
+// binary if threshold > 0. The rotation is done before the blur instead of
+// after it, and the noise is different, so the images are similar to those
+// of DegradeImage, but not identical.
+// The input image is destroyed and a different image returned.
+Pix* DegradeImageFused(Pix* input, int exposure, TRand* randomizer,
+                       float* rotation, int threshold) {
+  Pix* pix = pixConvertTo8(input, false);
+  pixDestroy(&input);
+  input = pix;
+  if (exposure >= 2) {
+    // An erosion simulates the spreading darkening of a dark copy.
+    pix = input;
+    input = pixErodeGray(pix, 3, 3);
+    pixDestroy(&pix);
+  }
+  if (rotation != nullptr) {
+    // The area map rotation is linear, so doing it before the convolution
+    // instead of after makes little difference.
+    *rotation = ChooseRotation(*rotation, randomizer);
+    pix = input;
+    input = pixRotate(pix, *rotation, L_ROTATE_AREA_MAP, L_BRING_IN_WHITE,
+                      0, 0);
+    pixDestroy(&pix);
+  }
+  FusedDegradeParams params;
+  params.blur = true;
+  if (exposure >= 3 || exposure == 1) {
+    // The light erosion has to come after the convolution, so they can't
+    // be fused.
+    pix = pixBlockconv(input, 1, 1);
+    pixDestroy(&input);
+    input = pixErodeGray(pix, 3, 3);
+    pixDestroy(&pix);
+    params.blur = false;
+  }
+  params.noise = kSaltnPepper;
+  params.ramp = pixGetWidth(input) + pixGetHeight(input) > kMinRampSize;
+  params.offset = ExposureOffset(exposure);
+  params.threshold = threshold;
+  pix = DegradeFused(input, params, randomizer);
+  pixDestroy(&input);
+  return pix;
+}
+
+// Randomly blurs, adds noise to and changes the exposure of the 8 bit grey
+// image of a text line, to augment training data on the fly.
+// Returns nullptr on error. The returned Pix must be pixDestroyed.
+Pix* AugmentLineImage(const Pix* pix, TRand* randomizer) {
+  FusedDegradeParams params;
+  params.blur = randomizer->SignedRand(1.0) > 0.0;
+  params.noise = kSaltnPepper;
+  // Line images are too small for the ramp to make any difference.
+  params.ramp = false;
+  params.offset = randomizer->IntRand() % (2 * kExposureFactor + 1) -
+                  kExposureFactor;
+  params.threshold = 0;
+  return DegradeFused(pix, params, randomizer);
+}
+
 // Creates and returns a Pix distorted by various means according to the bool
 // flags. If boxes is not nullptr, the boxes are resized/positioned according to
 // any spatial distortion and also by the integer reduction factor box_scale
@@ -35,6 +35,42 @@ namespace tesseract {
 struct Pix* DegradeImage(struct Pix* input, int exposure, TRand* randomizer,
                          float* rotation);
 
+// The degradations that DegradeFused applies to every pixel, in order.
+struct FusedDegradeParams {
+  // Blurs with a 3x3 mean filter, like pixBlockconv(pix, 1, 1).
+  bool blur;
+  // Adds random salt and pepper noise in [-noise, noise].
+  int noise;
+  // Fades the image gradually towards the bottom right, like DegradeImage.
+  bool ramp;
+  // Added to every pixel to darken (< 0) or lighten (> 0) the image.
+  int offset;
+  // If > 0, the result is binary, and black where the degraded pixel is less
+  // than threshold. Otherwise the result is 8 bit grey.
+  int threshold;
+};
+
+// Degrades the 8 bit grey pix according to params in a single pass over its
+// rows, with no intermediate images, using the best SIMD kernel available.
+// The noise is seeded from randomizer, and omitted if it is nullptr.
+// Returns nullptr on error. The returned Pix must be pixDestroyed.
+Pix* DegradeFused(const Pix* pix, const FusedDegradeParams& params,
+                  TRand* randomizer);
+
+// As DegradeImage, but with the blur, noise, ramp and exposure offset fused
+// into a single pass by DegradeFused, which also thresholds the result to
+// binary if threshold > 0. The rotation is done before the blur instead of
+// after it, and the noise is different, so the images are similar to those
+// of DegradeImage, but not identical.
+// The input image is destroyed and a different image returned.
+Pix* DegradeImageFused(Pix* input, int exposure, TRand* randomizer,
+                       float* rotation, int threshold);
+
+// Randomly blurs, adds noise to and changes the exposure of the 8 bit grey
+// image of a text line, to augment training data on the fly.
+// Returns nullptr on error. The returned Pix must be pixDestroyed.
+Pix* AugmentLineImage(const Pix* pix, TRand* randomizer);
+
 // Creates and returns a Pix distorted by various means according to the bool
 // flags. If boxes is not nullptr, the boxes are resized/positioned according to
 // any spatial distortion and also by the integer reduction factor box_scale
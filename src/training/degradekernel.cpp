@@ -0,0 +1,42 @@
+///////////////////////////////////////////////////////////////////////
+// File:        degradekernel.cpp
+// Description: Fused blur, noise and exposure kernel for image degradation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+///////////////////////////////////////////////////////////////////////
+
+#ifdef HAVE_CONFIG_H
+#include "config_auto.h"  // for HAVE_AVX2
+#endif
+#include "degradekernel.h"
+#include "simddetect.h"  // for SIMDDetect
+
+namespace tesseract {
+
+void DegradeRowGeneric(const uint8_t* above, const uint8_t* row,
+                       const uint8_t* below, int width, int y,
+                       const DegradeRowParams& params, uint8_t* out) {
+  uint32_t row_key = DegradeRowKey(params.seed, y);
+  for (int x = 0; x < width; ++x) {
+    out[x] = DegradePixel(above, row, below, width, x, y, row_key, params);
+  }
+}
+
+DegradeRowFunction BestDegradeRow() {
+#if defined(HAVE_AVX2)
+  if (SIMDDetect::IsAVX2Available()) {
+    return DegradeRowAVX2;
+  }
+#endif
+  return DegradeRowGeneric;
+}
+
+}  // namespace tesseract.
@@ -0,0 +1,108 @@
+///////////////////////////////////////////////////////////////////////
+// File:        degradekernel.h
+// Description: Fused blur, noise and exposure kernel for image degradation.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_TRAINING_DEGRADEKERNEL_H_
+#define TESSERACT_TRAINING_DEGRADEKERNEL_H_
+
+#include <cstdint>
+
+namespace tesseract {
+
+// Multiplier that divides a sum of 9 pixels by 9 in 16 bit fixed point.
+constexpr int kDegradeBlurMultiplier = (1 << 16) / 9;
+// Spreads the row number over the hash input, so rows are unrelated.
+constexpr uint32_t kDegradeRowMultiplier = 0x9e3779b9u;
+
+// What to do to each pixel of a row.
+struct DegradeRowParams {
+  // If true, each pixel is replaced by the mean of its 3x3 neighbourhood,
+  // with the edge pixels repeated beyond the edges.
+  bool blur;
+  // Noise is uniform in [-noise, noise], or none if 0.
+  int noise;
+  // A ramp of ((2x + y) * ramp_scale) >> 16 is subtracted.
+  int ramp_scale;
+  // Added to every pixel after the noise and ramp.
+  int offset;
+  // Selects the noise pattern, which depends only on seed and the pixel.
+  uint32_t seed;
+};
+
+// A 32 bit integer hash with good avalanche, which is cheap in SIMD, as it
+// has only shifts, xors and multiplies. It serves as a counter based random
+// number generator, so every pixel can draw its noise independently.
+inline uint32_t DegradeHash(uint32_t x) {
+  x ^= x >> 16;
+  x *= 0x7feb352du;
+  x ^= x >> 15;
+  x *= 0x846ca68bu;
+  x ^= x >> 16;
+  return x;
+}
+
+// Returns the hash key of row y, to which the x coordinate is added.
+inline uint32_t DegradeRowKey(uint32_t seed, int y) {
+  return DegradeHash(seed ^ (static_cast<uint32_t>(y) * kDegradeRowMultiplier));
+}
+
+// Returns the degraded value of pixel x of row, between the rows above and
+// below, which are the same as row at the image edges.
+inline uint8_t DegradePixel(const uint8_t* above, const uint8_t* row,
+                            const uint8_t* below, int width, int x, int y,
+                            uint32_t row_key, const DegradeRowParams& params) {
+  int value;
+  if (params.blur) {
+    int left = x > 0 ? x - 1 : 0;
+    int right = x + 1 < width ? x + 1 : width - 1;
+    int sum = above[left] + above[x] + above[right] + row[left] + row[x] +
+              row[right] + below[left] + below[x] + below[right];
+    value = (sum * kDegradeBlurMultiplier + (1 << 15)) >> 16;
+  } else {
+    value = row[x];
+  }
+  if (params.noise > 0) {
+    uint32_t hash = DegradeHash(row_key + x);
+    value += static_cast<int>(((hash >> 16) * (2 * params.noise + 1)) >> 16) -
+             params.noise;
+  }
+  value -= ((2 * x + y) * params.ramp_scale) >> 16;
+  value += params.offset;
+  if (value < 0) value = 0;
+  if (value > 255) value = 255;
+  return static_cast<uint8_t>(value);
+}
+
+// Writes the width degraded pixels of row y to out. All the kernels produce
+// identical rows.
+void DegradeRowGeneric(const uint8_t* above, const uint8_t* row,
+                       const uint8_t* below, int width, int y,
+                       const DegradeRowParams& params, uint8_t* out);
+
+// Uses Intel AVX2 intrinsics to access the SIMD instruction set.
+void DegradeRowAVX2(const uint8_t* above, const uint8_t* row,
+                    const uint8_t* below, int width, int y,
+                    const DegradeRowParams& params, uint8_t* out);
+
+// Function pointer for a kernel that degrades a row of an image.
+using DegradeRowFunction = void (*)(const uint8_t*, const uint8_t*,
+                                    const uint8_t*, int, int,
+                                    const DegradeRowParams&, uint8_t*);
+
+// Returns the fastest kernel that this machine can run.
+DegradeRowFunction BestDegradeRow();
+
+}  // namespace tesseract.
+
+#endif  // TESSERACT_TRAINING_DEGRADEKERNEL_H_
@@ -0,0 +1,110 @@
+///////////////////////////////////////////////////////////////////////
+// File:        degradekernelavx2.cpp
+// Description: Fused image degradation kernel on avx2.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+///////////////////////////////////////////////////////////////////////
+
+#if !defined(__AVX2__)
+ #if defined(__i686__) || defined(__x86_64__)
+  #error Implementation only for AVX2 capable architectures
+ #endif
+#else
+
+#include "degradekernel.h"
+
+#include <immintrin.h>
+#include <cstdint>
+#include <cstring>
+
+namespace tesseract {
+
+// Number of pixels in a register.
+constexpr int kPixelsPerRegister = 8;
+
+// Loads 8 pixels from p, zero extended to 32 bits.
+static inline __m256i LoadPixels(const uint8_t* p) {
+  return _mm256_cvtepu8_epi32(
+      _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+}
+
+// Each 32-bit lane holds one pixel, and the hash is done on all 8 lanes at
+// once. The noise and ramp need no test, as they are 0 when disabled. The
+// clipping to [0, 255] comes from the saturating packs.
+void DegradeRowAVX2(const uint8_t* above, const uint8_t* row,
+                    const uint8_t* below, int width, int y,
+                    const DegradeRowParams& params, uint8_t* out) {
+  uint32_t row_key = DegradeRowKey(params.seed, y);
+  const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m256i key = _mm256_set1_epi32(row_key);
+  const __m256i mult1 = _mm256_set1_epi32(0x7feb352d);
+  const __m256i mult2 = _mm256_set1_epi32(0x846ca68b);
+  const __m256i noise_range = _mm256_set1_epi32(2 * params.noise + 1);
+  const __m256i noise = _mm256_set1_epi32(params.noise);
+  const __m256i ramp_y = _mm256_set1_epi32(y);
+  const __m256i ramp_scale = _mm256_set1_epi32(params.ramp_scale);
+  const __m256i offset = _mm256_set1_epi32(params.offset);
+  const __m256i blur_mult = _mm256_set1_epi32(kDegradeBlurMultiplier);
+  const __m256i round = _mm256_set1_epi32(1 << 15);
+  int x = 0;
+  // The first pixel has no left neighbour, so it is done on its own.
+  if (width > 0) {
+    out[0] = DegradePixel(above, row, below, width, 0, y, row_key, params);
+    x = 1;
+  }
+  // The right neighbour of the last pixel in the register must exist.
+  for (; x + kPixelsPerRegister < width; x += kPixelsPerRegister) {
+    __m256i value;
+    if (params.blur) {
+      __m256i sum = _mm256_add_epi32(LoadPixels(above + x - 1),
+                                     LoadPixels(above + x));
+      sum = _mm256_add_epi32(sum, LoadPixels(above + x + 1));
+      sum = _mm256_add_epi32(sum, LoadPixels(row + x - 1));
+      sum = _mm256_add_epi32(sum, LoadPixels(row + x));
+      sum = _mm256_add_epi32(sum, LoadPixels(row + x + 1));
+      sum = _mm256_add_epi32(sum, LoadPixels(below + x - 1));
+      sum = _mm256_add_epi32(sum, LoadPixels(below + x));
+      sum = _mm256_add_epi32(sum, LoadPixels(below + x + 1));
+      value = _mm256_srli_epi32(
+          _mm256_add_epi32(_mm256_mullo_epi32(sum, blur_mult), round), 16);
+    } else {
+      value = LoadPixels(row + x);
+    }
+    __m256i xs = _mm256_add_epi32(_mm256_set1_epi32(x), lanes);
+    __m256i hash = _mm256_add_epi32(key, xs);
+    hash = _mm256_xor_si256(hash, _mm256_srli_epi32(hash, 16));
+    hash = _mm256_mullo_epi32(hash, mult1);
+    hash = _mm256_xor_si256(hash, _mm256_srli_epi32(hash, 15));
+    hash = _mm256_mullo_epi32(hash, mult2);
+    hash = _mm256_xor_si256(hash, _mm256_srli_epi32(hash, 16));
+    __m256i pixel_noise = _mm256_srli_epi32(
+        _mm256_mullo_epi32(_mm256_srli_epi32(hash, 16), noise_range), 16);
+    value = _mm256_add_epi32(value, _mm256_sub_epi32(pixel_noise, noise));
+    __m256i ramp = _mm256_add_epi32(_mm256_add_epi32(xs, xs), ramp_y);
+    ramp = _mm256_srai_epi32(_mm256_mullo_epi32(ramp, ramp_scale), 16);
+    value = _mm256_add_epi32(_mm256_sub_epi32(value, ramp), offset);
+    // The packs work within each 128 bit half, so the low 4 bytes of each
+    // half hold 4 of the pixels.
+    __m256i packed = _mm256_packs_epi32(value, value);
+    packed = _mm256_packus_epi16(packed, packed);
+    int32_t low = _mm_cvtsi128_si32(_mm256_castsi256_si128(packed));
+    int32_t high = _mm_cvtsi128_si32(_mm256_extracti128_si256(packed, 1));
+    memcpy(out + x, &low, sizeof(low));
+    memcpy(out + x + 4, &high, sizeof(high));
+  }
+  for (; x < width; ++x) {
+    out[x] = DegradePixel(above, row, below, width, x, y, row_key, params);
+  }
+}
+
+}  // namespace tesseract.
+
+#endif
@@ -35,6 +35,8 @@ static STRING_PARAM_FLAG(eval_listfile, "",
 static INT_PARAM_FLAG(max_image_MB, 2000, "Max memory to use for images.");
 static INT_PARAM_FLAG(verbosity, 1,
                       "Amount of diagnosting information to output (0-2).");
+static INT_PARAM_FLAG(num_threads, 1,
+                      "Number of threads to evaluate samples in parallel.");
 
 int main(int argc, char **argv) {
   tesseract::CheckSharedLibraryVersion();
@@ -74,6 +76,7 @@ int main(int argc, char **argv) {
     tprintf("Failed to load eval data from: %s\n", FLAGS_eval_listfile.c_str());
     return 1;
   }
+  tester.set_num_threads(FLAGS_num_threads);
   double errs = 0.0;
   STRING result =
       tester.RunEvalSync(0, &errs, mgr,
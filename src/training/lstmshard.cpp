@@ -0,0 +1,80 @@
+///////////////////////////////////////////////////////////////////////
+// File:        lstmshard.cpp
+// Description: Converts lstmf training files to a memory-mappable shard.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+///////////////////////////////////////////////////////////////////////
+
+#ifdef GOOGLE_TESSERACT
+#include "base/commandlineflags.h"
+#endif
+#include "commontraining.h"
+#include "fileio.h"
+#include "genericvector.h"
+#include "imagedata.h"
+#include "imageshard.h"
+#include "strngs.h"
+#include "tprintf.h"
+
+using namespace tesseract;
+
+static STRING_PARAM_FLAG(listfile, "",
+                         "File listing sample files in lstmf training format.");
+static STRING_PARAM_FLAG(output, "", "Name of the shard file to write.");
+static INT_PARAM_FLAG(target_height, 0,
+                      "Height to scale the images to, which must be the input "
+                      "height of the network, or 0 for a network of variable "
+                      "input height.");
+static INT_PARAM_FLAG(max_height, 48,
+                      "Max height of the images if target_height is 0.");
+
+int main(int argc, char **argv) {
+  tesseract::CheckSharedLibraryVersion();
+  ParseArguments(&argc, &argv);
+  if (FLAGS_listfile.empty()) {
+    tprintf("Must provide a --listfile!\n");
+    return 1;
+  }
+  if (FLAGS_output.empty()) {
+    tprintf("Must provide an --output!\n");
+    return 1;
+  }
+  GenericVector<STRING> filenames;
+  if (!LoadFileLinesToStrings(FLAGS_listfile.c_str(), &filenames)) {
+    tprintf("Failed to load list of filenames from %s\n",
+            FLAGS_listfile.c_str());
+    return 1;
+  }
+  ImageShardWriter writer;
+  if (!writer.Open(FLAGS_output.c_str())) return 1;
+  for (int f = 0; f < filenames.size(); ++f) {
+    DocumentData document(filenames[f]);
+    if (!document.LoadDocument(filenames[f].c_str(), 0, 0, nullptr)) {
+      tprintf("Failed to load %s\n", filenames[f].c_str());
+      return 1;
+    }
+    for (int p = 0; p < document.NumPages(); ++p) {
+      const ImageData* page = document.GetPage(p);
+      if (page == nullptr ||
+          !writer.AddSample(*page, FLAGS_target_height, FLAGS_max_height)) {
+        tprintf("Failed to add page %d of %s\n", p, filenames[f].c_str());
+        return 1;
+      }
+    }
+  }
+  int num_samples = writer.num_samples();
+  if (!writer.Close()) {
+    tprintf("Failed to write %s\n", FLAGS_output.c_str());
+    return 1;
+  }
+  tprintf("Wrote %d samples to %s\n", num_samples, FLAGS_output.c_str());
+  return 0;
+} /* main */
@@ -15,7 +15,12 @@
 // limitations under the License.
 ///////////////////////////////////////////////////////////////////////
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include <memory>               // for std::unique_ptr
 #include <thread>               // for std::thread
+#include <vector>               // for std::vector
 #include "fileio.h"             // for LoadFileLinesToStrings
 #include "lstmtester.h"
 #include "genericvector.h"
@@ -25,6 +30,18 @@ namespace tesseract {
 LSTMTester::LSTMTester(int64_t max_memory)
     : test_data_(max_memory) {}
 
+// Finishes the running and the waiting evaluation, and prints the results
+// that RunEvalAsync has not returned.
+LSTMTester::~LSTMTester() {
+  {
+    std::lock_guard<std::mutex> lock(async_mutex_);
+    stop_async_ = true;
+  }
+  async_cv_.notify_all();
+  if (async_thread_.joinable()) async_thread_.join();
+  if (!async_results_.empty()) tprintf("%s\n", async_results_.c_str());
+}
+
 // Loads a set of lstmf files that were created using the lstm.train config to
 // tesseract into memory ready for testing. Returns false if nothing was
 // loaded. The arg is a filename of a file that lists the filenames.
@@ -48,8 +65,9 @@ bool LSTMTester::LoadAllEvalData(const GenericVector<STRING>& filenames) {
   return result;
 }
 
-// Runs an evaluation asynchronously on the stored data and returns a string
-// describing the results of the previous test.
+// Queues an evaluation on the stored eval data and returns a string
+// describing the results of the evaluations that have finished since the
+// previous call. The request replaces any older one that is still waiting.
 STRING LSTMTester::RunEvalAsync(int iteration, const double* training_errors,
                                 const TessdataManager& model_mgr,
                                 int training_stage) {
@@ -58,25 +76,27 @@ STRING LSTMTester::RunEvalAsync(int iteration, const double* training_errors,
     result.add_str_int("No test data at iteration ", iteration);
     return result;
   }
-  if (!LockIfNotRunning()) {
-    result.add_str_int("Previous test incomplete, skipping test at iteration ",
-                       iteration);
-    return result;
-  }
-  // Save the args.
-  STRING prev_result = test_result_;
-  test_result_ = "";
+  std::lock_guard<std::mutex> lock(async_mutex_);
   if (training_errors != nullptr) {
-    test_iteration_ = iteration;
-    test_training_errors_ = training_errors;
-    test_model_mgr_ = model_mgr;
-    test_training_stage_ = training_stage;
-    std::thread t(&LSTMTester::ThreadFunc, this);
-    t.detach();
-  } else {
-    UnlockRunning();
+    if (waiting_eval_ != nullptr) {
+      if (!async_results_.empty()) async_results_ += "\n";
+      async_results_.add_str_int("Replaced waiting test at iteration ",
+                                 waiting_eval_->iteration);
+      async_results_.add_str_int(" with test at iteration ", iteration);
+    } else {
+      waiting_eval_.reset(new EvalRequest);
+    }
+    waiting_eval_->iteration = iteration;
+    waiting_eval_->model_mgr = model_mgr;
+    waiting_eval_->training_stage = training_stage;
+    if (!async_thread_.joinable()) {
+      async_thread_ = std::thread(&LSTMTester::ThreadFunc, this);
+    }
+    async_cv_.notify_one();
   }
-  return prev_result;
+  result = async_results_;
+  async_results_ = "";
+  return result;
 }
 
 // Runs an evaluation synchronously on the stored data and returns a string
@@ -84,39 +104,83 @@ STRING LSTMTester::RunEvalAsync(int iteration, const double* training_errors,
 STRING LSTMTester::RunEvalSync(int iteration, const double* training_errors,
                                const TessdataManager& model_mgr,
                                int training_stage, int verbosity) {
-  LSTMTrainer trainer;
-  trainer.InitCharSet(model_mgr);
+  // Each thread needs its own copy of the network, as the forward pass keeps
+  // its state in it, so the model is deserialized once and cloned.
+  std::vector<std::unique_ptr<LSTMTrainer>> trainers;
+  trainers.emplace_back(new LSTMTrainer);
+  LSTMTrainer* trainer = trainers[0].get();
+  trainer->InitCharSet(model_mgr);
   TFile fp;
   if (!model_mgr.GetComponent(TESSDATA_LSTM, &fp) ||
-      !trainer.DeSerialize(&model_mgr, &fp)) {
+      !trainer->DeSerialize(&model_mgr, &fp)) {
     return "Deserialize failed";
   }
-  int eval_iteration = 0;
+#ifdef _OPENMP
+  int num_threads = std::max(std::min(num_threads_, total_pages_), 1);
+#else
+  int num_threads = 1;
+#endif
+  if (num_threads > 1) {
+    GenericVector<char> data;
+    if (!trainer->SaveTrainingDump(LIGHT, trainer, &data)) {
+      return "Clone failed";
+    }
+    for (int t = 1; t < num_threads; ++t) {
+      auto* clone = new LSTMTrainer;
+      trainers.emplace_back(clone);
+      if (!trainer->ReadTrainingDump(data, clone)) return "Clone failed";
+    }
+  }
+  // The errors of each sample are kept apart and summed in order afterwards,
+  // so the results don't depend on the number of threads.
+  std::vector<double> char_errors(total_pages_, 0.0);
+  std::vector<double> word_errors(total_pages_, 0.0);
+  std::vector<char> encodable(total_pages_, false);
+  std::vector<STRING> reports(verbosity > 0 ? total_pages_ : 0);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(num_threads) schedule(dynamic)
+#endif  // _OPENMP
+  for (int s = 0; s < total_pages_; ++s) {
+#ifdef _OPENMP
+    LSTMTrainer* thread_trainer = trainers[omp_get_thread_num()].get();
+#else
+    LSTMTrainer* thread_trainer = trainer;
+#endif
+    std::unique_ptr<ImageData> trainingdata(test_data_.CopyPageBySerial(s));
+    thread_trainer->SetIteration(s + 1);
+    NetworkIO fwd_outputs, targets;
+    Trainability result = thread_trainer->PrepareForBackward(
+        trainingdata.get(), &fwd_outputs, &targets);
+    if (result == UNENCODABLE) continue;
+    char_errors[s] = thread_trainer->NewSingleError(tesseract::ET_CHAR_ERROR);
+    word_errors[s] = thread_trainer->NewSingleError(tesseract::ET_WORD_RECERR);
+    encodable[s] = true;
+    if (verbosity > 1 || (verbosity > 0 && result != PERFECT)) {
+      GenericVector<int> ocr_labels;
+      GenericVector<int> xcoords;
+      thread_trainer->LabelsFromOutputs(fwd_outputs, &ocr_labels, &xcoords);
+      STRING ocr_text = thread_trainer->DecodeLabels(ocr_labels);
+      reports[s] = "Truth:";
+      reports[s] += trainingdata->transcription();
+      reports[s] += "\nOCR  :";
+      reports[s] += ocr_text;
+      reports[s] += "\n";
+    }
+  }
   double char_error = 0.0;
   double word_error = 0.0;
   int error_count = 0;
-  while (error_count < total_pages_) {
-    const ImageData* trainingdata = test_data_.GetPageBySerial(eval_iteration);
-    trainer.SetIteration(++eval_iteration);
-    NetworkIO fwd_outputs, targets;
-    Trainability result =
-        trainer.PrepareForBackward(trainingdata, &fwd_outputs, &targets);
-    if (result != UNENCODABLE) {
-      char_error += trainer.NewSingleError(tesseract::ET_CHAR_ERROR);
-      word_error += trainer.NewSingleError(tesseract::ET_WORD_RECERR);
-      ++error_count;
-      if (verbosity > 1 || (verbosity > 0 && result != PERFECT)) {
-        tprintf("Truth:%s\n", trainingdata->transcription().c_str());
-        GenericVector<int> ocr_labels;
-        GenericVector<int> xcoords;
-        trainer.LabelsFromOutputs(fwd_outputs, &ocr_labels, &xcoords);
-        STRING ocr_text = trainer.DecodeLabels(ocr_labels);
-        tprintf("OCR  :%s\n", ocr_text.c_str());
-      }
-    }
+  for (int s = 0; s < total_pages_; ++s) {
+    if (!encodable[s]) continue;
+    char_error += char_errors[s];
+    word_error += word_errors[s];
+    ++error_count;
+    if (!reports.empty()) tprintf("%s", reports[s].c_str());
+  }
+  if (error_count > 0) {
+    char_error *= 100.0 / error_count;
+    word_error *= 100.0 / error_count;
   }
-  char_error *= 100.0 / total_pages_;
-  word_error *= 100.0 / total_pages_;
   STRING result;
   result.add_str_int("At iteration ", iteration);
   result.add_str_int(", stage ", training_stage);
@@ -125,30 +189,24 @@ STRING LSTMTester::RunEvalSync(int iteration, const double* training_errors,
   return result;
 }
 
-// Helper thread function for RunEvalAsync.
-// LockIfNotRunning must have returned true before calling ThreadFunc, and
-// it will call UnlockRunning to release the lock after RunEvalSync completes.
+// Body of the background thread of RunEvalAsync, which runs the waiting
+// evaluation until the tester is destroyed.
 void LSTMTester::ThreadFunc() {
-  test_result_ = RunEvalSync(
-      test_iteration_, test_training_errors_,
-      test_model_mgr_, test_training_stage_,
-      /*verbosity*/ 0);
-  UnlockRunning();
-}
-
-// Returns true if there is currently nothing running, and takes the lock
-// if there is nothing running.
-bool LSTMTester::LockIfNotRunning() {
-  std::lock_guard<std::mutex> lock(running_mutex_);
-  if (async_running_) return false;
-  async_running_ = true;
-  return true;
-}
-
-// Releases the running lock.
-void LSTMTester::UnlockRunning() {
-  std::lock_guard<std::mutex> lock(running_mutex_);
-  async_running_ = false;
+  std::unique_lock<std::mutex> lock(async_mutex_);
+  for (;;) {
+    async_cv_.wait(lock,
+                   [this] { return stop_async_ || waiting_eval_ != nullptr; });
+    // The destructor only ends the thread once the waiting test has run.
+    if (waiting_eval_ == nullptr) return;
+    std::unique_ptr<EvalRequest> request = std::move(waiting_eval_);
+    lock.unlock();
+    STRING result =
+        RunEvalSync(request->iteration, nullptr, request->model_mgr,
+                    request->training_stage, /*verbosity*/ 0);
+    lock.lock();
+    if (!async_results_.empty()) async_results_ += "\n";
+    async_results_ += result;
+  }
 }
 
 }  // namespace tesseract
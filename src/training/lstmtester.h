@@ -18,7 +18,11 @@
 #ifndef TESSERACT_TRAINING_LSTMTESTER_H_
 #define TESSERACT_TRAINING_LSTMTESTER_H_
 
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
 #include <mutex>
+#include <thread>
 #include "genericvector.h"
 #include "lstmtrainer.h"
 #include "strngs.h"
@@ -28,6 +32,9 @@ namespace tesseract {
 class LSTMTester {
  public:
   LSTMTester(int64_t max_memory);
+  // Finishes the running and the waiting evaluation, and prints the results
+  // that RunEvalAsync has not returned.
+  ~LSTMTester();
 
   // Loads a set of lstmf files that were created using the lstm.train config to
   // tesseract into memory ready for testing. Returns false if nothing was
@@ -40,8 +47,18 @@ class LSTMTester {
   // loaded.
   bool LoadAllEvalData(const GenericVector<STRING>& filenames);
 
-  // Runs an evaluation asynchronously on the stored eval data and returns a
-  // string describing the results of the previous test. Args match TestCallback
+  // Sets the number of threads that evaluate the samples of one evaluation in
+  // parallel, each with its own copy of the model.
+  void set_num_threads(int num_threads) {
+    num_threads_ = std::max(num_threads, 1);
+  }
+
+  // Queues an evaluation on the stored eval data and returns a string
+  // describing the results of the evaluations that have finished since the
+  // previous call. The evaluations run one at a time on a background thread.
+  // A request that comes while another is running waits for it, but only the
+  // newest request waits: it replaces any older one that has not started,
+  // which is reported in the results instead. Args match TestCallback
   // declared in lstmtrainer.h:
   // iteration: Current learning iteration number.
   // training_errors: If not null, is an array of size ET_COUNT, indexed by
@@ -56,34 +73,40 @@ class LSTMTester {
   // Runs an evaluation synchronously on the stored eval data and returns a
   // string describing the results. Args as RunEvalAsync, except verbosity,
   // which outputs errors, if 1, or all results if 2.
+  // The results are the same whatever the number of threads.
   STRING RunEvalSync(int iteration, const double* training_errors,
                      const TessdataManager& model_mgr, int training_stage,
                      int verbosity);
 
  private:
-  // Helper thread function for RunEvalAsync.
-  // LockIfNotRunning must have returned true before calling ThreadFunc, and
-  // it will call UnlockRunning to release the lock after RunEvalSync completes.
+  // An evaluation requested by RunEvalAsync.
+  struct EvalRequest {
+    int iteration;
+    TessdataManager model_mgr;
+    int training_stage;
+  };
+
+  // Body of the background thread of RunEvalAsync, which runs the waiting
+  // evaluation until the tester is destroyed.
   void ThreadFunc();
-  // Returns true if there is currently nothing running, and takes the lock
-  // if there is nothing running.
-  bool LockIfNotRunning();
-  // Releases the running lock.
-  void UnlockRunning();
 
   // The data to test with.
   DocumentCache test_data_;
   int total_pages_ = 0;
-  // Flag that indicates an asynchronous test is currently running.
-  // Protected by running_mutex_.
-  bool async_running_ = false;
-  std::mutex running_mutex_;
-  // Stored copies of the args for use while running asynchronously.
-  int test_iteration_ = 0;
-  const double* test_training_errors_ = nullptr;
-  TessdataManager test_model_mgr_;
-  int test_training_stage_ = 0;
-  STRING test_result_;
+  int num_threads_ = 1;
+  // Guards the members below.
+  std::mutex async_mutex_;
+  // Signals the background thread that there is a request or it must stop.
+  std::condition_variable async_cv_;
+  // The evaluation waiting to be run by the background thread, if any. Each
+  // holds a copy of the model, so there is never more than one.
+  std::unique_ptr<EvalRequest> waiting_eval_;
+  // Results of the finished evaluations, not yet returned by RunEvalAsync.
+  STRING async_results_;
+  // The background thread, started by the first request.
+  std::thread async_thread_;
+  // Set by the destructor to end the thread once nothing is waiting.
+  bool stop_async_ = false;
 };
 
 }  // namespace tesseract
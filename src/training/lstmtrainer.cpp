@@ -23,13 +23,17 @@
 #endif
 
 #include "lstmtrainer.h"
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "allheaders.h"
 #include "boxread.h"
 #include "ctc.h"
+#include "degradeimage.h"
 #include "imagedata.h"
 #include "input.h"
+#include "networkio.h"
 #include "networkbuilder.h"
 #include "ratngs.h"
 #include "recodebeam.h"
@@ -71,6 +75,7 @@ const int kTargetYScale = 100;
 
 LSTMTrainer::LSTMTrainer()
     : randomly_rotate_(false),
+      augment_fraction_(0.0),
       training_data_(0),
       sub_trainer_(nullptr) {
   EmptyConstructor();
@@ -80,6 +85,7 @@ LSTMTrainer::LSTMTrainer()
 LSTMTrainer::LSTMTrainer(const char* model_base, const char* checkpoint_name,
                          int debug_interval, int64_t max_memory)
     : randomly_rotate_(false),
+      augment_fraction_(0.0),
       training_data_(max_memory),
       sub_trainer_(nullptr) {
   EmptyConstructor();
@@ -205,6 +211,7 @@ void LSTMTrainer::InitIterations() {
     error_rates_[i] = 100.0;
   }
   error_rate_of_last_saved_best_ = kMinStartedErrorRate;
+  queued_best_error_rates_.clear();
 }
 
 // If the training sample is usable, grid searches for the optimal
@@ -278,10 +285,12 @@ bool LSTMTrainer::LoadAllTrainingData(const GenericVector<STRING>& filenames,
 
 // Keeps track of best and locally worst char error_rate and launches tests
 // using tester, when a new min or max is reached.
-// Writes checkpoints at appropriate times and builds and returns a log message
-// to indicate progress. Returns false if nothing interesting happened.
+// Queues checkpoints to be written at appropriate times and builds and returns
+// a log message to indicate progress. Returns false if nothing interesting
+// happened.
 bool LSTMTrainer::MaintainCheckpoints(TestCallback tester, STRING* log_msg) {
   PrepareLogMsg(log_msg);
+  UpdateSavedBest();
   double error_rate = CharError();
   int iteration = learning_iteration();
   if (iteration >= stall_iteration_ &&
@@ -316,14 +325,13 @@ bool LSTMTrainer::MaintainCheckpoints(TestCallback tester, STRING* log_msg) {
       log_msg->add_str_int(" Transitioned to stage ", CurrentTrainingStage());
     }
     SaveTrainingDump(NO_BEST_TRAINER, this, &best_trainer_);
-    if (error_rate < error_rate_of_last_saved_best_ * kBestCheckpointFraction) {
+    if (error_rate < LastQueuedBestErrorRate() * kBestCheckpointFraction) {
       STRING best_model_name = DumpFilename();
-      if (!SaveDataToFile(best_trainer_, best_model_name.c_str())) {
-        *log_msg += " failed to write best model:";
-      } else {
-        *log_msg += " wrote best model:";
-        error_rate_of_last_saved_best_ = best_error_rate_;
-      }
+      // best_trainer_ is kept, so the writer gets a copy of it.
+      std::vector<char> best_model_data(best_trainer_);
+      checkpoint_writer_.Write(best_model_name, &best_model_data);
+      *log_msg += " queued best model:";
+      queued_best_error_rates_[best_model_name] = best_error_rate_;
       *log_msg += best_model_name;
     }
   } else if (error_rate > worst_error_rate_) {
@@ -355,13 +363,15 @@ bool LSTMTrainer::MaintainCheckpoints(TestCallback tester, STRING* log_msg) {
   if (checkpoint_name_.length() > 0) {
     // Write a current checkpoint.
     GenericVector<char> checkpoint;
-    if (!SaveTrainingDump(FULL, this, &checkpoint) ||
-        !SaveDataToFile(checkpoint, checkpoint_name_.c_str())) {
+    if (!SaveTrainingDump(FULL, this, &checkpoint)) {
       *log_msg += " failed to write checkpoint.";
     } else {
-      *log_msg += " wrote checkpoint.";
+      checkpoint_writer_.Write(checkpoint_name_, &checkpoint);
+      *log_msg += " queued checkpoint.";
     }
   }
+  // The writes finish in the background, so they are reported later.
+  *log_msg += checkpoint_writer_.TakeResults();
   *log_msg += "\n";
   return result;
 }
@@ -436,6 +446,8 @@ bool LSTMTrainer::Serialize(SerializeAmount serialize_amount,
 // Reads from the given file. Returns false in case of error.
 // NOTE: It is assumed that the trainer is never read cross-endian.
 bool LSTMTrainer::DeSerialize(const TessdataManager* mgr, TFile* fp) {
+  // The workers replicate the network that is about to be replaced.
+  workers_.clear();
   if (!LSTMRecognizer::DeSerialize(mgr, fp)) return false;
   if (!fp->DeSerialize(&learning_iteration_)) {
     // Special case. If we successfully decoded the recognizer, but fail here
@@ -763,6 +775,254 @@ Trainability LSTMTrainer::TrainOnLine(const ImageData* trainingdata,
   return trainable;
 }
 
+// Returns the training sample with the given serial number from the
+// training data of samples_trainer. If they are prefetched, the sample is a
+// decoded copy that stays valid until the next call.
+const ImageData* LSTMTrainer::GetTrainingSample(LSTMTrainer* samples_trainer,
+                                                int serial) {
+  DocumentCache* training_data = &samples_trainer->training_data_;
+  if (!training_data->prefetching()) {
+    return training_data->GetPageBySerial(serial);
+  }
+  current_sample_.reset(training_data->CopyPageBySerial(serial));
+  return current_sample_.get();
+}
+
+// Data-parallel version of TrainOnLine(samples_trainer, false): runs the
+// next num_threads samples in parallel on replicas of *this, each of which
+// computes the weight deltas of its own sample, then sums the deltas and
+// updates the weights of *this once. The error buffers and iteration
+// counters advance as if the samples had been trained one at a time.
+// Returns the number of samples that were usable.
+int LSTMTrainer::TrainOnLines(LSTMTrainer* samples_trainer, int num_threads) {
+  if (num_threads <= 1 || !PrepareWorkers(num_threads)) {
+    return TrainOnLine(samples_trainer, false) != nullptr ? 1 : 0;
+  }
+  // Copy the samples, as fetching more may evict the earlier ones.
+  std::vector<std::unique_ptr<ImageData>> samples(num_threads);
+  for (int t = 0; t < num_threads; ++t) {
+    samples[t].reset(samples_trainer->training_data_.CopyPageBySerial(
+        sample_iteration_ + t));
+  }
+  // Run the forward passes, leaving the errors of each sample in the error
+  // buffers of its worker.
+  std::vector<Trainability> trainable(num_threads, UNENCODABLE);
+  std::vector<NetworkIO> targets(num_threads);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(num_threads)
+#endif
+  for (int t = 0; t < num_threads; ++t) {
+    if (samples[t] == nullptr) continue;
+    LSTMTrainer* worker = workers_[t];
+    worker->training_iteration_ = training_iteration_;
+    worker->sample_iteration_ = sample_iteration_ + t;
+    NetworkIO fwd_outputs;
+    trainable[t] =
+        worker->PrepareForBackward(samples[t].get(), &fwd_outputs, &targets[t]);
+  }
+  // Account for the samples in order, as TrainOnLine would have.
+  std::vector<bool> backward(num_threads, false);
+  int num_used = 0;
+  int num_backward = 0;
+  // The Adam iteration that TrainOnLine would give the last update.
+  int adam_iteration = 0;
+  for (int t = 0; t < num_threads; ++t) {
+    if (trainable[t] == UNENCODABLE || trainable[t] == NOT_BOXED) {
+      ++sample_iteration_;
+      continue;
+    }
+    const LSTMTrainer* worker = workers_[t];
+    for (int type = ET_RMS; type < ET_SKIP_RATIO; ++type) {
+      auto error_type = static_cast<ErrorTypes>(type);
+      UpdateErrorBuffer(worker->NewSingleError(error_type), error_type);
+    }
+    UpdateErrorBuffer(sample_iteration_ - prev_sample_iteration_,
+                      ET_SKIP_RATIO);
+    ++sample_iteration_;
+    backward[t] = network_->IsTraining() &&
+                  (trainable[t] != PERFECT ||
+                   training_iteration() >
+                       last_perfect_training_iteration_ + perfect_delay_);
+    if (backward[t]) {
+      ++num_backward;
+      adam_iteration = training_iteration_ + 1;
+    }
+    ++num_used;
+    RollErrorBuffers();
+  }
+  if (num_backward == 0) return num_used;
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(num_threads)
+#endif
+  for (int t = 0; t < num_threads; ++t) {
+    if (!backward[t]) continue;
+    LSTMTrainer* worker = workers_[t];
+    NetworkIO bp_deltas;
+    worker->network_->Backward(false, targets[t], &worker->scratch_space_,
+                               &bp_deltas);
+  }
+  // Reduce the deltas into *this and apply them in a single update.
+  network_->ZeroDeltas();
+  for (int t = 0; t < num_threads; ++t) {
+    if (backward[t]) network_->AddDeltas(*workers_[t]->network_);
+  }
+  network_->Update(learning_rate_, momentum_, adam_beta_, adam_iteration);
+  return num_used;
+}
+
+// Makes sure that workers_ holds num_threads replicas of *this, and copies
+// the current weights into them. Returns false on failure.
+bool LSTMTrainer::PrepareWorkers(int num_threads) {
+  if (workers_.size() != num_threads) {
+    workers_.clear();
+    GenericVector<char> data;
+    if (!SaveTrainingDump(LIGHT, this, &data)) return false;
+    for (int t = 0; t < num_threads; ++t) {
+      auto* worker = new LSTMTrainer;
+      if (!ReadTrainingDump(data, worker)) {
+        delete worker;
+        workers_.clear();
+        return false;
+      }
+      worker->randomly_rotate_ = randomly_rotate_;
+      worker->augment_fraction_ = augment_fraction_;
+      workers_.push_back(worker);
+    }
+  }
+  for (LSTMTrainer* worker : workers_) {
+    worker->network_->CopyWeights(*network_);
+  }
+  return true;
+}
+
+// Trains on the next batch_size samples as one mini-batch: the lines run
+// forward and backward together as the items of a single NetworkIO, the
+// targets are computed for each line on its own, and the weights are updated
+// once with the deltas of the whole batch. The error buffers and iteration
+// counters advance as if the samples had been trained one at a time.
+// Returns the number of samples that were usable.
+int LSTMTrainer::TrainOnBatch(LSTMTrainer* samples_trainer, int batch_size) {
+  if (batch_size <= 1) {
+    return TrainOnLine(samples_trainer, false) != nullptr ? 1 : 0;
+  }
+  int first_sample = sample_iteration_;
+  // Copy the samples, as fetching more may evict the earlier ones.
+  std::vector<std::unique_ptr<ImageData>> samples(batch_size);
+  std::vector<GenericVector<int>> truth_labels(batch_size);
+  // The line images of the batch, and the sample index of each.
+  std::vector<Pix*> pixes;
+  std::vector<int> line_samples;
+  for (int s = 0; s < batch_size; ++s) {
+    sample_iteration_ = first_sample + s;
+    bool upside_down;
+    samples[s].reset(
+        samples_trainer->training_data_.CopyPageBySerial(sample_iteration_));
+    if (samples[s] == nullptr ||
+        !PrepareTruthLabels(*samples[s], &truth_labels[s], &upside_down)) {
+      continue;
+    }
+    float image_scale;
+    Pix* pix = PrepareLineImage(*samples[s], upside_down, &image_scale);
+    if (pix == nullptr) {
+      tprintf("Image not trainable\n");
+      continue;
+    }
+    pixes.push_back(pix);
+    line_samples.push_back(s);
+  }
+  int num_lines = pixes.size();
+  NetworkIO inputs, outputs;
+  if (num_lines > 0) {
+    sample_iteration_ = first_sample;
+    ForwardBatch(pixes, &inputs, &outputs);
+    // As RecognizeLine does, try inverting lines without boxes that look
+    // inverted, and keep whichever of the two is better.
+    std::vector<int> inverted;
+    std::vector<float> pos_means;
+    for (int b = 0; b < num_lines; ++b) {
+      if (!samples[line_samples[b]]->boxes().empty()) continue;
+      NetworkIO line_outputs;
+      line_outputs.CopyBatchItemFrom(outputs, b);
+      float pos_min, pos_mean, pos_sd;
+      OutputStats(line_outputs, &pos_min, &pos_mean, &pos_sd);
+      if (pos_mean < 0.5) {
+        pixInvert(pixes[b], pixes[b]);
+        inverted.push_back(b);
+        pos_means.push_back(pos_mean);
+      }
+    }
+    if (!inverted.empty()) {
+      ForwardBatch(pixes, &inputs, &outputs);
+      bool reverted = false;
+      for (size_t i = 0; i < inverted.size(); ++i) {
+        int b = inverted[i];
+        NetworkIO line_outputs;
+        line_outputs.CopyBatchItemFrom(outputs, b);
+        float inv_min, inv_mean, inv_sd;
+        OutputStats(line_outputs, &inv_min, &inv_mean, &inv_sd);
+        if (inv_mean <= pos_means[i]) {
+          pixInvert(pixes[b], pixes[b]);
+          reverted = true;
+        }
+      }
+      // The outputs must be the forward results of the lines as trained.
+      if (reverted) ForwardBatch(pixes, &inputs, &outputs);
+    }
+  }
+  // Compute the targets of each line, accounting for the samples in order,
+  // as TrainOnLine would have, and gather the deltas of those to backprop.
+  NetworkIO deltas;
+  if (num_lines > 0) {
+    deltas.Resize(outputs, network_->NumOutputs());
+    deltas.Zero();
+  }
+  int num_used = 0;
+  int num_backward = 0;
+  // The Adam iteration that TrainOnLine would give the last update.
+  int adam_iteration = 0;
+  for (int b = 0; b < num_lines; ++b) {
+    int s = line_samples[b];
+    sample_iteration_ = first_sample + s;
+    NetworkIO line_inputs, line_outputs, line_targets;
+    line_inputs.CopyBatchItemFrom(inputs, b);
+    line_outputs.CopyBatchItemFrom(outputs, b);
+    Trainability trainable =
+        PrepareTargets(*samples[s], line_inputs, &truth_labels[s],
+                       &line_outputs, &line_targets);
+    ++sample_iteration_;
+    if (trainable == UNENCODABLE || trainable == NOT_BOXED) continue;
+    if (network_->IsTraining() &&
+        (trainable != PERFECT ||
+         training_iteration() >
+             last_perfect_training_iteration_ + perfect_delay_)) {
+      line_targets.CopyBatchItemTo(b, &deltas);
+      ++num_backward;
+      adam_iteration = training_iteration_ + 1;
+    }
+    ++num_used;
+    RollErrorBuffers();
+  }
+  sample_iteration_ = first_sample + batch_size;
+  if (num_backward > 0) {
+    NetworkIO bp_deltas;
+    network_->Backward(false, deltas, &scratch_space_, &bp_deltas);
+    network_->Update(learning_rate_, momentum_, adam_beta_, adam_iteration);
+  }
+  for (Pix* pix : pixes) pixDestroy(&pix);
+  return num_used;
+}
+
+// Runs the network forward on the given line images as a single batch.
+void LSTMTrainer::ForwardBatch(const std::vector<Pix*>& pixes,
+                               NetworkIO* inputs, NetworkIO* outputs) {
+  inputs->set_int_mode(IsIntMode());
+  SetRandomSeed();
+  Input::PreparePixInputs(network_->InputShape(),
+                          std::vector<const Pix*>(pixes.begin(), pixes.end()),
+                          &randomizer_, inputs);
+  network_->Forward(false, *inputs, nullptr, &scratch_space_, outputs);
+}
+
 // Prepares the ground truth, runs forward, and prepares the targets.
 // Returns a Trainability enum to indicate the suitability of the sample.
 Trainability LSTMTrainer::PrepareForBackward(const ImageData* trainingdata,
@@ -776,55 +1036,99 @@ Trainability LSTMTrainer::PrepareForBackward(const ImageData* trainingdata,
   bool debug = debug_interval_ > 0 &&
       training_iteration() % debug_interval_ == 0;
   GenericVector<int> truth_labels;
-  if (!EncodeString(trainingdata->transcription(), &truth_labels)) {
-    tprintf("Can't encode transcription: '%s' in language '%s'\n",
-            trainingdata->transcription().c_str(),
-            trainingdata->language().c_str());
+  bool upside_down;
+  if (!PrepareTruthLabels(*trainingdata, &truth_labels, &upside_down)) {
+    return UNENCODABLE;
+  }
+  float image_scale;
+  NetworkIO inputs;
+  bool invert = trainingdata->boxes().empty();
+  if (!RecognizeLine(*trainingdata, invert, debug, invert, upside_down,
+                     &image_scale, &inputs, fwd_outputs)) {
+    tprintf("Image not trainable\n");
     return UNENCODABLE;
   }
-  bool upside_down = false;
+  return PrepareTargets(*trainingdata, inputs, &truth_labels, fwd_outputs,
+                        targets);
+}
+
+// Encodes the transcription of trainingdata as truth_labels, and decides
+// whether the sample is to be trained upside-down, in which case the labels
+// are changed to match. Returns false if the sample is unusable.
+bool LSTMTrainer::PrepareTruthLabels(const ImageData& trainingdata,
+                                     GenericVector<int>* truth_labels,
+                                     bool* upside_down) {
+  if (!EncodeString(trainingdata.transcription(), truth_labels)) {
+    tprintf("Can't encode transcription: '%s' in language '%s'\n",
+            trainingdata.transcription().c_str(),
+            trainingdata.language().c_str());
+    return false;
+  }
+  *upside_down = false;
   if (randomly_rotate_) {
     // This ensures consistent training results.
     SetRandomSeed();
-    upside_down = randomizer_.SignedRand(1.0) > 0.0;
-    if (upside_down) {
+    *upside_down = randomizer_.SignedRand(1.0) > 0.0;
+    if (*upside_down) {
       // Modify the truth labels to match the rotation:
       // Apart from space and null, increment the label. This is changes the
       // script-id to the same script-id but upside-down.
       // The labels need to be reversed in order, as the first is now the last.
-      for (int c = 0; c < truth_labels.size(); ++c) {
-        if (truth_labels[c] != UNICHAR_SPACE && truth_labels[c] != null_char_)
-          ++truth_labels[c];
+      for (int c = 0; c < truth_labels->size(); ++c) {
+        if ((*truth_labels)[c] != UNICHAR_SPACE &&
+            (*truth_labels)[c] != null_char_)
+          ++(*truth_labels)[c];
       }
-      truth_labels.reverse();
+      truth_labels->reverse();
     }
   }
   int w = 0;
-  while (w < truth_labels.size() &&
-         (truth_labels[w] == UNICHAR_SPACE || truth_labels[w] == null_char_))
+  while (w < truth_labels->size() &&
+         ((*truth_labels)[w] == UNICHAR_SPACE ||
+          (*truth_labels)[w] == null_char_))
     ++w;
-  if (w == truth_labels.size()) {
+  if (w == truth_labels->size()) {
     tprintf("Blank transcription: %s\n",
-            trainingdata->transcription().c_str());
-    return UNENCODABLE;
-  }
-  float image_scale;
-  NetworkIO inputs;
-  bool invert = trainingdata->boxes().empty();
-  if (!RecognizeLine(*trainingdata, invert, debug, invert, upside_down,
-                     &image_scale, &inputs, fwd_outputs)) {
-    tprintf("Image not trainable\n");
-    return UNENCODABLE;
+            trainingdata.transcription().c_str());
+    return false;
   }
+  return true;
+}
+
+// As LSTMRecognizer::PrepareLineImage, but a random augment_fraction_ of
+// the grey line images are degraded with AugmentLineImage.
+Pix* LSTMTrainer::PrepareLineImage(const ImageData& image_data,
+                                   bool upside_down, float* scale_factor) {
+  Pix* pix =
+      LSTMRecognizer::PrepareLineImage(image_data, upside_down, scale_factor);
+  if (pix == nullptr || augment_fraction_ <= 0.0 || pixGetDepth(pix) != 8)
+    return pix;
+  // The randomizer was seeded from the sample iteration, so the augmentation
+  // is reproducible, but different each time a sample comes round again.
+  if (randomizer_.UnsignedRand(1.0) >= augment_fraction_) return pix;
+  Pix* augmented = AugmentLineImage(pix, &randomizer_);
+  if (augmented == nullptr) return pix;
+  pixDestroy(&pix);
+  return augmented;
+}
+
+// Given the forward outputs of trainingdata from inputs, computes the targets
+// (as deltas from the outputs) and records the errors in the rolling buffers.
+// Returns a Trainability enum to indicate the suitability of the sample.
+Trainability LSTMTrainer::PrepareTargets(const ImageData& trainingdata,
+                                         const NetworkIO& inputs,
+                                         GenericVector<int>* truth_labels,
+                                         NetworkIO* fwd_outputs,
+                                         NetworkIO* targets) {
   targets->Resize(*fwd_outputs, network_->NumOutputs());
   LossType loss_type = OutputLossType();
   if (loss_type == LT_SOFTMAX) {
-    if (!ComputeTextTargets(*fwd_outputs, truth_labels, targets)) {
+    if (!ComputeTextTargets(*fwd_outputs, *truth_labels, targets)) {
       tprintf("Compute simple targets failed!\n");
       return UNENCODABLE;
     }
   } else if (loss_type == LT_CTC) {
-    if (!ComputeCTCTargets(truth_labels, fwd_outputs, targets)) {
+    if (!ComputeCTCTargets(*truth_labels, fwd_outputs, targets)) {
       tprintf("Compute CTC targets failed!\n");
       return UNENCODABLE;
     }
@@ -837,15 +1141,15 @@ Trainability LSTMTrainer::PrepareForBackward(const ImageData* trainingdata,
   LabelsFromOutputs(*fwd_outputs, &ocr_labels, &xcoords);
   // CTC does not produce correct target labels to begin with.
   if (loss_type != LT_CTC) {
-    LabelsFromOutputs(*targets, &truth_labels, &xcoords);
+    LabelsFromOutputs(*targets, truth_labels, &xcoords);
   }
-  if (!DebugLSTMTraining(inputs, *trainingdata, *fwd_outputs, truth_labels,
+  if (!DebugLSTMTraining(inputs, trainingdata, *fwd_outputs, *truth_labels,
                          *targets)) {
     tprintf("Input width was %d\n", inputs.Width());
     return UNENCODABLE;
   }
   STRING ocr_text = DecodeLabels(ocr_labels);
-  STRING truth_text = DecodeLabels(truth_labels);
+  STRING truth_text = DecodeLabels(*truth_labels);
   targets->SubtractAllFromFloat(*fwd_outputs);
   if (debug_interval_ != 0) {
       if (truth_text != ocr_text) {
@@ -853,12 +1157,12 @@ Trainability LSTMTrainer::PrepareForBackward(const ImageData* trainingdata,
             training_iteration(), ocr_text.c_str());
       }
   }
-  double char_error = ComputeCharError(truth_labels, ocr_labels);
+  double char_error = ComputeCharError(*truth_labels, ocr_labels);
   double word_error = ComputeWordError(&truth_text, &ocr_text);
   double delta_error = ComputeErrorRates(*targets, char_error, word_error);
   if (debug_interval_ != 0) {
-    tprintf("File %s line %d %s:\n", trainingdata->imagefilename().c_str(),
-            trainingdata->page_number(), delta_error == 0.0 ? "(Perfect)" : "");
+    tprintf("File %s line %d %s:\n", trainingdata.imagefilename().c_str(),
+            trainingdata.page_number(), delta_error == 0.0 ? "(Perfect)" : "");
   }
   if (delta_error == 0.0) return PERFECT;
   if (targets->AnySuspiciousTruth(kHighConfidence)) return HI_PRECISION_ERR;
@@ -1255,6 +1559,32 @@ void LSTMTrainer::RollErrorBuffers() {
   }
 }
 
+// Takes the writes of best models that checkpoint_writer_ has finished,
+// and updates error_rate_of_last_saved_best_ with those that succeeded.
+// A best model that failed to be written no longer counts, so the next best
+// one is written, even if it is not much better.
+void LSTMTrainer::UpdateSavedBest() {
+  for (const auto& finished : checkpoint_writer_.TakeFinished()) {
+    auto it = queued_best_error_rates_.find(finished.first);
+    if (it == queued_best_error_rates_.end()) continue;
+    if (finished.second) {
+      error_rate_of_last_saved_best_ =
+          std::min(error_rate_of_last_saved_best_, it->second);
+    }
+    queued_best_error_rates_.erase(it);
+  }
+}
+
+// Returns the lowest error rate of the best models that have been written
+// or are still queued to be.
+float LSTMTrainer::LastQueuedBestErrorRate() const {
+  float error_rate = error_rate_of_last_saved_best_;
+  for (const auto& queued : queued_best_error_rates_) {
+    error_rate = std::min(error_rate, queued.second);
+  }
+  return error_rate;
+}
+
 // Given that error_rate is either a new min or max, updates the best/worst
 // error rates, and record of progress.
 // Tester is an externally supplied callback function that tests on some
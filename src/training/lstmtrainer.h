@@ -19,6 +19,10 @@
 #define TESSERACT_LSTM_LSTMTRAINER_H_
 
 #include <functional>        // for std::function
+#include <map>               // for std::map
+#include <memory>            // for std::unique_ptr
+#include <vector>            // for std::vector
+#include "checkpointwriter.h"
 #include "imagedata.h"
 #include "lstmrecognizer.h"
 #include "rect.h"
@@ -135,6 +139,9 @@ class LSTMTrainer : public LSTMRecognizer {
   int learning_iteration() const { return learning_iteration_; }
   int32_t improvement_steps() const { return improvement_steps_; }
   void set_perfect_delay(int delay) { perfect_delay_ = delay; }
+  // Sets the fraction of training lines that are degraded on the fly by
+  // PrepareLineImage.
+  void set_augment_fraction(double fraction) { augment_fraction_ = fraction; }
   const GenericVector<char>& best_trainer() const { return best_trainer_; }
   // Returns the error that was just calculated by PrepareForBackward.
   double NewSingleError(ErrorTypes type) const {
@@ -173,7 +180,13 @@ class LSTMTrainer : public LSTMRecognizer {
 
   // Keeps track of best and locally worst error rate, using internally computed
   // values. See MaintainCheckpointsSpecific for more detail.
+  // The checkpoints are written in the background, and the log message
+  // reports the writes that have finished since the previous call.
   bool MaintainCheckpoints(TestCallback tester, STRING* log_msg);
+  // Waits until the checkpoints queued by MaintainCheckpoints are written.
+  void FlushCheckpoints() {
+    checkpoint_writer_.Flush();
+  }
   // Keeps track of best and locally worst error_rate (whatever it is) and
   // launches tests using rec_model, when a new min or max is reached.
   // Writes checkpoints using train_model at appropriate times and builds and
@@ -244,8 +257,7 @@ class LSTMTrainer : public LSTMRecognizer {
   // holds the training samples.
   const ImageData* TrainOnLine(LSTMTrainer* samples_trainer, bool batch) {
     int sample_index = sample_iteration();
-    const ImageData* image =
-        samples_trainer->training_data_.GetPageBySerial(sample_index);
+    const ImageData* image = GetTrainingSample(samples_trainer, sample_index);
     if (image != nullptr) {
       Trainability trainable = TrainOnLine(image, batch);
       if (trainable == UNENCODABLE || trainable == NOT_BOXED) {
@@ -257,11 +269,42 @@ class LSTMTrainer : public LSTMRecognizer {
     return image;
   }
   Trainability TrainOnLine(const ImageData* trainingdata, bool batch);
+  // Data-parallel version of TrainOnLine(samples_trainer, false): runs the
+  // next num_threads samples in parallel on replicas of *this, each of which
+  // computes the weight deltas of its own sample, then sums the deltas and
+  // updates the weights of *this once. The error buffers and iteration
+  // counters advance as if the samples had been trained one at a time.
+  // Returns the number of samples that were usable.
+  int TrainOnLines(LSTMTrainer* samples_trainer, int num_threads);
+  // Trains on the next batch_size samples as one mini-batch: the lines run
+  // forward and backward together as the items of a single NetworkIO, the
+  // targets are computed for each line on its own, and the weights are
+  // updated once with the deltas of the whole batch. The error buffers and
+  // iteration counters advance as if the samples had been trained one at a
+  // time. Returns the number of samples that were usable.
+  int TrainOnBatch(LSTMTrainer* samples_trainer, int batch_size);
 
   // Prepares the ground truth, runs forward, and prepares the targets.
   // Returns a Trainability enum to indicate the suitability of the sample.
   Trainability PrepareForBackward(const ImageData* trainingdata,
                                   NetworkIO* fwd_outputs, NetworkIO* targets);
+  // Encodes the transcription of trainingdata as truth_labels, and decides
+  // whether the sample is to be trained upside-down, in which case the labels
+  // are changed to match. Returns false if the sample is unusable.
+  bool PrepareTruthLabels(const ImageData& trainingdata,
+                          GenericVector<int>* truth_labels, bool* upside_down);
+  // As LSTMRecognizer::PrepareLineImage, but a random augment_fraction_ of
+  // the grey line images are degraded with AugmentLineImage.
+  Pix* PrepareLineImage(const ImageData& image_data, bool upside_down,
+                        float* scale_factor) override;
+  // Given the forward outputs of trainingdata from inputs, computes the
+  // targets (as deltas from the outputs) and records the errors in the
+  // rolling buffers. Returns a Trainability enum to indicate the suitability
+  // of the sample.
+  Trainability PrepareTargets(const ImageData& trainingdata,
+                              const NetworkIO& inputs,
+                              GenericVector<int>* truth_labels,
+                              NetworkIO* fwd_outputs, NetworkIO* targets);
 
   // Writes the trainer to memory, so that the current training state can be
   // restored.  *this must always be the master trainer that retains the only
@@ -372,12 +415,30 @@ class LSTMTrainer : public LSTMRecognizer {
   // Rolls error buffers and reports the current means.
   void RollErrorBuffers();
 
+  // Returns the training sample with the given serial number from the
+  // training data of samples_trainer. If they are prefetched, the sample is a
+  // decoded copy that stays valid until the next call.
+  const ImageData* GetTrainingSample(LSTMTrainer* samples_trainer, int serial);
+  // Makes sure that workers_ holds num_threads replicas of *this, and copies
+  // the current weights into them. Returns false on failure.
+  bool PrepareWorkers(int num_threads);
+  // Runs the network forward on the given line images as a single batch.
+  void ForwardBatch(const std::vector<Pix*>& pixes, NetworkIO* inputs,
+                    NetworkIO* outputs);
+
   // Given that error_rate is either a new min or max, updates the best/worst
   // error rates, and record of progress.
   STRING UpdateErrorGraph(int iteration, double error_rate,
                           const GenericVector<char>& model_data,
                           TestCallback tester);
 
+  // Takes the writes of best models that checkpoint_writer_ has finished,
+  // and updates error_rate_of_last_saved_best_ with those that succeeded.
+  void UpdateSavedBest();
+  // Returns the lowest error rate of the best models that have been written
+  // or are still queued to be.
+  float LastQueuedBestErrorRate() const;
+
  protected:
   // Alignment display window.
   ScrollView* align_win_;
@@ -395,13 +456,25 @@ class LSTMTrainer : public LSTMRecognizer {
   STRING model_base_;
   // Checkpoint filename.
   STRING checkpoint_name_;
+  // Writes the checkpoints and best models without holding up training.
+  CheckpointWriter checkpoint_writer_;
+  // Error rates of the best models queued on checkpoint_writer_, by filename,
+  // until it reports that their writes have finished.
+  std::map<STRING, float> queued_best_error_rates_;
   // Training data.
   bool randomly_rotate_;
+  // Fraction of training lines to degrade with AugmentLineImage.
+  double augment_fraction_;
   DocumentCache training_data_;
   // Name to use when saving best_trainer_.
   STRING best_model_name_;
   // Number of available training stages.
   int num_training_stages_;
+  // Replicas of *this that run the samples of TrainOnLines, made on first use
+  // and discarded whenever the network is replaced by DeSerialize.
+  PointerVector<LSTMTrainer> workers_;
+  // The last sample returned by GetTrainingSample, if it is a copy.
+  std::unique_ptr<ImageData> current_sample_;
 
   // ===Serialized data to ensure that a restart produces the same results.===
   // These members are only serialized when serialize_amount != LIGHT.
@@ -427,7 +500,8 @@ class LSTMTrainer : public LSTMRecognizer {
   // A subsidiary trainer running with a different learning rate until either
   // *this or sub_trainer_ hits a new best.
   LSTMTrainer* sub_trainer_;
-  // Error rate at which last best model was dumped.
+  // Error rate at which last best model was dumped. Only counts the best
+  // models that checkpoint_writer_ has reported as written.
   float error_rate_of_last_saved_best_;
   // Current stage of training.
   int training_stage_;
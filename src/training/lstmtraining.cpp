@@ -27,6 +27,7 @@
 #include "strngs.h"
 #include "tprintf.h"
 #include "unicharset_training_utils.h"
+#include "weightmatrix.h"       // for weight_matrix_threads
 
 using namespace tesseract;
 
@@ -65,6 +66,27 @@ static STRING_PARAM_FLAG(old_traineddata, "",
                          " character set that is to be replaced");
 static BOOL_PARAM_FLAG(randomly_rotate, false,
                        "Train OSD and randomly turn training samples upside-down");
+static DOUBLE_PARAM_FLAG(augment_fraction, 0.0,
+                         "Fraction of the training lines to degrade on the fly"
+                         " with blur, noise and exposure changes");
+static INT_PARAM_FLAG(num_threads, 1,
+                      "Number of samples to train on in parallel between"
+                      " weight updates");
+static INT_PARAM_FLAG(batch_size, 1,
+                      "Number of lines to train on as one mini-batch between"
+                      " weight updates. Overrides num_threads if greater"
+                      " than 1");
+static INT_PARAM_FLAG(prefetch_threads, 0,
+                      "Number of threads that copy and decode training samples"
+                      " ahead of the trainer");
+static INT_PARAM_FLAG(prefetch_samples, 32,
+                      "Number of training samples to keep decoded ahead of the"
+                      " trainer when prefetch_threads > 0");
+static INT_PARAM_FLAG(eval_threads, 1,
+                      "Number of threads to evaluate eval samples in parallel");
+static INT_PARAM_FLAG(update_threads, 4,
+                      "Number of threads to compute the deltas and updates of"
+                      " each large weight matrix");
 
 // Number of training images to train between calls to MaintainCheckpoints.
 const int kNumPagesPerBatch = 100;
@@ -84,6 +106,10 @@ int main(int argc, char **argv) {
     tprintf("Must provide a --traineddata see training documentation\n");
     return EXIT_FAILURE;
   }
+  if (FLAGS_update_threads < 1) {
+    tprintf("--update_threads must be at least 1!\n");
+    return EXIT_FAILURE;
+  }
 
   // Check write permissions.
   STRING test_file = FLAGS_model_output.c_str();
@@ -182,6 +208,10 @@ int main(int argc, char **argv) {
       trainer.set_perfect_delay(FLAGS_perfect_sample_delay);
     }
   }
+  tesseract::weight_matrix_threads = FLAGS_update_threads;
+  trainer.set_augment_fraction(FLAGS_augment_fraction);
+  trainer.mutable_training_data()->SetPrefetch(FLAGS_prefetch_threads,
+                                               FLAGS_prefetch_samples);
   if (!trainer.LoadAllTrainingData(filenames,
                                    FLAGS_sequential_training
                                        ? tesseract::CS_SEQUENTIAL
@@ -201,6 +231,7 @@ int main(int argc, char **argv) {
               FLAGS_eval_listfile.c_str());
       return EXIT_FAILURE;
     }
+    tester.set_num_threads(FLAGS_eval_threads);
     tester_callback = std::bind(&tesseract::LSTMTester::RunEvalAsync, &tester, _1, _2, _3, _4);
   }
   do {
@@ -210,7 +241,12 @@ int main(int argc, char **argv) {
          iteration < target_iteration &&
          (iteration < FLAGS_max_iterations || FLAGS_max_iterations == 0);
          iteration = trainer.training_iteration()) {
-      trainer.TrainOnLine(&trainer, false);
+      if (FLAGS_batch_size > 1)
+        trainer.TrainOnBatch(&trainer, FLAGS_batch_size);
+      else if (FLAGS_num_threads > 1)
+        trainer.TrainOnLines(&trainer, FLAGS_num_threads);
+      else
+        trainer.TrainOnLine(&trainer, false);
     }
     STRING log_str;
     trainer.MaintainCheckpoints(tester_callback, &log_str);
@@ -218,6 +254,8 @@ int main(int argc, char **argv) {
   } while (trainer.best_error_rate() > FLAGS_target_error_rate &&
            (trainer.training_iteration() < FLAGS_max_iterations ||
             FLAGS_max_iterations == 0));
+  if (FLAGS_prefetch_threads > 0) trainer.training_data().PrintStats();
+  trainer.FlushCheckpoints();
   tprintf("Finished! Error rate = %g\n", trainer.best_error_rate());
   return EXIT_SUCCESS;
 } /* main */
@@ -333,6 +333,17 @@ void StringRenderer::RotatePageBoxes(float rotation) {
                        start_box_, boxchars_.size(), &boxchars_);
 }
 
+void StringRenderer::MoveBoxesTo(StringRenderer* other) {
+  other->boxchars_.insert(other->boxchars_.end(), boxchars_.begin(),
+                          boxchars_.end());
+  boxchars_.clear();
+  start_box_ = 0;
+  if (page_boxes_ != nullptr) {
+    if (other->page_boxes_ == nullptr) other->page_boxes_ = boxaCreate(0);
+    boxaJoin(other->page_boxes_, page_boxes_, 0, -1);
+    boxaDestroy(&page_boxes_);
+  }
+}
 
 void StringRenderer::ClearBoxes() {
   for (size_t i = 0; i < boxchars_.size(); ++i) delete boxchars_[i];
@@ -810,6 +821,15 @@ int StringRenderer::RenderToImage(const char* text, int text_length,
   return page_offset;
 }
 
+// Returns the byte offset up to which RenderToImage would render the text,
+// without rendering it.
+int StringRenderer::FindPageBreak(const char* text, int text_length) {
+  InitPangoCairo();
+  const int page_offset = FindFirstPageBreakOffset(text, text_length);
+  FreePangoCairo();
+  return page_offset;
+}
+
 // Render a string to an image, returning it as an 8 bit pix.  Behaves as
 // RenderString, except that it ignores the font set at construction and works
 // through all the fonts, returning 0 until they are exhausted, at which point
@@ -64,6 +64,9 @@ class StringRenderer {
   // a font be able to render all the text.
   int RenderAllFontsToImage(double min_coverage, const char* text,
                             int text_length, std::string* font_used, Pix** pix);
+  // Returns the byte offset up to which RenderToImage would render the text,
+  // without rendering it.
+  int FindPageBreak(const char* text, int text_length);
 
   bool set_font(const std::string& desc);
   // Char spacing is in PIXELS!!!!.
@@ -143,6 +146,9 @@ class StringRenderer {
 
   // Rotate the boxes on the most recent page by the given rotation.
   void RotatePageBoxes(float rotation);
+  // Moves the boxes of all pages rendered so far to the end of the boxes of
+  // other, which should have the same page size.
+  void MoveBoxesTo(StringRenderer* other);
   // Delete all boxes.
   void ClearBoxes();
   // Returns the boxes in a boxfile string.
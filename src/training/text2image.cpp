@@ -31,6 +31,7 @@
 #include <algorithm>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <random>
 #include <string>
 #include <utility>
@@ -44,6 +45,7 @@
 #include "errcode.h"
 #include "fileio.h"
 #include <tesseract/helpers.h>
+#include "ligature_table.h"
 #include "normstrngs.h"
 #include "stringrenderer.h"
 #include "tlog.h"
@@ -52,11 +54,17 @@
 #ifdef _MSC_VER
 #  define putenv(s) _putenv(s)
 #endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using namespace tesseract;
 
 // A number with which to initialize the random number generator.
 const int kRandomSeed = 0x18273645;
+// Spreads the seeds of the pages, so that successive pages get unrelated
+// random numbers.
+const uint64_t kPageSeedMultiplier = 0x9e3779b97f4a7c15ULL;
 
 // The text input file.
 static STRING_PARAM_FLAG(text, "", "File name of text input to process");
@@ -69,6 +77,12 @@ static BOOL_PARAM_FLAG(degrade_image, true,
                        "Degrade rendered image with speckle noise, dilation/erosion "
                        "and rotation");
 
+// Degrade in a single pass with the fused, vectorized kernel.
+static BOOL_PARAM_FLAG(fused_degrade, false,
+                       "Degrade the rendered image with a single fused pass"
+                       " of blur, noise and thresholding, which is faster, but"
+                       " gives slightly different images");
+
 // Rotate the rendered image to have more realistic glyph borders
 static BOOL_PARAM_FLAG(rotate_image, true, "Rotate the image in a random way.");
 
@@ -185,6 +199,11 @@ static STRING_PARAM_FLAG(unicharset_file, "",
 static BOOL_PARAM_FLAG(bidirectional_rotation, false,
                        "Rotate the generated characters both ways.");
 
+static INT_PARAM_FLAG(jobs, 1,
+                      "Number of pages to render and degrade in parallel. Each "
+                      "page is degraded with its own random seed, so the "
+                      "output doesn't depend on the number.");
+
 static BOOL_PARAM_FLAG(only_extract_font_properties, false,
                        "Assumes that the input file contains a list of ngrams. Renders"
                        " each ngram, extracts spacing properties and records them in"
@@ -435,13 +454,181 @@ static bool MakeIndividualGlyphs(Pix* pix, const std::vector<BoxChar*>& vbox,
 }  // namespace tesseract
 
 using tesseract::DegradeImage;
+using tesseract::DegradeImageFused;
 using tesseract::ExtractFontProperties;
 using tesseract::File;
 using tesseract::FontUtils;
+using tesseract::LigatureTable;
 using tesseract::SpanUTF8NotWhitespace;
 using tesseract::SpanUTF8Whitespace;
 using tesseract::StringRenderer;
 
+// Applies the rendering flags to the given renderer. Returns false if the
+// writing mode is invalid.
+static bool SetRenderProperties(StringRenderer* render) {
+  render->set_add_ligatures(FLAGS_ligatures);
+  render->set_leading(FLAGS_leading);
+  render->set_resolution(FLAGS_resolution);
+  render->set_char_spacing(FLAGS_char_spacing * FLAGS_ptsize);
+  render->set_h_margin(FLAGS_margin);
+  render->set_v_margin(FLAGS_margin);
+  render->set_output_word_boxes(FLAGS_output_word_boxes);
+  render->set_box_padding(FLAGS_box_padding);
+  render->set_strip_unrenderable_words(FLAGS_strip_unrenderable_words);
+  render->set_underline_start_prob(FLAGS_underline_start_prob);
+  render->set_underline_continuation_prob(FLAGS_underline_continuation_prob);
+
+  // Set text rendering orientation and their forms.
+  if (FLAGS_writing_mode == "horizontal") {
+    // Render regular horizontal text (default).
+    render->set_vertical_text(false);
+    render->set_gravity_hint_strong(false);
+    render->set_render_fullwidth_latin(false);
+  } else if (FLAGS_writing_mode == "vertical") {
+    // Render vertical text. Glyph orientation is selected by Pango.
+    render->set_vertical_text(true);
+    render->set_gravity_hint_strong(false);
+    render->set_render_fullwidth_latin(false);
+  } else if (FLAGS_writing_mode == "vertical-upright") {
+    // Render vertical text. Glyph orientation is set to be upright.
+    // Also Basic Latin characters are converted to their fullwidth forms
+    // on rendering, since fullwidth Latin characters are well designed to fit
+    // vertical text lines, while .box files store halfwidth Basic Latin
+    // unichars.
+    render->set_vertical_text(true);
+    render->set_gravity_hint_strong(true);
+    render->set_render_fullwidth_latin(true);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Renders the pages as Main does, but on FLAGS_jobs threads, each with its
+// own renderer and so its own Pango and Cairo contexts. Each page starts
+// where the previous one ended, so the page breaks are found first, which
+// only needs the text layout. Each page is then degraded with a randomizer
+// seeded from its number, so the output doesn't depend on the number of
+// threads. The images are written in page order, and the boxes are collected
+// in render, also in page order.
+static void RenderPagesInParallel(const char* font_desc_name,
+                                  const std::string& src_utf8,
+                                  StringRenderer* render) {
+  const char* to_render_utf8 = src_utf8.c_str();
+  const int text_length = src_utf8.length();
+  // Start of each page, and the end of the last.
+  std::vector<int> page_starts(1, 0);
+  while (page_starts.back() < text_length &&
+         (FLAGS_max_pages == 0 ||
+          static_cast<int>(page_starts.size()) <= FLAGS_max_pages)) {
+    int offset = page_starts.back();
+    int page_length = render->FindPageBreak(to_render_utf8 + offset,
+                                            text_length - offset);
+    if (page_length == 0) {
+      tprintf("Failed to fit the text at offset %d onto a page\n", offset);
+      break;
+    }
+    page_starts.push_back(offset + page_length);
+  }
+  const int num_pages = page_starts.size() - 1;
+  if (FLAGS_ligatures) {
+    // Builds the shared table before the threads need it.
+    LigatureTable::Get();
+  }
+  const int num_jobs = FLAGS_jobs;
+  std::vector<std::unique_ptr<StringRenderer>> renderers(num_jobs);
+  std::vector<float> page_rotation(num_pages, 0.0f);
+  // We use a two pass mechanism to rotate images in both direction.
+  // The first pass(0) will rotate the images in random directions and
+  // the second pass(1) will mirror those rotations.
+  int num_pass = FLAGS_bidirectional_rotation ? 2 : 1;
+  for (int pass = 0; pass < num_pass; ++pass) {
+#ifdef _OPENMP
+#pragma omp parallel for ordered schedule(dynamic) num_threads(num_jobs)
+#endif  // _OPENMP
+    for (int page_num = 0; page_num < num_pages; ++page_num) {
+#ifdef _OPENMP
+      std::unique_ptr<StringRenderer>& page_render =
+          renderers[omp_get_thread_num()];
+#else
+      std::unique_ptr<StringRenderer>& page_render = renderers[0];
+#endif  // _OPENMP
+      if (page_render == nullptr) {
+        page_render.reset(
+            new StringRenderer(font_desc_name, FLAGS_xsize, FLAGS_ysize));
+        SetRenderProperties(page_render.get());
+      }
+      int im = pass * num_pages + page_num;
+      int page_length = page_starts[page_num + 1] - page_starts[page_num];
+      tlog(1, "Starting page %d\n", im);
+      page_render->set_page(im);
+      Pix* pix = nullptr;
+      int rendered_length = page_render->RenderToImage(
+          to_render_utf8 + page_starts[page_num], page_length, &pix);
+      if (rendered_length != page_length) {
+        tprintf("WARNING: Rendered %d of %d bytes of page %d\n",
+                rendered_length, page_length, im);
+      }
+      Pix* binary = nullptr;
+      if (pix != nullptr) {
+        tesseract::TRand randomizer;
+        randomizer.set_seed((kRandomSeed + im) * kPageSeedMultiplier);
+        float rotation = 0;
+        if (pass == 1) {
+          // Pass 2, do mirror rotation.
+          rotation = -1 * page_rotation[page_num];
+        }
+        if (FLAGS_degrade_image && FLAGS_fused_degrade) {
+          // The distortions need a grey image, so only threshold if there
+          // are none.
+          pix = DegradeImageFused(pix, FLAGS_exposure, &randomizer,
+                                  FLAGS_rotate_image ? &rotation : nullptr,
+                                  FLAGS_distort_image ? 0 : 128);
+        } else if (FLAGS_degrade_image) {
+          pix = DegradeImage(pix, FLAGS_exposure, &randomizer,
+                             FLAGS_rotate_image ? &rotation : nullptr);
+        }
+        if (FLAGS_distort_image) {
+          pix = PrepareDistortedPix(pix, false, FLAGS_invert,
+                                    FLAGS_white_noise, FLAGS_smooth_noise,
+                                    FLAGS_blur, 1, &randomizer, nullptr);
+        }
+        page_render->RotatePageBoxes(rotation);
+        if (pass == 0) {
+          // Pass 1, rotate randomly and store the rotation..
+          page_rotation[page_num] = rotation;
+        }
+        binary = pix;
+        if (pixGetDepth(pix) != 1) {
+          Pix* gray_pix = pixConvertTo8(pix, false);
+          pixDestroy(&pix);
+          binary = pixThresholdToBinary(gray_pix, 128);
+          pixDestroy(&gray_pix);
+        }
+      }
+#ifdef _OPENMP
+#pragma omp ordered
+#endif  // _OPENMP
+      {
+        page_render->MoveBoxesTo(render);
+        if (binary != nullptr) {
+          char tiff_name[1024];
+          snprintf(tiff_name, 1024, "%s.tif", FLAGS_outputbase.c_str());
+          pixWriteTiff(tiff_name, binary, IFF_TIFF_G4, im == 0 ? "w" : "a");
+          tprintf("Rendered page %d to file %s\n", im, tiff_name);
+          // Make individual glyphs
+          if (FLAGS_output_individual_glyph_images) {
+            if (!MakeIndividualGlyphs(binary, render->GetBoxes(), im)) {
+              tprintf("ERROR: Individual glyphs not saved\n");
+            }
+          }
+          pixDestroy(&binary);
+        }
+      }
+    }
+  }
+}
+
 static int Main() {
   if (FLAGS_list_available_fonts) {
     const std::vector<std::string>& all_fonts = FontUtils::ListAvailableFonts();
@@ -495,39 +682,7 @@ static int Main() {
             static_cast<int>(FLAGS_ptsize));
 
   StringRenderer render(font_desc_name, FLAGS_xsize, FLAGS_ysize);
-  render.set_add_ligatures(FLAGS_ligatures);
-  render.set_leading(FLAGS_leading);
-  render.set_resolution(FLAGS_resolution);
-  render.set_char_spacing(FLAGS_char_spacing * FLAGS_ptsize);
-  render.set_h_margin(FLAGS_margin);
-  render.set_v_margin(FLAGS_margin);
-  render.set_output_word_boxes(FLAGS_output_word_boxes);
-  render.set_box_padding(FLAGS_box_padding);
-  render.set_strip_unrenderable_words(FLAGS_strip_unrenderable_words);
-  render.set_underline_start_prob(FLAGS_underline_start_prob);
-  render.set_underline_continuation_prob(FLAGS_underline_continuation_prob);
-
-  // Set text rendering orientation and their forms.
-  if (FLAGS_writing_mode == "horizontal") {
-    // Render regular horizontal text (default).
-    render.set_vertical_text(false);
-    render.set_gravity_hint_strong(false);
-    render.set_render_fullwidth_latin(false);
-  } else if (FLAGS_writing_mode == "vertical") {
-    // Render vertical text. Glyph orientation is selected by Pango.
-    render.set_vertical_text(true);
-    render.set_gravity_hint_strong(false);
-    render.set_render_fullwidth_latin(false);
-  } else if (FLAGS_writing_mode == "vertical-upright") {
-    // Render vertical text. Glyph orientation is set to be upright.
-    // Also Basic Latin characters are converted to their fullwidth forms
-    // on rendering, since fullwidth Latin characters are well designed to fit
-    // vertical text lines, while .box files store halfwidth Basic Latin
-    // unichars.
-    render.set_vertical_text(true);
-    render.set_gravity_hint_strong(true);
-    render.set_render_fullwidth_latin(true);
-  } else {
+  if (!SetRenderProperties(&render)) {
     tprintf("Invalid writing mode: %s\n", FLAGS_writing_mode.c_str());
     exit(1);
   }
@@ -610,12 +765,18 @@ static int Main() {
     return 0;
   }
 
+  if (FLAGS_jobs > 1 && !FLAGS_find_fonts) {
+    RenderPagesInParallel(font_desc_name, src_utf8, &render);
+    std::string box_name = FLAGS_outputbase.c_str();
+    box_name += ".box";
+    render.WriteAllBoxes(box_name);
+    return 0;
+  }
+
   int im = 0;
   std::vector<float> page_rotation;
   const char* to_render_utf8 = src_utf8.c_str();
 
-  tesseract::TRand randomizer;
-  randomizer.set_seed(kRandomSeed);
   std::vector<std::string> font_names;
   // We use a two pass mechanism to rotate images in both direction.
   // The first pass(0) will rotate the images in random directions and
@@ -640,12 +801,22 @@ static int Main() {
                                        strlen(to_render_utf8 + offset), &pix);
       }
       if (pix != nullptr) {
+        // Seeded from the page number as in RenderPagesInParallel, so the
+        // output is the same for any number of jobs.
+        tesseract::TRand randomizer;
+        randomizer.set_seed((kRandomSeed + im) * kPageSeedMultiplier);
         float rotation = 0;
         if (pass == 1) {
           // Pass 2, do mirror rotation.
           rotation = -1 * page_rotation[page_num];
         }
-        if (FLAGS_degrade_image) {
+        if (FLAGS_degrade_image && FLAGS_fused_degrade) {
+          // The distortions need a grey image, so only threshold if there
+          // are none.
+          pix = DegradeImageFused(pix, FLAGS_exposure, &randomizer,
+                                  FLAGS_rotate_image ? &rotation : nullptr,
+                                  FLAGS_distort_image ? 0 : 128);
+        } else if (FLAGS_degrade_image) {
           pix = DegradeImage(pix, FLAGS_exposure, &randomizer,
                              FLAGS_rotate_image ? &rotation : nullptr);
         }
@@ -662,10 +833,13 @@ static int Main() {
           page_rotation.push_back(rotation);
         }
 
-        Pix* gray_pix = pixConvertTo8(pix, false);
-        pixDestroy(&pix);
-        Pix* binary = pixThresholdToBinary(gray_pix, 128);
-        pixDestroy(&gray_pix);
+        Pix* binary = pix;
+        if (pixGetDepth(pix) != 1) {
+          Pix* gray_pix = pixConvertTo8(pix, false);
+          pixDestroy(&pix);
+          binary = pixThresholdToBinary(gray_pix, 128);
+          pixDestroy(&gray_pix);
+        }
         char tiff_name[1024];
         if (FLAGS_find_fonts) {
           if (FLAGS_render_per_font) {
@@ -0,0 +1,160 @@
+///////////////////////////////////////////////////////////////////////
+// File:        blobcache.cpp
+// Description: Cache of the classifications of the blobs of a page.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#include "blobcache.h"
+
+#include <cstring>     // for memcpy
+#include "blobs.h"     // for TBLOB, TESSLINE, EDGEPT
+#include "coutln.h"    // for C_OUTLINE
+#include "normalis.h"  // for DENORM
+#include "ocrblock.h"  // for BLOCK
+#include "pagearena.h" // for PageArena
+#include "ratngs.h"    // for BLOB_CHOICE_LIST
+#include "tprintf.h"   // for tprintf
+
+namespace tesseract {
+
+// Separates the outlines in a key.
+const int32_t kEndOfOutline = INT32_MIN;
+// Max number of shapes kept. The cache is emptied when it is full, which
+// bounds its memory on a page with very many different shapes.
+const size_t kMaxShapes = 20000;
+
+// Adds the bits of value to key.
+static void AddFloat(float value, std::vector<int32_t>* key) {
+  int32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  key->push_back(bits);
+}
+
+BlobChoiceCache::BlobChoiceCache()
+    : adaptation_count_(0), hits_(0), misses_(0) {}
+
+BlobChoiceCache::~BlobChoiceCache() = default;
+
+size_t BlobChoiceCache::KeyHash::operator()(const Key& key) const {
+  // FNV-1a over the words of the key.
+  uint64_t hash = 14695981039346656037ULL;
+  for (int32_t value : key) {
+    hash ^= static_cast<uint32_t>(value);
+    hash *= 1099511628211ULL;
+  }
+  return static_cast<size_t>(hash);
+}
+
+void BlobChoiceCache::MakeKey(const TBLOB& blob, Key* key) {
+  key->clear();
+  int left = blob.bounding_box().left();
+  for (const TESSLINE* outline = blob.outlines; outline != nullptr;
+       outline = outline->next) {
+    key->push_back(outline->is_hole);
+    const EDGEPT* pt = outline->loop;
+    if (pt != nullptr) {
+      do {
+        key->push_back(pt->pos.x - left);
+        key->push_back(pt->pos.y);
+        key->push_back(pt->IsHidden());
+        key->push_back(pt->start_step);
+        key->push_back(pt->step_count);
+        // The features come from the steps of the source outline, so blobs
+        // with the same polygon but other steps are other shapes.
+        const C_OUTLINE* steps = pt->src_outline;
+        key->push_back(steps != nullptr);
+        if (steps != nullptr) {
+          int length = steps->pathlength();
+          for (int s = 0; s < pt->step_count; ++s) {
+            int index = (pt->start_step + s) % length;
+            key->push_back(steps->step_dir(index).get_dir());
+          }
+        }
+        pt = pt->next;
+      } while (pt != outline->loop);
+    }
+    key->push_back(kEndOfOutline);
+  }
+  for (const DENORM* denorm = &blob.denorm(); denorm != nullptr;
+       denorm = denorm->predecessor()) {
+    AddFloat(denorm->x_scale(), key);
+    AddFloat(denorm->y_scale(), key);
+    key->push_back(denorm->inverse());
+    const FCOORD* rotation = denorm->rotation();
+    key->push_back(rotation != nullptr);
+    if (rotation != nullptr) {
+      AddFloat(rotation->x(), key);
+      AddFloat(rotation->y(), key);
+    }
+    if (denorm->block() != nullptr) {
+      FCOORD classify_rotation = denorm->block()->classify_rotation();
+      AddFloat(classify_rotation.x(), key);
+      AddFloat(classify_rotation.y(), key);
+    }
+  }
+}
+
+void BlobChoiceCache::CheckAdaptationCount(int adaptation_count) {
+  if (adaptation_count != adaptation_count_) {
+    choices_.clear();
+    adaptation_count_ = adaptation_count;
+  }
+}
+
+BLOB_CHOICE_LIST* BlobChoiceCache::Lookup(const TBLOB& blob,
+                                          int adaptation_count) {
+  Key key;
+  MakeKey(blob, &key);
+  std::lock_guard<std::mutex> lock(mutex_);
+  CheckAdaptationCount(adaptation_count);
+  auto it = choices_.find(key);
+  if (it == choices_.end()) {
+    ++misses_;
+    return nullptr;
+  }
+  ++hits_;
+  auto* choices = new BLOB_CHOICE_LIST;
+  choices->deep_copy(it->second.get(), &BLOB_CHOICE::deep_copy);
+  return choices;
+}
+
+void BlobChoiceCache::Store(const TBLOB& blob, int adaptation_count,
+                            const BLOB_CHOICE_LIST& choices) {
+  Key key;
+  MakeKey(blob, &key);
+  std::unique_ptr<BLOB_CHOICE_LIST> copy(new BLOB_CHOICE_LIST);
+  {
+    // The copies must not keep the arena of the page alive.
+    PageArena::Scope heap_scope(nullptr);
+    copy->deep_copy(&choices, &BLOB_CHOICE::deep_copy);
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  CheckAdaptationCount(adaptation_count);
+  if (choices_.size() >= kMaxShapes) choices_.clear();
+  choices_[key] = std::move(copy);
+}
+
+void BlobChoiceCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  choices_.clear();
+  hits_ = 0;
+  misses_ = 0;
+}
+
+void BlobChoiceCache::PrintStats() const {
+  int lookups = hits_ + misses_;
+  tprintf("Blob cache: %d hits in %d lookups (%.1f%%)\n", hits_, lookups,
+          lookups > 0 ? 100.0 * hits_ / lookups : 0.0);
+}
+
+}  // namespace tesseract.
@@ -0,0 +1,93 @@
+///////////////////////////////////////////////////////////////////////
+// File:        blobcache.h
+// Description: Cache of the classifications of the blobs of a page.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_WORDREC_BLOBCACHE_H_
+#define TESSERACT_WORDREC_BLOBCACHE_H_
+
+#include <cstdint>        // for int32_t
+#include <memory>         // for std::unique_ptr
+#include <mutex>          // for std::mutex
+#include <unordered_map>  // for std::unordered_map
+#include <vector>         // for std::vector
+
+namespace tesseract {
+
+class BLOB_CHOICE_LIST;
+struct TBLOB;
+
+// Remembers the choices of the classifier for each shape of blob seen on a
+// page, so that a blob that is classified again, by the chopper, the
+// segmentation search or a later pass, or that repeats a glyph seen
+// elsewhere on the page, is classified only once.
+// Blobs have the same shape if their outlines in the normalized (BLN)
+// coordinates are the same, relative to the left edge of the blob, with the
+// same steps of the source outlines, and their DENORMs have the same scales
+// and rotations. The horizontal position
+// is left out, as the features are centred on the blob, but the choices
+// depend on it through their x-height ranges, which the caller must
+// recompute on a hit.
+// The classifier also depends on the adapted templates, so the cache is
+// emptied whenever the adaptation count given to it changes. It is also
+// emptied when it holds too many shapes, and by its owner at the end of
+// each page.
+// Lookup and Store may be called from several threads at once.
+class BlobChoiceCache {
+ public:
+  BlobChoiceCache();
+  ~BlobChoiceCache();
+
+  // Returns a new copy of the choices stored for the shape of blob, or
+  // nullptr if there are none. adaptation_count is Classify's count of
+  // changes to the adapted templates.
+  BLOB_CHOICE_LIST* Lookup(const TBLOB& blob, int adaptation_count);
+  // Stores a copy of the choices for the shape of blob.
+  void Store(const TBLOB& blob, int adaptation_count,
+             const BLOB_CHOICE_LIST& choices);
+  // Empties the cache and resets the counts.
+  void Clear();
+  // Prints the hit rate.
+  void PrintStats() const;
+
+  int hits() const {
+    return hits_;
+  }
+  int misses() const {
+    return misses_;
+  }
+
+ private:
+  using Key = std::vector<int32_t>;
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+
+  // Makes the key describing the shape of blob.
+  static void MakeKey(const TBLOB& blob, Key* key);
+  // Empties the cache if adaptation_count has changed. Must be called with
+  // mutex_ held.
+  void CheckAdaptationCount(int adaptation_count);
+
+  std::mutex mutex_;
+  std::unordered_map<Key, std::unique_ptr<BLOB_CHOICE_LIST>, KeyHash> choices_;
+  // The adaptation count of the entries in choices_.
+  int adaptation_count_;
+  int hits_;
+  int misses_;
+};
+
+}  // namespace tesseract.
+
+#endif  // TESSERACT_WORDREC_BLOBCACHE_H_
@@ -384,6 +384,7 @@ SEAM* Wordrec::chop_one_blob(const GenericVector<TBOX>& boxes,
  */
 void Wordrec::chop_word_main(WERD_RES *word) {
   int num_blobs = word->chopped_word->NumBlobs();
+  ResetSeamSearches();
   if (word->ratings == nullptr) {
     word->ratings = new MATRIX(num_blobs, wordrec_max_join_chunks);
   }
@@ -476,7 +477,8 @@ void Wordrec::improve_by_chopping(float rating_cert_scale,
     // states in WERD_CHOICEs, and blob widths.
     word->InsertSeam(blob_number, seam);
     // Insert a new entry in the beam array.
-    best_choice_bundle->beam.insert(new LanguageModelState, blob_number);
+    best_choice_bundle->beam.insert(
+        new (&best_choice_bundle->arena) LanguageModelState, blob_number);
     // Fixpts are outdated, but will get recalculated.
     best_choice_bundle->fixpt.clear();
     // Remap existing pain points.
@@ -70,23 +70,34 @@ void Wordrec::add_seam_to_queue(float new_priority, SEAM *new_seam,
     new_seam->Print("seam: ");
   }
   if (seams->size() >= MAX_NUM_SEAMS) {
-    SeamPair old_pair(0, nullptr);
-    if (seams->PopWorst(&old_pair) && old_pair.key() <= new_priority) {
+    float worst_priority = seams->PeekWorst().key();
+    if (worst_priority <= new_priority) {
       if (chop_debug) {
-        tprintf("Old seam staying with priority %g\n", old_pair.key());
+        tprintf("Old seam staying with priority %g\n", worst_priority);
       }
       delete new_seam;
-      seams->Push(&old_pair);
       return;
     } else if (chop_debug) {
       tprintf("New seam with priority %g beats old worst seam with %g\n",
-              new_priority, old_pair.key());
+              new_priority, worst_priority);
     }
+    seams->PopWorst(nullptr);
   }
   SeamPair new_pair(new_priority, new_seam);
   seams->Push(&new_pair);
 }
 
+/**********************************************************************
+ * seam_queue_keeps
+ *
+ * Returns true if add_seam_to_queue would keep a seam of the given
+ * priority, so that seams that would be thrown away at once are not
+ * built at all.
+ **********************************************************************/
+static bool seam_queue_keeps(const SeamQueue& seams, float priority) {
+  return seams.size() < MAX_NUM_SEAMS || seams.PeekWorst().key() > priority;
+}
+
 
 /**********************************************************************
  * choose_best_seam
@@ -110,12 +121,14 @@ void Wordrec::choose_best_seam(SeamQueue *seam_queue, const SPLIT *split,
   /* Add seam of split */
   my_priority = priority;
   if (split != nullptr) {
-    TPOINT split_point = split->point1->pos;
-    split_point += split->point2->pos;
-    split_point /= 2;
-    seam = new SEAM(my_priority, split_point, *split);
-    if (chop_debug > 1) seam->Print("Partial priority    ");
-    add_seam_to_queue(my_priority, seam, seam_queue);
+    if (chop_debug || seam_queue_keeps(*seam_queue, my_priority)) {
+      TPOINT split_point = split->point1->pos;
+      split_point += split->point2->pos;
+      split_point /= 2;
+      seam = new SEAM(my_priority, split_point, *split);
+      if (chop_debug > 1) seam->Print("Partial priority    ");
+      add_seam_to_queue(my_priority, seam, seam_queue);
+    }
 
     if (my_priority > chop_good_split)
       return;
@@ -198,7 +211,9 @@ void Wordrec::combine_seam(const SeamPile& seam_pile,
                            const SEAM* seam, SeamQueue* seam_queue) {
   for (int x = 0; x < seam_pile.size(); ++x) {
     const SEAM *this_one = seam_pile.get(x).data();
-    if (seam->CombineableWith(*this_one, SPLIT_CLOSENESS, chop_ok_split)) {
+    float combined_priority = seam->priority() + this_one->priority();
+    if ((chop_debug || seam_queue_keeps(*seam_queue, combined_priority)) &&
+        seam->CombineableWith(*this_one, SPLIT_CLOSENESS, chop_ok_split)) {
       SEAM *new_one = new SEAM(*seam);
       new_one->CombineWith(*this_one);
       if (chop_debug > 1) new_one->Print("Combo priority       ");
@@ -221,6 +236,15 @@ SEAM *Wordrec::pick_good_seam(TBLOB *blob) {
   TESSLINE *outline;
   int16_t num_points = 0;
 
+  // The critical points and the pairs of them worth splitting depend only
+  // on the outlines, so they are kept for when the blob comes back.
+  SeamSearch *search = nullptr;
+  bool search_found = false;
+  if (chop_cache_splits) {
+    search = seam_cache_.Lookup(*blob, &search_found);
+    if (search_found && search->no_seam) return nullptr;
+  }
+
 #ifndef GRAPHICS_DISABLED
   if (chop_debug > 2)
     wordrec_display_splits.set_value(true);
@@ -228,19 +252,34 @@ SEAM *Wordrec::pick_good_seam(TBLOB *blob) {
   draw_blob_edges(blob);
 #endif
 
-  PointHeap point_heap(MAX_NUM_POINTS);
-  for (outline = blob->outlines; outline; outline = outline->next)
-    prioritize_points(outline, &point_heap);
+  if (search_found) {
+    for (EDGEPT *point : search->points) points[num_points++] = point;
+  } else {
+    PointHeap point_heap(MAX_NUM_POINTS);
+    for (outline = blob->outlines; outline; outline = outline->next)
+      prioritize_points(outline, &point_heap);
 
-  while (!point_heap.empty() && num_points < MAX_NUM_POINTS) {
-    points[num_points++] = point_heap.PeekTop().data();
-    point_heap.Pop(nullptr);
+    while (!point_heap.empty() && num_points < MAX_NUM_POINTS) {
+      points[num_points++] = point_heap.PeekTop().data();
+      point_heap.Pop(nullptr);
+    }
+    if (search != nullptr)
+      search->points.assign(points, points + num_points);
   }
 
   /* Initialize queue */
   SeamQueue seam_queue(MAX_NUM_SEAMS);
 
-  try_point_pairs(points, num_points, &seam_queue, &seam_pile, &seam, blob);
+  if (search_found) {
+    for (const SplitCandidate &pair : search->pairs) {
+      SPLIT split(pair.point1, pair.point2);
+      choose_best_seam(&seam_queue, &split, pair.priority, &seam, blob,
+                       &seam_pile);
+    }
+  } else {
+    try_point_pairs(points, num_points, &seam_queue, &seam_pile, &seam, blob,
+                    search != nullptr ? &search->pairs : nullptr);
+  }
   try_vertical_splits(points, num_points, &new_points,
                       &seam_queue, &seam_pile, &seam, blob);
 
@@ -282,24 +321,36 @@ SEAM *Wordrec::pick_good_seam(TBLOB *blob) {
 
   if (chop_debug)
     wordrec_display_splits.set_value(false);
+  // All the inserted points are gone again, so the blob is as it was when
+  // it was looked up.
+  if (seam == nullptr && search != nullptr) search->no_seam = true;
 
   return (seam);
 }
 
 
+void Wordrec::ClearSeamCache() {
+  if (wordrec_debug_level > 0 && seam_cache_.lookups() > 0)
+    seam_cache_.PrintStats();
+  seam_cache_.Clear();
+}
+
+
 /**********************************************************************
  * try_point_pairs
  *
  * Try all the splits that are produced by pairing critical points
  * together.  See if any of them are suitable for use.  Use a seam
  * queue and seam pile that have already been initialized and used.
+ * If pairs is not nullptr, the splits tried are added to it.
  **********************************************************************/
 void Wordrec::try_point_pairs(EDGEPT * points[MAX_NUM_POINTS],
                               int16_t num_points,
                               SeamQueue* seam_queue,
                               SeamPile* seam_pile,
                               SEAM ** seam,
-                              TBLOB * blob) {
+                              TBLOB * blob,
+                              std::vector<SplitCandidate>* pairs) {
   int16_t x;
   int16_t y;
   PRIORITY priority;
@@ -314,6 +365,8 @@ void Wordrec::try_point_pairs(EDGEPT * points[MAX_NUM_POINTS],
           !is_exterior_point(points[y], points[x])) {
         SPLIT split(points[x], points[y]);
         priority = partial_split_priority(&split);
+        if (pairs != nullptr)
+          pairs->push_back({points[x], points[y], priority});
 
         choose_best_seam(seam_queue, &split, priority, seam, blob, seam_pile);
       }
@@ -21,6 +21,7 @@
 #define TESSERACT_WORDREC_LANGUAGE_MODEL_DEFS_H_
 
 #include "associate.h"       // for AssociateStats
+#include "chunkallocator.h"  // for ChunkAllocator
 #include "dawg.h"            // for DawgPositionVector
 #include "elst.h"            // for ELIST_ITERATOR, ELISTIZEH, ELIST_LINK
 #include "genericvector.h"   // for PointerVector
@@ -28,6 +29,8 @@
 #include "ratngs.h"          // for BLOB_CHOICE, PermuterType
 #include "stopper.h"         // for DANGERR
 #include "strngs.h"          // for STRING
+
+#include <cstddef>           // for size_t
 #include <tesseract/unichar.h>         // for UNICHAR_ID
 #include "unicharset.h"      // for UNICHARSET
 
@@ -86,9 +89,36 @@ struct LanguageModelNgramInfo {
   float ngram_and_classifier_cost;
 };
 
+/// Size of the chunks that the objects of the search of one word come from.
+const size_t kSearchArenaChunkSize = 64 * 1024;
+/// Biggest object that is taken from a chunk.
+const size_t kMaxSearchArenaBlock = 1024;
+
+/// Base class for the objects of the segmentation search of one word, which
+/// are made and pruned in large numbers. They are made with
+/// new (arena) T(...) from the ChunkAllocator of the word's search, or with
+/// plain new to use the heap, and deleted with delete as usual, including by
+/// the ELIST and PointerVector that own them. Deleted objects leave their
+/// memory for reuse in the arena, which gives back all of it at once when
+/// it is destroyed, so the objects cost no malloc or free of their own.
+struct SearchArenaObject {
+  static void* operator new(size_t size) {
+    return ChunkAllocator::New(size, nullptr);
+  }
+  static void* operator new(size_t size, ChunkAllocator* arena) {
+    return ChunkAllocator::New(size, arena);
+  }
+  static void operator delete(void* p) {
+    ChunkAllocator::Delete(p);
+  }
+  static void operator delete(void* p, ChunkAllocator*) {
+    ChunkAllocator::Delete(p);
+  }
+};
+
 /// Struct for storing the information about a path in the segmentation graph
 /// explored by Viterbi search.
-struct ViterbiStateEntry : public ELIST_LINK {
+struct ViterbiStateEntry : public ELIST_LINK, public SearchArenaObject {
   ViterbiStateEntry(ViterbiStateEntry *pe,
                     BLOB_CHOICE *b, float c, float ol,
                     const LMConsistencyInfo &ci,
@@ -197,7 +227,7 @@ struct ViterbiStateEntry : public ELIST_LINK {
 ELISTIZEH(ViterbiStateEntry)
 
 /// Struct to store information maintained by various language model components.
-struct LanguageModelState {
+struct LanguageModelState : public SearchArenaObject {
   LanguageModelState() :
      viterbi_state_entries_prunable_length(0),
     viterbi_state_entries_prunable_max_cost(FLT_MAX),
@@ -221,13 +251,17 @@ struct LanguageModelState {
 /// Bundle together all the things pertaining to the best choice/state.
 struct BestChoiceBundle {
   explicit BestChoiceBundle(int matrix_dimension)
-    : updated(false), best_vse(nullptr) {
+    : arena(kSearchArenaChunkSize, kMaxSearchArenaBlock),
+      updated(false), best_vse(nullptr) {
     beam.reserve(matrix_dimension);
     for (int i = 0; i < matrix_dimension; ++i)
-      beam.push_back(new LanguageModelState);
+      beam.push_back(new (&arena) LanguageModelState);
   }
   ~BestChoiceBundle() {}
 
+  /// Holds the LanguageModelStates and ViterbiStateEntries of the search.
+  /// Declared first, so it is destroyed after the beam that uses it.
+  ChunkAllocator arena;
   /// Flag to indicate whether anything was changed.
   bool updated;
   /// Places to try to fix the word suggested by ambiguity checking.
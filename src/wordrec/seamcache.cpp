@@ -0,0 +1,95 @@
+///////////////////////////////////////////////////////////////////////
+// File:        seamcache.cpp
+// Description: Cache of the split candidates of the blobs being chopped.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#include "seamcache.h"
+
+#include "blobs.h"    // for TBLOB, TESSLINE, EDGEPT
+#include "tprintf.h"  // for tprintf
+
+namespace tesseract {
+
+// Max number of blobs remembered. The cache is emptied when it is full, so
+// that a word with a very large number of chops cannot make it grow without
+// bound.
+const size_t kMaxSearches = 1000;
+// Separates the outlines in a key.
+const intptr_t kEndOfOutline = -1;
+
+SeamSearchCache::SeamSearchCache() : lookups_(0), hits_(0) {}
+
+SeamSearchCache::~SeamSearchCache() = default;
+
+size_t SeamSearchCache::KeyHash::operator()(const Key& key) const {
+  // FNV-1a over the words of the key.
+  uint64_t hash = 14695981039346656037ULL;
+  for (intptr_t value : key) {
+    hash ^= static_cast<uint64_t>(value);
+    hash *= 1099511628211ULL;
+  }
+  return static_cast<size_t>(hash);
+}
+
+void SeamSearchCache::MakeKey(const TBLOB& blob, Key* key) {
+  key->clear();
+  for (const TESSLINE* outline = blob.outlines; outline != nullptr;
+       outline = outline->next) {
+    key->push_back(outline->is_hole);
+    const EDGEPT* pt = outline->loop;
+    if (pt != nullptr) {
+      do {
+        key->push_back(reinterpret_cast<intptr_t>(pt));
+        key->push_back(pt->pos.x);
+        key->push_back(pt->pos.y);
+        key->push_back(pt->vec.x);
+        key->push_back(pt->vec.y);
+        key->push_back(pt->IsHidden() | pt->IsChopPt() << 1);
+        pt = pt->next;
+      } while (pt != outline->loop);
+    }
+    key->push_back(kEndOfOutline);
+  }
+}
+
+SeamSearch* SeamSearchCache::Lookup(const TBLOB& blob, bool* found) {
+  Key key;
+  MakeKey(blob, &key);
+  ++lookups_;
+  auto it = searches_.find(key);
+  *found = it != searches_.end();
+  if (*found) {
+    ++hits_;
+    return &it->second;
+  }
+  if (searches_.size() >= kMaxSearches) searches_.clear();
+  return &searches_[key];
+}
+
+void SeamSearchCache::ClearSearches() {
+  searches_.clear();
+}
+
+void SeamSearchCache::Clear() {
+  searches_.clear();
+  lookups_ = 0;
+  hits_ = 0;
+}
+
+void SeamSearchCache::PrintStats() const {
+  tprintf("Seam cache: %d of %d seam searches reused (%.1f%%)\n", hits_,
+          lookups_, lookups_ > 0 ? 100.0 * hits_ / lookups_ : 0.0);
+}
+
+}  // namespace tesseract.
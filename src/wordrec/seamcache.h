@@ -0,0 +1,99 @@
+///////////////////////////////////////////////////////////////////////
+// File:        seamcache.h
+// Description: Cache of the split candidates of the blobs being chopped.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////
+
+#ifndef TESSERACT_WORDREC_SEAMCACHE_H_
+#define TESSERACT_WORDREC_SEAMCACHE_H_
+
+#include <cstdint>        // for intptr_t
+#include <unordered_map>  // for std::unordered_map
+#include <vector>         // for std::vector
+#include "seam.h"         // for PRIORITY
+
+namespace tesseract {
+
+struct EDGEPT;
+struct TBLOB;
+
+// A pair of critical points that try_point_pairs found worth splitting
+// between, with the partial priority of the split.
+struct SplitCandidate {
+  EDGEPT* point1;
+  EDGEPT* point2;
+  PRIORITY priority;
+};
+
+// What pick_good_seam found out about one blob: its critical points, the
+// point pairs that make acceptable splits, and whether the search ended
+// without a seam.
+struct SeamSearch {
+  SeamSearch() : no_seam(false) {}
+
+  std::vector<EDGEPT*> points;
+  std::vector<SplitCandidate> pairs;
+  bool no_seam;
+};
+
+// Remembers the seam searches of the blobs being chopped, so that a blob
+// that the chopper comes back to, after a chop of it was rejected or while
+// it tries other blobs of the word, does not have its critical points and
+// split priorities worked out again, and a blob that has no seam is given
+// up on straight away.
+// The key is the edge points of the blob, by address as well as by
+// position, so an entry is only ever found for the very same outlines in
+// the same state, and the points it holds are points of the blob.
+// The searches depend on chop_ok_split and chop_good_split, and a freed
+// edge point may be reused at the same address by a later word, so the
+// entries must be forgotten with ClearSearches before each word is chopped
+// and whenever those thresholds change.
+class SeamSearchCache {
+ public:
+  SeamSearchCache();
+  ~SeamSearchCache();
+
+  // Returns the search stored for blob, setting *found, or a new empty
+  // search for it to be filled in by the caller, clearing *found.
+  SeamSearch* Lookup(const TBLOB& blob, bool* found);
+  // Empties the cache, keeping the counts.
+  void ClearSearches();
+  // Empties the cache and resets the counts.
+  void Clear();
+  // Prints the number of searches saved.
+  void PrintStats() const;
+
+  int lookups() const {
+    return lookups_;
+  }
+  int hits() const {
+    return hits_;
+  }
+
+ private:
+  using Key = std::vector<intptr_t>;
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+
+  // Makes the key describing the outlines of blob.
+  static void MakeKey(const TBLOB& blob, Key* key);
+
+  std::unordered_map<Key, SeamSearch, KeyHash> searches_;
+  int lookups_;
+  int hits_;
+};
+
+}  // namespace tesseract.
+
+#endif  // TESSERACT_WORDREC_SEAMCACHE_H_
@@ -21,6 +21,7 @@
 ----------------------------------------------------------------------*/
 
 #include "blamer.h"   // for blamer_bundle
+#include "normalis.h" // for DENORM
 #include "params.h"   // for BoolParam
 #include "render.h"   // for display_blob, blob_window, wordrec_blob_pause
 #include "wordrec.h"  // for Wordrec
@@ -58,7 +59,29 @@ BLOB_CHOICE_LIST *Wordrec::classify_blob(TBLOB *blob,
     display_blob(blob, color);
 #endif
   // TODO(rays) collapse with call_matcher and move all to wordrec.cpp.
-  BLOB_CHOICE_LIST* choices = call_matcher(blob);
+  BLOB_CHOICE_LIST* choices = nullptr;
+  if (wordrec_blob_cache) {
+    choices = blob_cache_.Lookup(*blob, adaptation_count());
+    if (choices != nullptr) {
+      // The x-height ranges depend on the position of the blob, which is
+      // not part of the key.
+      BLOB_CHOICE_IT bc_it(choices);
+      for (bc_it.mark_cycle_pt(); !bc_it.cycled_list(); bc_it.forward()) {
+        BLOB_CHOICE* choice = bc_it.data();
+        if (choice->classifier() == BCC_SPECKLE_CLASSIFIER) continue;
+        float min_xheight, max_xheight, yshift;
+        blob->denorm().XHeightRange(choice->unichar_id(), unicharset,
+                                    blob->bounding_box(), &min_xheight,
+                                    &max_xheight, &yshift);
+        choice->set_xheight_range(min_xheight, max_xheight, yshift);
+      }
+    }
+  }
+  if (choices == nullptr) {
+    choices = call_matcher(blob);
+    if (wordrec_blob_cache)
+      blob_cache_.Store(*blob, adaptation_count(), *choices);
+  }
   // If a blob with the same bounding box as one of the truth character
   // bounding boxes is not classified as the corresponding truth character
   // blame character classifier for incorrect answer.
@@ -79,4 +102,10 @@ BLOB_CHOICE_LIST *Wordrec::classify_blob(TBLOB *blob,
   return choices;
 }
 
+void Wordrec::ClearBlobCache() {
+  if (wordrec_debug_level > 0 && blob_cache_.hits() + blob_cache_.misses() > 0)
+    blob_cache_.PrintStats();
+  blob_cache_.Clear();
+}
+
 }  // namespace tesseract;
@@ -97,6 +97,9 @@ Wordrec::Wordrec() :
                 params()),
   INT_MEMBER(chop_x_y_weight, 3, "X / Y  length weight",
              params()),
+  BOOL_MEMBER(chop_cache_splits, true,
+              "Reuse the split candidates of blobs that are chopped again",
+              params()),
   BOOL_MEMBER(assume_fixed_pitch_char_segment, false,
               "include fixed-pitch heuristics in char segmentation",
               params()),
@@ -126,6 +129,9 @@ Wordrec::Wordrec() :
               "Save alternative paths found during chopping"
               " and segmentation search",
               params()),
+  BOOL_MEMBER(wordrec_blob_cache, false,
+              "Classify the blobs of the same shape on a page only once",
+              params()),
   pass2_ok_split(0.0f) {
   prev_word_best_choice_ = nullptr;
   language_model_.reset(new LanguageModel(&get_fontinfo_table(),
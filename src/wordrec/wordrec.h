@@ -65,6 +65,7 @@ class Wordrec : public Classify {
 
 #include <memory>
 #include "associate.h"
+#include "blobcache.h"         // for BlobChoiceCache
 #include "chop.h"              // for PointHeap, MAX_NUM_POINTS
 #include "classify.h"          // for Classify
 #include "dict.h"
@@ -77,6 +78,7 @@ class Wordrec : public Classify {
 #include "points.h"            // for ICOORD
 #include "ratngs.h"            // for BLOB_CHOICE_LIST (ptr only), BLOB_CHOI...
 #include "seam.h"              // for SEAM (ptr only), PRIORITY
+#include "seamcache.h"         // for SeamSearchCache, SplitCandidate
 #include "stopper.h"           // for DANGERR
 
 #include "genericvector.h"     // for GenericVector
@@ -222,6 +224,8 @@ class Wordrec : public Classify {
   double_VAR_H(chop_ok_split, 100.0, "OK split limit");
   double_VAR_H(chop_good_split, 50.0, "Good split limit");
   INT_VAR_H(chop_x_y_weight, 3, "X / Y  length weight");
+  BOOL_VAR_H(chop_cache_splits, true,
+             "Reuse the split candidates of blobs that are chopped again");
   BOOL_VAR_H(assume_fixed_pitch_char_segment, false,
              "include fixed-pitch heuristics in char segmentation");
   INT_VAR_H(wordrec_debug_level, 0, "Debug level for wordrec");
@@ -241,6 +245,8 @@ class Wordrec : public Classify {
   BOOL_VAR_H(save_alt_choices, true,
              "Save alternative paths found during chopping "
              "and segmentation search");
+  BOOL_VAR_H(wordrec_blob_cache, false,
+             "Classify the blobs of the same shape on a page only once");
 
   // methods from wordrec/*.cpp ***********************************************
   Wordrec();
@@ -279,6 +285,20 @@ class Wordrec : public Classify {
                                   const char *string,
                                   ScrollView::Color color,
                                   BlamerBundle *blamer_bundle);
+  // Empties the cache of blob classifications, at the end of a page,
+  // printing its hit rate if wordrec_debug_level > 0.
+  void ClearBlobCache();
+  // Empties the cache of seam searches, at the end of a page, printing the
+  // number of searches saved if wordrec_debug_level > 0.
+  void ClearSeamCache();
+  // Forgets the seam searches, keeping the counts, when a new word is to be
+  // chopped or the chop thresholds change. See SeamSearchCache.
+  void ResetSeamSearches() {
+    seam_cache_.ClearSearches();
+  }
+  const SeamSearchCache& seam_cache() const {
+    return seam_cache_;
+  }
 
   // segsearch.cpp
   // SegSearch works on the lower diagonal matrix of BLOB_CHOICE_LISTs.
@@ -407,7 +427,8 @@ class Wordrec : public Classify {
                         int16_t num_points,
                         SeamQueue* seam_queue,
                         SeamPile* seam_pile,
-                        SEAM ** seam, TBLOB * blob);
+                        SEAM ** seam, TBLOB * blob,
+                        std::vector<SplitCandidate>* pairs);
   void try_vertical_splits(EDGEPT * points[MAX_NUM_POINTS],
                            int16_t num_points,
                            EDGEPT_CLIST *new_points,
@@ -477,6 +498,12 @@ class Wordrec : public Classify {
   WERD_CHOICE *prev_word_best_choice_;
   // Sums of blame reasons computed by the blamer.
   GenericVector<int> blame_reasons_;
+  // Classifications of the blobs of the current page, used by classify_blob
+  // if wordrec_blob_cache.
+  BlobChoiceCache blob_cache_;
+  // Seam searches of the blobs being chopped, used by pick_good_seam if
+  // chop_cache_splits.
+  SeamSearchCache seam_cache_;
   // Function used to fill char choice lattices.
   void (Wordrec::*fill_lattice_)(const MATRIX &ratings,
                                  const WERD_CHOICE_LIST &best_choices,
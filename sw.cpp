@@ -73,9 +73,12 @@ void build(Solution &s)
         if (libtesseract.getBuildSettings().TargetOS.Type != OSType::Windows)
         {
             libtesseract["src/arch/dotproductavx.cpp"].args.push_back("-mavx");
+            libtesseract["src/arch/weightupdateavx.cpp"].args.push_back("-mavx");
             libtesseract["src/arch/dotproductsse.cpp"].args.push_back("-msse4.1");
             libtesseract["src/arch/intsimdmatrixsse.cpp"].args.push_back("-msse4.1");
             libtesseract["src/arch/intsimdmatrixavx2.cpp"].args.push_back("-mavx2");
+            libtesseract["src/arch/classpruneravx2.cpp"].args.push_back("-mavx2");
+            libtesseract["src/arch/protodistanceavx2.cpp"].args.push_back("-mavx2");
         }
         if (!win_or_mingw)
             libtesseract += "pthread"_slib;
@@ -156,6 +159,9 @@ void build(Solution &s)
     {
         unicharset_training += cppstd;
         unicharset_training +=
+            "src/training/checkpointwriter.*"_rr,
+            "src/training/degradeimage.*"_rr,
+            "src/training/degradekernel.*"_rr,
             "src/training/fileio.*"_rr,
             "src/training/icuerrorcode.*"_rr,
             "src/training/icuerrorcode.h",
@@ -167,6 +173,8 @@ void build(Solution &s)
             "src/training/validat.*"_rr;
         unicharset_training.Public += common_training;
         unicharset_training.Public += "org.sw.demo.unicode.icu.i18n"_dep;
+        if (unicharset_training.getBuildSettings().TargetOS.Type != OSType::Windows)
+            unicharset_training["src/training/degradekernelavx2.cpp"].args.push_back("-mavx2");
     }
 
     //
@@ -188,6 +196,7 @@ void build(Solution &s)
     ADD_EXE(unicharset_extractor, unicharset_training);
     ADD_EXE(wordlist2dawg, libtesseract);
     ADD_EXE(lstmeval, unicharset_training);
+    ADD_EXE(lstmshard, unicharset_training);
     ADD_EXE(lstmtraining, unicharset_training);
     ADD_EXE(set_unicharset_properties, unicharset_training);
     ADD_EXE(merge_unicharsets, tessopt);
@@ -216,8 +225,6 @@ void build(Solution &s)
     {
         text2image += cppstd;
         text2image +=
-            "src/training/degradeimage.cpp",
-            "src/training/degradeimage.h",
             "src/training/icuerrorcode.h",
             "src/training/normstrngs.cpp",
             "src/training/normstrngs.h",
@@ -15,8 +15,12 @@
 #include "log.h"        // for LOG
 #include "ocrblock.h"   // for class BLOCK
 #include "pageres.h"
+#include "protodistance.h" // for ProtoDistancesGeneric
+#include "simddetect.h"     // for ProtoDistances
+#include "tesseractclass.h" // for Tesseract
 
 #include <tesseract/baseapi.h>
+#include <tesseract/renderer.h>
 
 #include "allheaders.h"
 #include "absl/strings/ascii.h"
@@ -25,6 +29,7 @@
 
 #include <memory>
 #include <regex>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -85,6 +90,133 @@ TEST_F(TesseractTest, BasicTesseractTest) {
   }
 }
 
+// Tests that the legacy engine gets the same answer on phototest when it
+// classifies the blobs of the same shape only once.
+TEST_F(TesseractTest, BlobCacheTest) {
+#ifdef DISABLED_LEGACY_ENGINE
+  // Skip test because the blob cache is part of the legacy engine.
+  GTEST_SKIP();
+#else
+  tesseract::TessBaseAPI api;
+  std::string truth_text;
+  std::string ocr_text;
+  if (api.Init(TessdataPath().c_str(), "eng", tesseract::OEM_TESSERACT_ONLY) == -1) {
+    // eng.traineddata not found.
+    GTEST_SKIP();
+    return;
+  }
+  api.SetVariable("wordrec_blob_cache", "1");
+  Pix* src_pix = pixRead(TestDataNameToPath("phototest.tif").c_str());
+  CHECK(src_pix);
+  ocr_text = GetCleanedTextResult(&api, src_pix);
+  CHECK_OK(file::GetContents(TestDataNameToPath("phototest.gold.txt"),
+                             &truth_text, file::Defaults()));
+  absl::StripAsciiWhitespace(&truth_text);
+  EXPECT_STREQ(truth_text.c_str(), ocr_text.c_str());
+  // The repeated letters of phototest and the blobs that the segmentation
+  // search classifies more than once must have come from the cache.
+  const tesseract::BlobChoiceCache& cache = api.tesseract()->blob_cache_;
+  EXPECT_GT(cache.hits(), 0);
+  EXPECT_GT(cache.misses(), 0);
+  pixDestroy(&src_pix);
+#endif
+}
+
+// Tests that the chopper gets the same answer when it reuses the split
+// candidates of the blobs it comes back to, and logs the seam searches per
+// second with and without the reuse, on phototest thickened so that
+// neighbouring characters touch.
+TEST_F(TesseractTest, SeamCacheBenchmark) {
+#ifdef DISABLED_LEGACY_ENGINE
+  // Skip test because the chopper is part of the legacy engine.
+  GTEST_SKIP();
+#else
+  tesseract::TessBaseAPI api;
+  if (api.Init(TessdataPath().c_str(), "eng", tesseract::OEM_TESSERACT_ONLY) == -1) {
+    // eng.traineddata not found.
+    GTEST_SKIP();
+    return;
+  }
+  Pix* src_pix = pixRead(TestDataNameToPath("phototest.tif").c_str());
+  CHECK(src_pix);
+  Pix* binary_pix = pixConvertTo1(src_pix, 128);
+  Pix* touching_pix = pixDilateBrick(nullptr, binary_pix, 3, 1);
+  CHECK(touching_pix);
+  std::string ocr_text[2];
+  int seam_searches = 0;
+  for (int cache = 0; cache < 2; ++cache) {
+    api.SetVariable("chop_cache_splits", cache ? "1" : "0");
+    api.SetImage(touching_pix);
+    CycleTimer timer;
+    timer.Restart();
+    EXPECT_EQ(0, api.Recognize(nullptr));
+    timer.Stop();
+    char* result = api.GetUTF8Text();
+    ocr_text[cache] = result;
+    delete[] result;
+    const SeamSearchCache& seam_cache = api.tesseract()->seam_cache();
+    // Without the cache there are no lookups, but the same seam searches.
+    if (cache) seam_searches = seam_cache.lookups();
+    LOG(INFO) << "chop_cache_splits=" << cache << " took " << timer.GetInMs()
+              << "ms, reusing " << seam_cache.hits() << " of "
+              << seam_cache.lookups() << " seam searches";
+    if (cache && timer.GetInMs() > 0) {
+      LOG(INFO) << seam_searches * 1000.0 / timer.GetInMs()
+                << " seam searches/s";
+    }
+  }
+  EXPECT_GT(seam_searches, 0);
+  EXPECT_EQ(ocr_text[0], ocr_text[1]);
+  pixDestroy(&touching_pix);
+  pixDestroy(&binary_pix);
+  pixDestroy(&src_pix);
+#endif
+}
+
+// Tests that the integer matcher gets the same answer on phototest with the
+// proto distances done one at a time as the pruning finds them, as before
+// the SIMD kernels, and in batches by the kernel that SIMDDetect chose, and
+// logs the time that recognition takes with each.
+TEST_F(TesseractTest, ProtoDistanceMatcherBenchmark) {
+#ifdef DISABLED_LEGACY_ENGINE
+  // Skip test because the integer matcher is part of the legacy engine.
+  GTEST_SKIP();
+#else
+  const int kIterations = 3;
+  tesseract::TessBaseAPI api;
+  if (api.Init(TessdataPath().c_str(), "eng", tesseract::OEM_TESSERACT_ONLY) == -1) {
+    // eng.traineddata not found.
+    GTEST_SKIP();
+    return;
+  }
+  // Without adaption, each run of the page sees the same templates.
+  api.SetVariable("classify_enable_learning", "0");
+  Pix* src_pix = pixRead(TestDataNameToPath("phototest.tif").c_str());
+  CHECK(src_pix);
+  const ProtoDistanceFunction selected = ProtoDistances;
+  std::string ocr_text[2];
+  int64_t ms[2];
+  for (int batched = 0; batched < 2; ++batched) {
+    ProtoDistances = batched ? selected : ProtoDistancesGeneric;
+    CycleTimer timer;
+    timer.Restart();
+    for (int i = 0; i < kIterations; ++i) {
+      ocr_text[batched] = GetCleanedTextResult(&api, src_pix);
+    }
+    timer.Stop();
+    ms[batched] = timer.GetInMs();
+  }
+  ProtoDistances = selected;
+  EXPECT_EQ(ocr_text[0], ocr_text[1]);
+  LOG(INFO) << "phototest x " << kIterations << ": one proto at a time "
+            << ms[0] << "ms, "
+            << (selected == ProtoDistancesGeneric ? "no SIMD kernel "
+                                                  : "SIMD kernel ")
+            << ms[1] << "ms\n";
+  pixDestroy(&src_pix);
+#endif
+}
+
 // Test that api.GetComponentImages() will return a set of images for
 // paragraphs even if text recognition was not run.
 TEST_F(TesseractTest, IteratesParagraphsEvenIfNotDetected) {
@@ -232,6 +364,59 @@ TEST_F(TesseractTest, AdaptToWordStrTest) {
 #endif
 }
 
+// Tests that an engine sharing its adaptive classifier with another gets
+// the right answer on pages it can only read with what the other learned.
+TEST_F(TesseractTest, ShareAdaptiveClassifierTest) {
+#ifdef DISABLED_LEGACY_ENGINE
+  // Skip test because TessBaseAPI::ShareAdaptiveClassifier is missing.
+  GTEST_SKIP();
+#else
+  static const char* kTrainingPages[] = {
+      "136.tif", "256.tif", "410.tif", "432.tif", "540.tif",
+      "692.tif", "779.tif", "793.tif", "808.tif", "815.tif",
+      "12.tif",  "12.tif",  nullptr};
+  static const char* kTrainingText[] = {
+      "1 3 6", "2 5 6", "4 1 0", "4 3 2", "5 4 0", "6 9 2", "7 7 9",
+      "7 9 3", "8 0 8", "8 1 5", "1 2",   "1 2",   nullptr};
+  static const char* kTestPages[] = {"324.tif", "433.tif", "12.tif", nullptr};
+  static const char* kTestText[] = {"324", "433", "12", nullptr};
+  tesseract::TessBaseAPI trainer;
+  tesseract::TessBaseAPI reader;
+  if (trainer.Init(TessdataPath().c_str(), "eng",
+                   tesseract::OEM_TESSERACT_ONLY) == -1 ||
+      reader.Init(TessdataPath().c_str(), "eng",
+                  tesseract::OEM_TESSERACT_ONLY) == -1) {
+    // eng.traineddata not found.
+    GTEST_SKIP();
+    return;
+  }
+  for (tesseract::TessBaseAPI* api : {&trainer, &reader}) {
+    api->SetVariable("matcher_sufficient_examples_for_prototyping", "1");
+    api->SetVariable("classify_class_pruner_threshold", "220");
+  }
+  EXPECT_TRUE(reader.ShareAdaptiveClassifier(&trainer));
+  // Train the trainer only.
+  for (int i = 0; kTrainingPages[i] != nullptr; ++i) {
+    Pix* src_pix = pixRead(TestDataNameToPath(kTrainingPages[i]).c_str());
+    CHECK(src_pix);
+    trainer.SetImage(src_pix);
+    EXPECT_TRUE(
+        trainer.AdaptToWordStr(tesseract::PSM_SINGLE_WORD, kTrainingText[i]));
+    pixDestroy(&src_pix);
+  }
+  // Test the reader.
+  reader.SetVariable("tess_bn_matching", "1");
+  reader.SetPageSegMode(tesseract::PSM_SINGLE_WORD);
+  for (int i = 0; kTestPages[i] != nullptr; ++i) {
+    Pix* src_pix = pixRead(TestDataNameToPath(kTestPages[i]).c_str());
+    CHECK(src_pix);
+    std::string ocr_text = GetCleanedTextResult(&reader, src_pix);
+    EXPECT_STREQ(kTestText[i], ocr_text.c_str());
+    pixDestroy(&src_pix);
+  }
+#endif
+}
+
 // Tests that LSTM gets exactly the right answer on phototest.
 TEST_F(TesseractTest, BasicLSTMTest) {
   tesseract::TessBaseAPI api;
@@ -252,6 +437,165 @@ TEST_F(TesseractTest, BasicLSTMTest) {
   pixDestroy(&src_pix);
 }
 
+// Splits text into its non-empty lines, with the whitespace in each line
+// collapsed to single spaces.
+static std::vector<std::string> TextLines(const char* text) {
+  std::vector<std::string> lines;
+  std::istringstream stream(text);
+  std::string line;
+  while (std::getline(stream, line)) {
+    std::istringstream line_stream(line);
+    std::string word, words;
+    while (line_stream >> word) words += (words.empty() ? "" : " ") + word;
+    if (!words.empty()) lines.push_back(words);
+  }
+  return lines;
+}
+
+// Tests that recognizing in tiles finds every line of phototest once, whole
+// and in reading order, even though most of the lines cross a seam and most
+// words are seen by more than one tile.
+TEST_F(TesseractTest, TiledRecognitionFindsEachLineInOrder) {
+  tesseract::TessBaseAPI api;
+  if (api.Init(TessdataPath().c_str(), "eng", tesseract::OEM_LSTM_ONLY) == -1) {
+    // eng.traineddata not found.
+    GTEST_SKIP();
+    return;
+  }
+  Pix* src_pix = pixRead(TestDataNameToPath("phototest_2.tif").c_str());
+  CHECK(src_pix);
+  std::string truth_text;
+  CHECK_OK(file::GetContents(TestDataNameToPath("phototest.gold.txt"),
+                             &truth_text, file::Defaults()));
+  std::vector<std::string> truth_lines = TextLines(truth_text.c_str());
+  api.SetVariable("tessedit_tile_size", "400");
+  api.SetVariable("tessedit_tile_overlap", "200");
+  // Twice with 2 jobs, so that the second run reuses the tile engines.
+  for (const char* jobs : {"1", "2", "2"}) {
+    api.SetVariable("tessedit_tile_jobs", jobs);
+    EXPECT_TRUE(api.RecognizeTiled(src_pix, 0));
+    std::unique_ptr<char[]> text(api.GetUTF8Text());
+    EXPECT_EQ(truth_lines, TextLines(text.get())) << "jobs " << jobs;
+    // One TSV row at level 4 for each line.
+    std::unique_ptr<char[]> tsv(api.GetTSVText(0));
+    std::istringstream tsv_stream(tsv.get());
+    std::string row;
+    size_t num_lines = 0;
+    while (std::getline(tsv_stream, row)) {
+      if (row.compare(0, 2, "4\t") == 0) ++num_lines;
+    }
+    EXPECT_EQ(truth_lines.size(), num_lines) << "jobs " << jobs;
+    EXPECT_THAT(tsv.get(), HasSubstr("quick"));
+  }
+  pixDestroy(&src_pix);
+}
+
+// Tests that ProcessPage recognizes a big image in one piece, instead of in
+// tiles, when a renderer needs more than the text and TSV of the tiles.
+TEST_F(TesseractTest, TiledRecognitionFallsBackForOtherRenderers) {
+  tesseract::TessBaseAPI api;
+  if (api.Init(TessdataPath().c_str(), "eng", tesseract::OEM_LSTM_ONLY) == -1) {
+    // eng.traineddata not found.
+    GTEST_SKIP();
+    return;
+  }
+  Pix* src_pix = pixRead(TestDataNameToPath("phototest_2.tif").c_str());
+  CHECK(src_pix);
+  api.SetVariable("tessedit_tile_size", "400");
+#if defined(_WIN32)
+  _mkdir(FLAGS_test_tmpdir);
+#else
+  mkdir(FLAGS_test_tmpdir, S_IRWXU | S_IRWXG);
+#endif
+  std::string outputbase = file::JoinPath(FLAGS_test_tmpdir, "tiled_hocr");
+  tesseract::TessHOcrRenderer renderer(outputbase.c_str());
+  EXPECT_TRUE(renderer.BeginDocument("tiled"));
+  EXPECT_TRUE(api.ProcessPage(src_pix, 0, "phototest_2.tif", nullptr, 0,
+                              &renderer));
+  EXPECT_TRUE(renderer.EndDocument());
+  // The hOCR is made from the results of the whole page.
+  std::unique_ptr<char[]> hocr(api.GetHOCRText(0));
+  ASSERT_TRUE(hocr != nullptr);
+  EXPECT_THAT(hocr.get(), HasSubstr("quick"));
+  pixDestroy(&src_pix);
+}
+
+// Makes a word with a best choice of the given certainty.
+static WERD_RES* MakeMultilangWord(const UNICHARSET* unicharset, bool accepted,
+                                   float certainty) {
+  auto* word = new WERD_RES;
+  word->tess_accepted = accepted;
+  auto* choice = new WERD_CHOICE(unicharset);
+  choice->set_certainty(certainty);
+  WERD_CHOICE_IT it(&word->best_choices);
+  it.add_after_then_move(choice);
+  word->best_choice = choice;
+  return word;
+}
+
+// Tests when the other languages are tried on a word, with and without a
+// chosen line language and a certainty limit.
+TEST_F(TesseractTest, MultilangRetriesWordsAsConfigured) {
+  Tesseract tess;
+  const UNICHARSET* unicharset = &tess.unicharset;
+  PointerVector<WERD_RES> good, bad, weak_good, weak_bad;
+  good.push_back(MakeMultilangWord(unicharset, true, -1.0f));
+  bad.push_back(MakeMultilangWord(unicharset, false, -1.0f));
+  weak_good.push_back(MakeMultilangWord(unicharset, true, -8.0f));
+  weak_bad.push_back(MakeMultilangWord(unicharset, false, -8.0f));
+  // Without a limit, the words that are not acceptable are tried again,
+  // whether the line language is chosen or not.
+  for (bool line_chosen : {false, true}) {
+    EXPECT_FALSE(tess.NeedsOtherLanguages(good, line_chosen));
+    EXPECT_TRUE(tess.NeedsOtherLanguages(bad, line_chosen));
+    EXPECT_FALSE(tess.NeedsOtherLanguages(weak_good, line_chosen));
+    EXPECT_TRUE(tess.NeedsOtherLanguages(weak_bad, line_chosen));
+  }
+  // With a limit, only the words below it are tried again, and, until the
+  // line language is chosen, only if they are not acceptable either.
+  tess.multilang_retry_certainty.set_value(-5.0);
+  EXPECT_FALSE(tess.NeedsOtherLanguages(good, false));
+  EXPECT_FALSE(tess.NeedsOtherLanguages(bad, false));
+  EXPECT_FALSE(tess.NeedsOtherLanguages(weak_good, false));
+  EXPECT_TRUE(tess.NeedsOtherLanguages(weak_bad, false));
+  EXPECT_FALSE(tess.NeedsOtherLanguages(good, true));
+  EXPECT_FALSE(tess.NeedsOtherLanguages(bad, true));
+  EXPECT_TRUE(tess.NeedsOtherLanguages(weak_good, true));
+  EXPECT_TRUE(tess.NeedsOtherLanguages(weak_bad, true));
+}
+
+// Tests that choosing the language per textline, and trying the other
+// languages at once, still read phototest right with two languages loaded,
+// and that the parallel and sequential retries agree.
+TEST_F(TesseractTest, MultilangLineLanguageTest) {
+  tesseract::TessBaseAPI api;
+  if (api.Init(TessdataPath().c_str(), "eng+deu",
+               tesseract::OEM_LSTM_ONLY) == -1) {
+    // eng.traineddata or deu.traineddata not found.
+    GTEST_SKIP();
+    return;
+  }
+  Pix* src_pix = pixRead(TestDataNameToPath("phototest.tif").c_str());
+  CHECK(src_pix);
+  std::string truth_text;
+  CHECK_OK(file::GetContents(TestDataNameToPath("phototest.gold.txt"),
+                             &truth_text, file::Defaults()));
+  absl::StripAsciiWhitespace(&truth_text);
+  api.SetVariable("multilang_line_language", "1");
+  for (const char* limit : {"0", "-2"}) {
+    api.SetVariable("multilang_retry_certainty", limit);
+    api.SetVariable("tessedit_parallelize", "0");
+    std::string sequential_text = GetCleanedTextResult(&api, src_pix);
+    api.SetVariable("tessedit_parallelize", "1");
+    std::string parallel_text = GetCleanedTextResult(&api, src_pix);
+    EXPECT_EQ(sequential_text, parallel_text) << "limit " << limit;
+    if (strcmp(limit, "0") == 0) {
+      EXPECT_STREQ(truth_text.c_str(), sequential_text.c_str());
+    }
+  }
+  pixDestroy(&src_pix);
+}
+
 // Test that LSTM's character bounding boxes are properly converted to
 // Tesseract structures. Note that we can't guarantee that LSTM's
 // character boxes fall completely within Tesseract's word box because
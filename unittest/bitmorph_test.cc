@@ -0,0 +1,137 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <random>
+
+#include "allheaders.h"
+#include "bitmorph.h"
+
+#include "include_gunit.h"
+
+namespace tesseract {
+
+class BitMorphTest : public testing::Test {
+ protected:
+  // Makes a random 1bpp image of sparse specks plus some horizontal and
+  // vertical lines of assorted widths, so the bricks have runs to find.
+  Pix* MakeImage(int width, int height, unsigned seed) {
+    std::mt19937 random(seed);
+    Pix* pix = pixCreate(width, height, 1);
+    for (int y = 0; y < height; ++y) {
+      for (int x = 0; x < width; ++x) {
+        if (random() % 100 < 20) pixSetPixel(pix, x, y, 1);
+      }
+    }
+    for (int i = 0; i < 20; ++i) {
+      int x = random() % width;
+      int y = random() % height;
+      int thickness = 1 + random() % 6;
+      int length = random() % width;
+      if (i % 2 == 0)
+        pixRasterop(pix, x, y, length, thickness, PIX_SET, nullptr, 0, 0);
+      else
+        pixRasterop(pix, x, y, thickness, length, PIX_SET, nullptr, 0, 0);
+    }
+    return pix;
+  }
+
+  // Expects the images to be identical, ignoring a border of the given size.
+  void ExpectSame(Pix* expected, Pix* actual, int border) {
+    ASSERT_TRUE(actual != nullptr);
+    Box* box = boxCreate(border, border, pixGetWidth(expected) - 2 * border,
+                         pixGetHeight(expected) - 2 * border);
+    Pix* expected_clip = pixClipRectangle(expected, box, nullptr);
+    Pix* actual_clip = pixClipRectangle(actual, box, nullptr);
+    l_int32 same = 0;
+    pixEqual(expected_clip, actual_clip, &same);
+    EXPECT_TRUE(same);
+    pixDestroy(&expected_clip);
+    pixDestroy(&actual_clip);
+    boxDestroy(&box);
+  }
+};
+
+// The opening must match Leptonica everywhere, for odd and even bricks.
+TEST_F(BitMorphTest, OpenMatchesLeptonica) {
+  const int kSizes[][2] = {{1, 1}, {15, 15}, {1, 75}, {75, 1}, {4, 9}, {33, 2}};
+  Pix* pix = MakeImage(421, 283, 1);
+  for (const auto& size : kSizes) {
+    Pix* expected = pixOpenBrick(nullptr, pix, size[0], size[1]);
+    Pix* actual = OpenBrickPacked(pix, size[0], size[1], 1);
+    ExpectSame(expected, actual, 0);
+    pixDestroy(&expected);
+    pixDestroy(&actual);
+  }
+  pixDestroy(&pix);
+}
+
+// The closing must match Leptonica everywhere, including the border.
+TEST_F(BitMorphTest, CloseMatchesLeptonica) {
+  const int kSizes[][2] = {{1, 1}, {5, 5}, {2, 7}, {9, 1}, {1, 12}};
+  Pix* pix = MakeImage(389, 301, 2);
+  for (const auto& size : kSizes) {
+    Pix* expected = pixCloseBrick(nullptr, pix, size[0], size[1]);
+    Pix* actual = CloseBrickPacked(pix, size[0], size[1], 1);
+    ExpectSame(expected, actual, 0);
+    pixDestroy(&expected);
+    pixDestroy(&actual);
+  }
+  pixDestroy(&pix);
+}
+
+// With Leptonica's default asymmetric boundary condition, the pixels outside
+// the image are OFF for the erosion as well as the dilation, so closing a
+// solid image clears exactly the pixels whose brick reaches outside it:
+// hsize / 2 columns on the left, hsize - 1 - hsize / 2 on the right, and
+// likewise for the rows at the top and bottom.
+TEST_F(BitMorphTest, CloseClearsBorder) {
+  const int kSizes[][2] = {{6, 9}, {5, 1}, {1, 4}, {40, 33}};
+  const int kWidth = 100;
+  const int kHeight = 80;
+  Pix* pix = pixCreate(kWidth, kHeight, 1);
+  pixSetAll(pix);
+  for (const auto& size : kSizes) {
+    int hsize = size[0];
+    int vsize = size[1];
+    Pix* closed = CloseBrickPacked(pix, hsize, vsize, 1);
+    ASSERT_TRUE(closed != nullptr);
+    int num_wrong = 0;
+    for (int y = 0; y < kHeight; ++y) {
+      for (int x = 0; x < kWidth; ++x) {
+        bool inside = x >= hsize / 2 && x < kWidth - (hsize - 1 - hsize / 2) &&
+                      y >= vsize / 2 && y < kHeight - (vsize - 1 - vsize / 2);
+        l_uint32 value = 0;
+        pixGetPixel(closed, x, y, &value);
+        if ((value != 0) != inside) ++num_wrong;
+      }
+    }
+    EXPECT_EQ(0, num_wrong) << "Brick " << hsize << "x" << vsize;
+    pixDestroy(&closed);
+  }
+  pixDestroy(&pix);
+}
+
+// The result must not depend on the number of threads.
+TEST_F(BitMorphTest, ThreadsMatchSingleThread) {
+  Pix* pix = MakeImage(1000, 700, 3);
+  Pix* single = OpenBrickPacked(pix, 1, 50, 1);
+  Pix* multi = OpenBrickPacked(pix, 1, 50, 4);
+  ExpectSame(single, multi, 0);
+  pixDestroy(&single);
+  pixDestroy(&multi);
+  single = CloseBrickPacked(pix, 50, 3, 1);
+  multi = CloseBrickPacked(pix, 50, 3, 4);
+  ExpectSame(single, multi, 0);
+  pixDestroy(&single);
+  pixDestroy(&multi);
+  pixDestroy(&pix);
+}
+
+}  // namespace tesseract.
@@ -0,0 +1,93 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "blobfeatures.h"
+#include "blobs.h"
+#include "classify.h"
+#include "mfoutline.h"
+#include "ocrfeatures.h"
+#include "picofeat.h"
+
+#include "include_gunit.h"
+
+namespace tesseract {
+
+class BlobFeaturesTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    std::locale::global(std::locale(""));
+  }
+
+  // Adds to blob an outline through the num_points points of xy, and back
+  // to a duplicate of the first point, with point number hidden hidden.
+  static void AddOutline(const int* xy, int num_points, int hidden,
+                         TBLOB* blob) {
+    EDGEPT* first = nullptr;
+    EDGEPT* prev = nullptr;
+    for (int i = 0; i <= num_points; ++i) {
+      auto* pt = new EDGEPT;
+      int p = i < num_points ? i : 0;
+      pt->pos.x = xy[2 * p];
+      pt->pos.y = xy[2 * p + 1];
+      if (i == hidden) pt->Hide();
+      if (prev == nullptr) {
+        first = pt;
+      } else {
+        prev->next = pt;
+        pt->prev = prev;
+      }
+      prev = pt;
+    }
+    prev->next = first;
+    first->prev = prev;
+    TESSLINE* outline = TESSLINE::BuildFromOutlineList(first);
+    outline->next = blob->outlines;
+    blob->outlines = outline;
+  }
+};
+
+// Tests that the pico-features made straight from the polygonal outlines
+// are the same as those made through MFOUTLINE lists.
+TEST_F(BlobFeaturesTest, PicoFeaturesMatchOutlineConversion) {
+#ifdef DISABLED_LEGACY_ENGINE
+  // Skip test because the pico-features are missing.
+  GTEST_SKIP();
+#else
+  // A baseline normalized "o", with a slanted outer outline and a hole.
+  const int kOuter[] = {10, 64, 90, 70, 100, 150, 50, 190, 0, 140};
+  const int kInner[] = {30, 90, 40, 160, 70, 150, 75, 95};
+  TBLOB blob;
+  AddOutline(kOuter, 5, -1, &blob);
+  AddOutline(kInner, 4, 2, &blob);
+
+  Classify classify;
+  classify.classify_norm_method.set_value(baseline);
+  FEATURE_SET expected = classify.ExtractPicoFeatures(&blob);
+  BlobFeatureBuffer* buffer = BlobFeatureBuffer::ForThisThread();
+  EXPECT_TRUE(buffer->ExtractPicoFeatures(blob, classify_pico_feature_length,
+                                          MAX_PICO_FEATURES));
+  const GenericVector<PicoFeature>& features = buffer->pico_features();
+  ASSERT_EQ(expected->NumFeatures, features.size());
+  EXPECT_GT(features.size(), 0);
+  for (int i = 0; i < features.size(); ++i) {
+    const FEATURE_STRUCT* feature = expected->Features[i];
+    EXPECT_FLOAT_EQ(feature->Params[PicoFeatX], features[i].x);
+    EXPECT_FLOAT_EQ(feature->Params[PicoFeatY], features[i].y);
+    EXPECT_FLOAT_EQ(feature->Params[PicoFeatDir], features[i].dir);
+  }
+  FreeFeatureSet(expected);
+
+  // Too many features is a failure.
+  EXPECT_FALSE(buffer->ExtractPicoFeatures(blob, classify_pico_feature_length,
+                                           features.size() - 1));
+#endif
+}
+
+}  // namespace tesseract
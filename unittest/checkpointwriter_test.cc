@@ -0,0 +1,136 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "checkpointwriter.h"
+#include "serialis.h"
+
+#include "include_gunit.h"
+#include "log.h"
+
+namespace tesseract {
+
+class CheckpointWriterTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    std::locale::global(std::locale(""));
+#if defined(_WIN32)
+    _mkdir(FLAGS_test_tmpdir);
+#else
+    mkdir(FLAGS_test_tmpdir, S_IRWXU | S_IRWXG);
+#endif
+  }
+
+  std::string OutputNameToPath(const std::string& name) {
+    return file::JoinPath(FLAGS_test_tmpdir, name);
+  }
+
+  // Returns a vector of size bytes, all equal to value.
+  static std::vector<char> MakeData(int size, char value) {
+    return std::vector<char>(size, value);
+  }
+};
+
+// Tests that every file gets the last snapshot queued for it, that no
+// temporary file is left behind, and that TakeFinished reports the writes.
+TEST_F(CheckpointWriterTest, WritesLastSnapshot) {
+  std::string checkpoint = OutputNameToPath("writer_checkpoint");
+  std::string best_model = OutputNameToPath("writer_best");
+  STRING results;
+  {
+    CheckpointWriter writer;
+    for (int i = 0; i < 10; ++i) {
+      std::vector<char> data = MakeData(100000 + i, 'a' + i);
+      writer.Write(checkpoint.c_str(), &data);
+      EXPECT_TRUE(data.empty());
+      if (i == 5) {
+        data = MakeData(1000, 'b');
+        writer.Write(best_model.c_str(), &data);
+      }
+    }
+    writer.Flush();
+    results = writer.TakeResults();
+    EXPECT_STREQ("", writer.TakeResults().c_str());
+    // The checkpoint may be written fewer times than it was queued.
+    bool wrote_best_model = false;
+    for (const auto& finished : writer.TakeFinished()) {
+      EXPECT_TRUE(finished.second);
+      if (finished.first == best_model.c_str()) wrote_best_model = true;
+    }
+    EXPECT_TRUE(wrote_best_model);
+    EXPECT_TRUE(writer.TakeFinished().empty());
+  }
+  std::vector<char> data;
+  ASSERT_TRUE(LoadDataFromFile(checkpoint.c_str(), &data));
+  EXPECT_EQ(MakeData(100009, 'j'), data);
+  ASSERT_TRUE(LoadDataFromFile(best_model.c_str(), &data));
+  EXPECT_EQ(MakeData(1000, 'b'), data);
+  std::string temp_name = checkpoint + ".tmp";
+  EXPECT_EQ(nullptr, fopen(temp_name.c_str(), "rb"));
+  EXPECT_NE(nullptr, strstr(results.c_str(), " wrote "));
+  EXPECT_EQ(nullptr, strstr(results.c_str(), "failed"));
+  LOG(INFO) << results.c_str() << "\n";
+}
+
+// Tests that snapshots of several files can wait at once, and that each file
+// gets its last one.
+TEST_F(CheckpointWriterTest, QueuesEachFile) {
+  const int kNumFiles = 5;
+  CheckpointWriter writer;
+  for (int round = 0; round < 4; ++round) {
+    for (int f = 0; f < kNumFiles; ++f) {
+      std::string name = OutputNameToPath("writer_file" + std::to_string(f));
+      std::vector<char> data = MakeData(1000000 + f, 'a' + round);
+      writer.Write(name.c_str(), &data);
+      EXPECT_TRUE(data.empty());
+    }
+  }
+  writer.Flush();
+  for (int f = 0; f < kNumFiles; ++f) {
+    std::string name = OutputNameToPath("writer_file" + std::to_string(f));
+    std::vector<char> data;
+    ASSERT_TRUE(LoadDataFromFile(name.c_str(), &data));
+    EXPECT_EQ(MakeData(1000000 + f, 'd'), data);
+  }
+  for (const auto& finished : writer.TakeFinished()) {
+    EXPECT_TRUE(finished.second);
+  }
+}
+
+// Tests that the destructor finishes the queued writes, and that a failed
+// write is reported, in the log and to TakeFinished.
+TEST_F(CheckpointWriterTest, FinishesOnDestruction) {
+  std::string checkpoint = OutputNameToPath("writer_unflushed");
+  remove(checkpoint.c_str());
+  {
+    CheckpointWriter writer;
+    std::vector<char> data = MakeData(5000000, 'x');
+    writer.Write(checkpoint.c_str(), &data);
+  }
+  std::vector<char> data;
+  ASSERT_TRUE(LoadDataFromFile(checkpoint.c_str(), &data));
+  EXPECT_EQ(MakeData(5000000, 'x'), data);
+  CheckpointWriter writer;
+  data = MakeData(10, 'y');
+  std::string bad_name = OutputNameToPath("no_such_dir/writer_checkpoint");
+  writer.Write(bad_name.c_str(), &data);
+  writer.Flush();
+  EXPECT_NE(nullptr, strstr(writer.TakeResults().c_str(), "failed to write"));
+  std::vector<std::pair<STRING, bool>> finished = writer.TakeFinished();
+  ASSERT_EQ(1u, finished.size());
+  EXPECT_STREQ(bad_name.c_str(), finished[0].first.c_str());
+  EXPECT_FALSE(finished[0].second);
+}
+
+}  // namespace tesseract
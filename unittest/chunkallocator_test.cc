@@ -0,0 +1,152 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "chunkallocator.h"
+
+#include "include_gunit.h"
+
+namespace tesseract {
+
+// Size and alignment of the size classes.
+const size_t kGranularity = alignof(std::max_align_t);
+const size_t kChunkSize = 1024;
+const size_t kMaxBlock = 256;
+
+class ChunkAllocatorTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    std::locale::global(std::locale(""));
+  }
+
+  static bool IsAligned(const void* p) {
+    return reinterpret_cast<uintptr_t>(p) % kGranularity == 0;
+  }
+};
+
+// Tests that blocks of every size are aligned for any type and do not
+// overlap, even when they span several chunks.
+TEST_F(ChunkAllocatorTest, BlocksAreAlignedAndDisjoint) {
+  ChunkAllocator allocator(kChunkSize, kMaxBlock);
+  std::vector<char*> blocks;
+  std::vector<size_t> sizes;
+  for (size_t size = 0; size <= kMaxBlock; ++size) {
+    auto* block = static_cast<char*>(allocator.Allocate(size));
+    ASSERT_NE(nullptr, block);
+    EXPECT_TRUE(IsAligned(block)) << "size " << size;
+    memset(block, static_cast<int>(size), size);
+    blocks.push_back(block);
+    sizes.push_back(size);
+  }
+  EXPECT_EQ(static_cast<int>(blocks.size()), allocator.num_allocated());
+  EXPECT_GT(allocator.num_chunks(), 1);
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    for (size_t j = 0; j < sizes[i]; ++j) {
+      EXPECT_EQ(static_cast<char>(sizes[i]), blocks[i][j]);
+    }
+  }
+}
+
+// Tests that a block given back is reused for any size of its size class,
+// and only for those sizes.
+TEST_F(ChunkAllocatorTest, ReusesBlocksOfTheSameSizeClass) {
+  ChunkAllocator allocator(kChunkSize, kMaxBlock);
+  void* block = allocator.Allocate(kGranularity + 1);
+  void* other = allocator.Allocate(kGranularity + 1);
+  EXPECT_EQ(2, allocator.num_allocated());
+  allocator.Free(block, kGranularity + 1);
+  EXPECT_EQ(1, allocator.num_allocated());
+  // A smaller and a bigger size class do not get the block.
+  void* smaller = allocator.Allocate(kGranularity);
+  void* bigger = allocator.Allocate(2 * kGranularity + 1);
+  EXPECT_NE(block, smaller);
+  EXPECT_NE(block, bigger);
+  // The biggest size of the class does.
+  EXPECT_EQ(block, allocator.Allocate(2 * kGranularity));
+  // Blocks are reused last in, first out.
+  allocator.Free(block, 2 * kGranularity);
+  allocator.Free(other, kGranularity + 1);
+  EXPECT_EQ(other, allocator.Allocate(2 * kGranularity));
+  EXPECT_EQ(block, allocator.Allocate(2 * kGranularity));
+  EXPECT_EQ(4, allocator.num_allocated());
+}
+
+// Tests that blocks bigger than the biggest block are refused.
+TEST_F(ChunkAllocatorTest, RefusesBigBlocks) {
+  ChunkAllocator allocator(kChunkSize, kMaxBlock);
+  EXPECT_NE(nullptr, allocator.Allocate(kMaxBlock));
+  EXPECT_EQ(nullptr, allocator.Allocate(kMaxBlock + 1));
+  EXPECT_EQ(1, allocator.num_allocated());
+  // The biggest block is never more than a chunk.
+  ChunkAllocator small_chunks(kChunkSize, 2 * kChunkSize);
+  EXPECT_EQ(nullptr, small_chunks.Allocate(kChunkSize + 1));
+}
+
+// Tests that the end of a chunk that is too small for a block is not lost,
+// but used for a smaller block.
+TEST_F(ChunkAllocatorTest, ReusesTheEndOfAChunk) {
+  ChunkAllocator allocator(kChunkSize, kChunkSize);
+  // Leave one granule at the end of the first chunk, too small for the next
+  // block.
+  auto* first =
+      static_cast<char*>(allocator.Allocate(kChunkSize - kGranularity));
+  allocator.Allocate(2 * kGranularity);
+  EXPECT_EQ(2, allocator.num_chunks());
+  EXPECT_EQ(first + kChunkSize - kGranularity, allocator.Allocate(1));
+}
+
+// Tests that Reset gives back all the chunks and starts afresh.
+TEST_F(ChunkAllocatorTest, ResetGivesBackAllChunks) {
+  ChunkAllocator allocator(kChunkSize, kMaxBlock);
+  for (int i = 0; i < 100; ++i) {
+    void* block = allocator.Allocate(i);
+    if (i % 2 == 0) allocator.Free(block, i);
+  }
+  EXPECT_EQ(50, allocator.num_allocated());
+  EXPECT_GT(allocator.num_chunks(), 1);
+  allocator.Reset();
+  EXPECT_EQ(0, allocator.num_allocated());
+  EXPECT_EQ(0, allocator.num_chunks());
+  // Nothing given back before the Reset is handed out again.
+  void* block = allocator.Allocate(2);
+  EXPECT_NE(nullptr, block);
+  EXPECT_EQ(1, allocator.num_allocated());
+  EXPECT_EQ(1, allocator.num_chunks());
+  allocator.Free(block, 2);
+  EXPECT_EQ(block, allocator.Allocate(kGranularity));
+}
+
+// Tests that objects made with New remember where they came from, and go
+// back there on Delete.
+TEST_F(ChunkAllocatorTest, NewRecordsTheOwner) {
+  ChunkAllocator allocator(kChunkSize, kMaxBlock);
+  void* heap = ChunkAllocator::New(8, nullptr);
+  void* small = ChunkAllocator::New(8, &allocator);
+  void* big = ChunkAllocator::New(kMaxBlock, &allocator);
+  EXPECT_TRUE(IsAligned(heap));
+  EXPECT_TRUE(IsAligned(small));
+  EXPECT_TRUE(IsAligned(big));
+  EXPECT_EQ(nullptr, ChunkAllocator::Owner(heap));
+  EXPECT_EQ(&allocator, ChunkAllocator::Owner(small));
+  // The header does not fit in the biggest block, so it comes from the heap.
+  EXPECT_EQ(nullptr, ChunkAllocator::Owner(big));
+  EXPECT_EQ(1, allocator.num_allocated());
+  ChunkAllocator::Delete(heap);
+  ChunkAllocator::Delete(big);
+  ChunkAllocator::Delete(small);
+  ChunkAllocator::Delete(nullptr);
+  EXPECT_EQ(0, allocator.num_allocated());
+  EXPECT_EQ(small, ChunkAllocator::New(8, &allocator));
+}
+
+}  // namespace tesseract
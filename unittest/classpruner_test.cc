@@ -0,0 +1,91 @@
+///////////////////////////////////////////////////////////////////////
+// File:        classpruner_test.cc
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+///////////////////////////////////////////////////////////////////////
+
+#include "classpruner.h"
+#include <vector>
+#include <gtest/gtest.h>
+#include "include_gunit.h"
+#include "simddetect.h"
+#include <tesseract/helpers.h>
+
+namespace tesseract {
+
+// Number of pruner words in the random pruner.
+const int kNumWords = 4096;
+
+class ClassPrunerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::locale::global(std::locale(""));
+    pruner_.resize(kNumWords);
+    for (auto& word : pruner_) {
+      word = static_cast<uint32_t>(random_.IntRand()) << 1 ^ random_.IntRand();
+    }
+  }
+
+  // Makes offsets for num_features random features.
+  std::vector<int> RandomOffsets(int num_features) {
+    std::vector<int> offsets(num_features);
+    for (auto& offset : offsets) offset = random_.IntRand() % (kNumWords / 2) * 2;
+    return offsets;
+  }
+
+  // Tests that the given kernel gets the same counts as the generic one, for
+  // feature counts either side of the kernels' internal flush intervals.
+  void ExpectEqualResults(ClassPrunerFunction kernel) {
+    for (int num_features : {0, 1, 7, 84, 85, 86, 170, 511, 1000}) {
+      std::vector<int> offsets = RandomOffsets(num_features);
+      std::vector<int> expected(kClassPrunerClasses, 5);
+      std::vector<int> actual(kClassPrunerClasses, 5);
+      ClassPrunerScoresGeneric(pruner_.data(), offsets.data(), num_features,
+                               expected.data());
+      kernel(pruner_.data(), offsets.data(), num_features, actual.data());
+      EXPECT_EQ(expected, actual) << "num_features=" << num_features;
+    }
+  }
+
+  std::vector<uint32_t> pruner_;
+  TRand random_;
+};
+
+// Tests the generic kernel against the weights read one class at a time.
+TEST_F(ClassPrunerTest, Generic) {
+  std::vector<int> offsets = RandomOffsets(100);
+  std::vector<int> counts(kClassPrunerClasses, 0);
+  ClassPrunerScoresGeneric(pruner_.data(), offsets.data(), offsets.size(),
+                           counts.data());
+  for (int c = 0; c < kClassPrunerClasses; ++c) {
+    int expected = 0;
+    for (int offset : offsets) {
+      expected += pruner_[offset + c / 16] >> (c % 16 * 2) & 3;
+    }
+    EXPECT_EQ(expected, counts[c]) << "class " << c;
+  }
+}
+
+// Tests that the AVX2 implementation gets the same result as the generic.
+TEST_F(ClassPrunerTest, AVX2) {
+#if defined(HAVE_AVX2)
+  if (!SIMDDetect::IsAVX2Available()) {
+    GTEST_LOG_(INFO) << "No AVX2 found! Not tested!";
+    GTEST_SKIP();
+  }
+  ExpectEqualResults(ClassPrunerScoresAVX2);
+#else
+  GTEST_LOG_(INFO) << "AVX2 unsupported! Not tested!";
+  GTEST_SKIP();
+#endif
+}
+
+}  // namespace tesseract
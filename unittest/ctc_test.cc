@@ -0,0 +1,150 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cmath>
+
+#include <tesseract/helpers.h>
+
+#include "ctc.h"
+#include "cycletimer.h"
+#include "genericvector.h"
+#include "include_gunit.h"
+#include "log.h"
+#include "matrix.h"
+#include "networkio.h"
+
+namespace tesseract {
+
+const int kNumClasses = 111;
+const int kNullChar = kNumClasses - 1;
+
+class CTCTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    std::locale::global(std::locale(""));
+    randomizer_.set_seed(kSeed);
+  }
+
+  // Makes labels for num_chars random classes, padded with nulls as the
+  // trainer does. Every repeat_interval-th class repeats its predecessor, so
+  // the null between them is needed.
+  void MakeLabels(int num_chars, int repeat_interval,
+                  GenericVector<int>* labels) {
+    labels->clear();
+    labels->push_back(kNullChar);
+    int prev_class = 0;
+    for (int i = 0; i < num_chars; ++i) {
+      int class_id = prev_class;
+      if (i == 0 || i % repeat_interval != 0)
+        class_id = randomizer_.IntRand() % kNullChar;
+      labels->push_back(class_id);
+      labels->push_back(kNullChar);
+      prev_class = class_id;
+    }
+  }
+
+  // Makes random softmax outputs, with no prob small enough to need the
+  // clipping of CTC::NormalizeProbs.
+  void MakeOutputs(int num_timesteps, GENERIC_2D_ARRAY<float>* outputs) {
+    outputs->Resize(num_timesteps, kNumClasses, 0.0f);
+    for (int t = 0; t < num_timesteps; ++t) {
+      float* outputs_t = (*outputs)[t];
+      double total = 0.0;
+      for (int c = 0; c < kNumClasses; ++c) {
+        outputs_t[c] = exp(randomizer_.SignedRand(4.0));
+        total += outputs_t[c];
+      }
+      for (int c = 0; c < kNumClasses; ++c) outputs_t[c] /= total;
+    }
+  }
+
+  // Checks that the banded CTC gives the same targets as the reference one.
+  void ExpectSameTargets(const GenericVector<int>& labels,
+                         const GENERIC_2D_ARRAY<float>& outputs) {
+    NetworkIO targets, reference_targets;
+    targets.Resize2d(false, outputs.dim1(), kNumClasses);
+    reference_targets.Resize2d(false, outputs.dim1(), kNumClasses);
+    bool ok = CTC::ComputeCTCTargets(labels, kNullChar, outputs, &targets);
+    bool reference_ok = CTC::ComputeCTCTargetsReference(
+        labels, kNullChar, outputs, &reference_targets);
+    EXPECT_EQ(reference_ok, ok);
+    if (!ok || !reference_ok) return;
+    for (int t = 0; t < outputs.dim1(); ++t) {
+      const float* targets_t = targets.f(t);
+      const float* reference_t = reference_targets.f(t);
+      for (int c = 0; c < kNumClasses; ++c) {
+        EXPECT_NEAR(reference_t[c], targets_t[c], 1e-5)
+            << "t=" << t << ", c=" << c;
+      }
+    }
+  }
+
+  static const uint64_t kSeed = 0x12345678;
+  TRand randomizer_;
+};
+
+// Tests that the banded CTC matches the reference with plenty of time, just
+// enough time, and too little time for the labels.
+TEST_F(CTCTest, BandedMatchesReference) {
+  GenericVector<int> labels;
+  GENERIC_2D_ARRAY<float> outputs;
+  for (int num_chars : {1, 2, 5, 20}) {
+    MakeLabels(num_chars, 3, &labels);
+    // Each char needs a timestep, as does the null between repeats.
+    int min_timesteps = num_chars + (num_chars - 1) / 3;
+    for (int num_timesteps :
+         {min_timesteps - 1, min_timesteps, min_timesteps + 1,
+          labels.size(), 4 * labels.size()}) {
+      if (num_timesteps <= 0) continue;
+      MakeOutputs(num_timesteps, &outputs);
+      ExpectSameTargets(labels, outputs);
+    }
+  }
+  // Labels that don't start and end with a null.
+  labels.clear();
+  for (int class_id : {5, kNullChar, 7, 7, kNullChar, 7}) {
+    labels.push_back(class_id);
+  }
+  for (int num_timesteps : {3, 4, 6, 30}) {
+    MakeOutputs(num_timesteps, &outputs);
+    ExpectSameTargets(labels, outputs);
+  }
+}
+
+// Compares the speed of the banded CTC with the reference on a long line.
+TEST_F(CTCTest, BandedSpeed) {
+  const int kNumChars = 100;
+  const int kNumTimesteps = 800;
+  const int kNumIterations = 20;
+  GenericVector<int> labels;
+  GENERIC_2D_ARRAY<float> outputs;
+  MakeLabels(kNumChars, 5, &labels);
+  MakeOutputs(kNumTimesteps, &outputs);
+  NetworkIO targets;
+  targets.Resize2d(false, kNumTimesteps, kNumClasses);
+  CycleTimer timer;
+  timer.Restart();
+  for (int i = 0; i < kNumIterations; ++i) {
+    EXPECT_TRUE(CTC::ComputeCTCTargetsReference(labels, kNullChar, outputs,
+                                                &targets));
+  }
+  int64_t reference_ms = timer.GetInMs();
+  timer.Restart();
+  for (int i = 0; i < kNumIterations; ++i) {
+    EXPECT_TRUE(
+        CTC::ComputeCTCTargets(labels, kNullChar, outputs, &targets));
+  }
+  int64_t banded_ms = timer.GetInMs();
+  LOG(INFO) << kNumIterations << " CTC targets of " << kNumTimesteps
+            << " timesteps: reference " << reference_ms << "ms, banded "
+            << banded_ms << "ms";
+}
+
+}  // namespace tesseract
@@ -0,0 +1,122 @@
+///////////////////////////////////////////////////////////////////////
+// File:        degradekernel_test.cc
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+///////////////////////////////////////////////////////////////////////
+
+#include "degradekernel.h"
+#include <algorithm>
+#include <vector>
+#include <gtest/gtest.h>
+#include "include_gunit.h"
+#include "simddetect.h"
+#include <tesseract/helpers.h>
+
+namespace tesseract {
+
+class DegradeKernelTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::locale::global(std::locale(""));
+  }
+
+  // Makes a row of width random pixels.
+  std::vector<uint8_t> RandomRow(int width) {
+    std::vector<uint8_t> row(width);
+    for (auto& pixel : row) pixel = static_cast<uint8_t>(random_.IntRand());
+    return row;
+  }
+
+  // Tests that the given kernel makes the same rows as the generic one, for
+  // widths either side of the kernels' register sizes, and all the options.
+  void ExpectEqualResults(DegradeRowFunction kernel) {
+    for (int width : {1, 2, 5, 8, 9, 10, 16, 17, 33, 1000}) {
+      std::vector<uint8_t> above = RandomRow(width);
+      std::vector<uint8_t> row = RandomRow(width);
+      std::vector<uint8_t> below = RandomRow(width);
+      for (bool blur : {false, true}) {
+        for (int noise : {0, 5, 100}) {
+          for (int offset : {-300, -48, 0, 300}) {
+            uint32_t seed = random_.IntRand();
+            DegradeRowParams params = {blur, noise, 2000, offset, seed};
+            for (int y : {0, 1, 999}) {
+              std::vector<uint8_t> expected(width);
+              std::vector<uint8_t> actual(width);
+              DegradeRowGeneric(above.data(), row.data(), below.data(), width,
+                                y, params, expected.data());
+              kernel(above.data(), row.data(), below.data(), width, y, params,
+                     actual.data());
+              EXPECT_EQ(expected, actual)
+                  << "width=" << width << " blur=" << blur
+                  << " noise=" << noise << " offset=" << offset << " y=" << y;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  TRand random_;
+};
+
+// Tests the generic kernel against the blur and clipping computed directly,
+// and that its noise is spread evenly over the whole range.
+TEST_F(DegradeKernelTest, Generic) {
+  const int kWidth = 1000;
+  std::vector<uint8_t> above = RandomRow(kWidth);
+  std::vector<uint8_t> row = RandomRow(kWidth);
+  std::vector<uint8_t> below = RandomRow(kWidth);
+  std::vector<uint8_t> out(kWidth);
+  DegradeRowParams params = {true, 0, 0, 10, 0};
+  DegradeRowGeneric(above.data(), row.data(), below.data(), kWidth, 0, params,
+                    out.data());
+  for (int x = 1; x + 1 < kWidth; ++x) {
+    int sum = 0;
+    for (int dx = -1; dx <= 1; ++dx) {
+      sum += above[x + dx] + row[x + dx] + below[x + dx];
+    }
+    int expected = std::min(sum / 9 + 10, 255);
+    EXPECT_NEAR(expected, out[x], 1) << "x=" << x;
+  }
+  const int kNoise = 5;
+  std::vector<uint8_t> grey(kWidth, 128);
+  std::vector<int> histogram(2 * kNoise + 1);
+  params = {false, kNoise, 0, 0, 12345};
+  for (int y = 0; y < 100; ++y) {
+    DegradeRowGeneric(grey.data(), grey.data(), grey.data(), kWidth, y, params,
+                      out.data());
+    for (uint8_t pixel : out) {
+      ASSERT_LE(128 - kNoise, pixel);
+      ASSERT_GE(128 + kNoise, pixel);
+      ++histogram[pixel - 128 + kNoise];
+    }
+  }
+  int expected_count = kWidth * 100 / histogram.size();
+  for (int count : histogram) {
+    EXPECT_NEAR(expected_count, count, expected_count / 10);
+  }
+}
+
+// Tests that the AVX2 implementation gets the same result as the generic.
+TEST_F(DegradeKernelTest, AVX2) {
+#if defined(HAVE_AVX2)
+  if (!SIMDDetect::IsAVX2Available()) {
+    GTEST_LOG_(INFO) << "No AVX2 found! Not tested!";
+    GTEST_SKIP();
+  }
+  ExpectEqualResults(DegradeRowAVX2);
+#else
+  GTEST_LOG_(INFO) << "AVX2 unsupported! Not tested!";
+  GTEST_SKIP();
+#endif
+}
+
+}  // namespace tesseract
@@ -9,13 +9,18 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
+#include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 
+#include "allheaders.h"
 #include "imagedata.h"
+#include "imageshard.h"
 #include "include_gunit.h"
 #include "log.h"
 
@@ -57,6 +62,43 @@ class ImagedataTest : public ::testing::Test {
     EXPECT_TRUE(write_doc.SaveDocument(filename.c_str(), nullptr));
     return filename;
   }
+
+  // Creates a real greyscale image of the given width, which varies with the
+  // page number.
+  Pix* MakeImage(int width, int page) {
+    const int kHeight = 60;
+    Pix* pix = pixCreate(width, kHeight, 8);
+    for (int y = 0; y < kHeight; ++y) {
+      for (int x = 0; x < width; ++x) {
+        pixSetPixel(pix, x, y, (x * 7 + y * 3 + page * 11) % 256);
+      }
+    }
+    return pix;
+  }
+
+  // Writes a shard of num_pages pages scaled to target_height, and returns the
+  // filename.
+  std::string MakeShard(int num_pages, unsigned shard_id, int target_height,
+                        std::vector<std::string>* page_texts) {
+    std::string filename = file::JoinPath(
+        FLAGS_test_tmpdir, absl::StrCat("imageshard", shard_id, ".lstms"));
+    ImageShardWriter writer;
+    EXPECT_TRUE(writer.Open(filename.c_str()));
+    for (int p = 0; p < num_pages; ++p) {
+      page_texts->push_back(
+          absl::StrFormat("Page %d of %d in shard %u", p, num_pages, shard_id));
+      // Build needs some image data, which is replaced by the real image.
+      const char kPlaceholder = 0;
+      std::unique_ptr<ImageData> page(
+          ImageData::Build("noname", p, "eng", &kPlaceholder, 1,
+                           page_texts->back().c_str(), nullptr));
+      page->SetPix(MakeImage(100 + 10 * p, p));
+      EXPECT_TRUE(writer.AddSample(*page, target_height, 48));
+    }
+    EXPECT_EQ(num_pages, writer.num_samples());
+    EXPECT_TRUE(writer.Close());
+    return filename;
+  }
 };
 
 TEST_F(ImagedataTest, CachesProperly) {
@@ -127,4 +169,146 @@ TEST_F(ImagedataTest, CachesMultiDocs) {
   }
 }
 
+TEST_F(ImagedataTest, PrefetchesPages) {
+  // This test verifies that the pages copied by DocumentCache, with and
+  // without prefetching, are the right ones, including after a seek.
+  const std::vector<int> kNumPages = {6, 5, 7};
+  // Order in which to read the pages, with a seek back and one forward.
+  const std::vector<int> kSerials = {0, 1, 2, 3, 4, 5, 6, 7, 2, 3, 4, 15, 16};
+  std::vector<std::vector<std::string>> page_texts;
+  GenericVector<STRING> filenames;
+  for (size_t d = 0; d < kNumPages.size(); ++d) {
+    page_texts.emplace_back(std::vector<std::string>());
+    std::string filename = MakeFakeDoc(kNumPages[d], d, &page_texts.back());
+    filenames.push_back(STRING(filename.c_str()));
+  }
+  for (int num_threads : {0, 1, 3}) {
+    DocumentCache cache(8000000);
+    cache.SetPrefetch(num_threads, 4);
+    cache.LoadDocuments(filenames, tesseract::CS_ROUND_ROBIN, nullptr);
+    EXPECT_EQ(num_threads > 0, cache.prefetching());
+    for (int p : kSerials) {
+      std::unique_ptr<ImageData> page(cache.CopyPageBySerial(p));
+      CHECK(page != nullptr);
+      int doc = p % kNumPages.size();
+      int doc_page = p / kNumPages.size() % kNumPages[doc];
+      EXPECT_STREQ(page_texts[doc][doc_page].c_str(),
+                   page->transcription().c_str());
+    }
+    EXPECT_EQ(static_cast<int>(kSerials.size()),
+              cache.prefetch_hits() + cache.prefetch_misses());
+    if (num_threads == 0) EXPECT_EQ(0, cache.prefetch_hits());
+    EXPECT_GE(cache.num_decoded(), static_cast<int>(kSerials.size()));
+    cache.PrintStats();
+  }
+}
+
+TEST_F(ImagedataTest, CopiesPagesInParallel) {
+  // This test verifies that several threads can copy pages from the same
+  // DocumentCache at once, while its documents are loaded and unloaded.
+  const std::vector<int> kNumPages = {6, 5, 7, 4};
+  const int kNumThreads = 4;
+  const int kPagesPerThread = 20;
+  std::vector<std::vector<std::string>> page_texts;
+  GenericVector<STRING> filenames;
+  for (size_t d = 0; d < kNumPages.size(); ++d) {
+    page_texts.emplace_back(std::vector<std::string>());
+    std::string filename = MakeFakeDoc(kNumPages[d], d, &page_texts.back());
+    filenames.push_back(STRING(filename.c_str()));
+  }
+  // Less room than any one document takes, so that each change of document
+  // unloads the others, while other threads may be copying their pages.
+  DocumentCache cache(3000000);
+  cache.SetPrefetch(2, 4);
+  cache.LoadDocuments(filenames, tesseract::CS_SEQUENTIAL, nullptr);
+  std::vector<int> num_right(kNumThreads, 0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < kPagesPerThread; ++i) {
+        int p = t * kPagesPerThread + i;
+        std::unique_ptr<ImageData> page(cache.CopyPageBySerial(p));
+        int doc = p / kNumPages[0] % kNumPages.size();
+        int doc_page = p % kNumPages[0] % kNumPages[doc];
+        if (page != nullptr &&
+            page_texts[doc][doc_page] == page->transcription().c_str()) {
+          ++num_right[t];
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  for (int t = 0; t < kNumThreads; ++t) {
+    EXPECT_EQ(kPagesPerThread, num_right[t]);
+  }
+}
+
+TEST_F(ImagedataTest, ReadsShards) {
+  // This test verifies that the samples of a shard come back with their text
+  // and with the scaled greyscale image that was written.
+  const int kNumPages = 5;
+  const int kTargetHeight = 30;
+  std::vector<std::string> page_texts;
+  std::string filename = MakeShard(kNumPages, 0, kTargetHeight, &page_texts);
+  EXPECT_TRUE(ImageShard::IsShard(filename.c_str()));
+  ImageShard shard;
+  ASSERT_TRUE(shard.Open(filename.c_str()));
+  EXPECT_EQ(kNumPages, shard.NumSamples());
+  for (int p = 0; p < kNumPages; ++p) {
+    std::unique_ptr<ImageData> sample(shard.GetSample(p));
+    ASSERT_TRUE(sample != nullptr);
+    EXPECT_STREQ(page_texts[p].c_str(), sample->transcription().c_str());
+    EXPECT_TRUE(sample->image_data().empty());
+    ImageData page(false, MakeImage(100 + 10 * p, p));
+    Pix* expected = page.PreScale(kTargetHeight, 48, nullptr, nullptr,
+                                  nullptr, nullptr);
+    Pix* pix = sample->GetPix();
+    EXPECT_EQ(kTargetHeight, pixGetHeight(pix));
+    EXPECT_EQ(8, pixGetDepth(pix));
+    l_int32 same = 0;
+    pixEqual(expected, pix, &same);
+    EXPECT_TRUE(same);
+    pixDestroy(&expected);
+    pixDestroy(&pix);
+  }
+  EXPECT_EQ(nullptr, shard.GetSample(kNumPages));
+}
+
+TEST_F(ImagedataTest, ShufflesShards) {
+  // This test verifies that DocumentCache takes every sample of a set of
+  // shards once in each epoch, in a different order each time, with and
+  // without prefetching.
+  const std::vector<int> kNumPages = {6, 5, 7};
+  std::set<std::string> all_texts;
+  GenericVector<STRING> filenames;
+  for (size_t s = 0; s < kNumPages.size(); ++s) {
+    std::vector<std::string> page_texts;
+    std::string filename = MakeShard(kNumPages[s], s, 0, &page_texts);
+    all_texts.insert(page_texts.begin(), page_texts.end());
+    filenames.push_back(STRING(filename.c_str()));
+  }
+  int num_samples = all_texts.size();
+  for (int num_threads : {0, 2}) {
+    DocumentCache cache(8000000);
+    cache.SetPrefetch(num_threads, 4);
+    EXPECT_TRUE(cache.LoadDocuments(filenames, tesseract::CS_SEQUENTIAL,
+                                    nullptr));
+    EXPECT_EQ(num_samples, cache.TotalPages());
+    std::vector<std::vector<std::string>> epochs(2);
+    for (int serial = 0; serial < 2 * num_samples; ++serial) {
+      std::unique_ptr<ImageData> page(cache.CopyPageBySerial(serial));
+      ASSERT_TRUE(page != nullptr);
+      epochs[serial / num_samples].push_back(page->transcription().c_str());
+      const ImageData* cached = cache.GetPageBySerial(serial);
+      ASSERT_TRUE(cached != nullptr);
+      EXPECT_EQ(page->transcription(), cached->transcription());
+    }
+    for (const auto& epoch : epochs) {
+      EXPECT_EQ(all_texts, std::set<std::string>(epoch.begin(), epoch.end()));
+    }
+    EXPECT_NE(epochs[0], epochs[1]);
+    EXPECT_EQ(0, cache.num_decoded());
+  }
+}
+
 }  // namespace.
@@ -11,10 +11,12 @@
 
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "include_gunit.h"
 
 #include "allheaders.h"
+#include "cycletimer.h"                 // for CycleTimer
 #include <tesseract/baseapi.h>
 #include "coutln.h"
 #include "log.h"                        // for LOG
@@ -231,4 +233,152 @@ TEST_F(LayoutTest, HebrewOrderingAndSkew) {
   delete it;
 }
 
+// Benchmarks the fast XY-cut page segmentation against the full PSM_AUTO
+// layout analysis on the same multi-column page, and checks that it still
+// finds multiple text blocks with the same main text.
+TEST_F(LayoutTest, FastXYCutBenchmark) {
+  SetImage("8087_054.3B.tif", "eng");
+  const int kIterations = 5;
+  // Runs the layout analysis kIterations times, returning the number of
+  // blocks found and the mean time taken in ms.
+  auto time_layout = [this, kIterations](int64_t* ms) {
+    CycleTimer timer;
+    int num_blocks = 0;
+    timer.Restart();
+    for (int i = 0; i < kIterations; ++i) {
+      api_.SetImage(src_pix_);
+      tesseract::PageIterator* it = api_.AnalyseLayout();
+      if (it == nullptr) return 0;
+      num_blocks = 0;
+      do {
+        ++num_blocks;
+      } while (it->Next(tesseract::RIL_BLOCK));
+      delete it;
+    }
+    timer.Stop();
+    *ms = timer.GetInMs() / kIterations;
+    return num_blocks;
+  };
+  int64_t auto_ms = 0;
+  int auto_blocks = time_layout(&auto_ms);
+  EXPECT_TRUE(api_.SetVariable("pageseg_fast_xycut", "1"));
+  int64_t xycut_ms = 0;
+  int xycut_blocks = time_layout(&xycut_ms);
+  LOG(INFO) << "PSM_AUTO layout: " << auto_ms << "ms, " << auto_blocks
+            << " blocks. XY-cut layout: " << xycut_ms << "ms, "
+            << xycut_blocks << " blocks.\n";
+  EXPECT_GT(auto_blocks, 1);
+  EXPECT_GT(xycut_blocks, 1);
+  // The page text must still be found with the fast layout.
+  api_.SetImage(src_pix_);
+  char* text = api_.GetUTF8Text();
+  ASSERT_TRUE(text != nullptr);
+  EXPECT_TRUE(strstr(text, "Dalmatian") != nullptr);
+  delete[] text;
+}
+
+// Tests that the blocks found by layout analysis on a reduced image are
+// mapped back to the right place at full resolution, on a page whose height
+// is not a multiple of the reduction factor, by checking that every text
+// line found by the full resolution layout is inside one of them.
+TEST_F(LayoutTest, ReducedLayoutOnOddHeightPage) {
+  SetImage("8087_054.3B.tif", "eng");
+  // Make the height 1 more than a multiple of 4, which is the worst case for
+  // the 4x reduction to 75 ppi.
+  int height = pixGetHeight(src_pix_);
+  int extra_rows = (5 - height % 4) % 4;
+  Pix* odd_pix = pixAddBlackOrWhiteBorder(src_pix_, 0, 0, 0, extra_rows,
+                                          L_GET_WHITE_VAL);
+  ASSERT_TRUE(odd_pix != nullptr);
+  pixDestroy(&src_pix_);
+  src_pix_ = odd_pix;
+  height = pixGetHeight(src_pix_);
+  ASSERT_EQ(1, height % 4);
+  api_.SetImage(src_pix_);
+  api_.SetSourceResolution(300);
+  tesseract::PageIterator* it = api_.AnalyseLayout();
+  ASSERT_TRUE(it != nullptr);
+  std::vector<TBOX> lines;
+  do {
+    int left, top, right, bottom;
+    if (it->BoundingBox(tesseract::RIL_TEXTLINE, &left, &top, &right,
+                        &bottom)) {
+      lines.emplace_back(left, top, right, bottom);
+    }
+  } while (it->Next(tesseract::RIL_TEXTLINE));
+  delete it;
+  EXPECT_GT(lines.size(), 10);
+
+  EXPECT_TRUE(api_.SetVariable("pageseg_layout_resolution", "75"));
+  api_.SetImage(src_pix_);
+  api_.SetSourceResolution(300);
+  it = api_.AnalyseLayout();
+  ASSERT_TRUE(it != nullptr);
+  delete it;
+  tesseract::MutableIterator* block_it = api_.GetMutableIterator();
+  ASSERT_TRUE(block_it != nullptr);
+  // The full resolution block boxes, converted to image coords, with y down
+  // as for the text lines.
+  std::vector<TBOX> blocks;
+  do {
+    const BLOCK* block = block_it->PageResIt()->block()->block;
+    const TBOX& box = block->pdblk.bounding_box();
+    blocks.emplace_back(box.left(), height - box.top(), box.right(),
+                        height - box.bottom());
+  } while (block_it->Next(tesseract::RIL_BLOCK));
+  delete block_it;
+  EXPECT_GT(blocks.size(), 1);
+  for (const auto& line : lines) {
+    bool contained = false;
+    for (const auto& block : blocks) {
+      if (block.contains(line)) contained = true;
+    }
+    EXPECT_TRUE(contained) << "Line (" << line.left() << "," << line.bottom()
+                           << ")->(" << line.right() << "," << line.top()
+                           << ") is not inside any reduced layout block";
+  }
+}
+
+// Tests that a rule line that the reduced layout analysis removes is also
+// removed from the full resolution image, so that it does not become a line
+// of text.
+TEST_F(LayoutTest, ReducedLayoutRemovesRuleLines) {
+  SetImage("8087_054.3B.tif", "eng");
+  // Add a margin below the text, with a thick rule across most of it.
+  const int kMargin = 80;
+  const int kRuleThickness = 6;
+  Pix* ruled_pix = pixAddBlackOrWhiteBorder(src_pix_, 0, 0, 0, kMargin,
+                                            L_GET_WHITE_VAL);
+  ASSERT_TRUE(ruled_pix != nullptr);
+  pixDestroy(&src_pix_);
+  src_pix_ = ruled_pix;
+  int width = pixGetWidth(src_pix_);
+  int height = pixGetHeight(src_pix_);
+  int rule_y = height - kMargin / 2;
+  ASSERT_EQ(0, pixRenderLine(src_pix_, width / 10, rule_y, width * 9 / 10,
+                             rule_y, kRuleThickness, L_SET_PIXELS));
+  TBOX rule_box(width / 10, rule_y - kRuleThickness, width * 9 / 10,
+                rule_y + kRuleThickness);
+
+  EXPECT_TRUE(api_.SetVariable("pageseg_layout_resolution", "75"));
+  api_.SetImage(src_pix_);
+  api_.SetSourceResolution(300);
+  tesseract::PageIterator* it = api_.AnalyseLayout();
+  ASSERT_TRUE(it != nullptr);
+  int num_lines = 0;
+  do {
+    int left, top, right, bottom;
+    if (it->BoundingBox(tesseract::RIL_TEXTLINE, &left, &top, &right,
+                        &bottom)) {
+      ++num_lines;
+      TBOX line(left, top, right, bottom);
+      EXPECT_FALSE(line.overlap(rule_box))
+          << "Line (" << left << "," << top << ")->(" << right << ","
+          << bottom << ") is on the rule";
+    }
+  } while (it->Next(tesseract::RIL_TEXTLINE));
+  delete it;
+  EXPECT_GT(num_lines, 10);
+}
+
 }  // namespace
@@ -142,6 +142,142 @@ TEST_F(LSTMTrainerTest, DeterminismTest) {
   LOG(INFO) << "********** *** ************\n" ;
 }
 
+// Tests that data-parallel training learns, counts its iterations as serial
+// training does, and writes a trainer that serial training can continue.
+TEST_F(LSTMTrainerTest, DataParallelTest) {
+  SetupTrainerEng("[1,1,0,32 Lfx100 O1c1]", "1D-lstm", false, false);
+  const int kNumThreads = 4;
+  int iteration = trainer_->training_iteration();
+  int sample_iteration = trainer_->sample_iteration();
+  int num_used = trainer_->TrainOnLines(trainer_.get(), kNumThreads);
+  EXPECT_EQ(sample_iteration + kNumThreads, trainer_->sample_iteration());
+  EXPECT_EQ(iteration + num_used, trainer_->training_iteration());
+  double initial_error = trainer_->CharError();
+  while (trainer_->training_iteration() < kTrainerIterations * 2) {
+    trainer_->TrainOnLines(trainer_.get(), kNumThreads);
+  }
+  double parallel_error = trainer_->CharError();
+  LOG(INFO) << "Initial error = " << initial_error
+            << ", parallel error = " << parallel_error << "\n";
+  EXPECT_LT(parallel_error, initial_error);
+  GenericVector<char> trainer_data;
+  EXPECT_TRUE(trainer_->SaveTrainingDump(NO_BEST_TRAINER, trainer_.get(),
+                                         &trainer_data));
+  LSTMTrainer serial_trainer;
+  EXPECT_TRUE(trainer_->ReadTrainingDump(trainer_data, &serial_trainer));
+  EXPECT_EQ(trainer_->training_iteration(),
+            serial_trainer.training_iteration());
+  EXPECT_FLOAT_EQ(parallel_error, serial_trainer.CharError());
+  EXPECT_NE(nullptr, serial_trainer.TrainOnLine(trainer_.get(), false));
+}
+
+// Tests that mini-batch training learns and counts its iterations as serial
+// training does.
+TEST_F(LSTMTrainerTest, BatchTest) {
+  SetupTrainerEng("[1,1,0,32 Lfx100 O1c1]", "1D-lstm", false, false);
+  const int kBatchSize = 4;
+  int iteration = trainer_->training_iteration();
+  int sample_iteration = trainer_->sample_iteration();
+  int num_used = trainer_->TrainOnBatch(trainer_.get(), kBatchSize);
+  EXPECT_EQ(sample_iteration + kBatchSize, trainer_->sample_iteration());
+  EXPECT_EQ(iteration + num_used, trainer_->training_iteration());
+  double initial_error = trainer_->CharError();
+  while (trainer_->training_iteration() < kTrainerIterations * 2) {
+    trainer_->TrainOnBatch(trainer_.get(), kBatchSize);
+  }
+  double batch_error = trainer_->CharError();
+  LOG(INFO) << "Initial error = " << initial_error
+            << ", batch error = " << batch_error << "\n";
+  EXPECT_LT(batch_error, initial_error);
+}
+
+// Tests that a mini-batch computes the same errors and weight updates as the
+// samples run one at a time through the forward and backward passes of
+// TrainOnLine, with their deltas summed into a single Adam update by
+// TrainOnLines.
+TEST_F(LSTMTrainerTest, BatchMatchesSerialTest) {
+  SetupTrainerEng("[1,1,0,32 Lfx100 O1c1]", "1D-lstm", false, true);
+  const int kBatchSize = 4;
+  const int kNumSteps = 3;
+  GenericVector<char> trainer_data;
+  EXPECT_TRUE(trainer_->SaveTrainingDump(NO_BEST_TRAINER, trainer_.get(),
+                                         &trainer_data));
+  LSTMTrainer batch_trainer;
+  EXPECT_TRUE(trainer_->ReadTrainingDump(trainer_data, &batch_trainer));
+  for (int step = 0; step < kNumSteps; ++step) {
+    int serial_used = trainer_->TrainOnLines(trainer_.get(), kBatchSize);
+    int batch_used = batch_trainer.TrainOnBatch(trainer_.get(), kBatchSize);
+    EXPECT_EQ(serial_used, batch_used);
+  }
+  EXPECT_EQ(trainer_->training_iteration(), batch_trainer.training_iteration());
+  EXPECT_EQ(trainer_->sample_iteration(), batch_trainer.sample_iteration());
+  EXPECT_NEAR(trainer_->CharError(), batch_trainer.CharError(), 1e-6);
+  // The networks must have the same weights, so give the same outputs.
+  const ImageData* sample =
+      trainer_->mutable_training_data()->GetPageBySerial(0);
+  ASSERT_NE(nullptr, sample);
+  float scale_factor;
+  NetworkIO inputs, serial_outputs, batch_outputs;
+  EXPECT_TRUE(trainer_->RecognizeLine(*sample, false, false, false, false,
+                                      &scale_factor, &inputs,
+                                      &serial_outputs));
+  EXPECT_TRUE(batch_trainer.RecognizeLine(*sample, false, false, false, false,
+                                          &scale_factor, &inputs,
+                                          &batch_outputs));
+  ASSERT_EQ(serial_outputs.Width(), batch_outputs.Width());
+  ASSERT_EQ(serial_outputs.NumFeatures(), batch_outputs.NumFeatures());
+  for (int t = 0; t < serial_outputs.Width(); ++t) {
+    for (int i = 0; i < serial_outputs.NumFeatures(); ++i) {
+      EXPECT_NEAR(serial_outputs.f(t)[i], batch_outputs.f(t)[i], 1e-4)
+          << "t=" << t << " i=" << i;
+    }
+  }
+}
+
+// Tests that evaluation gives the same results on any number of threads, and
+// that an asynchronous evaluation requested before the previous one has
+// started replaces it, while any other is run.
+TEST_F(LSTMTrainerTest, ParallelEvalTest) {
+  SetupTrainerEng("[1,1,0,32 Lfx100 O1c1]", "1D-lstm", false, false);
+  TrainIterations(kTrainerIterations / 2);
+  std::string traineddata_path =
+      file::JoinPath(FLAGS_test_tmpdir, "1D-lstm.traineddata");
+  EXPECT_TRUE(trainer_->SaveTraineddata(traineddata_path.c_str()));
+  TessdataManager mgr;
+  EXPECT_TRUE(mgr.Init(traineddata_path.c_str()));
+  LSTMTester tester(1000000000);
+  GenericVector<STRING> filenames;
+  filenames.push_back(STRING(TestDataNameToPath("eng.Arial.exp0.lstmf").c_str()));
+  EXPECT_TRUE(tester.LoadAllEvalData(filenames));
+  double errors[ET_COUNT] = {0.0};
+  STRING serial_result = tester.RunEvalSync(1, errors, mgr, 0, 0);
+  tester.set_num_threads(4);
+  STRING parallel_result = tester.RunEvalSync(1, errors, mgr, 0, 0);
+  LOG(INFO) << serial_result.c_str() << "\n";
+  EXPECT_STREQ(serial_result.c_str(), parallel_result.c_str());
+  // Request two evaluations at once, then poll until the second has reported,
+  // giving up after a minute rather than hanging.
+  EXPECT_STREQ("", tester.RunEvalAsync(2, errors, mgr, 0).c_str());
+  std::string async_results = tester.RunEvalAsync(3, errors, mgr, 0).c_str();
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::minutes(1);
+  while (async_results.find("At iteration 3,") == std::string::npos &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    async_results += tester.RunEvalAsync(3, nullptr, mgr, 0).c_str();
+  }
+  LOG(INFO) << async_results << "\n";
+  ASSERT_NE(std::string::npos, async_results.find("At iteration 3,"))
+      << "Timed out waiting for the asynchronous evaluation";
+  // The first either started before the second came, or was replaced by it.
+  bool ran = async_results.find("At iteration 2,") != std::string::npos;
+  bool replaced =
+      async_results.find("Replaced waiting test at iteration 2 with test at "
+                         "iteration 3") != std::string::npos;
+  EXPECT_NE(ran, replaced);
+  // The destructor runs this one.
+  tester.RunEvalAsync(4, errors, mgr, 0);
+}
+
 // The baseline network against which to test the built-in softmax.
 TEST_F(LSTMTrainerTest, SoftmaxBaselineTest) {
   // A basic single-layer, single direction LSTM.
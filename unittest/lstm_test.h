@@ -12,8 +12,10 @@
 #ifndef TESSERACT_UNITTEST_LSTM_TEST_H_
 #define TESSERACT_UNITTEST_LSTM_TEST_H_
 
+#include <chrono>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 
 #include "include_gunit.h"
@@ -25,6 +27,7 @@
 #include "functions.h"
 #include "lang_model_helpers.h"
 #include "log.h"                        // for LOG
+#include "lstmtester.h"
 #include "lstmtrainer.h"
 #include "unicharset.h"
 
@@ -21,6 +21,9 @@
 // TrainingSampleSet, TrainingSample can all serialize/deserialize correctly
 // enough to reproduce the same results.
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <string>
 #include <utility>
 #include <vector>
@@ -30,13 +33,18 @@
 
 #include "include_gunit.h"
 
+#include "cycletimer.h"                 // for CycleTimer
 #include "genericvector.h"
+#include <tesseract/helpers.h>         // for ClipToRange, IntCastRounded
+#include "intmatcher.h"                 // for IntegerMatcher
 #include "log.h"                        // for LOG
 #include "unicharset.h"
 #include "errorcounter.h"
 #include "mastertrainer.h"
+#include "protodistance.h"
 #include "shapeclassifier.h"
 #include "shapetable.h"
+#include "simddetect.h"                 // for ProtoDistances
 #include "trainingsample.h"
 #include "commontraining.h"
 #include "tessopt.h"                    // tessoptind
@@ -304,4 +312,98 @@ TEST_F(MasterTrainerTest, ErrorCounterTest) {
 #endif
 }
 
+// Compares the proto distances of the integer matcher computed by the
+// kernel that SIMDDetect chose for this machine with the scalar ones, and
+// times both, on the features of the samples of the master trainer. Each
+// sample is matched against protos made from its own features, as in a
+// class template, so the distances cover the whole range of evidences.
+TEST_F(MasterTrainerTest, ProtoDistanceBenchmark) {
+#ifdef DISABLED_LEGACY_ENGINE
+  // Skip test because LoadTrainingData is missing.
+  GTEST_SKIP();
+#else
+  const int kIterations = 20;
+  // As set up by IntegerMatcher::Init.
+  const int kMultTruncShiftBits = 14 - IntegerMatcher::kIntEvidenceTruncBits;
+  const int kTableTruncShiftBits =
+      27 - SE_TABLE_BITS - (kMultTruncShiftBits << 1);
+  LoadMasterTrainer();
+  const TrainingSampleSet* samples = master_trainer_->GetSamples();
+  std::vector<std::vector<uint32_t>> sample_protos(samples->num_samples());
+  int num_distances = 0;
+  for (int s = 0; s < samples->num_samples(); ++s) {
+    const TrainingSample* sample = samples->GetSample(s);
+    int num_protos = std::min<int>(sample->num_features(), PROTOS_PER_PROTO_SET);
+    for (int f = 0; f < num_protos; ++f) {
+      // The line through the feature in its direction, converted as in
+      // Classify::ConvertProto, with B kept positive.
+      const INT_FEATURE_STRUCT& feature = sample->features()[f];
+      double angle = feature.Theta * 2.0 * M_PI / 256.0;
+      double a = -sin(angle);
+      double b = cos(angle);
+      if (b > 0.0) {
+        a = -a;
+        b = -b;
+      }
+      double c = -(a * (feature.X - 128) + b * (feature.Y - 128)) / 256.0;
+      struct {
+        int8_t a;
+        uint8_t b;
+        int8_t c;
+        uint8_t angle;
+      } proto;
+      proto.a = ClipToRange<int>(IntCastRounded(a * 128), -128, 127);
+      proto.b = ClipToRange<int>(IntCastRounded(-b * 256), 0, 255);
+      proto.c = ClipToRange<int>(IntCastRounded(c * 128), -128, 127);
+      proto.angle = feature.Theta;
+      uint32_t packed;
+      memcpy(&packed, &proto, sizeof(packed));
+      sample_protos[s].push_back(packed);
+    }
+    num_distances += sample->num_features() * num_protos;
+  }
+  EXPECT_GT(num_distances, 0);
+
+  // Returns a checksum of all the distances computed by distances_fn.
+  auto match_all = [&](ProtoDistanceFunction distances_fn) {
+    std::vector<uint32_t> distances(PROTOS_PER_PROTO_SET);
+    uint64_t checksum = 0;
+    ProtoDistanceParams params;
+    params.theta_fudge = IntegerMatcher::kIntThetaFudge;
+    params.mult_trunc_shift_bits = kMultTruncShiftBits;
+    params.evidence_mult_mask =
+        (1 << IntegerMatcher::kIntEvidenceTruncBits) - 1;
+    params.table_trunc_shift_bits = kTableTruncShiftBits;
+    for (int s = 0; s < samples->num_samples(); ++s) {
+      const TrainingSample* sample = samples->GetSample(s);
+      const std::vector<uint32_t>& protos = sample_protos[s];
+      for (int f = 0; f < sample->num_features(); ++f) {
+        params.x = sample->features()[f].X;
+        params.y = sample->features()[f].Y;
+        params.theta = sample->features()[f].Theta;
+        distances_fn(protos.data(), protos.size(), params, distances.data());
+        for (size_t p = 0; p < protos.size(); ++p) {
+          checksum = checksum * 31 + distances[p];
+        }
+      }
+    }
+    return checksum;
+  };
+  EXPECT_EQ(match_all(ProtoDistancesGeneric), match_all(ProtoDistances));
+
+  CycleTimer timer;
+  timer.Restart();
+  for (int i = 0; i < kIterations; ++i) match_all(ProtoDistancesGeneric);
+  timer.Stop();
+  int64_t generic_ms = timer.GetInMs();
+  timer.Restart();
+  for (int i = 0; i < kIterations; ++i) match_all(ProtoDistances);
+  timer.Stop();
+  int64_t best_ms = timer.GetInMs();
+  LOG(INFO) << num_distances << " proto distances x " << kIterations
+            << ": scalar " << generic_ms << "ms, selected kernel " << best_ms
+            << "ms\n";
+#endif
+}
+
 } // namespace tesseract
@@ -190,4 +190,37 @@ TEST_F(NetworkioTest, CopyWithXYTranspose) {
   EXPECT_EQ(next_t, 40);
 }
 
+// Tests that CopyBatchItemFrom extracts the valid time steps of one batch
+// item, keeping its shape, and CopyBatchItemTo puts them back.
+TEST_F(NetworkioTest, CopyBatchItem) {
+  NetworkIO nio;
+  SetupNetworkIO(&nio);
+  NetworkIO item;
+  item.CopyBatchItemFrom(nio, 1);
+  EXPECT_EQ(item.Width(), 20);
+  EXPECT_EQ(item.stride_map().Size(FD_BATCH), 1);
+  EXPECT_EQ(item.stride_map().Size(FD_HEIGHT), 4);
+  EXPECT_EQ(item.stride_map().Size(FD_WIDTH), 5);
+  for (int t = 0; t < item.Width(); ++t) {
+    EXPECT_EQ(item.i(t)[0], 12 + t);
+    EXPECT_EQ(item.i(t)[1], -12 - t);
+  }
+  NetworkIO copy;
+  copy.ResizeToMap(true, nio.stride_map(), 2);
+  copy.Zero();
+  item.CopyBatchItemTo(1, &copy);
+  StrideMap::Index index(copy.stride_map());
+  do {
+    int t = index.t();
+    if (index.index(FD_BATCH) == 1) {
+      EXPECT_EQ(copy.i(t)[0], nio.i(t)[0]);
+      EXPECT_EQ(copy.i(t)[1], nio.i(t)[1]);
+    } else {
+      // Batch item 0 is untouched.
+      EXPECT_EQ(copy.i(t)[0], 0);
+      EXPECT_EQ(copy.i(t)[1], 0);
+    }
+  } while (index.Increment());
+}
+
 }  // namespace
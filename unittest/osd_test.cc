@@ -130,4 +130,68 @@ INSTANTIATE_TEST_CASE_P(
                        ::testing::Values(TESTING_DIR "/devatest.png"),
                        ::testing::Values(TESSDATA_DIR "_fast")));
 
+#ifndef DISABLED_LEGACY_ENGINE
+// Detects the orientation and script of image with the given osd_jobs and
+// osd_max_resolution.
+static void DetectWith(tesseract::TessBaseAPI* api, Pix* image,
+                       const char* jobs, const char* max_resolution,
+                       int* orient_deg, std::string* script) {
+  api->SetVariable("osd_jobs", jobs);
+  api->SetVariable("osd_max_resolution", max_resolution);
+  api->SetImage(image);
+  float orient_conf;
+  const char* script_name;
+  float script_conf;
+  ASSERT_TRUE(api->DetectOrientationScript(orient_deg, &orient_conf,
+                                           &script_name, &script_conf))
+      << "Failed to detect OSD with osd_jobs " << jobs
+      << " and osd_max_resolution " << max_resolution;
+  *script = script_name;
+}
+#endif
+
+class OSDSpeedupTest : public TestClass,
+                       public ::testing::WithParamInterface<const char*> {};
+
+// Tests that classifying the blobs on several threads, and on a copy of the
+// page at half and at a quarter of its resolution, finds the same
+// orientation and script as the serial search at full resolution.
+TEST_P(OSDSpeedupTest, MatchesSerialFullResolution) {
+#ifdef DISABLED_LEGACY_ENGINE
+  // Skip test because TessBaseAPI::DetectOrientationScript is missing.
+  GTEST_SKIP();
+#else
+  std::unique_ptr<tesseract::TessBaseAPI> api(new tesseract::TessBaseAPI());
+  ASSERT_FALSE(api->Init(TESSDATA_DIR "_fast", "osd"))
+      << "Could not initialize tesseract.";
+  Pix* image = pixRead(GetParam());
+  ASSERT_TRUE(image != nullptr) << "Failed to read test image.";
+  // With a known resolution, osd_max_resolution reduces the page.
+  pixSetResolution(image, 300, 300);
+  int serial_deg = -1;
+  std::string serial_script;
+  DetectWith(api.get(), image, "1", "0", &serial_deg, &serial_script);
+  const char* settings[][2] = {{"4", "0"}, {"1", "150"}, {"4", "75"}};
+  for (const auto& setting : settings) {
+    int orient_deg = -1;
+    std::string script;
+    DetectWith(api.get(), image, setting[0], setting[1], &orient_deg,
+               &script);
+    EXPECT_EQ(serial_deg, orient_deg)
+        << "osd_jobs " << setting[0] << ", osd_max_resolution " << setting[1];
+    EXPECT_EQ(serial_script, script)
+        << "osd_jobs " << setting[0] << ", osd_max_resolution " << setting[1];
+  }
+  api->End();
+  pixDestroy(&image);
+#endif
+}
+
+INSTANTIATE_TEST_CASE_P(
+    TessdataFastRotated, OSDSpeedupTest,
+    ::testing::Values(TESTING_DIR "/phototest.tif",
+                      TESTING_DIR "/phototest-rotated-R.png",
+                      TESTING_DIR "/phototest-rotated-180.png",
+                      TESTING_DIR "/devatest-rotated-270.png"));
+
 }  // namespace
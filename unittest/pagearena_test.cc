@@ -0,0 +1,136 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <thread>
+
+#include "blobs.h"
+#include "clst.h"
+#include "pagearena.h"
+#include "pageres.h"
+#include "ratngs.h"
+#include "unicharset.h"
+
+#include "include_gunit.h"
+
+namespace tesseract {
+
+class PageArenaTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    std::locale::global(std::locale(""));
+  }
+};
+
+// Tests that list cells cost no more than their two pointers.
+TEST_F(PageArenaTest, ListCellsHaveNoHeader) {
+  EXPECT_EQ(2 * sizeof(void*), sizeof(CLIST_LINK));
+}
+
+// Tests that objects come from the arena only while a scope is open for it,
+// and that blocks deleted in the scope are reused.
+TEST_F(PageArenaTest, AllocatesInScope) {
+  auto* arena = new PageArena;
+  auto* heap_pt = new EDGEPT;
+  EDGEPT* arena_pt;
+  TBLOB* arena_blob;
+  {
+    PageArena::Scope scope(arena);
+    arena_pt = new EDGEPT;
+    arena_blob = new TBLOB;
+    EXPECT_EQ(2, arena->num_allocated());
+    {
+      // A nested scope without an arena uses the heap.
+      PageArena::Scope heap_scope(nullptr);
+      delete new EDGEPT;
+      EXPECT_EQ(2, arena->num_allocated());
+    }
+    delete arena_pt;
+    EXPECT_EQ(1, arena->num_allocated());
+    // The block of the deleted point is the next one of its size.
+    EDGEPT* reused_pt = new EDGEPT;
+    EXPECT_EQ(arena_pt, reused_pt);
+    arena_pt = reused_pt;
+    delete heap_pt;
+    EXPECT_EQ(2, arena->num_allocated());
+    // The owner, the scope and the two objects.
+    EXPECT_EQ(4, arena->num_refs());
+  }
+  EXPECT_EQ(1, arena->num_chunks());
+  delete arena_blob;
+  delete arena_pt;
+  EXPECT_EQ(1, arena->num_refs());
+  arena->Release();
+}
+
+// Tests that objects deleted outside the scope of their arena, on its thread
+// or any other, leave their blocks to go with the arena.
+TEST_F(PageArenaTest, DeletesOutsideScopeLeaveBlocks) {
+  auto* arena = new PageArena;
+  EDGEPT* pt;
+  EDGEPT* other_pt;
+  {
+    PageArena::Scope scope(arena);
+    pt = new EDGEPT;
+    other_pt = new EDGEPT;
+  }
+  delete pt;
+  std::thread other_thread([other_pt] { delete other_pt; });
+  other_thread.join();
+  EXPECT_EQ(2, arena->num_allocated());
+  EXPECT_EQ(1, arena->num_refs());
+  {
+    PageArena::Scope scope(arena);
+    EDGEPT* new_pt = new EDGEPT;
+    EXPECT_NE(pt, new_pt);
+    EXPECT_NE(other_pt, new_pt);
+    delete new_pt;
+  }
+  arena->Release();
+}
+
+// Tests that a word taken out of the results stays valid after the PAGE_RES
+// that owns the arena is deleted, and that deleting it afterwards, on
+// another thread, gives the arena back.
+TEST_F(PageArenaTest, DetachedResultOutlivesPage) {
+  UNICHARSET unicharset;
+  auto* page_res = new PAGE_RES;
+  auto* arena = new PageArena;
+  page_res->arena = arena;
+  WERD_RES* word;
+  {
+    PageArena::Scope scope(arena);
+    word = new WERD_RES;
+    word->best_choice = new WERD_CHOICE(&unicharset, 1);
+    word->best_choice->append_unichar_id_space_allocated(UNICHAR_SPACE, 1,
+                                                         0.0f, 0.0f);
+  }
+  delete page_res;
+  // The arena is kept by the word and its choice.
+  EXPECT_EQ(2, arena->num_refs());
+  EXPECT_EQ(1, word->best_choice->length());
+  std::thread other_thread([word] { delete word; });
+  other_thread.join();
+}
+
+// Tests that without an arena, the objects use the heap.
+TEST_F(PageArenaTest, AllocatesOnTheHeap) {
+  auto* arena = new PageArena;
+  {
+    PageArena::Scope scope(nullptr);
+    delete new EDGEPT;
+    delete new TBLOB;
+  }
+  EXPECT_EQ(0, arena->num_allocated());
+  EXPECT_EQ(0, arena->num_chunks());
+  EXPECT_EQ(1, arena->num_refs());
+  arena->Release();
+}
+
+}  // namespace tesseract
@@ -0,0 +1,112 @@
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <thread>
+#include <vector>
+
+#include "adaptive.h"
+#include "blobfeatures.h"
+#include "classify.h"
+#include "intproto.h"
+#include "sharedadapt.h"
+
+#include "include_gunit.h"
+
+namespace tesseract {
+
+class SharedAdaptTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    std::locale::global(std::locale(""));
+  }
+
+  // Learns one more config of class 0, making the templates if needed.
+  void AddConfig(ADAPT_TEMPLATES* templates) {
+    if (*templates == nullptr) {
+      *templates = classify_.NewAdaptedTemplates(false);
+      AddAdaptedClass(*templates, NewAdaptedClass(), 0);
+    }
+    AddIntConfig(ClassForClassId((*templates)->Templates, 0));
+  }
+
+  static int NumConfigs(const ADAPT_TEMPLATES_STRUCT* templates) {
+    return ClassForClassId(templates->Templates, 0)->NumConfigs;
+  }
+
+  Classify classify_;
+};
+
+// Tests that a copy is only made when the master has changed.
+TEST_F(SharedAdaptTest, CopiesOnlyNewVersions) {
+  SharedAdaptedTemplates shared;
+  int version = 0;
+  EXPECT_EQ(nullptr, shared.UpdatedCopy(&version));
+  shared.Update([this](ADAPT_TEMPLATES* templates) { AddConfig(templates); });
+  shared.Update([this](ADAPT_TEMPLATES* templates) { AddConfig(templates); });
+  ADAPT_TEMPLATES copy = shared.UpdatedCopy(&version);
+  ASSERT_NE(nullptr, copy);
+  EXPECT_EQ(2, version);
+  EXPECT_EQ(2, NumConfigs(copy));
+  EXPECT_EQ(nullptr, shared.UpdatedCopy(&version));
+  // The copy is the reader's own.
+  AddConfig(&copy);
+  shared.Update([this](ADAPT_TEMPLATES* templates) { AddConfig(templates); });
+  ADAPT_TEMPLATES next_copy = shared.UpdatedCopy(&version);
+  ASSERT_NE(nullptr, next_copy);
+  EXPECT_EQ(3, NumConfigs(next_copy));
+  free_adapted_templates(copy);
+  free_adapted_templates(next_copy);
+}
+
+// Tests that readers copying while the master changes always get a whole
+// version of it.
+TEST_F(SharedAdaptTest, CopiesAreConsistent) {
+  SharedAdaptedTemplates shared;
+  const int kNumReaders = 4;
+  std::vector<std::thread> readers;
+  for (int r = 0; r < kNumReaders; ++r) {
+    readers.emplace_back([&shared] {
+      int version = 0;
+      while (version < MAX_NUM_CONFIGS) {
+        ADAPT_TEMPLATES copy = shared.UpdatedCopy(&version);
+        if (copy == nullptr) continue;
+        EXPECT_EQ(version, NumConfigs(copy));
+        free_adapted_templates(copy);
+      }
+    });
+  }
+  for (int i = 0; i < MAX_NUM_CONFIGS; ++i) {
+    shared.Update([this](ADAPT_TEMPLATES* templates) { AddConfig(templates); });
+  }
+  for (auto& reader : readers) reader.join();
+  EXPECT_EQ(MAX_NUM_CONFIGS, shared.version());
+}
+
+// Tests that once a class of the master is full, a worker that takes a copy
+// can no longer learn it either, as documented in sharedadapt.h.
+TEST_F(SharedAdaptTest, FullClassStopsLearning) {
+  SharedAdaptedTemplates shared;
+  for (int i = 0; i < MAX_NUM_CONFIGS; ++i) {
+    shared.Update([this](ADAPT_TEMPLATES* templates) { AddConfig(templates); });
+  }
+  int version = 0;
+  ADAPT_TEMPLATES copy = shared.UpdatedCopy(&version);
+  ASSERT_NE(nullptr, copy);
+  EXPECT_EQ(MAX_NUM_CONFIGS, NumConfigs(copy));
+  EXPECT_FALSE(classify_.AdaptiveClassifierIsFull());
+  INT_FEATURE_ARRAY features;
+  GenericVector<PicoFeature> float_features;
+  EXPECT_EQ(-1, classify_.MakeNewTemporaryConfig(copy, 0, 0, 0, features,
+                                                 float_features));
+  EXPECT_TRUE(classify_.AdaptiveClassifierIsFull());
+  free_adapted_templates(copy);
+}
+
+}  // namespace tesseract
@@ -0,0 +1,168 @@
+///////////////////////////////////////////////////////////////////////
+// File:        weightupdate_test.cc
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+///////////////////////////////////////////////////////////////////////
+
+#include "weightupdate.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include "include_gunit.h"
+#include "matrix.h"
+#include "simddetect.h"
+#include <tesseract/helpers.h>
+
+namespace tesseract {
+
+// Number of weights in the random matrices.
+const int kNumRows = 3;
+const int kNumCols = 333;
+
+class WeightUpdateTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::locale::global(std::locale(""));
+  }
+
+  // Makes a matrix of random values in [-range, range], or [0, range] if
+  // positive.
+  GENERIC_2D_ARRAY<double> RandomMatrix(double range, bool positive) {
+    GENERIC_2D_ARRAY<double> a(kNumRows, kNumCols, 0.0);
+    for (int i = 0; i < kNumRows; ++i) {
+      for (int j = 0; j < kNumCols; ++j) {
+        a(i, j) = positive ? random_.UnsignedRand(range)
+                           : random_.SignedRand(range);
+      }
+    }
+    return a;
+  }
+
+  // The arrays of a weight matrix.
+  struct Arrays {
+    GENERIC_2D_ARRAY<double> dw, updates, sq_sum, weights;
+  };
+  Arrays RandomArrays() {
+    Arrays arrays;
+    arrays.dw = RandomMatrix(1.0, false);
+    arrays.updates = RandomMatrix(0.1, false);
+    arrays.sq_sum = RandomMatrix(0.01, true);
+    arrays.weights = RandomMatrix(1.0, false);
+    return arrays;
+  }
+
+  static WeightUpdateParams MakeParams(double momentum) {
+    WeightUpdateParams params;
+    params.dw_scale = 1e-3 * (1.0 - momentum);
+    params.momentum = momentum;
+    params.beta = 0.999;
+    params.epsilon = 1e-11;
+    return params;
+  }
+
+  // Runs the given kernels on each row of arrays, with all the lengths
+  // either side of the register size at the start of the rows.
+  static void RunKernels(const WeightUpdateParams& params, bool adam,
+                         AdamUpdateFunction adam_kernel,
+                         MomentumUpdateFunction momentum_kernel,
+                         Arrays* arrays) {
+    for (int i = 0; i < kNumRows; ++i) {
+      for (int start = 0; start < kNumCols;) {
+        int n = start < 20 ? start % 9 + 1 : kNumCols;
+        n = std::min(n, kNumCols - start);
+        if (adam) {
+          adam_kernel(params, n, arrays->dw[i] + start,
+                      arrays->updates[i] + start, arrays->sq_sum[i] + start,
+                      arrays->weights[i] + start);
+        } else {
+          momentum_kernel(params, n, arrays->dw[i] + start,
+                          arrays->updates[i] + start,
+                          arrays->weights[i] + start);
+        }
+        start += n;
+      }
+    }
+  }
+
+  // Tests that the given kernels get the same results as the generic ones.
+  void ExpectEqualResults(AdamUpdateFunction adam_kernel,
+                          MomentumUpdateFunction momentum_kernel) {
+    for (bool adam : {false, true}) {
+      for (double momentum : {-1.0, 0.0, 0.5, 0.9}) {
+        if (adam && momentum <= 0.0) continue;
+        WeightUpdateParams params = MakeParams(momentum);
+        Arrays expected = RandomArrays();
+        Arrays actual = expected;
+        RunKernels(params, adam, AdamUpdateWeightsGeneric,
+                   MomentumUpdateWeightsGeneric, &expected);
+        RunKernels(params, adam, adam_kernel, momentum_kernel, &actual);
+        ExpectEqualArrays(expected, actual);
+      }
+    }
+  }
+
+  static void ExpectEqualArrays(const Arrays& expected, const Arrays& actual) {
+    for (int i = 0; i < kNumRows; ++i) {
+      for (int j = 0; j < kNumCols; ++j) {
+        EXPECT_EQ(expected.dw(i, j), actual.dw(i, j));
+        EXPECT_EQ(expected.updates(i, j), actual.updates(i, j));
+        EXPECT_EQ(expected.sq_sum(i, j), actual.sq_sum(i, j));
+        EXPECT_EQ(expected.weights(i, j), actual.weights(i, j));
+      }
+    }
+  }
+
+  TRand random_;
+};
+
+// Tests the generic kernels against the whole matrix operations that
+// WeightMatrix::Update used to do.
+TEST_F(WeightUpdateTest, Generic) {
+  for (double momentum : {-1.0, 0.0, 0.5, 0.9}) {
+    WeightUpdateParams params = MakeParams(momentum);
+    Arrays expected = RandomArrays();
+    Arrays actual = expected;
+    expected.dw *= params.dw_scale;
+    expected.updates += expected.dw;
+    if (momentum > 0.0) expected.weights += expected.updates;
+    if (momentum >= 0.0) expected.updates *= momentum;
+    RunKernels(params, false, AdamUpdateWeightsGeneric,
+               MomentumUpdateWeightsGeneric, &actual);
+    ExpectEqualArrays(expected, actual);
+  }
+  WeightUpdateParams params = MakeParams(0.9);
+  Arrays expected = RandomArrays();
+  Arrays actual = expected;
+  expected.sq_sum.SumSquares(expected.dw, params.beta);
+  expected.dw *= params.dw_scale;
+  expected.updates *= params.momentum;
+  expected.updates += expected.dw;
+  expected.weights.AdamUpdate(expected.updates, expected.sq_sum,
+                              params.epsilon);
+  RunKernels(params, true, AdamUpdateWeightsGeneric,
+             MomentumUpdateWeightsGeneric, &actual);
+  ExpectEqualArrays(expected, actual);
+}
+
+// Tests that the AVX implementation gets the same result as the generic.
+TEST_F(WeightUpdateTest, AVX) {
+#if defined(HAVE_AVX)
+  if (!SIMDDetect::IsAVXAvailable()) {
+    GTEST_LOG_(INFO) << "No AVX found! Not tested!";
+    GTEST_SKIP();
+  }
+  ExpectEqualResults(AdamUpdateWeightsAVX, MomentumUpdateWeightsAVX);
+#else
+  GTEST_LOG_(INFO) << "AVX unsupported! Not tested!";
+  GTEST_SKIP();
+#endif
+}
+
+}  // namespace tesseract